@@ -0,0 +1,57 @@
+/**
+*	Filename: amesh.h
+*
+*	Description: Binary cooked mesh format, the payload can be uploaded to OpenGL straight from a mapped file
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef AMESH_H
+#define AMESH_H
+#include <cstdint>
+
+/**
+* File layout:
+* [AMeshHeader][AMeshAttribute * attributeCount][padding][index data][padding][vertex data]
+* Index and vertex data start on a AMESH_ALIGNMENT boundary, all values are little endian.
+*/
+#define AMESH_MAGIC 0x48534D41 // "AMSH"
+#define AMESH_VERSION 1
+#define AMESH_ALIGNMENT 16
+#define AMESH_MAX_ATTRIBUTES 8
+
+/**
+* Describes a single vertex attribute, as passed to glVertexAttribPointer
+*/
+struct AMeshAttribute {
+	uint32_t location; /// @brief The attribute location in the shader
+	uint32_t components; /// @brief Amount of components, 1 to 4
+	uint32_t type; /// @brief OpenGL type of the components, i.e GL_FLOAT
+	uint32_t normalized; /// @brief 1 if integer components should be normalized
+	uint32_t offset; /// @brief Offset in bytes from the start of the vertex
+};
+
+struct AMeshHeader {
+	uint32_t magic; /// @brief Always AMESH_MAGIC
+	uint32_t version; /// @brief Always AMESH_VERSION
+	uint32_t vertexCount; /// @brief Amount of vertices
+	uint32_t indexCount; /// @brief Amount of indices, 3 for every triangle
+	uint32_t vertexStride; /// @brief Size of a vertex in bytes
+	uint32_t indexType; /// @brief GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	uint32_t attributeCount; /// @brief Amount of attributes following the header
+	uint32_t reserved; /// @brief Unused, keeps the offsets 8 byte aligned
+	float boundsMin[3]; /// @brief Minimum of the axis aligned bounding box
+	float boundsMax[3]; /// @brief Maximum of the axis aligned bounding box
+	float sphereCenter[3]; /// @brief Center of the bounding sphere
+	float sphereRadius; /// @brief Radius of the bounding sphere
+	uint64_t indexOffset; /// @brief Offset of the index data from the start of the file
+	uint64_t indexSize; /// @brief Size of the index data in bytes
+	uint64_t vertexOffset; /// @brief Offset of the vertex data from the start of the file
+	uint64_t vertexSize; /// @brief Size of the vertex data in bytes
+};
+
+static_assert(sizeof(AMeshHeader) == 104, "AMeshHeader layout changed, bump AMESH_VERSION");
+static_assert(sizeof(AMeshAttribute) == 20, "AMeshAttribute layout changed, bump AMESH_VERSION");
+
+#endif // !AMESH_H
\ No newline at end of file
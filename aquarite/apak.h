@@ -0,0 +1,54 @@
+/**
+*	Filename: apak.h
+*
+*	Description: Packed asset archive format, many assets in a single file that is mapped once
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef APAK_H
+#define APAK_H
+#include <cstdint>
+
+/**
+* File layout:
+* [APakHeader][APakEntry * entryCount][uint32_t bucket * bucketCount][paths][padding][payload][padding][payload]...
+* Every payload starts on a APAK_ALIGNMENT boundary, all values are little endian.
+* Buckets hold the entry index + 1, or 0 if empty. A path is found by probing linearly from its FNV-1a hash.
+*/
+#define APAK_MAGIC 0x4B415041 // "APAK"
+#define APAK_VERSION 1
+#define APAK_ALIGNMENT 4096
+#define APAK_COMPRESSION_NONE 0 // Payload is stored as is, and can be used straight from the mapping
+#define APAK_COMPRESSION_LZ4 1 // Payload is a single LZ4 block
+#define APAK_LZ4_MAX_RATIO 255 // LZ4 can not expand a block more than this, larger original sizes are rejected
+
+/**
+* A single asset in the archive
+*/
+struct APakEntry {
+	uint32_t pathHash; /// @brief FNV-1a hash of the path
+	uint32_t compression; /// @brief APAK_COMPRESSION_NONE or APAK_COMPRESSION_LZ4
+	uint32_t pathOffset; /// @brief Offset of the path from the start of the paths
+	uint32_t pathLength; /// @brief Length of the path, without terminator
+	uint64_t offset; /// @brief Offset of the payload from the start of the file
+	uint64_t size; /// @brief Size of the stored payload in bytes
+	uint64_t originalSize; /// @brief Size of the asset after decompressing
+};
+
+struct APakHeader {
+	uint32_t magic; /// @brief Always APAK_MAGIC
+	uint32_t version; /// @brief Always APAK_VERSION
+	uint32_t entryCount; /// @brief Amount of entries
+	uint32_t bucketCount; /// @brief Amount of buckets, a power of two
+	uint64_t entryOffset; /// @brief Offset of the entries from the start of the file
+	uint64_t bucketOffset; /// @brief Offset of the buckets from the start of the file
+	uint64_t pathOffset; /// @brief Offset of the paths from the start of the file
+	uint64_t pathSize; /// @brief Size of the paths in bytes
+};
+
+static_assert(sizeof(APakHeader) == 48, "APakHeader layout changed, bump APAK_VERSION");
+static_assert(sizeof(APakEntry) == 40, "APakEntry layout changed, bump APAK_VERSION");
+
+#endif // !APAK_H
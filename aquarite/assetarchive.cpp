@@ -0,0 +1,266 @@
+/**
+*	Filename: assetarchive.cpp
+*
+*	Description: Source file for AssetArchive class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include "assetarchive.h"
+#include "lz4block.h"
+#include "resourcehandle.h"
+#include "debug.h"
+
+std::vector<AssetArchive*> AssetArchive::_mounted; // declare mounted archives
+
+/**
+* Pads the stream with zeros up to the alignment
+*/
+static void AlignStream(std::ofstream& stream, size_t alignment) {
+	static const char zeros[APAK_ALIGNMENT] = {};
+	size_t position = (size_t)stream.tellp();
+	size_t padding = (alignment - (position % alignment)) % alignment;
+	stream.write(zeros, padding);
+}
+
+/**
+* Returns true if length bytes at offset lie within size bytes, without overflowing
+*/
+static bool InRange(uint64_t offset, uint64_t length, uint64_t size) {
+	return length <= size && offset <= size - length;
+}
+
+AssetArchive::AssetArchive() {
+	this->header = nullptr;
+	this->entries = nullptr;
+	this->buckets = nullptr;
+	this->paths = nullptr;
+}
+
+bool AssetArchive::Open(std::string path, std::string root) {
+	this->header = nullptr;
+	if (!file.Open(path)) return false;
+
+	const unsigned char* data = file.GetData();
+	size_t size = file.GetSize();
+	if (size < sizeof(APakHeader)) {
+		Debug::Log("Invalid archive " + path, typeid(*this).name());
+		return false;
+	}
+
+	const APakHeader* fileHeader = (const APakHeader*)data;
+	if (fileHeader->magic != APAK_MAGIC || fileHeader->version != APAK_VERSION) {
+		Debug::Log("Invalid archive or version " + path, typeid(*this).name());
+		return false;
+	}
+
+	//Validate the table of contents once, so lookups do not have to
+	bool valid = fileHeader->bucketCount != 0 && (fileHeader->bucketCount & (fileHeader->bucketCount - 1)) == 0 &&
+		fileHeader->entryCount < fileHeader->bucketCount &&
+		InRange(fileHeader->entryOffset, (uint64_t)fileHeader->entryCount * sizeof(APakEntry), size) &&
+		InRange(fileHeader->bucketOffset, (uint64_t)fileHeader->bucketCount * sizeof(uint32_t), size) &&
+		InRange(fileHeader->pathOffset, fileHeader->pathSize, size) &&
+		fileHeader->entryOffset % sizeof(uint64_t) == 0 && fileHeader->bucketOffset % sizeof(uint32_t) == 0;
+
+	const APakEntry* fileEntries = (const APakEntry*)(data + fileHeader->entryOffset);
+	for (uint32_t i = 0; i < fileHeader->entryCount && valid; i++) {
+		const APakEntry& entry = fileEntries[i];
+		valid = (entry.compression == APAK_COMPRESSION_NONE || entry.compression == APAK_COMPRESSION_LZ4) &&
+			InRange(entry.pathOffset, entry.pathLength, fileHeader->pathSize) && InRange(entry.offset, entry.size, size) &&
+			(entry.compression != APAK_COMPRESSION_NONE || entry.size == entry.originalSize) &&
+			(entry.compression != APAK_COMPRESSION_LZ4 || entry.originalSize <= entry.size * APAK_LZ4_MAX_RATIO); // Size is bounded by the file, so this can not overflow
+	}
+
+	//Find probes until it reaches a empty bucket, a table without one would make it loop forever
+	const uint32_t* fileBuckets = (const uint32_t*)(data + fileHeader->bucketOffset);
+	uint32_t emptyBuckets = 0;
+	for (uint32_t i = 0; i < fileHeader->bucketCount && valid; i++) {
+		valid = fileBuckets[i] <= fileHeader->entryCount;
+		if (fileBuckets[i] == 0) emptyBuckets++;
+	}
+	valid = valid && emptyBuckets > 0;
+
+	if (!valid) {
+		Debug::Log("Corrupt archive " + path, typeid(*this).name());
+		file.Close();
+		return false;
+	}
+
+	this->header = fileHeader;
+	this->entries = fileEntries;
+	this->buckets = fileBuckets;
+	this->paths = (const char*)(data + fileHeader->pathOffset);
+	this->root = NormalizePath(root);
+	return true;
+}
+
+const APakEntry* AssetArchive::Find(std::string path) {
+	if (!header) return nullptr;
+
+	path = NormalizePath(path, root);
+	uint32_t hash = HashResourceName(path);
+	uint32_t mask = header->bucketCount - 1;
+
+	//The table is at most half full, so probing always ends at a empty bucket
+	for (uint32_t bucket = hash & mask; buckets[bucket] != 0; bucket = (bucket + 1) & mask) {
+		const APakEntry* entry = &entries[buckets[bucket] - 1];
+		if (entry->pathHash == hash && entry->pathLength == path.size() && memcmp(paths + entry->pathOffset, path.data(), path.size()) == 0) {
+			return entry;
+		}
+	}
+
+	return nullptr;
+}
+
+const unsigned char* AssetArchive::GetPayload(const APakEntry* entry) {
+	return file.GetData() + entry->offset;
+}
+
+bool AssetArchive::Decompress(const APakEntry* entry, std::vector<unsigned char>& data) {
+	data.resize((size_t)entry->originalSize);
+	if (entry->compression == APAK_COMPRESSION_NONE) {
+		if (!data.empty()) memcpy(data.data(), GetPayload(entry), data.size());
+		return true;
+	}
+
+	return LZ4Block::Decompress(GetPayload(entry), (size_t)entry->size, data.data(), data.size());
+}
+
+size_t AssetArchive::GetEntryCount() {
+	return header ? header->entryCount : 0;
+}
+
+std::string AssetArchive::NormalizePath(std::string path, std::string root) {
+	for (size_t i = 0; i < path.size(); i++) {
+		if (path[i] == '\\') path[i] = '/';
+	}
+	for (size_t i = 0; i < root.size(); i++) {
+		if (root[i] == '\\') root[i] = '/';
+	}
+
+	if (!root.empty() && path.compare(0, root.size(), root) == 0) path.erase(0, root.size());
+	while (path.compare(0, 2, "./") == 0) path.erase(0, 2);
+	return path;
+}
+
+bool AssetArchive::Write(std::string archivePath, std::string root, const std::vector<std::string>& files, bool compress) {
+	std::vector<APakEntry> archiveEntries(files.size());
+	std::vector<std::vector<unsigned char>> payloads(files.size());
+	std::string archivePaths;
+
+	uint32_t bucketCount = 16;
+	while (bucketCount < files.size() * 2) bucketCount *= 2; // At most half full
+	std::vector<uint32_t> archiveBuckets(bucketCount, 0);
+
+	for (size_t i = 0; i < files.size(); i++) {
+		std::string path = NormalizePath(files[i], root);
+		std::ifstream input(root + path, std::ios::binary);
+		if (!input.is_open()) {
+			Debug::Log("Cannot read " + root + path, typeid(AssetArchive).name());
+			return false;
+		}
+		std::vector<unsigned char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+		APakEntry& entry = archiveEntries[i];
+		entry.pathHash = HashResourceName(path);
+		entry.compression = APAK_COMPRESSION_NONE;
+		entry.pathOffset = (uint32_t)archivePaths.size();
+		entry.pathLength = (uint32_t)path.size();
+		entry.originalSize = data.size();
+		archivePaths.append(path);
+
+		if (compress && !data.empty()) {
+			std::vector<unsigned char> compressed(LZ4Block::GetMaxCompressedSize(data.size()));
+			size_t compressedSize = LZ4Block::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+			if (compressedSize > 0 && compressedSize <= data.size() - data.size() / 8) {
+				compressed.resize(compressedSize);
+				data.swap(compressed);
+				entry.compression = APAK_COMPRESSION_LZ4;
+			}
+		}
+		entry.size = data.size();
+		payloads[i].swap(data);
+
+		uint32_t bucket = entry.pathHash & (bucketCount - 1);
+		while (archiveBuckets[bucket] != 0) {
+			const APakEntry& other = archiveEntries[archiveBuckets[bucket] - 1];
+			if (archivePaths.compare(other.pathOffset, other.pathLength, path) == 0) {
+				Debug::Log("Duplicate path " + path, typeid(AssetArchive).name());
+				return false;
+			}
+			bucket = (bucket + 1) & (bucketCount - 1);
+		}
+		archiveBuckets[bucket] = (uint32_t)i + 1;
+	}
+
+	//Lay out the table of contents, then the payloads each on their own alignment boundary
+	APakHeader archiveHeader;
+	archiveHeader.magic = APAK_MAGIC;
+	archiveHeader.version = APAK_VERSION;
+	archiveHeader.entryCount = (uint32_t)files.size();
+	archiveHeader.bucketCount = bucketCount;
+	archiveHeader.entryOffset = sizeof(APakHeader);
+	archiveHeader.bucketOffset = archiveHeader.entryOffset + archiveEntries.size() * sizeof(APakEntry);
+	archiveHeader.pathOffset = archiveHeader.bucketOffset + archiveBuckets.size() * sizeof(uint32_t);
+	archiveHeader.pathSize = archivePaths.size();
+
+	uint64_t offset = archiveHeader.pathOffset + archiveHeader.pathSize;
+	for (size_t i = 0; i < archiveEntries.size(); i++) {
+		offset = (offset + APAK_ALIGNMENT - 1) / APAK_ALIGNMENT * APAK_ALIGNMENT;
+		archiveEntries[i].offset = offset;
+		offset += archiveEntries[i].size;
+	}
+
+	std::ofstream output(archivePath, std::ios::binary | std::ios::trunc);
+	if (!output.is_open()) {
+		Debug::Log("Cannot write " + archivePath, typeid(AssetArchive).name());
+		return false;
+	}
+
+	output.write((const char*)&archiveHeader, sizeof(APakHeader));
+	output.write((const char*)archiveEntries.data(), archiveEntries.size() * sizeof(APakEntry));
+	output.write((const char*)archiveBuckets.data(), archiveBuckets.size() * sizeof(uint32_t));
+	output.write(archivePaths.data(), archivePaths.size());
+	for (size_t i = 0; i < payloads.size(); i++) {
+		AlignStream(output, APAK_ALIGNMENT);
+		output.write((const char*)payloads[i].data(), payloads[i].size());
+	}
+
+	return output.good();
+}
+
+bool AssetArchive::Mount(std::string path, std::string root) {
+	AssetArchive* archive = new AssetArchive();
+	if (!archive->Open(path, root)) {
+		delete archive;
+		return false;
+	}
+
+	_mounted.push_back(archive);
+	Debug::Log("Mounted archive " + path + " with " + std::to_string(archive->GetEntryCount()) + " assets", typeid(AssetArchive).name());
+	return true;
+}
+
+bool AssetArchive::FindMounted(std::string path, AssetArchive** archive, const APakEntry** entry) {
+	for (size_t i = _mounted.size(); i-- > 0;) {
+		const APakEntry* found = _mounted[i]->Find(path);
+		if (!found) continue;
+
+		*archive = _mounted[i];
+		*entry = found;
+		return true;
+	}
+
+	return false;
+}
+
+void AssetArchive::UnmountAll() {
+	for (size_t i = 0; i < _mounted.size(); i++) {
+		delete _mounted[i];
+	}
+	_mounted.clear();
+}
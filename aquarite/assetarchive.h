@@ -0,0 +1,92 @@
+/**
+*	Filename: assetarchive.h
+*
+*	Description: Header file for AssetArchive class, reads and writes .apak archives
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef ASSETARCHIVE_H
+#define ASSETARCHIVE_H
+#include <string>
+#include <vector>
+#include "apak.h"
+#include "mappedfile.h"
+
+#define DEFAULT_ARCHIVE "data.apak" // Archive mounted from the build directory at startup, if it exists
+
+/**
+* A archive is mapped once and its table of contents is used in place, finding a asset does not read or allocate anything.
+* Paths in a archive are relative to the root directory it is mounted with, using forward slashes.
+* Mounted archives are only read after mounting, so they can be searched from worker threads. Mount before loading starts.
+*/
+class AssetArchive {
+private:
+	static std::vector<AssetArchive*> _mounted; /// @brief Mounted archives, searched from the last mounted to the first
+
+	MappedFile file; /// @brief The mapped archive
+	std::string root; /// @brief Directory the paths are relative to, normalized
+	const APakHeader* header; /// @brief Header inside the mapping
+	const APakEntry* entries; /// @brief Entries inside the mapping
+	const uint32_t* buckets; /// @brief Buckets inside the mapping
+	const char* paths; /// @brief Paths inside the mapping
+public:
+	/**
+	* Constructor
+	*/
+	AssetArchive();
+
+	/**
+	* Maps and validates a archive, paths are resolved relative to root. Returns false if it is not a valid archive
+	*/
+	bool Open(std::string path, std::string root = "");
+
+	/**
+	* Returns the entry of a path, relative to the root or starting with it. Returns nullptr if the archive does not hold it
+	*/
+	const APakEntry* Find(std::string path);
+
+	/**
+	* Returns the stored payload of a entry, used as is when the entry is not compressed
+	*/
+	const unsigned char* GetPayload(const APakEntry* entry);
+
+	/**
+	* Decompresses a entry into data, returns false if the payload is corrupt
+	*/
+	bool Decompress(const APakEntry* entry, std::vector<unsigned char>& data);
+
+	/**
+	* Returns the amount of entries
+	*/
+	size_t GetEntryCount();
+
+	/**
+	* Returns path with forward slashes, relative to root if it starts with it
+	*/
+	static std::string NormalizePath(std::string path, std::string root = "");
+
+	/**
+	* Writes a archive of files, given relative to root. With compress set, a entry is stored LZ4 compressed if that saves at least an eighth.
+	* Returns false if a file can not be read or the archive can not be written
+	*/
+	static bool Write(std::string archivePath, std::string root, const std::vector<std::string>& files, bool compress);
+
+	/**
+	* Opens a archive and adds it to the mounted archives, later mounts are searched first
+	*/
+	static bool Mount(std::string path, std::string root);
+
+	/**
+	* Searches the mounted archives for a path, returns false if none holds it
+	*/
+	static bool FindMounted(std::string path, AssetArchive** archive, const APakEntry** entry);
+
+	/**
+	* Closes and removes all mounted archives
+	*/
+	static void UnmountAll();
+};
+
+#endif // !ASSETARCHIVE_H
@@ -0,0 +1,84 @@
+/**
+*	Filename: assetfile.cpp
+*
+*	Description: Source file for AssetFile class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "assetfile.h"
+#include "assetarchive.h"
+#include "mappedfile.h"
+#include "debug.h"
+
+AssetFile::AssetFile() {
+	this->data = nullptr;
+	this->size = 0;
+	this->archived = false;
+	this->looseFile = nullptr;
+}
+
+bool AssetFile::Open(std::string path) {
+	Close();
+
+	AssetArchive* archive;
+	const APakEntry* entry;
+	if (AssetArchive::FindMounted(path, &archive, &entry)) {
+		if (entry->compression == APAK_COMPRESSION_NONE) {
+			data = archive->GetPayload(entry); // Zero copy
+		}
+		else {
+			if (!archive->Decompress(entry, buffer)) {
+				Debug::Log("Corrupt archive entry " + path, typeid(*this).name());
+				Close();
+				return false;
+			}
+			data = buffer.data();
+		}
+
+		size = (size_t)entry->originalSize;
+		archived = true;
+		return true;
+	}
+
+	//Loose file fallback, for development
+	looseFile = new MappedFile();
+	if (!looseFile->Open(path)) {
+		Close();
+		return false;
+	}
+
+	data = looseFile->GetData();
+	size = looseFile->GetSize();
+	return true;
+}
+
+void AssetFile::Close() {
+	delete looseFile;
+	looseFile = nullptr;
+	std::vector<unsigned char>().swap(buffer);
+	data = nullptr;
+	size = 0;
+	archived = false;
+}
+
+const unsigned char* AssetFile::GetData() {
+	return this->data;
+}
+
+size_t AssetFile::GetSize() {
+	return this->size;
+}
+
+std::string AssetFile::GetText() {
+	return data ? std::string((const char*)data, size) : std::string();
+}
+
+bool AssetFile::IsArchived() {
+	return this->archived;
+}
+
+AssetFile::~AssetFile() {
+	Close();
+}
@@ -0,0 +1,72 @@
+/**
+*	Filename: assetfile.h
+*
+*	Description: Header file for AssetFile class, the contents of a asset from a mounted archive or a loose file
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef ASSETFILE_H
+#define ASSETFILE_H
+#include <string>
+#include <vector>
+
+//Forward declarations
+class MappedFile;
+
+/**
+* Opens a asset from the mounted archives first, and from disk if no archive holds it.
+* Uncompressed archive entries point straight into the archive mapping, compressed entries are decompressed into a buffer,
+* and loose files are mapped.
+*/
+class AssetFile {
+private:
+	const unsigned char* data; /// @brief The contents, nullptr if not open or empty
+	size_t size; /// @brief Size of the contents in bytes
+	bool archived; /// @brief True if the contents come from a archive
+	MappedFile* looseFile; /// @brief The mapping of a loose file
+	std::vector<unsigned char> buffer; /// @brief The decompressed contents of a compressed entry
+public:
+	/**
+	* Constructor
+	*/
+	AssetFile();
+
+	/**
+	* Opens a asset, returns false if neither a archive nor the disk holds it
+	*/
+	bool Open(std::string path);
+
+	/**
+	* Releases the contents, pointers returned by GetData are no longer valid
+	*/
+	void Close();
+
+	/**
+	* Returns the contents, nullptr if the asset is empty
+	*/
+	const unsigned char* GetData();
+
+	/**
+	* Returns the size of the contents
+	*/
+	size_t GetSize();
+
+	/**
+	* Returns the contents as text
+	*/
+	std::string GetText();
+
+	/**
+	* Returns true if the contents come from a archive
+	*/
+	bool IsArchived();
+
+	/**
+	* Destructor, closes the asset
+	*/
+	~AssetFile();
+};
+
+#endif // !ASSETFILE_H
@@ -0,0 +1,47 @@
+/**
+*	Filename: atex.h
+*
+*	Description: Binary cooked texture format, a mip chain that can be uploaded to OpenGL straight from a mapped file
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef ATEX_H
+#define ATEX_H
+#include <cstdint>
+
+/**
+* File layout:
+* [ATexHeader][padding][level 0][padding][level 1]...
+* Every level starts on a ATEX_ALIGNMENT boundary and is tightly packed, rows bottom to top as OpenGL expects.
+* Compressed levels are rows of 4x4 blocks, partial blocks at the edges are stored as full blocks.
+* Levels halve in size down to 1x1, all values are little endian.
+*/
+#define ATEX_MAGIC 0x58455441 // "ATEX"
+#define ATEX_VERSION 2 // Version 2 added the compressed formats, version 1 files are still read
+#define ATEX_ALIGNMENT 16
+#define ATEX_MAX_LEVELS 16
+
+/**
+* A single level of the mip chain
+*/
+struct ATexLevel {
+	uint32_t width; /// @brief Width in pixels
+	uint32_t height; /// @brief Height in pixels
+	uint64_t offset; /// @brief Offset of the level from the start of the file
+	uint64_t size; /// @brief Size of the level in bytes
+};
+
+struct ATexHeader {
+	uint32_t magic; /// @brief Always ATEX_MAGIC
+	uint32_t version; /// @brief Always ATEX_VERSION
+	uint32_t format; /// @brief OpenGL format of the pixels, GL_RGB, GL_RGBA or a BC1, BC3 or BC7 compressed format
+	uint32_t levelCount; /// @brief Amount of levels, at most ATEX_MAX_LEVELS
+	ATexLevel levels[ATEX_MAX_LEVELS]; /// @brief The levels, largest first
+};
+
+static_assert(sizeof(ATexLevel) == 24, "ATexLevel layout changed, bump ATEX_VERSION");
+static_assert(sizeof(ATexHeader) == 400, "ATexHeader layout changed, bump ATEX_VERSION");
+
+#endif // !ATEX_H
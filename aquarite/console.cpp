@@ -68,7 +68,7 @@ void Console::Initialize() {
 
 	//Initialize text
 	Console::GetInstance()->inputText = new Text();
-	Console::GetInstance()->inputText->position = Console::GetInstance()->inputField->GetPositionGlobal() + Vec3(0, (float)textBoxBG->textureData->height, 0);
+	Console::GetInstance()->inputText->SetPosition(Console::GetInstance()->inputField->GetPositionGlobal() + Vec3(0, (float)textBoxBG->textureData->height, 0));
 
 	//Child inputfield
 	Console::GetInstance()->console->AddChild(Console::GetInstance()->inputField);
@@ -78,7 +78,7 @@ void Console::Initialize() {
 
 	//Log text
 	Console::GetInstance()->logText = new Text();
-	Console::GetInstance()->logText->position = Vec3(0, (float)Core::GetResolution().y, 0);
+	Console::GetInstance()->logText->SetPosition(Vec3(0, (float)Core::GetResolution().y, 0));
 	Console::GetInstance()->console->AddChild(Console::GetInstance()->logText);
 
 	Console::GetInstance()->showConsole = false;
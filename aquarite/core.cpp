@@ -10,19 +10,34 @@
 #include <Windows.h>
 #include <chrono>
 #include <sstream>
+#include <map>
+#include <mutex>
+#include <deque>
+#include <algorithm>
+#include <memory>
+#include <condition_variable>
 #include "core.h"
 #include "soundmanager.h"
 #include "scenemanager.h"
 #include "resourcemanager.h"
+#include "resourceloader.h"
+#include "residency.h"
+#include "assetarchive.h"
 #include "input.h"
 #include "debug.h"
 #include "console.h"
 #include "luascript.h"
 #include "editor.h"
+#include "mesh.h"
+#include "jobsystem.h"
+#include "frameprofiler.h"
+#include "graphics/frustumculler.h"
+#include "graphics/pixelconverter.h"
+#include "texture.h"
 
 //Native functions for console and lua, these include Run and Spawn, Running a method means running it on this thread,
-// We only continue computing if return value is evaluated. If a lua script is spawned, it will be executed on a different
-// thread allowing for further computation while the lua script is ran
+// We only continue computing if return value is evaluated. If a lua script is spawned, it will be executed on a detached
+// job of the job system allowing for further computation while the lua script is ran
 //Runs a function in lua
 
 //Run a function in lua
@@ -45,23 +60,89 @@ std::string Run(std::string value) {
 	return "Lua: No Function Specified!";
 }
 
-//We call this function to run threads, we pass state boolean as a reference
-void RunThread(std::string value, bool& state) {
-	Console::Log(Run(value)); // We run the code
-	state = true; // If we get here we know that thread is done running
+//Spawned scripts run on the script threads, while the scene, the spatial index, the transform hierarchy, the resource tables
+//and the console are only safe to use from the main thread. Calls touching those are queued here and run at the start of the script phase
+struct MainThreadCall {
+	std::function<void()> function; /// @brief The call, it only runs on the main thread
+	bool done; /// @brief Set once the function returned, guarded by mainThreadMutex
+};
+
+static std::deque<std::shared_ptr<MainThreadCall>> mainThreadCalls;
+static std::mutex mainThreadMutex;
+static std::condition_variable mainThreadCondition;
+static std::thread::id mainThreadId;
+
+//Runs function on the main thread. On another thread it is queued, and if wait is set this returns once the main thread ran it.
+//Returns false if the script was stopped before the function ran, the function is then dropped
+static bool CallOnMainThread(const std::function<void()>& function, bool wait = true) {
+	if (std::this_thread::get_id() == mainThreadId) {
+		function();
+		return true;
+	}
+
+	std::shared_ptr<MainThreadCall> call = std::make_shared<MainThreadCall>();
+	call->function = function;
+	call->done = false;
+
+	std::unique_lock<std::mutex> lock(mainThreadMutex);
+	mainThreadCalls.push_back(call);
+	if (!wait) return true;
+
+	//The main thread stops running the calls when shutting down, a stopped script takes its call back if it was not started yet
+	while (!call->done) {
+		if (JobSystem::IsScriptStopped()) {
+			std::deque<std::shared_ptr<MainThreadCall>>::iterator it = std::find(mainThreadCalls.begin(), mainThreadCalls.end(), call);
+			if (it != mainThreadCalls.end()) {
+				mainThreadCalls.erase(it);
+				return false;
+			}
+		}
+		mainThreadCondition.wait_for(lock, std::chrono::milliseconds(10));
+	}
+	return true;
 }
 
-std::string Spawn(std::string value) {
-	Thread* thread = new Thread();
-	thread->isDone = false;
-	thread->thread = std::thread(RunThread, value, std::ref(thread->isDone));
+//Runs the queued calls, on the main thread
+static void RunMainThreadCalls() {
+	std::deque<std::shared_ptr<MainThreadCall>> calls;
+	{
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		calls.swap(mainThreadCalls);
+	}
+	if (calls.empty()) return;
 
-	Core::RegisterThread(thread); // Launch thread, and register
-	return "Spawned new thread";
+	for (size_t i = 0; i < calls.size(); i++) {
+		calls[i]->function();
+
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		calls[i]->done = true;
+	}
+	mainThreadCondition.notify_all();
 }
 
-std::string DThread(std::string value) {
-	return Core::DestroyThread(std::stoi(value));
+std::string Spawn(std::string value) {
+	//Scripts can run for a long time, so they go to the script threads instead of holding up a worker or a waiting thread
+	unsigned id = JobSystem::RunScript([value]() {
+		std::string result = Run(value);
+		CallOnMainThread([result]() { Console::Log(result); }, false); // We run the code, and log the result when done
+	});
+	return "Spawned script " + std::to_string(id);
+}
+
+std::string StopScript(std::string value) {
+	if (value.empty()) {
+		std::vector<unsigned> scripts = JobSystem::GetScripts();
+		std::string result = "Scripts:";
+		for (size_t i = 0; i < scripts.size(); i++) {
+			result += " " + std::to_string(scripts[i]);
+		}
+		return result;
+	}
+
+	if (JobSystem::StopScript((unsigned)std::atoi(value.c_str()))) {
+		return "Stopping script " + value;
+	}
+	return "No script with id " + value;
 }
 
 std::string EnableEditor(std::string value) {
@@ -73,7 +154,137 @@ std::string EnableEditor(std::string value) {
 	return "";
 }
 
-//Native functions for lua, added by default
+//Converts a obj file to a cooked amesh file, and optionally simplified lod levels. Paths are relative to the build directory
+std::string ConvertMesh(std::string value) {
+	std::stringstream ss(value);
+	std::string segment;
+	std::vector<std::string> segments;
+	while (std::getline(ss, segment, ' ')) { // Split by space character
+		segments.push_back(segment);
+	}
+
+	if (segments.size() < 2) {
+		return "Usage: amesh input.obj output.amesh [lod levels]";
+	}
+
+	//With a lod count, simplified levels are written next to the output
+	if (segments.size() > 2) {
+		int levels = Mesh::ConvertObjLods(Core::GetBuildDirectory() + segments[0], Core::GetBuildDirectory() + segments[1], std::stoi(segments[2]));
+		if (levels < 0) {
+			return "Failed to convert " + segments[0];
+		}
+
+		std::string result = "Converted " + segments[0] + " to " + segments[1];
+		for (int i = 1; i <= levels; i++) {
+			result += ", " + Mesh::GetLodPath(segments[1], i);
+		}
+		return result;
+	}
+
+	if (!Mesh::ConvertObj(Core::GetBuildDirectory() + segments[0], Core::GetBuildDirectory() + segments[1])) {
+		return "Failed to convert " + segments[0];
+	}
+	return "Converted " + segments[0] + " to " + segments[1];
+}
+
+//Returns the averaged time spent in each phase of the frame
+std::string FramePhases(std::string value) {
+	return FrameProfiler::GetReport();
+}
+
+//Culls a million random spheres with every supported culling kernel and returns the timings
+std::string CullBenchmark(std::string value) {
+	return FrustumCuller::Benchmark();
+}
+
+//Times the pixel conversion kernels, "pixelbench file.tga" also times decoding the file with and without the swizzle to RGB
+std::string PixelBenchmark(std::string value) {
+	std::stringstream report;
+	report << PixelConverter::Benchmark();
+
+	std::string file = value.substr(0, value.find(' '));
+	if (file.empty()) return report.str();
+
+	bool uploadBGR = Texture::GetUploadBGR();
+	for (int bgr = 0; bgr < 2; bgr++) {
+		Texture::SetUploadBGR(bgr == 1);
+
+		//Best of a few runs, the first run also reads the file into the cache
+		double best = 1e9;
+		for (int run = 0; run < 5; run++) {
+			Texture texture;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			bool decoded = texture.DecodeTGA((char*)(Core::GetBuildDirectory() + file).c_str());
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+			if (!decoded) {
+				Texture::SetUploadBGR(uploadBGR);
+				return report.str() + "Cannot read " + file;
+			}
+			double time = std::chrono::duration<double, std::milli>(end - start).count();
+			if (time < best) best = time; // std::min is a macro after Windows.h
+		}
+		report << "Decoding " << file << (bgr == 1 ? " in BGR order: " : " swizzled to RGB: ") << best << " ms" << std::endl;
+	}
+
+	Texture::SetUploadBGR(uploadBGR);
+	return report.str();
+}
+
+//Prints the occlusion culling stats of the last frame, "0" or "1" disables or enables occlusion culling
+std::string OcclusionCulling(std::string value) {
+	Renderer* renderer = Core::GetRenderer();
+	if (value == "0" || value == "1") renderer->SetOcclusionCulling(value == "1");
+
+	OcclusionStats stats = renderer->GetOcclusionStats();
+	std::stringstream report;
+	report << "Occlusion culling " << (renderer->GetOcclusionCulling() ? "enabled" : "disabled") << ": " << stats.occluders << " occluders, "
+		<< stats.triangles << " triangles, " << stats.rejected << " of " << stats.tested << " objects rejected";
+	return report.str();
+}
+
+//Packs files into a archive, "apak out.apak [lz4] file file ...", all paths relative to the build directory
+std::string PackArchive(std::string value) {
+	std::stringstream ss(value);
+	std::string segment;
+	std::vector<std::string> segments;
+	while (std::getline(ss, segment, ' ')) { // Split by space character
+		if (segment != "") segments.push_back(segment);
+	}
+
+	bool compress = segments.size() > 1 && segments[1] == "lz4";
+	std::vector<std::string> files(segments.begin() + (compress ? 2 : 1), segments.end());
+	if (segments.empty() || files.empty()) return "Usage: apak out.apak [lz4] file file ...";
+
+	if (!AssetArchive::Write(Core::GetBuildDirectory() + segments[0], Core::GetBuildDirectory(), files, compress)) return "Failed to write " + segments[0];
+	return "Packed " + std::to_string(files.size()) + " files into " + segments[0];
+}
+
+//Prints the amount of resources still loading in the background and the time spent finishing them last frame
+std::string Loading(std::string value) {
+	std::stringstream report;
+	report << ResourceLoader::GetPendingCount() << " resources loading, " << ResourceLoader::GetLastUpdateTime() << " ms spent last frame";
+	return report.str();
+}
+
+//Prints the memory used by textures and meshes against the budgets, "budget CPU_MB GPU_MB" sets the budgets
+std::string Residency(std::string value) {
+	std::stringstream ss(value);
+	std::string command;
+	size_t cpuMegabytes, gpuMegabytes;
+	if (ss >> command) {
+		if (command != "budget" || !(ss >> cpuMegabytes >> gpuMegabytes)) return "Usage: residency [budget CPU_MB GPU_MB]";
+		ResidencyManager::SetBudgets(cpuMegabytes * 1024 * 1024, gpuMegabytes * 1024 * 1024);
+	}
+	return ResidencyManager::GetReport();
+}
+
+//Native functions for lua, added by default.
+//Spawned scripts call these from a script thread. The natives touching the scene, the spatial index, the transform hierarchy,
+//the resource tables or the console go through CallOnMainThread: GetModelHandle, CreateEntity, GetEntityFromScene,
+//FindEntitiesInRadius and Raycast wait for the next frame, ConsoleLog, SetEntityPosition and SetCameraPosition are applied
+//in the next frame without waiting. The other natives are safe to call from any thread, the getters of positions and time
+//read single values and may see the values of a frame that is being updated
 
 int Run(lua_State* state) {
 	std::string returnValue = Run(lua_tostring(state, -1));
@@ -82,13 +293,15 @@ int Run(lua_State* state) {
 }
 
 int Spawn(lua_State* state) {
-	Spawn(lua_tostring(state, -1)); // Call spawn function
-	return 0; // Return 0 because spawn does not return any value
+	std::string returnValue = Spawn(lua_tostring(state, -1)); // Call spawn function
+	lua_pushstring(state, returnValue.c_str());
+	return 1; // We have pushed 1 value on the lua stack
 }
 
 //Prints to console from lua
 int Lua_ConsoleLog(lua_State* state) {
-	Console::Log(lua_tostring(state, -1));
+	std::string value = lua_tostring(state, -1);
+	CallOnMainThread([value]() { Console::Log(value); }, false);
 	return 0; // Return nothing
 }
 
@@ -104,15 +317,36 @@ int Lua_GetTimeElapsed(lua_State* state) {
 	return 1;
 }
 
+//Returns the handle of a model, handles are resolved in constant time and stay valid when the model is replaced
+int Lua_GetModelHandle(lua_State* state) {
+	std::string name = lua_tostring(state, -1);
+	ModelHandle handle;
+	if (!CallOnMainThread([&]() { handle = ResourceManager::GetModelHandle(name); })) return 0;
+	if (!handle.IsValid()) return 0; // No model with this name
+
+	lua_pushinteger(state, (lua_Integer)handle.ToInteger());
+	return 1;
+}
+
 // Creates a new entity, and adds to scene. Returns a pointer to the object to lua
 int Lua_CreateEntity(lua_State* state) {
-	if (SceneManager::GetActiveScene()) {
-		Entity* entity = new Entity();
-		entity->SetModel(ResourceManager::GetModel(lua_tostring(state, -4)));
-		entity->position = Vec3((float)lua_tonumber(state, -3), (float)lua_tonumber(state, -2), (float)lua_tonumber(state, -1));
-
-		SceneManager::GetActiveScene()->AddChild(entity);
+	bool byHandle = lua_type(state, -4) == LUA_TNUMBER; // A handle from GetModelHandle
+	ModelHandle handle = byHandle ? ModelHandle::FromInteger((uint64_t)lua_tointeger(state, -4)) : ModelHandle();
+	std::string name = byHandle ? "" : lua_tostring(state, -4);
+	Vec3 position = Vec3((float)lua_tonumber(state, -3), (float)lua_tonumber(state, -2), (float)lua_tonumber(state, -1));
+
+	Entity* entity = nullptr;
+	CallOnMainThread([&]() {
+		if (SceneManager::GetActiveScene()) {
+			entity = new Entity();
+			entity->SetModel(byHandle ? ResourceManager::GetModel(handle) : ResourceManager::GetModel(name));
+			entity->SetPosition(position);
+
+			SceneManager::GetActiveScene()->AddChild(entity);
+		}
+	});
 
+	if (entity) {
 		//Push to lua stack and return
 		lua_pushlightuserdata(state, (void*) entity);
 
@@ -125,8 +359,18 @@ int Lua_CreateEntity(lua_State* state) {
 
 //Returns a entity from scene entity children where index matches, Note that we cannot find children using this method
 int lua_GetEntityFromScene(lua_State* state) {
-	if (SceneManager::GetActiveScene()) {
-		lua_pushlightuserdata(state, SceneManager::GetActiveScene()->GetChild((int)lua_tonumber(state, -1)));
+	int index = (int)lua_tonumber(state, -1);
+	bool found = false;
+	Entity* entity = nullptr;
+	CallOnMainThread([&]() {
+		if (SceneManager::GetActiveScene()) {
+			entity = SceneManager::GetActiveScene()->GetChild(index);
+			found = true;
+		}
+	});
+
+	if (found) {
+		lua_pushlightuserdata(state, entity);
 		return 1;
 	}
 	return 0;
@@ -136,7 +380,8 @@ int lua_GetEntityFromScene(lua_State* state) {
 int lua_SetEntityPosition(lua_State* state) {
 	if (SceneManager::GetActiveScene()) {
 		Entity* entity = (Entity*) lua_touserdata(state, -4);
-		entity->position = Vec3((float)lua_tonumber(state, -3), (float)lua_tonumber(state, -2), (float)lua_tonumber(state, -1));
+		Vec3 position = Vec3((float)lua_tonumber(state, -3), (float)lua_tonumber(state, -2), (float)lua_tonumber(state, -1));
+		CallOnMainThread([entity, position]() { entity->SetPosition(position); }, false);
 	}
 
 	return 0;
@@ -146,9 +391,10 @@ int lua_SetEntityPosition(lua_State* state) {
 int lua_GetEntityPosition(lua_State* state) {
 	if (SceneManager::GetActiveScene()) {
 		Entity* entity = (Entity*)lua_touserdata(state, -4);
-		lua_pushnumber(state, entity->position.x);
-		lua_pushnumber(state, entity->position.y);
-		lua_pushnumber(state, entity->position.z);
+		Vec3 position = entity->GetPosition();
+		lua_pushnumber(state, position.x);
+		lua_pushnumber(state, position.y);
+		lua_pushnumber(state, position.z);
 		return 3; // We pushed 3 values onto the stack
 	}
 
@@ -159,23 +405,75 @@ int lua_GetEntityPosition(lua_State* state) {
 int lua_GetEntityPositionGlobal(lua_State* state) {
 	if (SceneManager::GetActiveScene()) {
 		Entity* entity = (Entity*)lua_touserdata(state, -4);
-		lua_pushnumber(state, entity->GetPositionGlobal().x);
-		lua_pushnumber(state, entity->GetPositionGlobal().y);
-		lua_pushnumber(state, entity->GetPositionGlobal().z);
+		Vec3 position = entity->GetPositionGlobal();
+		lua_pushnumber(state, position.x);
+		lua_pushnumber(state, position.y);
+		lua_pushnumber(state, position.z);
 		return 3; // We pushed 3 values onto the stack
 	}
 
 	return 0; // If nothing found return 0
 }
 
+//Returns a table of the entities within radius of a point, FindEntitiesInRadius(x, y, z, radius)
+int Lua_FindEntitiesInRadius(lua_State* state) {
+	Vec3 centre = Vec3((float)lua_tonumber(state, -4), (float)lua_tonumber(state, -3), (float)lua_tonumber(state, -2));
+	float radius = (float)lua_tonumber(state, -1);
+
+	bool found = false;
+	std::vector<Entity*> entities;
+	CallOnMainThread([&]() {
+		if (SceneManager::GetActiveScene()) {
+			entities = SceneManager::GetActiveScene()->FindEntitiesInRadius(centre, radius);
+			found = true;
+		}
+	});
+
+	if (found) {
+		lua_newtable(state);
+		for (size_t i = 0; i < entities.size(); i++) {
+			lua_pushlightuserdata(state, (void*)entities[i]);
+			lua_rawseti(state, -2, (int)i + 1); // Lua tables start at 1
+		}
+		return 1;
+	}
+
+	return 0;
+}
+
+//Returns the first entity hit by a ray and the distance, Raycast(x, y, z, directionX, directionY, directionZ, maxDistance)
+int Lua_Raycast(lua_State* state) {
+	Vec3 origin = Vec3((float)lua_tonumber(state, -7), (float)lua_tonumber(state, -6), (float)lua_tonumber(state, -5));
+	Vec3 direction = Vec3((float)lua_tonumber(state, -4), (float)lua_tonumber(state, -3), (float)lua_tonumber(state, -2));
+	float maxDistance = (float)lua_tonumber(state, -1);
+
+	float distance = 0;
+	Entity* entity = nullptr;
+	CallOnMainThread([&]() {
+		if (SceneManager::GetActiveScene()) {
+			entity = SceneManager::GetActiveScene()->Raycast(origin, direction, maxDistance, &distance);
+		}
+	});
+
+	if (entity) {
+		lua_pushlightuserdata(state, (void*)entity);
+		lua_pushnumber(state, distance);
+		return 2; // We pushed the entity and the distance
+	}
+
+	return 0; // Nothing hit
+}
+
 // Sets the camera position
 int Lua_SetCameraPosition(lua_State* state) {
-	if (SceneManager::GetActiveScene()) {
-		if (SceneManager::GetActiveScene()->GetActiveCamera()) {
-			Vec3 pos = Vec3((float)lua_tonumber(state, -3), (float)lua_tonumber(state, -2), (float)lua_tonumber(state, -1));
-			SceneManager::GetActiveScene()->GetActiveCamera()->SetPos(pos.ToGLM());
+	Vec3 pos = Vec3((float)lua_tonumber(state, -3), (float)lua_tonumber(state, -2), (float)lua_tonumber(state, -1));
+	CallOnMainThread([pos]() {
+		if (SceneManager::GetActiveScene()) {
+			if (SceneManager::GetActiveScene()->GetActiveCamera()) {
+				SceneManager::GetActiveScene()->GetActiveCamera()->SetPos(pos.ToGLM());
+			}
 		}
-	}
+	}, false);
 
 	return 0;
 }
@@ -194,6 +492,38 @@ int Lua_GetCameraPosition(lua_State* state) {
 	return 0; // Return 0 if failed
 }
 
+//Handles of the meta files loaded from lua by load id, scripts can run on their own threads so the map is guarded by a mutex.
+//A handle is released once GetLoadProgress reported it done
+static std::map<int, ResourceLoadHandle> luaLoads;
+static int luaLoadsNextId = 1;
+static std::mutex luaLoadsMutex;
+
+//Starts loading a meta file in the background and returns its load id, LoadMetaAsync(path)
+int Lua_LoadMetaAsync(lua_State* state) {
+	ResourceLoadHandle handle = ResourceManager::LoadMetaAsync(lua_tostring(state, -1));
+
+	std::lock_guard<std::mutex> lock(luaLoadsMutex);
+	int id = luaLoadsNextId++;
+	luaLoads[id] = handle;
+	lua_pushnumber(state, (lua_Number)id);
+	return 1;
+}
+
+//Returns the progress of a load between 0 and 1 and whether it is done, GetLoadProgress(id). The id is invalid after it reported done
+int Lua_GetLoadProgress(lua_State* state) {
+	int id = (int)lua_tonumber(state, -1);
+
+	std::lock_guard<std::mutex> lock(luaLoadsMutex);
+	std::map<int, ResourceLoadHandle>::iterator it = luaLoads.find(id);
+	if (it == luaLoads.end()) return 0;
+
+	bool done = it->second.IsDone();
+	lua_pushnumber(state, it->second.GetProgress());
+	lua_pushboolean(state, done);
+	if (done) luaLoads.erase(it);
+	return 2;
+}
+
 //Creates the editor from a lua call
 int Lua_EnableEditor(lua_State* state) {
 	Editor::SetActive(lua_toboolean(state, -1));
@@ -208,16 +538,25 @@ void AddNativeFunctionsToLuaStack() {
 	LuaScript::AddNativeFunction("GetDeltaTime", Lua_GetDeltaTime);
 	LuaScript::AddNativeFunction("GetTimeElapsed", Lua_GetTimeElapsed);
 
+	//Resources
+	LuaScript::AddNativeFunction("LoadMetaAsync", Lua_LoadMetaAsync, "string");
+	LuaScript::AddNativeFunction("GetLoadProgress", Lua_GetLoadProgress, "int");
+
 	//Editor
 	LuaScript::AddNativeFunction("EnableEditor", Lua_EnableEditor, "bool");
 
 	//Entity methods
-	LuaScript::AddNativeFunction("CreateEntity", Lua_CreateEntity, "modelName, x, y, z");
+	LuaScript::AddNativeFunction("GetModelHandle", Lua_GetModelHandle, "modelName");
+	LuaScript::AddNativeFunction("CreateEntity", Lua_CreateEntity, "modelName or modelHandle, x, y, z");
 	LuaScript::AddNativeFunction("GetEntityFromScene", lua_GetEntityFromScene, "int");
 	LuaScript::AddNativeFunction("SetEntityPosition", lua_SetEntityPosition, "entity, x, y, z");
 	LuaScript::AddNativeFunction("GetEntityPosition", lua_GetEntityPosition);
 	LuaScript::AddNativeFunction("GetEntityPositionGlobal", lua_GetEntityPositionGlobal);
 
+	//Scene queries
+	LuaScript::AddNativeFunction("FindEntitiesInRadius", Lua_FindEntitiesInRadius, "x, y, z, radius");
+	LuaScript::AddNativeFunction("Raycast", Lua_Raycast, "x, y, z, directionX, directionY, directionZ, maxDistance");
+
 	//Camera methods
 	LuaScript::AddNativeFunction("SetCameraPosition", Lua_SetCameraPosition, "x, y, z");
 	LuaScript::AddNativeFunction("GetCameraPosition", Lua_GetCameraPosition);
@@ -254,6 +593,7 @@ float Core::GetFPS() {
 
 int Core::Initialize(char* argv[], Point2i resolution) {
 	Debug::Log("Initializing", typeid(*this).name());
+	mainThreadId = std::this_thread::get_id(); // Lua natives called from other threads are queued for this thread
 
 	//Find the executable folder location
 	std::string _exeDirArg = argv[0]; // Get the executable path directory from arguments
@@ -261,6 +601,9 @@ int Core::Initialize(char* argv[], Point2i resolution) {
 	_executablePath = _exeDirArg.substr(0, found); // Cut off last part of path
 	_executablePath.append("\\"); // Append a slash to return the absolute directory
 
+	//Start the job system workers, before any subsystem queues work
+	JobSystem::Initialize();
+
 	//Set up time
 	this->_timeStart = (unsigned)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); // Recieve Current Time
 	this->_timeElapsed = this->_timeStart - this->_timeStart; // Calculate Time elapsed
@@ -296,6 +639,9 @@ int Core::Initialize(char* argv[], Point2i resolution) {
 	// Initialize ResourceManager, (if end user has not done it yet)
 	ResourceManager::GetInstance();
 
+	// Mount the packed assets if shipped, loose files are used otherwise
+	ResourceManager::MountArchive(DEFAULT_ARCHIVE);
+
 	// Initialize Input, (if end user has not done it yet)
 	Input::Init(renderer->GetWindow());
 
@@ -311,8 +657,16 @@ int Core::Initialize(char* argv[], Point2i resolution) {
 	//Add Run / Spawn to console
 	Console::AddCommand("run", Run);
 	Console::AddCommand("spawn", Spawn);
-	Console::AddCommand("destroy", DThread);
+	Console::AddCommand("stop", StopScript);
 	Console::AddCommand("editor", EnableEditor);
+	Console::AddCommand("amesh", ConvertMesh);
+	Console::AddCommand("phases", FramePhases);
+	Console::AddCommand("cullbench", CullBenchmark);
+	Console::AddCommand("pixelbench", PixelBenchmark);
+	Console::AddCommand("occlusion", OcclusionCulling);
+	Console::AddCommand("loading", Loading);
+	Console::AddCommand("apak", PackArchive);
+	Console::AddCommand("residency", Residency);
 
 	this->_active = true; // set active to true
 	Debug::Log("Initialized", typeid(*this).name());
@@ -333,75 +687,99 @@ void Core::HandleUpdates() {
 		this->_lastFrameUpdate = this->_timeElapsed; // Set last frame update to the time elapsed
 	}
 
-	float _localDelta = (float)this->_timeElapsed; // Set local delta to current time elapsed
-
-	//Check threads
-	for (size_t t = 0; t < this->threads.size(); t++) {
-		if (threads[t]->isDone) { // If thread is done running
-			threads[t]->thread.join(); // Join
-			
-			delete threads[t];
-			threads.erase(threads.begin() + t);
-			Console::Log("Thread Stopped");
+	//Input, poll the events of this frame and start a new frame in the renderer
+	FrameProfiler::Begin(InputPhase);
+	Input::HandleUpdates(); // Must be before polling, so the key states of the last frame are kept
+	renderer->PollEvents(); // Poll Events
+	renderer->Clear();
+	FrameProfiler::End(InputPhase);
+
+	//Streaming, upload resources decoded in the background within the frame budget
+	FrameProfiler::Begin(StreamingPhase);
+	ResourceLoader::Update(RESOURCE_UPLOAD_BUDGET);
+	ResidencyManager::Update(); // Evict what was not used last frame if over budget, evicted resources load again when used
+	FrameProfiler::End(StreamingPhase);
+
+	Scene* scene = SceneManager::GetActiveScene();
+	if (scene && scene->GetActiveCamera()) {
+		//Script, the editor or console handle their input and commands
+		FrameProfiler::Begin(ScriptPhase);
+		RunMainThreadCalls(); // Natives called by spawned scripts since the last frame
+		if (Editor::Active()) {
+			Editor::Update();
 		}
-	}
-
-	//Update Game
-	if (SceneManager::GetActiveScene()) {
-		// Update all entities and their children
-		if (SceneManager::GetActiveScene()->GetActiveCamera()) {
-			//Update SoundManager
-			SoundManager::Update(Vec3::ToVec3(SceneManager::GetActiveScene()->GetActiveCamera()->GetPos()), 
-								 Vec3::ToVec3(SceneManager::GetActiveScene()->GetActiveCamera()->GetTarget()), 
-								 Vec3::ToVec3(SceneManager::GetActiveScene()->GetActiveCamera()->GetUp()));
-
-			SceneManager::GetActiveScene()->GetActiveCamera()->UpdateFront();
-			//Update renderer
-			renderer->HandleTranslations(SceneManager::GetActiveScene()->GetActiveCamera(), _fov);
-
-			//Update frustum
-			Vec3 cameraPos = Vec3::ToVec3(SceneManager::GetActiveScene()->GetActiveCamera()->GetPos());
-			Vec3 cameraTarget = Vec3::ToVec3(SceneManager::GetActiveScene()->GetActiveCamera()->GetPos() + SceneManager::GetActiveScene()->GetActiveCamera()->GetTarget());
-			Vec3 cameraUp = Vec3::ToVec3(SceneManager::GetActiveScene()->GetActiveCamera()->GetUp());
-
-			SceneManager::GetActiveScene()->GetActiveCamera()->GetFrustum()->setCamDef(cameraPos,cameraTarget,cameraUp);
-
-			//Render children
-			for (unsigned i = 0; i < SceneManager::GetActiveScene()->GetChildren().size(); i++) {
-				SceneManager::GetActiveScene()->UpdateSceneChildren();
-				SceneManager::GetActiveScene()->RenderSceneChildren(renderer, SceneManager::GetActiveScene()->GetActiveCamera()); // Normal draw
-			}
-
-			if (Editor::Active()) {
-				Editor::Update();
-			}
-			else {
-				//Check if we are not using editor's camera, if we do set it back to the camera that the editor has remembered
-				if (SceneManager::GetActiveScene()->GetActiveCamera() == Editor::GetCamera()) {
-					SceneManager::GetActiveScene()->SetActiveCamera(Editor::GetActiveCamera());
-				}
-
-				//Console is temporary always enabled
-				Console::Update();
-				Console::Render(renderer);
+		else {
+			//Check if we are not using editor's camera, if we do set it back to the camera that the editor has remembered
+			if (scene->GetActiveCamera() == Editor::GetCamera()) {
+				scene->SetActiveCamera(Editor::GetActiveCamera());
 			}
 
-			Debug::NewFrame();
-			renderer->Render(SceneManager::GetActiveScene()->GetActiveCamera());
+			//Console is temporary always enabled
+			Console::Update();
+		}
+		FrameProfiler::End(ScriptPhase);
+
+		//Simulation, update all entities and their children once
+		FrameProfiler::Begin(SimulationPhase);
+		scene->UpdateSceneChildren();
+		FrameProfiler::End(SimulationPhase);
+
+		//Transforms, propagate the global transforms after all entities have moved
+		FrameProfiler::Begin(TransformPhase);
+		scene->UpdateSceneTransforms();
+		FrameProfiler::End(TransformPhase);
+
+		Camera* camera = scene->GetActiveCamera();
+		camera->UpdateFront();
+
+		//Audio only needs the listener, so it runs as a job next to visibility
+		Vec3 listenerPosition = Vec3::ToVec3(camera->GetPos());
+		Vec3 listenerHead = Vec3::ToVec3(camera->GetTarget());
+		Vec3 listenerUp = Vec3::ToVec3(camera->GetUp());
+
+		JobCounter audioCounter;
+		JobSystem::Run([listenerPosition, listenerHead, listenerUp]() {
+			FrameProfiler::Begin(AudioPhase);
+			SoundManager::Update(listenerPosition, listenerHead, listenerUp);
+			FrameProfiler::End(AudioPhase);
+		}, &audioCounter);
+
+		//Visibility, collect the drawables and build the render queue of the visible ones
+		FrameProfiler::Begin(VisibilityPhase);
+		renderer->HandleTranslations(camera, _fov);
+
+		//Update frustum
+		Vec3 cameraPos = Vec3::ToVec3(camera->GetPos());
+		Vec3 cameraTarget = Vec3::ToVec3(camera->GetPos() + camera->GetTarget());
+		Vec3 cameraUp = Vec3::ToVec3(camera->GetUp());
+		camera->GetFrustum()->setCamDef(cameraPos, cameraTarget, cameraUp);
+
+		scene->RenderSceneChildren(renderer, camera); // Normal draw
+		renderer->Cull(camera);
+		FrameProfiler::End(VisibilityPhase);
+
+		JobSystem::Wait(&audioCounter);
+
+		//Render, submit all draws to the gpu
+		FrameProfiler::Begin(RenderPhase);
+		if (!Editor::Active()) {
+			Console::Render(renderer);
 		}
-	}
 
-	//Update Input
-	Input::HandleUpdates();
+		Debug::NewFrame();
+		renderer->Render(camera);
+		FrameProfiler::End(RenderPhase);
+	}
 
+	//Present, we do not wait for the gpu to finish, so it works on this frame while the next frame is prepared
+	FrameProfiler::Begin(PresentPhase);
 	if (!glfwWindowShouldClose(renderer->GetWindow())) { // Check if window should close
 		renderer->SwapBuffers(); // Swap buffers
-		renderer->PollEvents(); // Poll Events
-		renderer->Clear();
 	}
 	else {
 		this->_active = false; // Disable the Core
 	}
+	FrameProfiler::End(PresentPhase);
     
 	this->_frames++; // Increment frames by 1
 }
@@ -416,6 +794,17 @@ float Core::CalculateDeltaTime() {
 }
 
 void Core::Destroy() {
+	//Finish all jobs first, they may still use other subsystems
+	JobSystem::Destroy();
+
+	//The scripts are stopped, calls they queued without waiting are dropped
+	mainThreadCalls.clear();
+
+	//Delete resources that were still being loaded
+	ResourceLoader::Destroy();
+
+	//Unmap the archives, after the last asset is read
+	AssetArchive::UnmountAll();
 
 	//Delete res manager
 	delete ResourceManager::GetInstance();
@@ -428,6 +817,9 @@ void Core::Destroy() {
 
 	delete SceneManager::GetInstance();
 
+	//After the resources and the renderer, textures deleted later do not report to it
+	ResidencyManager::Destroy();
+
 	//Exit alut
 	SoundManager::Destroy();
 
@@ -508,19 +900,8 @@ void Core::SetRendererDrawFrameBufferToScreen(bool state) {
 	Core::GetInstance()->renderer->DrawFrameBufferToScreenObject(state);
 }
 
-void Core::RegisterThread(Thread* thread) {
-	Core::GetInstance()->threads.push_back(thread);
-}
-
-std::string Core::DestroyThread(int index) {
-	for (size_t t = 0; t < Core::GetInstance()->threads.size(); t++) {
-		if (t == index) {
-			Core::GetInstance()->threads[t]->isDone = true;
-			return "Marked thread as done";
-		}
-	}
-
-	return "Could not find thread";
+Renderer* Core::GetRenderer() {
+	return Core::GetInstance()->renderer;
 }
 
 void Core::AddToGlobalEntityList(Entity* entity) {
@@ -11,19 +11,10 @@
 #ifndef CORE_H
 #define CORE_H
 #include <iostream>
-#include <thread>
 #include <string>
 #include "math/pointx.h"
 #include "renderer.h"
 
-/**
-* Thread struct, holds a extra boolean, so we can check if execution is done
-*/
-struct Thread {
-	std::thread thread; /**< Pointer to the thread*/
-	bool isDone; /**< Boolean if true thread is done executing*/
-};
-
 class Core {
 private:
 	//Static Variables
@@ -53,9 +44,6 @@ private:
 	//Cursor state
 	bool cursorEnabled; /// @brief true if cursor is enabled
 
-	//List of threads, we check each frame if a thread has done its execution, so we can end it
-	std::vector<Thread*> threads; /**< List of activly running threads*/
-
 	//We want to keep a list of entities, so we can easily access all entities, whenever a child is added to whatever entity,
 	//A call should be made to this list (Only applies for Entities base, not UIElements)
 	std::vector<Entity*> entityList; /**< List of entityes*/
@@ -182,14 +170,9 @@ public:
 	static void SetRendererDrawFrameBufferToScreen(bool state);
 
 	/**
-	* Registers a new thread to keep hold of
-	*/
-	static void RegisterThread(Thread* thread);
-
-	/**
-	* Destroys the thread where index matches, returns string with info
+	* Returns the renderer
 	*/
-	static std::string DestroyThread(int index);
+	static Renderer* GetRenderer();
 
 	/**
 	* Adds a entity to the entity global list, Note that it is adviced to use AddChild, to allow for rendering
@@ -33,7 +33,7 @@ void Debug::Log(std::string string, std::string callerName) {
 }
 
 void Debug::LogScreen(std::string string) {
-	Debug::GetInstance()->text->position = Vec3(0, Core::GetResolution().y);
+	Debug::GetInstance()->text->SetPosition(Vec3(0, Core::GetResolution().y));
 
 	//Construct string
 	std::string content = Debug::PREFIX;
@@ -41,13 +41,15 @@ void Debug::LogScreen(std::string string) {
 	content.append(string);
 
 	Debug::GetInstance()->text->SetColor(Debug::GetInstance()->color);
-	Debug::GetInstance()->text->GetText().insert(0, content);
-	Debug::GetInstance()->text->GetText().insert(content.size(),"\n");
+	std::string log = Debug::GetInstance()->text->GetText();
+	log.insert(0, content);
+	log.insert(content.size(),"\n");
 
 	//Make sure we delete some text if string becomes too long (2150 chars), keep hardcoded for now
-	if (Debug::GetInstance()->text->GetText().size() > 2150) {
-		Debug::GetInstance()->text->GetText().erase(2150, Debug::GetInstance()->text->GetText().size());
+	if (log.size() > 2150) {
+		log.erase(2150, log.size());
 	}
+	Debug::GetInstance()->text->SetText(log);
 }
 
 void Debug::NewFrame() {
@@ -0,0 +1,362 @@
+/**
+*	Filename: dynamictree.cpp
+*
+*	Description: Source file for DynamicTree class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <algorithm>
+#include <utility>
+#include "dynamictree.h"
+
+float AABB::Raycast(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance) const {
+	glm::vec3 t1 = (min - origin) * inverseDirection;
+	glm::vec3 t2 = (max - origin) * inverseDirection;
+	glm::vec3 tMin = glm::min(t1, t2);
+	glm::vec3 tMax = glm::max(t1, t2);
+
+	float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+	float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+	return enter <= exit ? enter : -1.0f;
+}
+
+DynamicTree::DynamicTree() {
+	this->root = TREE_NULL;
+	this->freeList = TREE_NULL;
+	this->proxyCount = 0;
+}
+
+int DynamicTree::AllocateNode() {
+	if (freeList == TREE_NULL) {
+		TreeNode node;
+		node.parent = TREE_NULL;
+		nodes.push_back(node);
+		freeList = (int)nodes.size() - 1;
+	}
+
+	int node = freeList;
+	freeList = nodes[node].parent;
+	nodes[node].parent = TREE_NULL;
+	nodes[node].child1 = TREE_NULL;
+	nodes[node].child2 = TREE_NULL;
+	nodes[node].height = 0;
+	nodes[node].userData = nullptr;
+	return node;
+}
+
+void DynamicTree::FreeNode(int node) {
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+AABB DynamicTree::Fatten(const AABB& box) {
+	glm::vec3 margin = glm::vec3(TREE_AABB_MARGIN) + (box.max - box.min) * TREE_AABB_MARGIN_SCALE;
+	return AABB(box.min - margin, box.max + margin);
+}
+
+void DynamicTree::InsertLeaf(int leaf) {
+	if (root == TREE_NULL) {
+		root = leaf;
+		nodes[root].parent = TREE_NULL;
+		return;
+	}
+
+	//Walk down to the cheapest sibling, cost is the surface area the new parent adds plus the growth of all ancestors
+	AABB leafBox = nodes[leaf].box;
+	int index = root;
+	while (!nodes[index].IsLeaf()) {
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+
+		float area = nodes[index].box.SurfaceArea();
+		float combinedArea = AABB::Union(nodes[index].box, leafBox).SurfaceArea();
+
+		float cost = 2.0f * combinedArea; // Making a new parent for this node and the leaf
+		float inheritanceCost = 2.0f * (combinedArea - area); // Minimum cost of pushing the leaf further down
+
+		float cost1 = AABB::Union(leafBox, nodes[child1].box).SurfaceArea() + inheritanceCost;
+		if (!nodes[child1].IsLeaf()) cost1 -= nodes[child1].box.SurfaceArea();
+
+		float cost2 = AABB::Union(leafBox, nodes[child2].box).SurfaceArea() + inheritanceCost;
+		if (!nodes[child2].IsLeaf()) cost2 -= nodes[child2].box.SurfaceArea();
+
+		if (cost < cost1 && cost < cost2) break;
+		index = cost1 < cost2 ? child1 : child2;
+	}
+
+	//Make a new parent for the sibling and the leaf
+	int sibling = index;
+	int oldParent = nodes[sibling].parent;
+	int newParent = AllocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].box = AABB::Union(leafBox, nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent != TREE_NULL) {
+		if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+		else nodes[oldParent].child2 = newParent;
+	}
+	else {
+		root = newParent;
+	}
+
+	Refit(newParent);
+}
+
+void DynamicTree::RemoveLeaf(int leaf) {
+	if (leaf == root) {
+		root = TREE_NULL;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	//The sibling takes the place of the parent
+	if (grandParent != TREE_NULL) {
+		if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+		else nodes[grandParent].child2 = sibling;
+		nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+		Refit(grandParent);
+	}
+	else {
+		root = sibling;
+		nodes[sibling].parent = TREE_NULL;
+		FreeNode(parent);
+	}
+}
+
+void DynamicTree::Refit(int node) {
+	while (node != TREE_NULL) {
+		node = Balance(node);
+
+		int child1 = nodes[node].child1;
+		int child2 = nodes[node].child2;
+		nodes[node].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+		nodes[node].box = AABB::Union(nodes[child1].box, nodes[child2].box);
+
+		node = nodes[node].parent;
+	}
+}
+
+int DynamicTree::Balance(int a) {
+	if (nodes[a].IsLeaf() || nodes[a].height < 2) return a;
+
+	int b = nodes[a].child1;
+	int c = nodes[a].child2;
+	int balance = nodes[c].height - nodes[b].height;
+
+	//Rotate the higher child up, it becomes the parent of a, and a takes its lower grandchild
+	if (balance > 1 || balance < -1) {
+		int up = balance > 1 ? c : b; // The child that moves up
+		int other = balance > 1 ? b : c; // The child that stays below a
+		int f = nodes[up].child1;
+		int g = nodes[up].child2;
+
+		nodes[up].child1 = a;
+		nodes[up].parent = nodes[a].parent;
+		nodes[a].parent = up;
+
+		if (nodes[up].parent != TREE_NULL) {
+			if (nodes[nodes[up].parent].child1 == a) nodes[nodes[up].parent].child1 = up;
+			else nodes[nodes[up].parent].child2 = up;
+		}
+		else {
+			root = up;
+		}
+
+		//The higher grandchild stays with up, the lower one replaces up below a
+		int high = nodes[f].height > nodes[g].height ? f : g;
+		int low = high == f ? g : f;
+		nodes[up].child2 = high;
+		if (balance > 1) nodes[a].child2 = low;
+		else nodes[a].child1 = low;
+		nodes[low].parent = a;
+
+		nodes[a].box = AABB::Union(nodes[other].box, nodes[low].box);
+		nodes[a].height = 1 + std::max(nodes[other].height, nodes[low].height);
+		nodes[up].box = AABB::Union(nodes[a].box, nodes[high].box);
+		nodes[up].height = 1 + std::max(nodes[a].height, nodes[high].height);
+		return up;
+	}
+
+	return a;
+}
+
+int DynamicTree::CreateProxy(const AABB& box, void* userData) {
+	int proxy = AllocateNode();
+	nodes[proxy].box = Fatten(box);
+	nodes[proxy].userData = userData;
+	InsertLeaf(proxy);
+	proxyCount++;
+	return proxy;
+}
+
+void DynamicTree::DestroyProxy(int proxy) {
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	proxyCount--;
+}
+
+bool DynamicTree::MoveProxy(int proxy, const AABB& box) {
+	//Still inside the fat box, and the fat box is not much larger than a fresh one would be
+	const AABB& fatBox = nodes[proxy].box;
+	if (fatBox.Contains(box)) {
+		AABB largeBox = Fatten(Fatten(Fatten(box)));
+		if (largeBox.Contains(fatBox)) return false;
+	}
+
+	RemoveLeaf(proxy);
+	nodes[proxy].box = Fatten(box);
+	InsertLeaf(proxy);
+	return true;
+}
+
+void* DynamicTree::GetUserData(int proxy) const {
+	return nodes[proxy].userData;
+}
+
+const AABB& DynamicTree::GetFatAABB(int proxy) const {
+	return nodes[proxy].box;
+}
+
+void DynamicTree::QueryFrustum(const glm::vec4* planes, std::vector<void*>& results) const {
+	if (root == TREE_NULL) return;
+
+	//Every entry holds a node and the planes its box still crosses, 6 bits
+	std::vector<std::pair<int, int>> stack;
+	stack.reserve(TREE_STACK_SIZE);
+	stack.push_back(std::make_pair(root, 0x3F));
+
+	while (!stack.empty()) {
+		int node = stack.back().first;
+		int planeMask = stack.back().second;
+		stack.pop_back();
+
+		const AABB& box = nodes[node].box;
+		bool outside = false;
+		for (int p = 0; p < 6 && !outside; p++) {
+			if (!(planeMask & (1 << p))) continue;
+
+			//The corner furthest along the normal decides if the box is outside, the closest one if it is fully inside
+			glm::vec3 normal = glm::vec3(planes[p]);
+			glm::vec3 farCorner(normal.x >= 0 ? box.max.x : box.min.x, normal.y >= 0 ? box.max.y : box.min.y, normal.z >= 0 ? box.max.z : box.min.z);
+			glm::vec3 nearCorner(normal.x >= 0 ? box.min.x : box.max.x, normal.y >= 0 ? box.min.y : box.max.y, normal.z >= 0 ? box.min.z : box.max.z);
+
+			if (glm::dot(normal, farCorner) + planes[p].w < 0) outside = true;
+			else if (glm::dot(normal, nearCorner) + planes[p].w >= 0) planeMask &= ~(1 << p);
+		}
+		if (outside) continue;
+
+		if (nodes[node].IsLeaf()) {
+			results.push_back(nodes[node].userData);
+			continue;
+		}
+
+		stack.push_back(std::make_pair(nodes[node].child1, planeMask));
+		stack.push_back(std::make_pair(nodes[node].child2, planeMask));
+	}
+}
+
+void DynamicTree::QueryBox(const AABB& box, std::vector<void*>& results) const {
+	if (root == TREE_NULL) return;
+
+	std::vector<int> stack;
+	stack.reserve(TREE_STACK_SIZE);
+	stack.push_back(root);
+
+	while (!stack.empty()) {
+		int node = stack.back();
+		stack.pop_back();
+		if (!nodes[node].box.Overlaps(box)) continue;
+
+		if (nodes[node].IsLeaf()) {
+			results.push_back(nodes[node].userData);
+			continue;
+		}
+
+		stack.push_back(nodes[node].child1);
+		stack.push_back(nodes[node].child2);
+	}
+}
+
+void DynamicTree::QuerySphere(const glm::vec3& centre, float radius, std::vector<void*>& results) const {
+	if (root == TREE_NULL) return;
+
+	std::vector<int> stack;
+	stack.reserve(TREE_STACK_SIZE);
+	stack.push_back(root);
+
+	while (!stack.empty()) {
+		int node = stack.back();
+		stack.pop_back();
+		if (!nodes[node].box.OverlapsSphere(centre, radius)) continue;
+
+		if (nodes[node].IsLeaf()) {
+			results.push_back(nodes[node].userData);
+			continue;
+		}
+
+		stack.push_back(nodes[node].child1);
+		stack.push_back(nodes[node].child2);
+	}
+}
+
+void* DynamicTree::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const std::function<float(void*)>& test, float& distance) const {
+	void* closest = nullptr;
+	distance = maxDistance;
+	if (root == TREE_NULL) return closest;
+
+	glm::vec3 inverseDirection = 1.0f / direction;
+
+	//Entries hold a node and the distance at which the ray enters its box
+	std::vector<std::pair<int, float>> stack;
+	stack.reserve(TREE_STACK_SIZE);
+	float rootDistance = nodes[root].box.Raycast(origin, inverseDirection, distance);
+	if (rootDistance >= 0) stack.push_back(std::make_pair(root, rootDistance));
+
+	while (!stack.empty()) {
+		int node = stack.back().first;
+		float enter = stack.back().second;
+		stack.pop_back();
+		if (enter > distance) continue; // A closer hit was found since this node was pushed
+
+		if (nodes[node].IsLeaf()) {
+			float hit = test(nodes[node].userData);
+			if (hit >= 0 && hit <= distance) {
+				distance = hit;
+				closest = nodes[node].userData;
+			}
+			continue;
+		}
+
+		//Push the nearest child last, so it is visited first and shrinks the distance for the other
+		float enter1 = nodes[nodes[node].child1].box.Raycast(origin, inverseDirection, distance);
+		float enter2 = nodes[nodes[node].child2].box.Raycast(origin, inverseDirection, distance);
+		std::pair<int, float> first = std::make_pair(nodes[node].child1, enter1);
+		std::pair<int, float> second = std::make_pair(nodes[node].child2, enter2);
+		if (enter2 >= 0 && (enter1 < 0 || enter2 < enter1)) std::swap(first, second);
+
+		if (second.second >= 0) stack.push_back(second);
+		if (first.second >= 0) stack.push_back(first);
+	}
+
+	return closest;
+}
+
+int DynamicTree::GetHeight() const {
+	return root == TREE_NULL ? 0 : nodes[root].height;
+}
+
+size_t DynamicTree::GetProxyCount() const {
+	return proxyCount;
+}
@@ -0,0 +1,197 @@
+/**
+*	Filename: dynamictree.h
+*
+*	Description: Header file for DynamicTree class, a incrementally updated bounding volume hierarchy of axis aligned boxes
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef DYNAMICTREE_H
+#define DYNAMICTREE_H
+#include <vector>
+#include <functional>
+#include <glm/glm.hpp>
+
+#define TREE_NULL -1 // Index of no node
+#define TREE_AABB_MARGIN 0.1f // Added to every side of a leaf box, so small movements do not need a reinsert
+#define TREE_AABB_MARGIN_SCALE 0.1f // Part of the box size added to every side of a leaf box as well
+#define TREE_STACK_SIZE 256 // Initial size of the traversal stacks
+
+/**
+* Axis aligned bounding box
+*/
+struct AABB {
+	glm::vec3 min; /// @brief Minimum corner
+	glm::vec3 max; /// @brief Maximum corner
+
+	AABB() : min(0.0f), max(0.0f) {}
+	AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+
+	/**
+	* Returns the box enclosing both boxes
+	*/
+	static AABB Union(const AABB& a, const AABB& b) { return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max)); }
+
+	/**
+	* Returns the surface area, the cost of a node in the tree
+	*/
+	float SurfaceArea() const {
+		glm::vec3 size = max - min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	/**
+	* Returns true if other lies fully inside this box
+	*/
+	bool Contains(const AABB& other) const {
+		return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+	}
+
+	/**
+	* Returns true if the boxes touch
+	*/
+	bool Overlaps(const AABB& other) const {
+		return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+	}
+
+	/**
+	* Returns true if the sphere touches the box
+	*/
+	bool OverlapsSphere(const glm::vec3& centre, float radius) const {
+		glm::vec3 closest = glm::clamp(centre, min, max);
+		glm::vec3 offset = closest - centre;
+		return glm::dot(offset, offset) <= radius * radius;
+	}
+
+	/**
+	* Returns the distance along the ray at which it enters the box, or -1 if it misses the box within maxDistance.
+	* inverseDirection is 1 / direction, so axis parallel rays give infinities that the slab test handles
+	*/
+	float Raycast(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance) const;
+};
+
+/**
+* A node is a leaf holding a proxy, or has exactly two children. Free nodes are linked through parent
+*/
+struct TreeNode {
+	AABB box; /// @brief Box of a leaf, fattened by the margin, or the box enclosing both children
+	void* userData; /// @brief The object of a leaf
+	int parent; /// @brief Parent node, or next free node
+	int child1, child2; /// @brief Children, TREE_NULL for leaves
+	int height; /// @brief 0 for leaves, -1 for free nodes
+
+	bool IsLeaf() const { return child1 == TREE_NULL; }
+};
+
+/**
+* Leaves are inserted where they increase the surface area of the tree the least, and the tree is kept balanced with
+* rotations while walking back up. Moving a proxy only touches the tree if it leaves its fattened box.
+*/
+class DynamicTree {
+private:
+	std::vector<TreeNode> nodes; /// @brief All nodes, proxies are node indices
+	int root; /// @brief The root node
+	int freeList; /// @brief First free node
+	size_t proxyCount; /// @brief Amount of leaves
+
+	/**
+	* Returns a free node, grows the node pool if there are none
+	*/
+	int AllocateNode();
+
+	/**
+	* Adds the node to the free list
+	*/
+	void FreeNode(int node);
+
+	/**
+	* Inserts a leaf next to the sibling that adds the least surface area
+	*/
+	void InsertLeaf(int leaf);
+
+	/**
+	* Removes a leaf, its sibling takes the place of their parent
+	*/
+	void RemoveLeaf(int leaf);
+
+	/**
+	* Rotates a child up if the subtree of the node is unbalanced, returns the node now at the place of the node
+	*/
+	int Balance(int node);
+
+	/**
+	* Recalculates the boxes and heights from the node up to the root, balancing on the way
+	*/
+	void Refit(int node);
+
+	/**
+	* Returns the box fattened by the margin
+	*/
+	static AABB Fatten(const AABB& box);
+public:
+	/**
+	* Constructor
+	*/
+	DynamicTree();
+
+	/**
+	* Adds a proxy for the object with the given box, returns the proxy
+	*/
+	int CreateProxy(const AABB& box, void* userData);
+
+	/**
+	* Removes a proxy
+	*/
+	void DestroyProxy(int proxy);
+
+	/**
+	* Updates the box of a proxy. The proxy is only reinserted if the box leaves the fattened box, or is a lot smaller than it.
+	* Returns true if the proxy was reinserted
+	*/
+	bool MoveProxy(int proxy, const AABB& box);
+
+	/**
+	* Returns the object of a proxy
+	*/
+	void* GetUserData(int proxy) const;
+
+	/**
+	* Returns the fattened box of a proxy
+	*/
+	const AABB& GetFatAABB(int proxy) const;
+
+	/**
+	* Adds the objects of all leaves that touch the frustum. Subtrees fully inside a plane skip that plane,
+	* subtrees fully inside the frustum are added without any further tests
+	*/
+	void QueryFrustum(const glm::vec4* planes, std::vector<void*>& results) const;
+
+	/**
+	* Adds the objects of all leaves that overlap the box
+	*/
+	void QueryBox(const AABB& box, std::vector<void*>& results) const;
+
+	/**
+	* Adds the objects of all leaves that overlap the sphere
+	*/
+	void QuerySphere(const glm::vec3& centre, float radius, std::vector<void*>& results) const;
+
+	/**
+	* Returns the object closest along the ray, or nullptr. test is called for the objects of leaves the ray hits, and returns
+	* the distance at which the ray hits the object or a negative value if it misses. Subtrees further than the closest hit are skipped
+	*/
+	void* Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const std::function<float(void*)>& test, float& distance) const;
+
+	/**
+	* Returns the height of the tree, 0 if there is a single leaf
+	*/
+	int GetHeight() const;
+
+	/**
+	* Returns the amount of proxies
+	*/
+	size_t GetProxyCount() const;
+};
+
+#endif // !DYNAMICTREE_H
@@ -61,7 +61,8 @@ void Editor::HandleEntityInfoMenu() {
 		//Position/Rotation/Scale
 		ImGui::TextColored(ImVec4(1, 0, 0, 1), "Transform Info");
 
-		float _currentEntityPos[3] = { currentSelection->position.x, currentSelection->position.y, currentSelection->position.z };
+		Vec3 _currentPosition = currentSelection->GetPosition();
+		float _currentEntityPos[3] = { _currentPosition.x, _currentPosition.y, _currentPosition.z };
 		float _currentEntityRot[3] = { currentSelection->GetRotation().x, currentSelection->GetRotation().y, currentSelection->GetRotation().z };;
 		float _currentEntityScale[3] = { currentSelection->GetScale().x, currentSelection->GetScale().y, currentSelection->GetScale().z };;
 
@@ -70,7 +71,7 @@ void Editor::HandleEntityInfoMenu() {
 		ImGui::DragFloat3("rotation", _currentEntityRot);
 		ImGui::DragFloat3("scale", _currentEntityScale);
 
-		currentSelection->position = Vec3(_currentEntityPos[0], _currentEntityPos[1], _currentEntityPos[2]);
+		currentSelection->SetPosition(Vec3(_currentEntityPos[0], _currentEntityPos[1], _currentEntityPos[2]));
 		currentSelection->SetRotation(Vec3(_currentEntityRot[0], _currentEntityRot[1], _currentEntityRot[2]));
 		currentSelection->SetScale(Vec3(_currentEntityScale[0], _currentEntityScale[1], _currentEntityScale[2]));
 
@@ -107,6 +108,13 @@ void Editor::HandleEntityInfoMenu() {
 			light->SetDiffuse(Vec3(_lightDiffuseColor[0], _lightDiffuseColor[1], _lightDiffuseColor[2]).ToGLM());
 			light->SetSpecular(Vec3(_lightSpecularColor[0], _lightSpecularColor[1], _lightSpecularColor[2]).ToGLM());
 
+			if (light->GetLightType() == LightType::PointLight) {
+				float _lightRadius = light->GetRadius();
+				if (ImGui::DragFloat("radius", &_lightRadius, 0.1f, 0.0f, 1000.0f)) {
+					light->SetRadius(_lightRadius); //Only once edited, so a derived radius keeps following the intensity
+				}
+			}
+
 			if (light->GetLightType() == LightType::Directional) {
 				dirLight = dynamic_cast<DirectionalLight*>(light);
 				float _dirLightDirection[3] = { dirLight->GetDirection().x, dirLight->GetDirection().y, dirLight->GetDirection().z };
@@ -147,8 +155,10 @@ void Editor::HandleEntityInfoMenu() {
 				ImGui::Text(_amountMaterialsString.c_str());
 
 				unsigned _amountVertices = 0;
+				unsigned _amountIndices = 0;
 				for (int i = 0; i < currentSelection->GetModel()->GetMeshesCount(); i++) {
 					_amountVertices += currentSelection->GetModel()->GetMesh(i)->GetVerticesCount();
+					_amountIndices += currentSelection->GetModel()->GetMesh(i)->GetIndicesCount();
 				}
 
 				std::string _amountVerticesString = "Amount of vertices: ";
@@ -156,8 +166,23 @@ void Editor::HandleEntityInfoMenu() {
 				ImGui::Text(_amountVerticesString.c_str());
 
 				std::string _amountTrianglesString = "Amount of triangles: ";
-				_amountTrianglesString.append(std::to_string(_amountVertices / 3));
+				_amountTrianglesString.append(std::to_string(_amountIndices / 3));
 				ImGui::Text(_amountTrianglesString.c_str());
+
+				//Lod level drawn last frame
+				int _lod = currentSelection->GetLod();
+				unsigned _amountLodIndices = 0;
+				for (int i = 0; i < currentSelection->GetModel()->GetMeshesCount(); i++) {
+					_amountLodIndices += currentSelection->GetModel()->GetMesh(i, _lod)->GetIndicesCount();
+				}
+
+				std::string _lodString = "Active lod: ";
+				_lodString.append(std::to_string(_lod) + " of " + std::to_string(currentSelection->GetModel()->GetLodCount()));
+				ImGui::Text(_lodString.c_str());
+
+				std::string _lodTrianglesString = "Triangles at lod: ";
+				_lodTrianglesString.append(std::to_string(_amountLodIndices / 3));
+				ImGui::Text(_lodTrianglesString.c_str());
 			}
 			else {
 				ImGui::Text("Entity has no model");
@@ -203,14 +228,14 @@ void Editor::HandleEntityListMenu() {
 
 	if (ImGui::Button("Create New")) {
 		Entity* entity = new Entity();
-		entity->position = Vec3(camera->GetPos().x, camera->GetPos().y, camera->GetPos().z);
+		entity->SetPosition(Vec3(camera->GetPos().x, camera->GetPos().y, camera->GetPos().z));
 		SceneManager::GetActiveScene()->AddChild(entity);
 		_currentEntityItem = SceneManager::GetActiveScene()->GetChildren().size() - 1;
 	}
 	ImGui::SameLine(0);
 	if (ImGui::Button("Copy")) {
 		Entity* copyEntity = new Entity();
-		copyEntity->position = currentSelection->position;
+		copyEntity->SetPosition(currentSelection->GetPosition());
 		copyEntity->SetRotation(currentSelection->GetRotation());
 		copyEntity->SetScale(currentSelection->GetScale());
 		copyEntity->SetModel(currentSelection->GetModel());
@@ -271,14 +296,14 @@ void Editor::HandleNativeFunctionListMenu() {
 void Editor::AddPointLight() {
 	Light* light = new Light();
 	light->SetLightType(LightType::PointLight);
-	light->position = Vec3(camera->GetPos().x, camera->GetPos().y, camera->GetPos().z);
+	light->SetPosition(Vec3(camera->GetPos().x, camera->GetPos().y, camera->GetPos().z));
 	SceneManager::GetActiveScene()->AddLight(light);
 }
 
 void Editor::AddDirectionalLight() {
 	DirectionalLight* light = new DirectionalLight();
 	light->SetName("Directional Light");
-	light->position = Vec3(camera->GetPos().x, camera->GetPos().y, camera->GetPos().z);
+	light->SetPosition(Vec3(camera->GetPos().x, camera->GetPos().y, camera->GetPos().z));
 	SceneManager::GetActiveScene()->AddLight(light);
 }
 
@@ -342,7 +367,7 @@ void Editor::Update() {
 
 	if (Input::GetButton(BUTTONCODE_LEFT) && !Core::CursorEnabled()) {
 		if (instance->currentSelection) {
-			instance->currentSelection->position = Input::GetMouseRayPositionWorldSpace(instance->camera, 5.0f);
+			instance->currentSelection->SetPosition(Input::GetMouseRayPositionWorldSpace(instance->camera, 5.0f));
 		}
 	}
 
@@ -12,40 +12,39 @@
 #include "entity.h"
 #include "debug.h"
 #include "core.h"
+#include "transformhierarchy.h"
+#include "scene.h"
 
 unsigned Entity::_currentId; // Declare static member
 
-void Entity::UpdateChildren() {
-	// Handle position/rotation/scale accoring to parent
-	if (this->parent) { // If we have a parent
-		// Set global position, rotation and scale
-		this->globalPosition = Vec3(parent->globalPosition.x + position.x, parent->globalPosition.y + position.y, parent->globalPosition.z + position.z);
-		this->globalRotation = Vec3(parent->globalRotation.x + localRotation.x, parent->globalRotation.y + localRotation.y, parent->globalRotation.z + localRotation.z);
-		this->globalScale = Vec3(parent->globalScale.x + localScale.x, parent->globalScale.y + localScale.y, parent->globalScale.z + localScale.z);
-	}
-	else {
-		// Set global position, rotation and scale
-		this->globalPosition = position;
-		this->globalRotation = localRotation;
-		this->globalScale = localScale;
+void Entity::UpdateIndex(bool recursive, bool force) {
+	Scene* root = GetScene();
+	Scene* scene = this->model ? root : nullptr;
+	if (scene != indexScene || force) {
+		if (indexScene) indexScene->RemoveFromIndex(this, proxy);
+		indexScene = scene;
+		proxy = scene ? scene->AddToIndex(this) : TREE_NULL;
 	}
 
-	//Update children
-	for (unsigned i = 0; i < children.size(); i++) {
-		children[i]->UpdateChildren();
+	//Static entities are not listed, so the scene does not visit them every frame
+	Scene* listed = this->updateEnabled || this->renderEnabled ? root : nullptr;
+	if (listed != listScene) {
+		if (listScene) listScene->RemoveFromLists(this);
+		listScene = listed;
+		if (listed) listed->AddToLists(this);
 	}
 
-	this->Update(); // Call local update function
-}
-
-void Entity::Render(Renderer* renderer, Camera* camera) {
-	if (this->model != nullptr) {
-		renderer->RegisterEntity(this);
+	if (!recursive) return;
+	for (size_t i = 0; i < children.size(); i++) {
+		children[i]->UpdateIndex(true);
 	}
+}
 
-	for (unsigned i = 0; i < children.size(); i++) {
-		children[i]->Render(renderer, camera);
+void Entity::DeleteChildren() {
+	for (size_t i = 0; i < children.size(); i++) {
+		delete children[i];
 	}
+	children.clear();
 }
 
 Entity::Entity() {
@@ -55,10 +54,15 @@ Entity::Entity() {
 
 	this->parent = nullptr; // Set parent to nullptr
 	this->model = nullptr; // Set model to nullptr
+	this->lod = 0;
+	this->indexScene = nullptr;
+	this->proxy = TREE_NULL;
+	this->updateEnabled = false;
+	this->renderEnabled = false;
+	this->listScene = nullptr;
 	this->id = _currentId; // Set this id to the _currentId
-
-	//Set scale
-	this->localScale = Vec3(1.0f,1.0f,1.0f);
+	this->transform = TransformHierarchy::Create(); // Identity transform, scale of 1
+	TransformHierarchy::SetUserData(this->transform, this);
 
 	this->name = "Entity";
 	_currentId++; // Increment global variable _currentId by 1
@@ -82,7 +86,9 @@ Entity* Entity::GetChild(int index) {
 
 Entity* Entity::AddChild(Entity* child) {
 	child->parent = this; // Set parent to this object
+	TransformHierarchy::SetParent(child->transform, this->transform);
 	children.push_back(child); // Push back child
+	child->UpdateIndex(true);
 	Core::AddToGlobalEntityList(child);
 	return child; //  Return child
 }
@@ -97,6 +103,11 @@ void Entity::RemoveChild(Entity* entity) {
 
 	if (index == -1) return;
 
+	//Detach before the children of the child are dropped, so their proxies are removed as well
+	entity->parent = nullptr;
+	TransformHierarchy::SetParent(entity->transform, TRANSFORM_NONE);
+	entity->UpdateIndex(true);
+
 	//Remove all children from child
 	for (size_t i = 0; i < this->children[index]->children.size(); i++) {
 		this->children[index]->children.erase(this->children[index]->children.begin() + i);
@@ -110,16 +121,24 @@ std::vector<Entity*> Entity::GetChildren() {
 	return this->children; // Return children Vector Array
 }
 
+void Entity::SetPosition(Vec3 position) {
+	TransformHierarchy::SetLocalPosition(this->transform, position.ToGLM());
+}
+
+Vec3 Entity::GetPosition() {
+	return Vec3::ToVec3(TransformHierarchy::GetLocalPosition(this->transform)); // Return local position
+}
+
 void Entity::Translate(Vec3 position) {
-	this->position = Vec3(this->position.x + position.x, this->position.y + position.y, this->position.z + position.z);
+	TransformHierarchy::SetLocalPosition(this->transform, TransformHierarchy::GetLocalPosition(this->transform) + position.ToGLM());
 }
 
 Vec3 Entity::GetPositionGlobal() {
-	return this->globalPosition; // Return global position
+	return Vec3::ToVec3(TransformHierarchy::GetWorldPosition(this->transform)); // Return global position
 }
 
 void Entity::SetPositionGlobal(Vec3 pos) {
-	this->globalPosition = pos;
+	TransformHierarchy::SetWorldPosition(this->transform, pos.ToGLM());
 }
 
 void Entity::SetRotation(Vec3 rotation) {
@@ -149,7 +168,7 @@ void Entity::SetRotation(Vec3 rotation) {
 	}
 
 	// Set local rotation
-	this->localRotation = rotation;
+	TransformHierarchy::SetLocalRotation(this->transform, rotation.ToGLM());
 }
 
 void Entity::Rotate(Vec3 rotation) {
@@ -178,15 +197,15 @@ void Entity::Rotate(Vec3 rotation) {
 		rotation.z = 360;
 	}
 
-	this->localRotation = Vec3(this->localRotation.x + rotation.x, this->localRotation.y + rotation.y, this->localRotation.z + rotation.z);
+	TransformHierarchy::SetLocalRotation(this->transform, TransformHierarchy::GetLocalRotation(this->transform) + rotation.ToGLM());
 }
 
 Vec3 Entity::GetRotation() {
-	return this->localRotation; // Return local rotation
+	return Vec3::ToVec3(TransformHierarchy::GetLocalRotation(this->transform)); // Return local rotation
 }
 
 Vec3 Entity::GetRotationGlobal() {
-	return this->globalRotation; // Return global rotation
+	return Vec3::ToVec3(TransformHierarchy::GetGlobalRotation(this->transform)); // Return global rotation
 }
 
 void Entity::SetScale(Vec3 scale) {
@@ -203,39 +222,96 @@ void Entity::SetScale(Vec3 scale) {
 		scale.z = 0;
 	}
 
-	this->localScale = scale; // Set local scale
+	TransformHierarchy::SetLocalScale(this->transform, scale.ToGLM()); // Set local scale
 }
 
 Vec3 Entity::GetScale() {
-	return this->localScale; // Return local scale
+	return Vec3::ToVec3(TransformHierarchy::GetLocalScale(this->transform)); // Return local scale
 }
 
 Vec3 Entity::GetScaleGlobal() {
-	return this->globalScale; //  Return global scale
+	return Vec3::ToVec3(TransformHierarchy::GetGlobalScale(this->transform)); //  Return global scale
+}
+
+const glm::mat4& Entity::GetWorldMatrix() {
+	return TransformHierarchy::GetWorldMatrix(this->transform);
 }
 
 void Entity::SetModel(Model* model) {
 	this->model = model;
+	this->lod = 0;
+	UpdateIndex(false, true); // The bounds of the new model can differ
 }
 
 Model* Entity::GetModel() {
 	return this->model;
 }
 
+void Entity::SetLod(int lod) {
+	this->lod = lod;
+}
+
+int Entity::GetLod() {
+	return this->lod;
+}
+
 void Entity::SetParent(Entity* parent) {
 	if (parent != nullptr) {
 		this->parent = parent;
+		TransformHierarchy::SetParent(this->transform, parent->transform);
+		UpdateIndex(true);
 	}
 }
 
+void Entity::SetUpdateEnabled(bool state) {
+	if (this->updateEnabled == state) return;
+
+	this->updateEnabled = state;
+	if (listScene) listScene->RemoveFromLists(this); // Listed again below with the new state
+	listScene = nullptr;
+	UpdateIndex(false);
+}
+
+bool Entity::GetUpdateEnabled() {
+	return this->updateEnabled;
+}
+
+void Entity::SetRenderEnabled(bool state) {
+	if (this->renderEnabled == state) return;
+
+	this->renderEnabled = state;
+	if (listScene) listScene->RemoveFromLists(this);
+	listScene = nullptr;
+	UpdateIndex(false);
+}
+
 Entity* Entity::GetParent() {
 	return this->parent;
 }
 
-Entity::~Entity() {
-	for (size_t i = 0; i < children.size(); i++) {
-		delete children[i];
+Scene* Entity::GetScene() {
+	Entity* root = this;
+	while (root->parent) {
+		root = root->parent;
 	}
+	return dynamic_cast<Scene*>(root);
+}
+
+MeshBounds Entity::GetWorldBounds() {
+	return this->model->GetWorldBounds(GetWorldMatrix());
+}
+
+void Entity::RefitIndex() {
+	if (!indexScene || proxy == TREE_NULL) return;
+	indexScene->RefitInIndex(this, proxy);
+}
+
+Entity::~Entity() {
+	DeleteChildren();
+
+	if (indexScene) indexScene->RemoveFromIndex(this, proxy);
+	if (listScene) listScene->RemoveFromLists(this);
+	TransformHierarchy::Destroy(this->transform);
 
 	Debug::Log("Deleted Entity:", typeid(*this).name());
 	Debug::Log(std::to_string(this->GetId()), typeid(*this).name());
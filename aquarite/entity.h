@@ -15,6 +15,9 @@
 #include "renderer.h"
 #include "math/vec3.h"
 #include "model.h"
+#include "dynamictree.h"
+
+class Scene; // Forward Declaration
 
 class Entity {
 private:
@@ -25,29 +28,47 @@ private:
 	//Local members
 	unsigned id; /// @brief The Id of this entity
 
-	Vec3 globalPosition; /// @brief the exact Position in world space.
-	Vec3 localRotation; /// @brief local rotation Vector3
-	Vec3 globalRotation; /// @brief global rotation Vector3, relative to parent
-	Vec3 localScale; /// @brief Local Scale Vector3
-	Vec3 globalScale; /// @brief Global Scale Vector3, relative to parent scaling
+	unsigned transform; /// @brief Handle of the transform in the TransformHierarchy, holds position, rotation and scale
 	
 	std::vector<Entity*> children; /// @brief Vector of children Entities
 	Entity* parent; /// @brief The parent entity of this entity, if entity has no parent will be set to nullptr.
 
 	Model* model; /// @brief The model that this entity uses
+	int lod; /// @brief The lod level of the model drawn last frame
+
+	Scene* indexScene; /// @brief The scene whose spatial index holds this entity, nullptr if it is not indexed
+	int proxy; /// @brief The proxy of this entity in the spatial index, TREE_NULL if the model ignores the frustum
+
+	bool updateEnabled; /// @brief True if Update is called every frame
+	bool renderEnabled; /// @brief True if Render is called every frame, for entities that register something without a model
+	Scene* listScene; /// @brief The scene whose update or render list holds this entity, nullptr if it is not listed
+
+	/**
+	* Adds this entity to the spatial index of its scene, or removes it if it has no model or scene anymore.
+	* If recursive the children are updated as well, if force the entity is reinserted even if its scene did not change.
+	* Entities with updates or rendering enabled are added to or removed from the lists of their scene in the same way
+	*/
+	void UpdateIndex(bool recursive, bool force = false);
+
+	friend class Scene; // The scene calls Update and Render of the listed entities
 protected:
 	/**
-	* Protected method UpdateChildren, this due to we not wanting the end user to call this method.
+	* Deletes all children, called by the destructor
 	*/
-	void UpdateChildren();
+	void DeleteChildren();
 
 	/**
 	* Protected method Render, this due to we not wanting the end user to call this method.
+	* Only called for entities that enabled rendering, like text and ui elements. It does not visit the children, they are listed themselves.
+	* Entities with a model are not registered here, the scene finds the visible ones in its spatial index
 	*/
-	virtual void Render(Renderer* renderer, Camera* camera);
-public:
-	Vec3 position; /// @brief Position Vector3, position is relative to the parent's position
+	virtual void Render(Renderer* renderer, Camera* camera) {};
 
+	/**
+	* Enables or disables calling Render every frame, entities overriding Render enable it in their constructor
+	*/
+	void SetRenderEnabled(bool state);
+public:
 	/**
 	* Constructor, if RenderMode is not defined then RenderMode will be WorldSpace
 	*/
@@ -69,10 +90,20 @@ public:
 	std::string GetName();
 
 	/**
-	* Update gets called every frame
+	* Update gets called every frame once updates are enabled with SetUpdateEnabled, the scene only visits the entities in its update list
 	*/
 	virtual void Update() {};
 
+	/**
+	* Enables or disables calling Update every frame, entities overriding Update enable it in their constructor
+	*/
+	void SetUpdateEnabled(bool state);
+
+	/**
+	* Returns true if Update is called every frame
+	*/
+	bool GetUpdateEnabled();
+
 	/**
 	* Returns the child where index matches
 	*/
@@ -93,13 +124,23 @@ public:
 	*/
 	std::vector<Entity*> GetChildren();
 
+	/**
+	* Sets the local position of the entity, position is relative to the parent's position
+	*/
+	void SetPosition(Vec3 position);
+
+	/**
+	* Get the local position of the entity
+	*/
+	Vec3 GetPosition();
+
 	/**
 	* Add given Vec3 to position
 	*/
 	void Translate(Vec3 amount);
 
 	/**
-	* Get the global rotation of the entity
+	* Get the global position of the entity
 	*/
 	Vec3 GetPositionGlobal();
 
@@ -143,6 +184,11 @@ public:
 	*/
 	Vec3 GetScaleGlobal();
 
+	/**
+	* Returns the cached world matrix of the entity, as of the last transform update
+	*/
+	const glm::mat4& GetWorldMatrix();
+
 	/**
 	* Sets the model of the entity
 	*/
@@ -153,6 +199,16 @@ public:
 	*/
 	Model* GetModel();
 
+	/**
+	* Sets the lod level of the model, chosen by the renderer every frame
+	*/
+	void SetLod(int lod);
+
+	/**
+	* Returns the lod level of the model drawn last frame
+	*/
+	int GetLod();
+
 	/**
 	* Sets the parent object of this entity if parent is not nullptr
 	*/
@@ -163,6 +219,21 @@ public:
 	*/
 	Entity* GetParent();
 
+	/**
+	* Returns the scene at the root of the hierarchy of this entity, nullptr if the root is not a scene
+	*/
+	Scene* GetScene();
+
+	/**
+	* Returns the bounds of the model in world space, as of the last transform update
+	*/
+	MeshBounds GetWorldBounds();
+
+	/**
+	* Moves the proxy of this entity in the spatial index to its current bounds, called after its transform changed
+	*/
+	void RefitIndex();
+
 	/**
 	* Destructor
 	*/
@@ -0,0 +1,73 @@
+/**
+*	Filename: frameprofiler.cpp
+*
+*	Description: Source file for FrameProfiler class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "frameprofiler.h"
+#include <cstdio>
+
+FrameProfiler* FrameProfiler::instance; // Instance
+
+FrameProfiler::FrameProfiler() {
+	for (int i = 0; i < FramePhaseCount; i++) {
+		last[i] = 0;
+		average[i] = 0;
+	}
+}
+
+FrameProfiler* FrameProfiler::GetInstance() {
+	if (!instance) {
+		instance = new FrameProfiler();
+	}
+
+	return instance;
+}
+
+void FrameProfiler::Begin(FramePhase phase) {
+	GetInstance()->start[phase] = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::End(FramePhase phase) {
+	FrameProfiler* profiler = GetInstance();
+	float time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - profiler->start[phase]).count();
+
+	profiler->last[phase] = time;
+	profiler->average[phase] += (time - profiler->average[phase]) * FRAMEPROFILER_SMOOTHING;
+}
+
+float FrameProfiler::GetLastTime(FramePhase phase) {
+	return GetInstance()->last[phase];
+}
+
+float FrameProfiler::GetAverageTime(FramePhase phase) {
+	return GetInstance()->average[phase];
+}
+
+const char* FrameProfiler::GetPhaseName(FramePhase phase) {
+	static const char* names[FramePhaseCount] = {
+		"Input",
+		"Streaming",
+		"Script",
+		"Simulation",
+		"Transform",
+		"Visibility",
+		"Audio",
+		"Render",
+		"Present"
+	};
+	return names[phase];
+}
+
+std::string FrameProfiler::GetReport() {
+	std::string report;
+	char line[64];
+	for (int i = 0; i < FramePhaseCount; i++) {
+		snprintf(line, sizeof(line), "%-12s %7.3f ms (last %7.3f ms)\n", GetPhaseName((FramePhase)i), GetAverageTime((FramePhase)i), GetLastTime((FramePhase)i));
+		report.append(line);
+	}
+	return report;
+}
\ No newline at end of file
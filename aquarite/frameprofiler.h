@@ -0,0 +1,81 @@
+/**
+*	Filename: frameprofiler.h
+*
+*	Description: Header file for FrameProfiler class, measures the time spent in each phase of a frame
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+#include <string>
+#include <chrono>
+
+#define FRAMEPROFILER_SMOOTHING 0.05f // Weight of the newest frame in the averaged phase times
+
+/**
+* The phases of a frame, in the order Core runs them. AudioPhase runs concurrently with VisibilityPhase
+*/
+enum FramePhase {
+	InputPhase,
+	StreamingPhase,
+	ScriptPhase,
+	SimulationPhase,
+	TransformPhase,
+	VisibilityPhase,
+	AudioPhase,
+	RenderPhase,
+	PresentPhase,
+	FramePhaseCount
+};
+
+class FrameProfiler {
+private:
+	static FrameProfiler* instance; /// @brief The instance of the profiler
+	std::chrono::steady_clock::time_point start[FramePhaseCount]; /// @brief Start time of the running phases
+	float last[FramePhaseCount]; /// @brief Time of the phases in the last frame, in milliseconds
+	float average[FramePhaseCount]; /// @brief Averaged time of the phases, in milliseconds
+
+	/**
+	* Constructor
+	*/
+	FrameProfiler();
+
+	/**
+	* Returns the instance, if it does not exist it will create a new instance
+	*/
+	static FrameProfiler* GetInstance();
+public:
+	/**
+	* Marks the start of a phase. Different phases may be measured on different threads at the same time
+	*/
+	static void Begin(FramePhase phase);
+
+	/**
+	* Marks the end of a phase
+	*/
+	static void End(FramePhase phase);
+
+	/**
+	* Returns the time of the phase in the last frame, in milliseconds
+	*/
+	static float GetLastTime(FramePhase phase);
+
+	/**
+	* Returns the averaged time of the phase, in milliseconds
+	*/
+	static float GetAverageTime(FramePhase phase);
+
+	/**
+	* Returns the name of the phase
+	*/
+	static const char* GetPhaseName(FramePhase phase);
+
+	/**
+	* Returns a line per phase with its averaged and last time
+	*/
+	static std::string GetReport();
+};
+
+#endif // !FRAMEPROFILER_H
\ No newline at end of file
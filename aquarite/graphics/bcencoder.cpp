@@ -0,0 +1,527 @@
+/**
+*	Filename: bcencoder.cpp
+*
+*	Description: Source file for BCEncoder class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "bcencoder.h"
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "../jobsystem.h"
+
+//SSE2 is always available on x64, and on x86 when the compiler targets it
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define BC_SSE2
+#include <emmintrin.h>
+#endif
+
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 }; // 4 bit index weights, out of 64
+static const float BC1_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f }; // Position of every BC1 index between the endpoints
+
+/**
+* Writes bits into a zeroed block, least significant bit first
+*/
+struct BitWriter {
+	unsigned char* data;
+	int position;
+
+	void Write(uint32_t value, int bits) {
+		for (int b = 0; b < bits; b++, position++) {
+			if ((value >> b) & 1) data[position >> 3] |= (unsigned char)(1 << (position & 7));
+		}
+	}
+};
+
+/**
+* Reads bits from a block, least significant bit first
+*/
+struct BitReader {
+	const unsigned char* data;
+	int position;
+
+	uint32_t Read(int bits) {
+		uint32_t value = 0;
+		for (int b = 0; b < bits; b++, position++) {
+			value |= (uint32_t)((data[position >> 3] >> (position & 7)) & 1) << b;
+		}
+		return value;
+	}
+};
+
+static float Clamp255(float value) {
+	return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+}
+
+/**
+* Splits the 16 RGBA pixels of a block into a float array per channel
+*/
+static void LoadBlock(const unsigned char* rgba, float pixels[4][16]) {
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		for (int c = 0; c < 4; c++) pixels[c][i] = rgba[i * 4 + c];
+	}
+}
+
+/**
+* Writes the index of the closest palette entry for every pixel and returns the summed squared error
+*/
+static float FindIndices(const float pixels[4][16], int channels, const float palette[][4], int count, unsigned char* indices) {
+	float error = 0.0f;
+#ifdef BC_SSE2
+	//Four pixels at a time, every lane keeps its closest entry
+	for (int g = 0; g < BC_BLOCK_PIXELS; g += 4) {
+		__m128 px[4];
+		for (int c = 0; c < channels; c++) px[c] = _mm_loadu_ps(&pixels[c][g]);
+
+		__m128 best = _mm_set1_ps(FLT_MAX);
+		__m128i bestIndex = _mm_setzero_si128();
+		for (int p = 0; p < count; p++) {
+			__m128 distance = _mm_setzero_ps();
+			for (int c = 0; c < channels; c++) {
+				__m128 difference = _mm_sub_ps(px[c], _mm_set1_ps(palette[p][c]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+			}
+
+			__m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+			best = _mm_min_ps(distance, best);
+			bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(p)), _mm_andnot_si128(closer, bestIndex));
+		}
+
+		int32_t lanes[4];
+		float errors[4];
+		_mm_storeu_si128((__m128i*)lanes, bestIndex);
+		_mm_storeu_ps(errors, best);
+		for (int i = 0; i < 4; i++) {
+			indices[g + i] = (unsigned char)lanes[i];
+			error += errors[i];
+		}
+	}
+#else
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		float best = FLT_MAX;
+		for (int p = 0; p < count; p++) {
+			float distance = 0.0f;
+			for (int c = 0; c < channels; c++) {
+				float difference = pixels[c][i] - palette[p][c];
+				distance += difference * difference;
+			}
+			if (distance < best) {
+				best = distance;
+				indices[i] = (unsigned char)p;
+			}
+		}
+		error += best;
+	}
+#endif
+	return error;
+}
+
+/**
+* Fits a line through the pixels along their principal axis, start and end are the outermost projections on it
+*/
+static void FitLine(const float pixels[4][16], int channels, float* start, float* end) {
+	float mean[4] = { 0, 0, 0, 0 };
+	float minimum[4], maximum[4];
+	for (int c = 0; c < channels; c++) {
+		minimum[c] = maximum[c] = pixels[c][0];
+		for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+			mean[c] += pixels[c][i];
+			minimum[c] = std::min(minimum[c], pixels[c][i]);
+			maximum[c] = std::max(maximum[c], pixels[c][i]);
+		}
+		mean[c] /= BC_BLOCK_PIXELS;
+	}
+
+	float covariance[4][4] = {};
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		for (int a = 0; a < channels; a++) {
+			for (int b = a; b < channels; b++) {
+				covariance[a][b] += (pixels[a][i] - mean[a]) * (pixels[b][i] - mean[b]);
+			}
+		}
+	}
+	for (int a = 0; a < channels; a++) {
+		for (int b = 0; b < a; b++) covariance[a][b] = covariance[b][a];
+	}
+
+	//Power iteration, starting from the diagonal of the bounding box
+	float axis[4];
+	for (int c = 0; c < channels; c++) axis[c] = maximum[c] - minimum[c];
+	for (int iteration = 0; iteration < 8; iteration++) {
+		float next[4] = { 0, 0, 0, 0 };
+		float largest = 0.0f;
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < channels; b++) next[a] += covariance[a][b] * axis[b];
+			largest = std::max(largest, std::fabs(next[a]));
+		}
+		if (largest <= 0.0f) break;
+		for (int c = 0; c < channels; c++) axis[c] = next[c] / largest;
+	}
+
+	float length = 0.0f;
+	for (int c = 0; c < channels; c++) length += axis[c] * axis[c];
+	length = std::sqrt(length);
+	if (length <= 0.0f) { // A single color
+		for (int c = 0; c < channels; c++) start[c] = end[c] = mean[c];
+		return;
+	}
+
+	float lowest = FLT_MAX, highest = -FLT_MAX;
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		float t = 0.0f;
+		for (int c = 0; c < channels; c++) t += (pixels[c][i] - mean[c]) * axis[c] / length;
+		lowest = std::min(lowest, t);
+		highest = std::max(highest, t);
+	}
+
+	for (int c = 0; c < channels; c++) {
+		start[c] = Clamp255(mean[c] + axis[c] / length * lowest);
+		end[c] = Clamp255(mean[c] + axis[c] / length * highest);
+	}
+}
+
+/**
+* Least squares fit of the endpoints, every pixel is at weights[i] between start and end. Returns false if the fit is singular
+*/
+static bool FitEndpoints(const float pixels[4][16], int channels, const float* weights, float* start, float* end) {
+	float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+	float ax[4] = { 0, 0, 0, 0 }, bx[4] = { 0, 0, 0, 0 };
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		float t = weights[i];
+		float s = 1.0f - t;
+		aa += s * s;
+		bb += t * t;
+		ab += s * t;
+		for (int c = 0; c < channels; c++) {
+			ax[c] += s * pixels[c][i];
+			bx[c] += t * pixels[c][i];
+		}
+	}
+
+	float determinant = aa * bb - ab * ab;
+	if (std::fabs(determinant) < 1e-6f) return false;
+	for (int c = 0; c < channels; c++) {
+		start[c] = Clamp255((ax[c] * bb - bx[c] * ab) / determinant);
+		end[c] = Clamp255((bx[c] * aa - ax[c] * ab) / determinant);
+	}
+	return true;
+}
+
+static uint16_t To565(const float* color) {
+	int r = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+	int g = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+	int b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void From565(uint16_t value, float* color) {
+	int r = (value >> 11) & 31, g = (value >> 5) & 63, b = value & 31;
+	color[0] = (float)((r << 3) | (r >> 2));
+	color[1] = (float)((g << 2) | (g >> 4));
+	color[2] = (float)((b << 3) | (b >> 2));
+	color[3] = 255.0f;
+}
+
+/**
+* Encodes the color of a block as a 4 color BC1 block
+*/
+static void EncodeColorBlock(const float pixels[4][16], unsigned char* block) {
+	float start[4], end[4];
+	FitLine(pixels, 3, start, end);
+
+	float bestError = FLT_MAX;
+	uint16_t best[2] = { 0, 0 };
+	unsigned char bestIndices[BC_BLOCK_PIXELS] = {};
+
+	for (int pass = 0; pass < 2; pass++) {
+		uint16_t c0 = To565(start), c1 = To565(end);
+		if (c0 < c1) std::swap(c0, c1); // The 4 color mode needs c0 > c1
+
+		float palette[4][4];
+		From565(c0, palette[0]);
+		From565(c1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		}
+
+		unsigned char indices[BC_BLOCK_PIXELS];
+		float error = FindIndices(pixels, 3, palette, c0 == c1 ? 1 : 4, indices);
+		if (error < bestError) {
+			bestError = error;
+			best[0] = c0;
+			best[1] = c1;
+			memcpy(bestIndices, indices, sizeof(indices));
+		}
+		if (c0 == c1) break; // A single color
+
+		//Refit the endpoints on the chosen indices
+		float weights[BC_BLOCK_PIXELS];
+		for (int i = 0; i < BC_BLOCK_PIXELS; i++) weights[i] = BC1_WEIGHTS[indices[i]];
+		if (!FitEndpoints(pixels, 3, weights, start, end)) break;
+	}
+
+	block[0] = (unsigned char)(best[0] & 0xFF);
+	block[1] = (unsigned char)(best[0] >> 8);
+	block[2] = (unsigned char)(best[1] & 0xFF);
+	block[3] = (unsigned char)(best[1] >> 8);
+	uint32_t bits = 0;
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) bits |= (uint32_t)bestIndices[i] << (i * 2);
+	for (int i = 0; i < 4; i++) block[4 + i] = (unsigned char)(bits >> (i * 8));
+}
+
+/**
+* Encodes the alpha of a block as a 8 value BC3 alpha block
+*/
+static void EncodeAlphaBlock(const float pixels[4][16], unsigned char* block) {
+	float alpha[4][16];
+	float minimum = 255.0f, maximum = 0.0f;
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		alpha[0][i] = pixels[3][i];
+		minimum = std::min(minimum, alpha[0][i]);
+		maximum = std::max(maximum, alpha[0][i]);
+	}
+
+	int a0 = (int)(maximum + 0.5f), a1 = (int)(minimum + 0.5f);
+	unsigned char indices[BC_BLOCK_PIXELS] = {};
+	if (a0 != a1) {
+		float palette[8][4];
+		palette[0][0] = (float)a0;
+		palette[1][0] = (float)a1;
+		for (int i = 2; i < 8; i++) palette[i][0] = ((8 - i) * a0 + (i - 1) * a1) / 7.0f;
+		FindIndices(alpha, 1, palette, 8, indices);
+	}
+
+	block[0] = (unsigned char)a0;
+	block[1] = (unsigned char)a1;
+	uint64_t bits = 0;
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) bits |= (uint64_t)indices[i] << (i * 3);
+	for (int i = 0; i < 6; i++) block[2 + i] = (unsigned char)(bits >> (i * 8));
+}
+
+/**
+* Decodes the 4 or 3 color palette of a BC1 color block, fourColor forces the 4 color mode as BC3 does
+*/
+static void DecodeColorBlock(const unsigned char* block, unsigned char* rgba, bool fourColor) {
+	uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+	uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+	float palette[4][4];
+	From565(c0, palette[0]);
+	From565(c1, palette[1]);
+	for (int c = 0; c < 3; c++) {
+		if (fourColor || c0 > c1) {
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		}
+		else {
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+			palette[3][c] = 0.0f;
+		}
+	}
+	palette[2][3] = 255.0f;
+	palette[3][3] = fourColor || c0 > c1 ? 255.0f : 0.0f; // Transparent black
+
+	uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		const float* color = palette[(bits >> (i * 2)) & 3];
+		for (int c = 0; c < 4; c++) rgba[i * 4 + c] = (unsigned char)(color[c] + 0.5f);
+	}
+}
+
+size_t BCEncoder::GetBlockSize(BCFormat format) {
+	return format == BC1Format ? 8 : 16;
+}
+
+size_t BCEncoder::GetEncodedSize(BCFormat format, uint32_t width, uint32_t height) {
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+void BCEncoder::EncodeBC1(const unsigned char* rgba, unsigned char* block) {
+	float pixels[4][16];
+	LoadBlock(rgba, pixels);
+	EncodeColorBlock(pixels, block);
+}
+
+void BCEncoder::EncodeBC3(const unsigned char* rgba, unsigned char* block) {
+	float pixels[4][16];
+	LoadBlock(rgba, pixels);
+	EncodeAlphaBlock(pixels, block);
+	EncodeColorBlock(pixels, block + 8);
+}
+
+void BCEncoder::EncodeBC7(const unsigned char* rgba, unsigned char* block) {
+	float pixels[4][16];
+	LoadBlock(rgba, pixels);
+
+	float start[4], end[4];
+	FitLine(pixels, 4, start, end);
+
+	float bestError = FLT_MAX;
+	int best[2][4] = {};
+	int bestBits[2] = { 0, 0 };
+	unsigned char bestIndices[BC_BLOCK_PIXELS] = {};
+
+	for (int pass = 0; pass < 2; pass++) {
+		//Every endpoint is 7 bits per channel and a shared lowest bit, try all lowest bits
+		for (int bits = 0; bits < 4; bits++) {
+			int p[2] = { bits & 1, bits >> 1 };
+			int endpoints[2][4];
+			for (int c = 0; c < 4; c++) {
+				endpoints[0][c] = std::min(127, std::max(0, (int)((start[c] - p[0]) / 2.0f + 0.5f)));
+				endpoints[1][c] = std::min(127, std::max(0, (int)((end[c] - p[1]) / 2.0f + 0.5f)));
+			}
+
+			float palette[16][4];
+			for (int w = 0; w < 16; w++) {
+				for (int c = 0; c < 4; c++) {
+					int e0 = (endpoints[0][c] << 1) | p[0];
+					int e1 = (endpoints[1][c] << 1) | p[1];
+					palette[w][c] = (float)(((64 - BC7_WEIGHTS[w]) * e0 + BC7_WEIGHTS[w] * e1 + 32) >> 6);
+				}
+			}
+
+			unsigned char indices[BC_BLOCK_PIXELS];
+			float error = FindIndices(pixels, 4, palette, 16, indices);
+			if (error < bestError) {
+				bestError = error;
+				memcpy(best, endpoints, sizeof(endpoints));
+				bestBits[0] = p[0];
+				bestBits[1] = p[1];
+				memcpy(bestIndices, indices, sizeof(indices));
+			}
+		}
+
+		float weights[BC_BLOCK_PIXELS];
+		for (int i = 0; i < BC_BLOCK_PIXELS; i++) weights[i] = BC7_WEIGHTS[bestIndices[i]] / 64.0f;
+		if (!FitEndpoints(pixels, 4, weights, start, end)) break;
+	}
+
+	//The highest bit of the first index is implied 0, swap the endpoints if it is set
+	if (bestIndices[0] >= 8) {
+		for (int c = 0; c < 4; c++) std::swap(best[0][c], best[1][c]);
+		std::swap(bestBits[0], bestBits[1]);
+		for (int i = 0; i < BC_BLOCK_PIXELS; i++) bestIndices[i] = (unsigned char)(15 - bestIndices[i]);
+	}
+
+	memset(block, 0, 16);
+	BitWriter writer = { block, 0 };
+	writer.Write(1 << 6, 7); // Mode 6
+	for (int c = 0; c < 4; c++) {
+		writer.Write(best[0][c], 7);
+		writer.Write(best[1][c], 7);
+	}
+	writer.Write(bestBits[0], 1);
+	writer.Write(bestBits[1], 1);
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) writer.Write(bestIndices[i], i == 0 ? 3 : 4);
+}
+
+void BCEncoder::DecodeBC1(const unsigned char* block, unsigned char* rgba) {
+	DecodeColorBlock(block, rgba, false);
+}
+
+void BCEncoder::DecodeBC3(const unsigned char* block, unsigned char* rgba) {
+	DecodeColorBlock(block + 8, rgba, true);
+
+	int a0 = block[0], a1 = block[1];
+	int palette[8] = { a0, a1 };
+	for (int i = 2; i < 8; i++) {
+		if (a0 > a1) palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+		else palette[i] = i < 6 ? ((6 - i) * a0 + (i - 1) * a1 + 2) / 5 : (i == 6 ? 0 : 255);
+	}
+
+	uint64_t bits = 0;
+	for (int i = 0; i < 6; i++) bits |= (uint64_t)block[2 + i] << (i * 8);
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) rgba[i * 4 + 3] = (unsigned char)palette[(bits >> (i * 3)) & 7];
+}
+
+bool BCEncoder::DecodeBC7(const unsigned char* block, unsigned char* rgba) {
+	if ((block[0] & 0x7F) != (1 << 6)) {
+		for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+			rgba[i * 4] = 255;
+			rgba[i * 4 + 1] = 0;
+			rgba[i * 4 + 2] = 255;
+			rgba[i * 4 + 3] = 255;
+		}
+		return false;
+	}
+
+	BitReader reader = { block, 7 };
+	int endpoints[2][4];
+	for (int c = 0; c < 4; c++) {
+		endpoints[0][c] = (int)reader.Read(7) << 1;
+		endpoints[1][c] = (int)reader.Read(7) << 1;
+	}
+	int p0 = (int)reader.Read(1), p1 = (int)reader.Read(1);
+	for (int c = 0; c < 4; c++) {
+		endpoints[0][c] |= p0;
+		endpoints[1][c] |= p1;
+	}
+
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		int weight = BC7_WEIGHTS[reader.Read(i == 0 ? 3 : 4)];
+		for (int c = 0; c < 4; c++) {
+			rgba[i * 4 + c] = (unsigned char)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+		}
+	}
+	return true;
+}
+
+void BCEncoder::Encode(BCFormat format, const unsigned char* pixels, uint32_t width, uint32_t height, unsigned bytesPerPixel, unsigned char* blocks) {
+	uint32_t blocksX = (width + 3) / 4;
+	uint32_t blocksY = (height + 3) / 4;
+	size_t blockSize = GetBlockSize(format);
+
+	JobSystem::ParallelFor(blocksY, 1, [&](size_t first, size_t last) {
+		unsigned char rgba[BC_BLOCK_PIXELS * 4];
+		for (size_t by = first; by < last; by++) {
+			for (uint32_t bx = 0; bx < blocksX; bx++) {
+				for (int y = 0; y < 4; y++) {
+					for (int x = 0; x < 4; x++) {
+						uint32_t sx = std::min(bx * 4 + x, width - 1);
+						uint32_t sy = std::min((uint32_t)by * 4 + y, height - 1);
+						const unsigned char* source = pixels + ((size_t)sy * width + sx) * bytesPerPixel;
+						unsigned char* target = rgba + (y * 4 + x) * 4;
+						target[0] = source[0];
+						target[1] = source[1];
+						target[2] = source[2];
+						target[3] = bytesPerPixel == 4 ? source[3] : 255;
+					}
+				}
+
+				unsigned char* block = blocks + ((size_t)by * blocksX + bx) * blockSize;
+				if (format == BC1Format) EncodeBC1(rgba, block);
+				else if (format == BC3Format) EncodeBC3(rgba, block);
+				else EncodeBC7(rgba, block);
+			}
+		}
+	});
+}
+
+bool BCEncoder::Decode(BCFormat format, const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* rgba) {
+	uint32_t blocksX = (width + 3) / 4;
+	uint32_t blocksY = (height + 3) / 4;
+	size_t blockSize = GetBlockSize(format);
+	bool decoded = true;
+
+	unsigned char pixels[BC_BLOCK_PIXELS * 4];
+	for (uint32_t by = 0; by < blocksY; by++) {
+		for (uint32_t bx = 0; bx < blocksX; bx++) {
+			const unsigned char* block = blocks + ((size_t)by * blocksX + bx) * blockSize;
+			if (format == BC1Format) DecodeBC1(block, pixels);
+			else if (format == BC3Format) DecodeBC3(block, pixels);
+			else if (!DecodeBC7(block, pixels)) decoded = false;
+
+			//Only the pixels inside the image
+			for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++) {
+				for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++) {
+					memcpy(rgba + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4, pixels + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+	}
+	return decoded;
+}
@@ -0,0 +1,84 @@
+/**
+*	Filename: bcencoder.h
+*
+*	Description: Header file for BCEncoder class, encodes and decodes BC1, BC3 and BC7 texture blocks
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef BCENCODER_H
+#define BCENCODER_H
+#include <cstddef>
+#include <cstdint>
+
+#define BC_BLOCK_PIXELS 16 // Pixels in a 4x4 block
+
+/**
+* The block compressed formats, BC1 is opaque RGB in 8 bytes, BC3 and BC7 are RGBA in 16 bytes
+*/
+enum BCFormat {
+	BC1Format,
+	BC3Format,
+	BC7Format
+};
+
+/**
+* Encoders fit the endpoints on the principal axis of the block, refine them with a least squares fit on the chosen indices,
+* and search the palette with SSE2 when available. BC7 blocks are always written in mode 6, a single RGBA subset with 4 bit indices.
+* Blocks are read and written as 16 RGBA pixels, rows of 4
+*/
+class BCEncoder {
+public:
+	/**
+	* Returns the size of a block in bytes
+	*/
+	static size_t GetBlockSize(BCFormat format);
+
+	/**
+	* Returns the size of a encoded image in bytes, partial blocks at the edges are counted as full blocks
+	*/
+	static size_t GetEncodedSize(BCFormat format, uint32_t width, uint32_t height);
+
+	/**
+	* Encodes a block to BC1, alpha is ignored
+	*/
+	static void EncodeBC1(const unsigned char* rgba, unsigned char* block);
+
+	/**
+	* Encodes a block to BC3, a BC1 color block after a interpolated alpha block
+	*/
+	static void EncodeBC3(const unsigned char* rgba, unsigned char* block);
+
+	/**
+	* Encodes a block to BC7 mode 6
+	*/
+	static void EncodeBC7(const unsigned char* rgba, unsigned char* block);
+
+	/**
+	* Decodes a BC1 block, blocks in the 3 color mode decode index 3 as transparent black
+	*/
+	static void DecodeBC1(const unsigned char* block, unsigned char* rgba);
+
+	/**
+	* Decodes a BC3 block
+	*/
+	static void DecodeBC3(const unsigned char* block, unsigned char* rgba);
+
+	/**
+	* Decodes a BC7 block, returns false for modes other than 6, those decode to magenta
+	*/
+	static bool DecodeBC7(const unsigned char* block, unsigned char* rgba);
+
+	/**
+	* Encodes a RGB or RGBA image, the rows of blocks are encoded on the job system. Pixels outside the image repeat the edge
+	*/
+	static void Encode(BCFormat format, const unsigned char* pixels, uint32_t width, uint32_t height, unsigned bytesPerPixel, unsigned char* blocks);
+
+	/**
+	* Decodes a image to RGBA, returns false if a block could not be decoded
+	*/
+	static bool Decode(BCFormat format, const unsigned char* blocks, uint32_t width, uint32_t height, unsigned char* rgba);
+};
+
+#endif // !BCENCODER_H
@@ -8,6 +8,7 @@
 *	 2018, Jens Heukers
 */
 #include <GL/glew.h>
+#include <cstring>
 #include "cubemap.h"
 #include "../debug.h"
 #include "../resourcemanager.h"
@@ -26,6 +27,7 @@ void CubeMap::ConstructCubeMapTexture(std::vector<Texture*> textureFaces) {
 	// So we can take the data of texturefaces[0].
 	int width = textureFaces[0]->textureData->width;
 	int height = textureFaces[0]->textureData->height;
+	std::vector<GLubyte> rows; // A face flipped to top to bottom
 	for (size_t i = 0; i < textureFaces.size(); i++) {
 		//If size does not match return
 		if (textureFaces[i]->textureData->width != width || textureFaces[i]->textureData->height != height) {
@@ -33,11 +35,24 @@ void CubeMap::ConstructCubeMapTexture(std::vector<Texture*> textureFaces) {
 			return;
 		}
 
-		//Get the data from the texture, and insert
-		GLubyte* data = textureFaces[i]->textureData->imageData;
+		//Get the data from the texture, and insert. The pixels were freed after the face was uploaded, read them again
+		if (!textureFaces[i]->RequirePixels()) {
+			Debug::Log("Error: texture face has no pixels", typeid(*this).name());
+			return;
+		}
+		//Textures store their rows bottom to top, cube map faces are read top to bottom
+		const TextureData* face = textureFaces[i]->textureData;
+		size_t stride = (size_t)width * face->bytesPerPixel;
+		rows.resize(stride * height);
+		for (int y = 0; y < height; y++) {
+			memcpy(&rows[(size_t)y * stride], face->imageData + (size_t)(height - 1 - y) * stride, stride);
+		}
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Rows of 3 byte pixels are tightly packed
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-			0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data
+			0, GL_RGB, width, height, 0, face->pixelFormat, GL_UNSIGNED_BYTE, rows.data()
 		);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
 		if (this->textures.size() >= 6) {
 			this->textures.erase(this->textures.begin(), this->textures.begin() + i);
@@ -137,7 +152,7 @@ void SkyBox::GenerateBuffers() {
 }
 
 SkyBox::SkyBox() {
-	this->shader = ResourceManager::GetShader("_aquariteDefaultSkyBoxShader");
+	this->shader = ResourceManager::GetShader(ResourceManager::GetShaderHandle(RESOURCE_ID("_aquariteDefaultSkyBoxShader")));
 	GenerateBuffers();
 }
 
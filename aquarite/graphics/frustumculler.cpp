@@ -0,0 +1,310 @@
+/**
+*	Filename: frustumculler.cpp
+*
+*	Description: Source file for FrustumCuller class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <glm/gtc/matrix_transform.hpp>
+#include "frustumculler.h"
+#include "../jobsystem.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CULL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CULL_TARGET_SSE
+#define CULL_TARGET_AVX2
+#else
+#define CULL_TARGET_SSE __attribute__((target("sse2")))
+#define CULL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+//Clears the mask words of [first, last), first is a multiple of 32 so the words are not shared with other ranges
+static void ClearMask(size_t first, size_t last, uint32_t* mask) {
+	if (first >= last) return;
+	std::fill(mask + (first >> 5), mask + ((last + 31) >> 5), 0u);
+}
+
+static void CullScalar(const glm::vec4* planes, const SphereArrays& spheres, size_t first, size_t last, uint32_t* mask) {
+	const float* x = spheres.x.data();
+	const float* y = spheres.y.data();
+	const float* z = spheres.z.data();
+	const float* radius = spheres.radius.data();
+
+	for (size_t i = first; i < last; i++) {
+		bool visible = true;
+		for (int p = 0; p < FRUSTUM_PLANE_COUNT && visible; p++) {
+			visible = planes[p].x * x[i] + planes[p].y * y[i] + planes[p].z * z[i] + planes[p].w >= -radius[i];
+		}
+
+		if (visible) mask[i >> 5] |= 1u << (i & 31);
+	}
+}
+
+#ifdef CULL_X86
+CULL_TARGET_SSE
+static void CullSSE(const glm::vec4* planes, const SphereArrays& spheres, size_t first, size_t last, uint32_t* mask) {
+	const float* x = spheres.x.data();
+	const float* y = spheres.y.data();
+	const float* z = spheres.z.data();
+	const float* radius = spheres.radius.data();
+
+	__m128 px[FRUSTUM_PLANE_COUNT], py[FRUSTUM_PLANE_COUNT], pz[FRUSTUM_PLANE_COUNT], pw[FRUSTUM_PLANE_COUNT];
+	for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		px[p] = _mm_set1_ps(planes[p].x);
+		py[p] = _mm_set1_ps(planes[p].y);
+		pz[p] = _mm_set1_ps(planes[p].z);
+		pw[p] = _mm_set1_ps(planes[p].w);
+	}
+
+	size_t i = first;
+	for (; i + 4 <= last; i += 4) {
+		__m128 cx = _mm_loadu_ps(x + i);
+		__m128 cy = _mm_loadu_ps(y + i);
+		__m128 cz = _mm_loadu_ps(z + i);
+		__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+		__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)), _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+			visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negRadius));
+		}
+
+		mask[i >> 5] |= (uint32_t)_mm_movemask_ps(visible) << (i & 31);
+	}
+
+	CullScalar(planes, spheres, i, last, mask); // Remaining spheres
+}
+
+CULL_TARGET_AVX2
+static void CullAVX2(const glm::vec4* planes, const SphereArrays& spheres, size_t first, size_t last, uint32_t* mask) {
+	const float* x = spheres.x.data();
+	const float* y = spheres.y.data();
+	const float* z = spheres.z.data();
+	const float* radius = spheres.radius.data();
+
+	__m256 px[FRUSTUM_PLANE_COUNT], py[FRUSTUM_PLANE_COUNT], pz[FRUSTUM_PLANE_COUNT], pw[FRUSTUM_PLANE_COUNT];
+	for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		px[p] = _mm256_set1_ps(planes[p].x);
+		py[p] = _mm256_set1_ps(planes[p].y);
+		pz[p] = _mm256_set1_ps(planes[p].z);
+		pw[p] = _mm256_set1_ps(planes[p].w);
+	}
+
+	size_t i = first;
+	for (; i + 8 <= last; i += 8) {
+		__m256 cx = _mm256_loadu_ps(x + i);
+		__m256 cy = _mm256_loadu_ps(y + i);
+		__m256 cz = _mm256_loadu_ps(z + i);
+		__m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+
+		__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+			__m256 distance = _mm256_fmadd_ps(px[p], cx, _mm256_fmadd_ps(py[p], cy, _mm256_fmadd_ps(pz[p], cz, pw[p])));
+			visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+		}
+
+		mask[i >> 5] |= (uint32_t)_mm256_movemask_ps(visible) << (i & 31);
+	}
+
+	CullScalar(planes, spheres, i, last, mask); // Remaining spheres
+}
+
+//Returns true if the cpu supports sse2 (sse) or avx2 and fma with the os saving the ymm registers (avx2)
+static bool CpuSupports(bool avx2) {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	if (!avx2) return (info[3] & (1 << 26)) != 0;
+
+	bool fma = (info[2] & (1 << 12)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!fma || !osxsave || !avx || maxLeaf < 7) return false;
+	if ((_xgetbv(0) & 6) != 6) return false; // The os does not save the xmm and ymm registers
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	if (!avx2) return __builtin_cpu_supports("sse2") != 0;
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+#endif
+
+//Returns the best kernel supported by the cpu
+static CullKernel DetectKernel() {
+#ifdef CULL_X86
+	if (CpuSupports(true)) return AVX2CullKernel;
+	if (CpuSupports(false)) return SSECullKernel;
+#endif
+	return ScalarCullKernel;
+}
+
+CullKernel FrustumCuller::_kernel = DetectKernel(); // Declare static member, chosen once at startup
+
+void FrustumCuller::ExtractPlanes(const glm::mat4& viewProjection, glm::vec4* planes) {
+	//Rows of the matrix, glm stores columns
+	glm::vec4 rows[4];
+	for (int r = 0; r < 4; r++) {
+		rows[r] = glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]);
+	}
+
+	planes[0] = rows[3] + rows[0]; // Left
+	planes[1] = rows[3] - rows[0]; // Right
+	planes[2] = rows[3] + rows[1]; // Bottom
+	planes[3] = rows[3] - rows[1]; // Top
+	planes[4] = rows[3] + rows[2]; // Near
+	planes[5] = rows[3] - rows[2]; // Far
+
+	//Normalize, so the distance to a plane can be compared with a radius
+	for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		planes[p] /= glm::length(glm::vec3(planes[p]));
+	}
+}
+
+bool FrustumCuller::SphereInFrustum(const glm::vec4* planes, const glm::vec3& centre, float radius) {
+	for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		if (glm::dot(glm::vec3(planes[p]), centre) + planes[p].w < -radius) return false;
+	}
+	return true;
+}
+
+bool FrustumCuller::BoxInFrustum(const glm::vec4* planes, const glm::vec3& min, const glm::vec3& max) {
+	for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		//The corner furthest along the normal, if it is behind the plane the whole box is
+		glm::vec3 corner(planes[p].x >= 0 ? max.x : min.x, planes[p].y >= 0 ? max.y : min.y, planes[p].z >= 0 ? max.z : min.z);
+		if (glm::dot(glm::vec3(planes[p]), corner) + planes[p].w < 0) return false;
+	}
+	return true;
+}
+
+void FrustumCuller::Cull(const glm::vec4* planes, const SphereArrays& spheres, size_t first, size_t last, uint32_t* mask) {
+	Cull(_kernel, planes, spheres, first, last, mask);
+}
+
+void FrustumCuller::Cull(CullKernel kernel, const glm::vec4* planes, const SphereArrays& spheres, size_t first, size_t last, uint32_t* mask) {
+	ClearMask(first, last, mask);
+
+	switch (kernel) {
+#ifdef CULL_X86
+	case AVX2CullKernel:
+		CullAVX2(planes, spheres, first, last, mask);
+		break;
+	case SSECullKernel:
+		CullSSE(planes, spheres, first, last, mask);
+		break;
+#endif
+	default:
+		CullScalar(planes, spheres, first, last, mask);
+		break;
+	}
+}
+
+void FrustumCuller::CullParallel(const glm::vec4* planes, const SphereArrays& spheres, std::vector<uint32_t>& mask) {
+	size_t count = spheres.Size();
+	mask.resize((count + 31) >> 5);
+
+	uint32_t* words = mask.data();
+	JobSystem::ParallelFor(count, CULL_BATCH_SIZE, [planes, &spheres, words](size_t first, size_t last) {
+		Cull(planes, spheres, first, last, words);
+	});
+}
+
+bool FrustumCuller::IsSupported(CullKernel kernel) {
+	switch (kernel) {
+	case ScalarCullKernel:
+		return true;
+#ifdef CULL_X86
+	case SSECullKernel:
+		return CpuSupports(false);
+	case AVX2CullKernel:
+		return CpuSupports(true);
+#endif
+	default:
+		return false;
+	}
+}
+
+bool FrustumCuller::SetKernel(CullKernel kernel) {
+	if (!IsSupported(kernel)) return false;
+	_kernel = kernel;
+	return true;
+}
+
+CullKernel FrustumCuller::GetKernel() {
+	return _kernel;
+}
+
+const char* FrustumCuller::GetKernelName(CullKernel kernel) {
+	switch (kernel) {
+	case ScalarCullKernel: return "Scalar";
+	case SSECullKernel: return "SSE";
+	case AVX2CullKernel: return "AVX2";
+	default: return "Unknown";
+	}
+}
+
+std::string FrustumCuller::Benchmark(size_t count) {
+	//Random spheres in a 2000 unit cube around a camera at the origin looking down -z
+	std::mt19937 random(1337);
+	std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> size(0.5f, 10.0f);
+
+	SphereArrays spheres;
+	for (size_t i = 0; i < count; i++) {
+		spheres.Push(glm::vec3(position(random), position(random), position(random)), size(random));
+	}
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+	ExtractPlanes(projection, planes);
+
+	std::vector<uint32_t> mask((count + 31) >> 5);
+	std::stringstream report;
+	report << "Culling " << count << " spheres" << std::endl;
+
+	CullKernel active = _kernel;
+	for (int k = 0; k < CullKernelCount; k++) {
+		CullKernel kernel = (CullKernel)k;
+		if (!IsSupported(kernel)) continue;
+
+		//Best of a few runs, the first run also warms up the caches
+		double single = 1e9, parallel = 1e9;
+		for (int run = 0; run < 5; run++) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			Cull(kernel, planes, spheres, 0, count, mask.data());
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			single = std::min(single, std::chrono::duration<double, std::milli>(end - start).count());
+
+			_kernel = kernel;
+			start = std::chrono::steady_clock::now();
+			CullParallel(planes, spheres, mask);
+			end = std::chrono::steady_clock::now();
+			parallel = std::min(parallel, std::chrono::duration<double, std::milli>(end - start).count());
+			_kernel = active;
+		}
+
+		size_t visible = 0;
+		for (size_t i = 0; i < count; i++) {
+			visible += IsVisible(mask.data(), i);
+		}
+
+		report << GetKernelName(kernel) << ": " << single << " ms, " << parallel << " ms on " << (JobSystem::GetWorkerCount() + 1) << " threads, " << visible << " visible" << std::endl;
+	}
+
+	return report.str();
+}
@@ -0,0 +1,134 @@
+/**
+*	Filename: frustumculler.h
+*
+*	Description: Header file for FrustumCuller class, tests arrays of bounding spheres against the view frustum 4 or 8 at a time
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef FRUSTUMCULLER_H
+#define FRUSTUMCULLER_H
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#define FRUSTUM_PLANE_COUNT 6
+#define CULL_BATCH_SIZE 4096 // Spheres per job when culling in parallel, must be a multiple of 32
+#define CULL_BENCHMARK_COUNT 1000000 // Amount of spheres culled by the benchmark
+
+/**
+* The kernels the culler can use, the best one supported by the cpu is chosen at runtime
+*/
+enum CullKernel {
+	ScalarCullKernel,
+	SSECullKernel,
+	AVX2CullKernel,
+	CullKernelCount
+};
+
+/**
+* Bounding spheres stored as separate arrays, so a kernel can load the same component of several spheres at once
+*/
+struct SphereArrays {
+	std::vector<float> x, y, z; /// @brief World space centres
+	std::vector<float> radius; /// @brief Radii
+
+	/**
+	* Adds a sphere
+	*/
+	void Push(const glm::vec3& centre, float r) {
+		x.push_back(centre.x);
+		y.push_back(centre.y);
+		z.push_back(centre.z);
+		radius.push_back(r);
+	}
+
+	/**
+	* Removes all spheres, the memory is kept
+	*/
+	void Clear() {
+		x.clear();
+		y.clear();
+		z.clear();
+		radius.clear();
+	}
+
+	/**
+	* Returns the amount of spheres
+	*/
+	size_t Size() const { return x.size(); }
+};
+
+/**
+* A sphere is visible when it is not fully behind any plane. The result is a bitmask with a bit per sphere,
+* sphere i is stored in bit (i % 32) of word (i / 32). Kernels do not touch shared state, ranges that start at a
+* multiple of 32 write to separate words and can be culled from different jobs.
+*/
+class FrustumCuller {
+private:
+	static CullKernel _kernel; /// @brief The kernel used by Cull
+public:
+	/**
+	* Extracts the frustum planes from a view projection matrix, xyz is the normalized normal pointing inwards and w the distance
+	*/
+	static void ExtractPlanes(const glm::mat4& viewProjection, glm::vec4* planes);
+
+	/**
+	* Returns true if a single sphere is not fully behind any plane
+	*/
+	static bool SphereInFrustum(const glm::vec4* planes, const glm::vec3& centre, float radius);
+
+	/**
+	* Returns true if a axis aligned box is not fully behind any plane
+	*/
+	static bool BoxInFrustum(const glm::vec4* planes, const glm::vec3& min, const glm::vec3& max);
+
+	/**
+	* Culls the spheres in [first, last) and writes their bits in mask, first must be a multiple of 32
+	*/
+	static void Cull(const glm::vec4* planes, const SphereArrays& spheres, size_t first, size_t last, uint32_t* mask);
+
+	/**
+	* Culls the spheres in [first, last) with the given kernel, the kernel must be supported
+	*/
+	static void Cull(CullKernel kernel, const glm::vec4* planes, const SphereArrays& spheres, size_t first, size_t last, uint32_t* mask);
+
+	/**
+	* Culls all spheres spread over the job system, mask is resized to hold a bit per sphere
+	*/
+	static void CullParallel(const glm::vec4* planes, const SphereArrays& spheres, std::vector<uint32_t>& mask);
+
+	/**
+	* Returns true if the bit of the sphere is set
+	*/
+	static bool IsVisible(const uint32_t* mask, size_t index) { return (mask[index >> 5] >> (index & 31)) & 1; }
+
+	/**
+	* Returns true if the cpu and the compiler support the kernel
+	*/
+	static bool IsSupported(CullKernel kernel);
+
+	/**
+	* Sets the kernel used by Cull, returns false if it is not supported
+	*/
+	static bool SetKernel(CullKernel kernel);
+
+	/**
+	* Returns the kernel used by Cull
+	*/
+	static CullKernel GetKernel();
+
+	/**
+	* Returns the name of the kernel
+	*/
+	static const char* GetKernelName(CullKernel kernel);
+
+	/**
+	* Culls count random spheres with every supported kernel, single and multithreaded, and returns the timings
+	*/
+	static std::string Benchmark(size_t count = CULL_BENCHMARK_COUNT);
+};
+
+#endif // !FRUSTUMCULLER_H
@@ -17,6 +17,7 @@ Light::Light(LightType type) {
 	this->SetAmbient(glm::vec3(0.2f));
 	this->SetDiffuse(glm::vec3(0.5f));
 	this->SetSpecular(glm::vec3(1.0f));
+	this->SetRadius(0.0f);
 }
 
 void Light::SetLightType(LightType type) {
@@ -51,6 +52,19 @@ glm::vec3 Light::GetSpecular() {
 	return this->specular;
 }
 
+void Light::SetRadius(float radius) {
+	this->radius = radius;
+}
+
+float Light::GetRadius() {
+	if (this->radius > 0.0f) return this->radius;
+
+	//Lights used to be unattenuated, without a radius they reach as far as a inverse square falloff of their intensity would
+	glm::vec3 brightest = glm::max(ambient, glm::max(diffuse, specular));
+	float intensity = glm::max(brightest.x, glm::max(brightest.y, brightest.z));
+	return glm::sqrt(intensity / LIGHT_CUTOFF);
+}
+
 //Directional Light
 
 DirectionalLight::DirectionalLight() {
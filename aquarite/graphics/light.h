@@ -12,6 +12,8 @@
 #include "../entity.h"
 #include <glm/glm.hpp>
 
+#define LIGHT_CUTOFF (1.0f / 256.0f) // Intensity below which a point light without a radius no longer contributes
+
 /**
 * Enum containing available Light Types
 */
@@ -28,6 +30,7 @@ private:
 	glm::vec3 ambient; /// @brief The Ambient Component of the light
 	glm::vec3 diffuse; /// @brief The Diffuse Component of the light
 	glm::vec3 specular; /// @brief The Specular Component of the light
+	float radius; /// @brief The range of the light, point lights do not affect anything outside of it. 0 derives it from the intensity
 public:
 	/**
 	* Constructor, Type is default set to None, so light type has to be set manually
@@ -75,6 +78,16 @@ public:
 	* Get Specular
 	*/
 	glm::vec3 GetSpecular();
+
+	/**
+	* Set Radius, 0 derives the radius from the intensity of the light
+	*/
+	void SetRadius(float radius);
+
+	/**
+	* Get Radius, if no radius is set it is the distance where the brightest component falls off to LIGHT_CUTOFF
+	*/
+	float GetRadius();
 };
 
 //Light Types
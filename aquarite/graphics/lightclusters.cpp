@@ -0,0 +1,354 @@
+/**
+*	Filename: lightclusters.cpp
+*
+*	Description: Source file for LightClusters class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "lightclusters.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CLUSTER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CLUSTER_TARGET_SSE
+#else
+#define CLUSTER_TARGET_SSE __attribute__((target("sse2")))
+#endif
+#endif
+
+#ifdef CLUSTER_X86
+//Returns true if the cpu supports sse2
+static bool CpuSupports() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+#endif
+
+//Returns the best kernel supported by the cpu
+static ClusterKernel DetectKernel() {
+#ifdef CLUSTER_X86
+	if (CpuSupports()) return SSEClusterKernel;
+#endif
+	return ScalarClusterKernel;
+}
+
+ClusterKernel LightClusters::_kernel = DetectKernel(); // Declare static member, chosen once at startup
+
+LightClusters::LightClusters() {
+	this->nearPlane = 0.1f;
+	this->farPlane = 100.0f;
+	this->sliceScale = 0;
+	this->sliceBias = 0;
+	this->view = glm::mat4(1.0f);
+	this->lights = nullptr;
+	this->lightCount = 0;
+
+	sliceIndices.resize(CLUSTER_GRID_Z);
+	grid.resize(CLUSTER_COUNT);
+}
+
+void LightClusters::SetView(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane) {
+	this->view = view;
+	this->nearPlane = nearPlane;
+	this->farPlane = farPlane;
+
+	//Depth slices are exponential, so clusters stay roughly cubic: slice = log(depth) * scale + bias
+	float logRange = std::log(farPlane / nearPlane);
+	sliceScale = (float)CLUSTER_GRID_Z / logRange;
+	sliceBias = -(float)CLUSTER_GRID_Z * std::log(nearPlane) / logRange;
+
+	//Tile boundaries are planes through the camera, stored as the slope of the plane over the view depth
+	float tanHalfX = 1.0f / projection[0][0];
+	float tanHalfY = 1.0f / projection[1][1];
+	for (int i = 0; i <= CLUSTER_GRID_X; i++) {
+		tileX[i] = (-1.0f + 2.0f * i / CLUSTER_GRID_X) * tanHalfX;
+		tileXInvLength[i] = 1.0f / std::sqrt(1.0f + tileX[i] * tileX[i]);
+	}
+	for (int i = 0; i <= CLUSTER_GRID_Y; i++) {
+		tileY[i] = (-1.0f + 2.0f * i / CLUSTER_GRID_Y) * tanHalfY;
+		tileYInvLength[i] = 1.0f / std::sqrt(1.0f + tileY[i] * tileY[i]);
+	}
+}
+
+void LightClusters::SetLights(const glm::vec4* lights, size_t count) {
+	this->lights = lights;
+	this->lightCount = count;
+	ranges.resize(count);
+}
+
+void LightClusters::GetTileRange(const float* slopes, const float* invLengths, int tileCount, float position, float depth, float radius, int& first, int& last) {
+	first = tileCount;
+	last = -1;
+
+	//Signed distance to a boundary, positive when the sphere center is on the positive side of it
+	float previous = (position - slopes[0] * depth) * invLengths[0];
+	for (int i = 0; i < tileCount; i++) {
+		float next = (position - slopes[i + 1] * depth) * invLengths[i + 1];
+
+		//The tile is touched if the sphere is not completely outside one of its two boundaries
+		if (previous >= -radius && next <= radius) {
+			if (i < first) first = i;
+			last = i;
+		}
+		previous = next;
+	}
+}
+
+void LightClusters::SetRange(ClusterRange& range, float depth, float radius, int minX, int maxX, int minY, int maxY) {
+	range.minX = range.minY = range.minZ = 1;
+	range.maxX = range.maxY = range.maxZ = 0;
+
+	if (radius <= 0 || depth + radius < nearPlane || depth - radius > farPlane) return;
+	if (maxX < minX || maxY < minY) return;
+
+	range.minX = minX;
+	range.maxX = maxX;
+	range.minY = minY;
+	range.maxY = maxY;
+	range.minZ = GetSlice(std::max(depth - radius, nearPlane));
+	range.maxZ = GetSlice(std::min(depth + radius, farPlane));
+}
+
+void LightClusters::PrepareLightsScalar(size_t first, size_t last) {
+	for (size_t i = first; i < last; i++) {
+		//Written out in the same order as the vector kernel, so both round the same way
+		float x = view[0][0] * lights[i].x + view[1][0] * lights[i].y + view[2][0] * lights[i].z + view[3][0];
+		float y = view[0][1] * lights[i].x + view[1][1] * lights[i].y + view[2][1] * lights[i].z + view[3][1];
+		float z = view[0][2] * lights[i].x + view[1][2] * lights[i].y + view[2][2] * lights[i].z + view[3][2];
+		float depth = -z;
+		float radius = lights[i].w;
+
+		int minX, maxX, minY, maxY;
+		GetTileRange(tileX, tileXInvLength, CLUSTER_GRID_X, x, depth, radius, minX, maxX);
+		GetTileRange(tileY, tileYInvLength, CLUSTER_GRID_Y, y, depth, radius, minY, maxY);
+		SetRange(ranges[i], depth, radius, minX, maxX, minY, maxY);
+	}
+}
+
+#ifdef CLUSTER_X86
+/**
+* Tests the spheres of 4 lights against all tile boundaries of one axis, the same test as GetTileRange.
+* Tiles are visited in order, so the first touched tile is kept in first and the last one overwrites last.
+*/
+CLUSTER_TARGET_SSE
+static void GetTileRanges(const float* slopes, const float* invLengths, int tileCount, __m128 position, __m128 depth, __m128 radius, __m128i& first, __m128i& last) {
+	__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+	__m128i none = _mm_set1_epi32(tileCount);
+	first = none;
+	last = _mm_set1_epi32(-1);
+
+	__m128 previous = _mm_mul_ps(_mm_sub_ps(position, _mm_mul_ps(_mm_set1_ps(slopes[0]), depth)), _mm_set1_ps(invLengths[0]));
+	for (int i = 0; i < tileCount; i++) {
+		__m128 next = _mm_mul_ps(_mm_sub_ps(position, _mm_mul_ps(_mm_set1_ps(slopes[i + 1]), depth)), _mm_set1_ps(invLengths[i + 1]));
+		__m128i touched = _mm_castps_si128(_mm_and_ps(_mm_cmpge_ps(previous, negRadius), _mm_cmple_ps(next, radius)));
+		__m128i tile = _mm_set1_epi32(i);
+
+		__m128i firstTouch = _mm_and_si128(touched, _mm_cmpeq_epi32(first, none));
+		first = _mm_or_si128(_mm_andnot_si128(firstTouch, first), _mm_and_si128(firstTouch, tile));
+		last = _mm_or_si128(_mm_andnot_si128(touched, last), _mm_and_si128(touched, tile));
+		previous = next;
+	}
+}
+
+CLUSTER_TARGET_SSE
+void LightClusters::PrepareLightsSSE(size_t first, size_t last) {
+	__m128 m[4][3];
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 3; r++) {
+			m[c][r] = _mm_set1_ps(view[c][r]);
+		}
+	}
+
+	size_t i = first;
+	for (; i + 4 <= last; i += 4) {
+		//Lights are stored as xyz and radius, transpose 4 of them into a register per component
+		__m128 x = _mm_loadu_ps(&lights[i].x);
+		__m128 y = _mm_loadu_ps(&lights[i + 1].x);
+		__m128 z = _mm_loadu_ps(&lights[i + 2].x);
+		__m128 radius = _mm_loadu_ps(&lights[i + 3].x);
+		_MM_TRANSPOSE4_PS(x, y, z, radius);
+
+		__m128 viewX = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][0], x), _mm_mul_ps(m[1][0], y)), _mm_mul_ps(m[2][0], z)), m[3][0]);
+		__m128 viewY = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][1], x), _mm_mul_ps(m[1][1], y)), _mm_mul_ps(m[2][1], z)), m[3][1]);
+		__m128 viewZ = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][2], x), _mm_mul_ps(m[1][2], y)), _mm_mul_ps(m[2][2], z)), m[3][2]);
+		__m128 depth = _mm_sub_ps(_mm_setzero_ps(), viewZ);
+
+		__m128i minX, maxX, minY, maxY;
+		GetTileRanges(tileX, tileXInvLength, CLUSTER_GRID_X, viewX, depth, radius, minX, maxX);
+		GetTileRanges(tileY, tileYInvLength, CLUSTER_GRID_Y, viewY, depth, radius, minY, maxY);
+
+		//The depth slices need a log, they are done per light
+		alignas(16) float depths[4], radii[4];
+		alignas(16) int tiles[4][4];
+		_mm_store_ps(depths, depth);
+		_mm_store_ps(radii, radius);
+		_mm_store_si128((__m128i*)tiles[0], minX);
+		_mm_store_si128((__m128i*)tiles[1], maxX);
+		_mm_store_si128((__m128i*)tiles[2], minY);
+		_mm_store_si128((__m128i*)tiles[3], maxY);
+		for (int l = 0; l < 4; l++) {
+			SetRange(ranges[i + l], depths[l], radii[l], tiles[0][l], tiles[1][l], tiles[2][l], tiles[3][l]);
+		}
+	}
+
+	PrepareLightsScalar(i, last); // Remaining lights
+}
+#endif
+
+void LightClusters::PrepareLights(size_t first, size_t last) {
+	PrepareLights(_kernel, first, last);
+}
+
+void LightClusters::PrepareLights(ClusterKernel kernel, size_t first, size_t last) {
+	switch (kernel) {
+#ifdef CLUSTER_X86
+	case SSEClusterKernel:
+		PrepareLightsSSE(first, last);
+		break;
+#endif
+	default:
+		PrepareLightsScalar(first, last);
+		break;
+	}
+}
+
+void LightClusters::BinSlices(int first, int last) {
+	const int tileCount = CLUSTER_GRID_X * CLUSTER_GRID_Y;
+	unsigned cursor[CLUSTER_GRID_X * CLUSTER_GRID_Y];
+
+	for (int z = first; z < last; z++) {
+		glm::uvec2* slice = &grid[GetClusterIndex(0, 0, z)];
+		for (int i = 0; i < tileCount; i++) {
+			slice[i] = glm::uvec2(0);
+		}
+
+		//Count the lights of every cluster in the slice
+		for (size_t l = 0; l < lightCount; l++) {
+			const ClusterRange& range = ranges[l];
+			if (z < range.minZ || z > range.maxZ) continue;
+
+			for (int y = range.minY; y <= range.maxY; y++) {
+				for (int x = range.minX; x <= range.maxX; x++) {
+					slice[x + y * CLUSTER_GRID_X].y++;
+				}
+			}
+		}
+
+		//Offsets are local to the slice until Compact
+		unsigned total = 0;
+		for (int i = 0; i < tileCount; i++) {
+			slice[i].x = total;
+			cursor[i] = total;
+			total += slice[i].y;
+		}
+
+		std::vector<unsigned>& list = sliceIndices[z];
+		list.resize(total);
+		for (size_t l = 0; l < lightCount; l++) {
+			const ClusterRange& range = ranges[l];
+			if (z < range.minZ || z > range.maxZ) continue;
+
+			for (int y = range.minY; y <= range.maxY; y++) {
+				for (int x = range.minX; x <= range.maxX; x++) {
+					list[cursor[x + y * CLUSTER_GRID_X]++] = (unsigned)l;
+				}
+			}
+		}
+	}
+}
+
+void LightClusters::Compact() {
+	const int tileCount = CLUSTER_GRID_X * CLUSTER_GRID_Y;
+
+	indices.clear();
+	for (int z = 0; z < CLUSTER_GRID_Z; z++) {
+		unsigned base = (unsigned)indices.size();
+		glm::uvec2* slice = &grid[GetClusterIndex(0, 0, z)];
+		for (int i = 0; i < tileCount; i++) {
+			slice[i].x += base;
+		}
+		indices.insert(indices.end(), sliceIndices[z].begin(), sliceIndices[z].end());
+	}
+}
+
+void LightClusters::Build(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, const glm::vec4* lights, size_t count) {
+	SetView(view, projection, nearPlane, farPlane);
+	SetLights(lights, count);
+	PrepareLights(0, count);
+	BinSlices(0, CLUSTER_GRID_Z);
+	Compact();
+}
+
+int LightClusters::GetSlice(float depth) {
+	int slice = (int)std::floor(std::log(depth) * sliceScale + sliceBias);
+	if (slice < 0) return 0;
+	if (slice >= CLUSTER_GRID_Z) return CLUSTER_GRID_Z - 1;
+	return slice;
+}
+
+int LightClusters::GetClusterIndex(int x, int y, int z) {
+	return x + CLUSTER_GRID_X * (y + CLUSTER_GRID_Y * z);
+}
+
+const std::vector<glm::uvec2>& LightClusters::GetGrid() {
+	return this->grid;
+}
+
+const std::vector<unsigned>& LightClusters::GetIndices() {
+	return this->indices;
+}
+
+const ClusterRange& LightClusters::GetRange(size_t light) {
+	return this->ranges[light];
+}
+
+float LightClusters::GetSliceScale() {
+	return this->sliceScale;
+}
+
+float LightClusters::GetSliceBias() {
+	return this->sliceBias;
+}
+
+bool LightClusters::IsSupported(ClusterKernel kernel) {
+	switch (kernel) {
+	case ScalarClusterKernel:
+		return true;
+#ifdef CLUSTER_X86
+	case SSEClusterKernel:
+		return CpuSupports();
+#endif
+	default:
+		return false;
+	}
+}
+
+bool LightClusters::SetKernel(ClusterKernel kernel) {
+	if (!IsSupported(kernel)) return false;
+	_kernel = kernel;
+	return true;
+}
+
+ClusterKernel LightClusters::GetKernel() {
+	return _kernel;
+}
+
+const char* LightClusters::GetKernelName(ClusterKernel kernel) {
+	switch (kernel) {
+	case ScalarClusterKernel: return "Scalar";
+	case SSEClusterKernel: return "SSE";
+	default: return "Unknown";
+	}
+}
\ No newline at end of file
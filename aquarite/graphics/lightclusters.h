@@ -0,0 +1,177 @@
+/**
+*	Filename: lightclusters.h
+*
+*	Description: Header file for LightClusters class, bins point lights into a 3d grid of view frustum clusters
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+#include <vector>
+#include <glm/glm.hpp>
+
+//Cluster grid size, tiles in screen space and exponential depth slices between the near and far plane
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define CLUSTER_COUNT (CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z)
+
+/**
+* The kernels PrepareLights can use, the best one supported by the cpu is chosen at runtime
+*/
+enum ClusterKernel {
+	ScalarClusterKernel,
+	SSEClusterKernel,
+	ClusterKernelCount
+};
+
+/**
+* The clusters a light touches, ranges are inclusive. A light that is not visible has a empty range (minZ > maxZ)
+*/
+struct ClusterRange {
+	int minX, maxX;
+	int minY, maxY;
+	int minZ, maxZ;
+};
+
+/**
+* Building is split in steps that work on independent ranges, so they can be spread over threads:
+* PrepareLights works on ranges of lights, BinSlices on ranges of depth slices, Compact joins the slices.
+* Build runs all steps on the calling thread. None of the steps touch OpenGL.
+* The vector kernel tests 4 lights against the tile boundaries at once, and gives the same ranges as the scalar kernel.
+*/
+class LightClusters {
+private:
+	static ClusterKernel _kernel; /// @brief The kernel used by PrepareLights
+	float nearPlane, farPlane; /// @brief Depth range of the grid
+	float sliceScale, sliceBias; /// @brief Maps log(depth) to a depth slice
+	float tileX[CLUSTER_GRID_X + 1], tileY[CLUSTER_GRID_Y + 1]; /// @brief Slope of the tile boundary planes, x / -z and y / -z
+	float tileXInvLength[CLUSTER_GRID_X + 1], tileYInvLength[CLUSTER_GRID_Y + 1]; /// @brief Inverse length of the tile boundary plane normals
+	glm::mat4 view; /// @brief The view matrix lights are transformed with
+
+	const glm::vec4* lights; /// @brief World space position and radius of the lights being binned
+	size_t lightCount; /// @brief Amount of lights being binned
+	std::vector<ClusterRange> ranges; /// @brief Clusters touched by each light
+	std::vector<std::vector<unsigned>> sliceIndices; /// @brief Light indices of each depth slice, ordered by cluster
+	std::vector<glm::uvec2> grid; /// @brief Offset into indices and light count of every cluster
+	std::vector<unsigned> indices; /// @brief Light indices of all clusters
+
+	/**
+	* Returns the first and last tile touched by a view space sphere along one axis, last is smaller than first if there is none
+	*/
+	static void GetTileRange(const float* slopes, const float* invLengths, int tileCount, float position, float depth, float radius, int& first, int& last);
+
+	/**
+	* Sets the range of a light from its view space sphere and the tile ranges, empties it if the light is not visible
+	*/
+	void SetRange(ClusterRange& range, float depth, float radius, int minX, int maxX, int minY, int maxY);
+
+	/**
+	* Calculates the clusters touched by the lights in [first, last) one light at a time
+	*/
+	void PrepareLightsScalar(size_t first, size_t last);
+
+	/**
+	* Calculates the clusters touched by the lights in [first, last) 4 lights at a time
+	*/
+	void PrepareLightsSSE(size_t first, size_t last);
+public:
+	/**
+	* Constructor
+	*/
+	LightClusters();
+
+	/**
+	* Sets the camera of the grid, must be called before binning. Projection must be a perspective projection.
+	*/
+	void SetView(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane);
+
+	/**
+	* Sets the lights to bin, xyz is the world position and w the radius. The data must stay valid until Compact
+	*/
+	void SetLights(const glm::vec4* lights, size_t count);
+
+	/**
+	* Calculates the clusters touched by the lights in [first, last)
+	*/
+	void PrepareLights(size_t first, size_t last);
+
+	/**
+	* Calculates the clusters touched by the lights in [first, last) with the given kernel, the kernel must be supported
+	*/
+	void PrepareLights(ClusterKernel kernel, size_t first, size_t last);
+
+	/**
+	* Builds the light lists of the depth slices in [first, last), all lights must be prepared
+	*/
+	void BinSlices(int first, int last);
+
+	/**
+	* Joins the slice lists into the grid and indices, all slices must be binned
+	*/
+	void Compact();
+
+	/**
+	* Runs all steps on the calling thread
+	*/
+	void Build(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, const glm::vec4* lights, size_t count);
+
+	/**
+	* Returns the depth slice of a view space depth, the same mapping is used by the shader
+	*/
+	int GetSlice(float depth);
+
+	/**
+	* Returns the index of a cluster in the grid
+	*/
+	static int GetClusterIndex(int x, int y, int z);
+
+	/**
+	* Returns the offset into indices (x) and light count (y) of every cluster
+	*/
+	const std::vector<glm::uvec2>& GetGrid();
+
+	/**
+	* Returns the light indices of all clusters
+	*/
+	const std::vector<unsigned>& GetIndices();
+
+	/**
+	* Returns the clusters touched by a light, valid after PrepareLights
+	*/
+	const ClusterRange& GetRange(size_t light);
+
+	/**
+	* Returns the scale to map log(depth) to a slice
+	*/
+	float GetSliceScale();
+
+	/**
+	* Returns the bias to map log(depth) to a slice
+	*/
+	float GetSliceBias();
+
+	/**
+	* Returns true if the cpu and the compiler support the kernel
+	*/
+	static bool IsSupported(ClusterKernel kernel);
+
+	/**
+	* Sets the kernel used by PrepareLights, returns false if it is not supported
+	*/
+	static bool SetKernel(ClusterKernel kernel);
+
+	/**
+	* Returns the kernel used by PrepareLights
+	*/
+	static ClusterKernel GetKernel();
+
+	/**
+	* Returns the name of the kernel
+	*/
+	static const char* GetKernelName(ClusterKernel kernel);
+};
+
+#endif // !LIGHTCLUSTERS_H
\ No newline at end of file
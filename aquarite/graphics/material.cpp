@@ -9,7 +9,12 @@
 */
 #include "material.h"
 
+unsigned Material::_currentId; // Declare static member
+
 Material::Material(Shader* shader,glm::vec3 color, glm::vec3 diffuseColor, glm::vec3 ambientColor, glm::vec3 specular, float shininess) {
+	this->id = _currentId; // Set this id to the _currentId
+	_currentId++; // Increment global variable _currentId by 1
+
 	this->shader = shader;
 	this->color = color;
 	this->diffuseColor = diffuseColor;
@@ -19,8 +24,13 @@ Material::Material(Shader* shader,glm::vec3 color, glm::vec3 diffuseColor, glm::
 	this->diffuseMap = nullptr;
 }
 
+unsigned Material::GetId() {
+	return this->id;
+}
 
 void Material::SetDiffuse(Texture* texture) {
+	if (texture) texture->AddRef();
+	if (this->diffuseMap) this->diffuseMap->Release();
 	this->diffuseMap = texture;
 }
 
@@ -74,4 +84,8 @@ void Material::SetShine(float shine) {
 
 float Material::GetShine() {
 	return this->shininess;
+}
+
+Material::~Material() {
+	if (this->diffuseMap) this->diffuseMap->Release();
 }
\ No newline at end of file
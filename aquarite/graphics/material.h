@@ -16,6 +16,8 @@
 
 class Material {
 private:
+	static unsigned _currentId; /// @brief Global current id, increments each time a new material is instanciated.
+	unsigned id; /// @brief The id of this material, used by the renderer to group draws
 	Texture* diffuseMap;
 	Shader* shader;
 	glm::vec3 color; /// @brief Vec3 containing color x,y,z.
@@ -27,10 +29,15 @@ public:
 	/**
 	* Constructor, takes as default parameters (glm::vec3(1.0f), glm::vec3(1.0f), glm::vec3(1.0f), glm::vec3(0.5f), 32f).
 	*/
-	Material(Shader* shader = ResourceManager::GetShader("_aquariteDefaultShader"),glm::vec3 color = glm::vec3(1.0f), glm::vec3 diffuseColor = glm::vec3(1.0f), glm::vec3 ambientColor = glm::vec3(1.0f), glm::vec3 specular = glm::vec3(0.5f), float shininess = 32.0f);
+	Material(Shader* shader = ResourceManager::GetShader(ResourceManager::GetShaderHandle(RESOURCE_ID("_aquariteDefaultShader"))),glm::vec3 color = glm::vec3(1.0f), glm::vec3 diffuseColor = glm::vec3(1.0f), glm::vec3 ambientColor = glm::vec3(1.0f), glm::vec3 specular = glm::vec3(0.5f), float shininess = 32.0f);
 
 	/**
-	* Set the diffuse map of the material
+	* Returns the id of the material
+	*/
+	unsigned GetId();
+
+	/**
+	* Set the diffuse map of the material, the material holds a reference to it
 	*/
 	void SetDiffuse(Texture* texture);
 
@@ -98,6 +105,11 @@ public:
 	* Get the shininess of the material
 	*/
 	float GetShine();
+
+	/**
+	* Destructor, releases the diffuse map
+	*/
+	~Material();
 };
 
 #endif // !MATERIAL_H
\ No newline at end of file
@@ -0,0 +1,327 @@
+/**
+*	Filename: meshoptimizer.cpp
+*
+*	Description: Source file for MeshOptimizer class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "meshoptimizer.h"
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "glm/glm.hpp"
+
+static const unsigned INVALID_INDEX = 0xFFFFFFFF;
+
+/**
+* FNV-1a over the bits of the vertex, with a final mix so the low bits can be used for the table
+*/
+static size_t HashVertex(const float* vertex, size_t stride) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < stride; i++) {
+		uint32_t bits;
+		memcpy(&bits, &vertex[i], sizeof(bits));
+		hash ^= bits;
+		hash *= 16777619u;
+	}
+	hash ^= hash >> 16;
+	return hash;
+}
+
+/**
+* Score of a vertex for the Forsyth optimizer, vertices recently used and vertices with few triangles left score higher
+*/
+static float VertexScore(int cachePosition, unsigned remainingValence) {
+	if (remainingValence == 0) return -1.0f; // No triangles left that use this vertex
+
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			score = 0.75f; // Used by the last triangle, fixed score so we do not favour a strip direction
+		}
+		else {
+			float scaler = 1.0f / (VERTEXCACHE_SIZE - 3);
+			score = powf(1.0f - (cachePosition - 3) * scaler, 1.5f);
+		}
+	}
+
+	//Boost vertices with few triangles left, so we finish off areas instead of leaving lone triangles behind
+	score += 2.0f * powf((float)remainingValence, -0.5f);
+	return score;
+}
+
+void MeshOptimizer::GenerateIndexBuffer(const std::vector<float>& soup, size_t stride, std::vector<float>& vertices, std::vector<unsigned>& indices) {
+	size_t count = soup.size() / stride;
+	vertices.clear();
+	indices.clear();
+	vertices.reserve(soup.size());
+	indices.reserve(count);
+
+	//Open addressing table of vertex ids, kept at most half full
+	size_t tableSize = 1;
+	while (tableSize < count * 2) tableSize *= 2;
+	std::vector<unsigned> table(tableSize, INVALID_INDEX);
+
+	for (size_t i = 0; i < count; i++) {
+		const float* vertex = &soup[i * stride];
+		size_t slot = HashVertex(vertex, stride) & (tableSize - 1);
+
+		while (true) {
+			unsigned id = table[slot];
+			if (id == INVALID_INDEX) {
+				//First time we see this vertex
+				id = (unsigned)(vertices.size() / stride);
+				table[slot] = id;
+				vertices.insert(vertices.end(), vertex, vertex + stride);
+				indices.push_back(id);
+				break;
+			}
+
+			if (memcmp(&vertices[id * stride], vertex, stride * sizeof(float)) == 0) {
+				indices.push_back(id);
+				break;
+			}
+
+			slot = (slot + 1) & (tableSize - 1);
+		}
+	}
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned>& indices, size_t vertexCount) {
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	//Build the vertex to triangle adjacency, valence holds the amount of triangles not yet emitted
+	std::vector<unsigned> valence(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		valence[indices[i]]++;
+	}
+
+	std::vector<unsigned> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++) {
+		offsets[v + 1] = offsets[v] + valence[v];
+	}
+
+	std::vector<unsigned> adjacency(triangleCount * 3);
+	std::vector<unsigned> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++) {
+		for (int c = 0; c < 3; c++) {
+			adjacency[fill[indices[t * 3 + c]]++] = (unsigned)t;
+		}
+	}
+
+	//Initial scores
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) {
+		vertexScores[v] = VertexScore(-1, valence[v]);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	int bestTriangle = 0;
+	for (size_t t = 0; t < triangleCount; t++) {
+		triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+		if (triangleScores[t] > triangleScores[bestTriangle]) bestTriangle = (int)t;
+	}
+
+	std::vector<unsigned> result;
+	result.reserve(triangleCount * 3);
+
+	std::vector<unsigned> cache, newCache;
+	cache.reserve(VERTEXCACHE_SIZE + 3);
+	newCache.reserve(VERTEXCACHE_SIZE + 3);
+
+	size_t inputCursor = 0;
+	while (result.size() < triangleCount * 3) {
+		if (bestTriangle < 0) {
+			//No candidate left around the cache, continue with the next triangle in input order
+			while (emitted[inputCursor]) inputCursor++;
+			bestTriangle = (int)inputCursor;
+		}
+
+		unsigned triangle = (unsigned)bestTriangle;
+		const unsigned* corners = &indices[triangle * 3];
+		emitted[triangle] = true;
+
+		//Emit the triangle and remove it from the adjacency of its vertices
+		newCache.clear();
+		for (int c = 0; c < 3; c++) {
+			unsigned v = corners[c];
+			result.push_back(v);
+
+			if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) {
+				newCache.push_back(v);
+			}
+
+			unsigned begin = offsets[v];
+			unsigned end = begin + valence[v];
+			for (unsigned a = begin; a < end; a++) {
+				if (adjacency[a] == triangle) {
+					adjacency[a] = adjacency[end - 1];
+					break;
+				}
+			}
+			valence[v]--;
+		}
+
+		//The triangle's vertices move to the front of the cache, the rest shifts back
+		for (size_t i = 0; i < cache.size(); i++) {
+			if (cache[i] != corners[0] && cache[i] != corners[1] && cache[i] != corners[2]) {
+				newCache.push_back(cache[i]);
+			}
+		}
+
+		for (size_t i = 0; i < newCache.size(); i++) {
+			cachePositions[newCache[i]] = i < VERTEXCACHE_SIZE ? (int)i : -1;
+		}
+
+		//Update the scores of all vertices in or just pushed out of the cache, and the triangles using them
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < newCache.size(); i++) {
+			unsigned v = newCache[i];
+			float score = VertexScore(cachePositions[v], valence[v]);
+			float delta = score - vertexScores[v];
+			vertexScores[v] = score;
+
+			for (unsigned a = offsets[v]; a < offsets[v] + valence[v]; a++) {
+				triangleScores[adjacency[a]] += delta;
+			}
+		}
+
+		for (size_t i = 0; i < newCache.size() && i < VERTEXCACHE_SIZE; i++) {
+			unsigned v = newCache[i];
+			for (unsigned a = offsets[v]; a < offsets[v] + valence[v]; a++) {
+				if (triangleScores[adjacency[a]] > bestScore) {
+					bestScore = triangleScores[adjacency[a]];
+					bestTriangle = (int)adjacency[a];
+				}
+			}
+		}
+
+		if (newCache.size() > VERTEXCACHE_SIZE) newCache.resize(VERTEXCACHE_SIZE);
+		cache.swap(newCache);
+	}
+
+	indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<unsigned>& indices, const std::vector<float>& vertices, size_t stride) {
+	size_t triangleCount = indices.size() / 3;
+	size_t vertexCount = vertices.size() / stride;
+	if (triangleCount == 0) return;
+
+	//A cluster starts where none of the triangle's vertices are in the simulated cache, moving those does not cost cache hits
+	std::vector<size_t> clusterStarts;
+	std::vector<unsigned> timestamps(vertexCount, 0);
+	unsigned time = VERTEXCACHE_SIZE + 1;
+	for (size_t t = 0; t < triangleCount; t++) {
+		int misses = 0;
+		for (int c = 0; c < 3; c++) {
+			unsigned v = indices[t * 3 + c];
+			if (time - timestamps[v] > VERTEXCACHE_SIZE) {
+				timestamps[v] = time++;
+				misses++;
+			}
+		}
+
+		if (t == 0 || misses == 3) clusterStarts.push_back(t);
+	}
+	clusterStarts.push_back(triangleCount);
+
+	size_t clusterCount = clusterStarts.size() - 1;
+	if (clusterCount < 2) return;
+
+	//Area weighted centroid and normal of every cluster
+	std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0));
+	std::vector<glm::vec3> normals(clusterCount, glm::vec3(0));
+	std::vector<float> areas(clusterCount, 0.0f);
+	glm::vec3 meshCentroid(0);
+	float meshArea = 0.0f;
+
+	for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+		for (size_t t = clusterStarts[cluster]; t < clusterStarts[cluster + 1]; t++) {
+			const float* a = &vertices[indices[t * 3] * stride];
+			const float* b = &vertices[indices[t * 3 + 1] * stride];
+			const float* c = &vertices[indices[t * 3 + 2] * stride];
+			glm::vec3 p0(a[0], a[1], a[2]), p1(b[0], b[1], b[2]), p2(c[0], c[1], c[2]);
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal) * 0.5f;
+
+			centroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+			normals[cluster] += normal;
+			areas[cluster] += area;
+		}
+
+		meshCentroid += centroids[cluster];
+		meshArea += areas[cluster];
+		if (areas[cluster] > 0.0f) centroids[cluster] /= areas[cluster];
+	}
+	if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+	//Clusters facing away from the centre are likely in front of the rest, so they are drawn first
+	std::vector<float> sortKeys(clusterCount);
+	std::vector<size_t> order(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+		float length = glm::length(normals[cluster]);
+		glm::vec3 normal = length > 0.0f ? normals[cluster] / length : glm::vec3(0);
+		sortKeys[cluster] = glm::dot(centroids[cluster] - meshCentroid, normal);
+		order[cluster] = cluster;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<unsigned> result;
+	result.reserve(indices.size());
+	for (size_t i = 0; i < clusterCount; i++) {
+		size_t cluster = order[i];
+		result.insert(result.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+	}
+
+	indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<float>& vertices, size_t stride, std::vector<unsigned>& indices) {
+	size_t vertexCount = vertices.size() / stride;
+	std::vector<unsigned> remap(vertexCount, INVALID_INDEX);
+
+	std::vector<float> result;
+	result.reserve(vertices.size());
+
+	//Vertices not referenced by any index are dropped
+	unsigned next = 0;
+	for (size_t i = 0; i < indices.size(); i++) {
+		unsigned v = indices[i];
+		if (remap[v] == INVALID_INDEX) {
+			remap[v] = next++;
+			result.insert(result.end(), vertices.begin() + v * stride, vertices.begin() + (v + 1) * stride);
+		}
+		indices[i] = remap[v];
+	}
+
+	vertices.swap(result);
+}
+
+float MeshOptimizer::CalculateACMR(const std::vector<unsigned>& indices, size_t vertexCount) {
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return 0.0f;
+
+	//Simulate a FIFO cache using timestamps
+	std::vector<unsigned> timestamps(vertexCount, 0);
+	unsigned time = VERTEXCACHE_SIZE + 1;
+	size_t misses = 0;
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		unsigned v = indices[i];
+		if (time - timestamps[v] > VERTEXCACHE_SIZE) {
+			timestamps[v] = time++;
+			misses++;
+		}
+	}
+
+	return (float)misses / (float)triangleCount;
+}
\ No newline at end of file
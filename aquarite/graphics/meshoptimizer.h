@@ -0,0 +1,48 @@
+/**
+*	Filename: meshoptimizer.h
+*
+*	Description: Header file for MeshOptimizer class, reorders index and vertex buffers for the gpu caches
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+#include <vector>
+#include <cstddef>
+
+#define VERTEXCACHE_SIZE 32 // Simulated post transform cache size, in vertices
+
+class MeshOptimizer {
+public:
+	/**
+	* Deduplicates a non indexed triangle list, every vertex is stride floats. Identical vertices are merged,
+	* the unique vertices are written to vertices and the triangle list to indices.
+	*/
+	static void GenerateIndexBuffer(const std::vector<float>& soup, size_t stride, std::vector<float>& vertices, std::vector<unsigned>& indices);
+
+	/**
+	* Reorders the triangles to make use of the post transform vertex cache, based on Tom Forsyth's linear-speed vertex cache optimisation
+	*/
+	static void OptimizeVertexCache(std::vector<unsigned>& indices, size_t vertexCount);
+
+	/**
+	* Splits the cache optimized triangle list into clusters at cache restarts, then orders the clusters so
+	* outward facing clusters are drawn first, this lowers overdraw without undoing the cache optimisation.
+	* Positions are read from the first 3 floats of every vertex.
+	*/
+	static void OptimizeOverdraw(std::vector<unsigned>& indices, const std::vector<float>& vertices, size_t stride);
+
+	/**
+	* Reorders the vertices in the order they are first used by the index buffer, and remaps the indices
+	*/
+	static void OptimizeVertexFetch(std::vector<float>& vertices, size_t stride, std::vector<unsigned>& indices);
+
+	/**
+	* Returns the average amount of cache misses per triangle for the index buffer, 0.5 is near optimal and 3 is the worst case
+	*/
+	static float CalculateACMR(const std::vector<unsigned>& indices, size_t vertexCount);
+};
+
+#endif // !MESHOPTIMIZER_H
\ No newline at end of file
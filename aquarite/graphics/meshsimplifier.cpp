@@ -0,0 +1,305 @@
+/**
+*	Filename: meshsimplifier.cpp
+*
+*	Description: Source file for MeshSimplifier class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "meshsimplifier.h"
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+#include "glm/glm.hpp"
+
+/**
+* Symmetric 4x4 matrix, the sum of the squared distances to a set of planes
+*/
+struct Quadric {
+	double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+	double weight; /// @brief Sum of the plane weights
+
+	Quadric() : a00(0), a01(0), a02(0), a03(0), a11(0), a12(0), a13(0), a22(0), a23(0), a33(0), weight(0) {}
+
+	/**
+	* Adds the plane with normal n and distance d, weighted
+	*/
+	void AddPlane(const glm::dvec3& n, double d, double weight) {
+		a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z; a03 += weight * n.x * d;
+		a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a13 += weight * n.y * d;
+		a22 += weight * n.z * n.z; a23 += weight * n.z * d;
+		a33 += weight * d * d;
+		this->weight += weight;
+	}
+
+	void Add(const Quadric& q) {
+		a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+		a11 += q.a11; a12 += q.a12; a13 += q.a13;
+		a22 += q.a22; a23 += q.a23;
+		a33 += q.a33;
+		weight += q.weight;
+	}
+
+	/**
+	* Returns the error of a position, the weighted mean of the squared distances to the planes
+	*/
+	double Error(const glm::vec3& p) const {
+		if (weight <= 0.0) return 0.0;
+		double x = p.x, y = p.y, z = p.z;
+		double error = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+			+ a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+			+ a22 * z * z + 2 * a23 * z
+			+ a33;
+		return error < 0.0 ? 0.0 : error / weight;
+	}
+};
+
+/**
+* A possible collapse of vertex from onto vertex to
+*/
+struct Collapse {
+	unsigned from, to;
+	double error;
+
+	bool operator<(const Collapse& other) const { return error < other.error; }
+};
+
+/**
+* Key of a position, vertices with bitwise equal positions share a key
+*/
+struct PositionKey {
+	uint32_t x, y, z;
+
+	bool operator==(const PositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+};
+
+struct PositionKeyHash {
+	size_t operator()(const PositionKey& key) const {
+		return (size_t)key.x * 73856093u ^ (size_t)key.y * 19349663u ^ (size_t)key.z * 83492791u;
+	}
+};
+
+static uint64_t EdgeKey(unsigned a, unsigned b) {
+	return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+}
+
+/**
+* Returns the squared distance between the attributes of two vertices, the floats after the position
+*/
+static float AttributeDistance(const std::vector<float>& vertices, size_t stride, unsigned a, unsigned b) {
+	float distance = 0.0f;
+	for (size_t i = 3; i < stride; i++) {
+		float difference = vertices[a * stride + i] - vertices[b * stride + i];
+		distance += difference * difference;
+	}
+	return distance;
+}
+
+float MeshSimplifier::Simplify(const std::vector<float>& vertices, size_t stride, const std::vector<unsigned>& indices, size_t targetIndexCount, float maxError, std::vector<unsigned>& result) {
+	size_t vertexCount = vertices.size() / stride;
+	size_t triangleCount = indices.size() / 3;
+	result = indices;
+	if (indices.size() <= targetIndexCount) return 0.0f;
+
+	//Vertices sharing a position are split by a uv or normal seam, the topology and the collapses work on the welded positions
+	std::unordered_map<PositionKey, unsigned, PositionKeyHash> positionIds;
+	std::vector<unsigned> welded(vertexCount);
+	std::vector<glm::vec3> positions;
+	std::vector<std::vector<unsigned>> splitVertices;
+	for (size_t i = 0; i < vertexCount; i++) {
+		PositionKey key;
+		memcpy(&key, &vertices[i * stride], sizeof(key));
+		std::pair<std::unordered_map<PositionKey, unsigned, PositionKeyHash>::iterator, bool> inserted = positionIds.insert(std::make_pair(key, (unsigned)positions.size()));
+		if (inserted.second) {
+			positions.push_back(glm::vec3(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]));
+			splitVertices.push_back(std::vector<unsigned>());
+		}
+		welded[i] = inserted.first->second;
+		splitVertices[welded[i]].push_back((unsigned)i);
+	}
+	size_t positionCount = positions.size();
+
+	//Edges used by a single triangle are on the border, moving their positions would open holes
+	std::vector<bool> locked(positionCount, false);
+	std::unordered_map<uint64_t, unsigned> edgeUse;
+	for (size_t t = 0; t < triangleCount; t++) {
+		for (int e = 0; e < 3; e++) {
+			edgeUse[EdgeKey(welded[indices[t * 3 + e]], welded[indices[t * 3 + (e + 1) % 3]])]++;
+		}
+	}
+	for (std::unordered_map<uint64_t, unsigned>::iterator it = edgeUse.begin(); it != edgeUse.end(); it++) {
+		if (it->second != 1) continue;
+		locked[(unsigned)(it->first >> 32)] = true;
+		locked[(unsigned)(it->first & 0xFFFFFFFF)] = true;
+	}
+
+	//Every position starts with the planes of its triangles, weighted by area
+	std::vector<Quadric> quadrics(positionCount);
+	std::vector<std::vector<unsigned>> positionTriangles(positionCount);
+	std::vector<glm::vec3> triangleNormals(triangleCount, glm::vec3(0.0f));
+	for (size_t t = 0; t < triangleCount; t++) {
+		unsigned corners[3] = { welded[indices[t * 3]], welded[indices[t * 3 + 1]], welded[indices[t * 3 + 2]] };
+		glm::dvec3 p0 = positions[corners[0]];
+		glm::dvec3 normal = glm::cross(glm::dvec3(positions[corners[1]]) - p0, glm::dvec3(positions[corners[2]]) - p0);
+		double length = glm::length(normal);
+
+		if (length > 0.0) {
+			normal /= length;
+			triangleNormals[t] = glm::vec3(normal);
+			for (int c = 0; c < 3; c++) {
+				quadrics[corners[c]].AddPlane(normal, -glm::dot(normal, p0), length * 0.5);
+			}
+		}
+
+		for (int c = 0; c < 3; c++) {
+			positionTriangles[corners[c]].push_back((unsigned)t);
+		}
+	}
+
+	std::vector<bool> removed(triangleCount, false);
+	std::vector<bool> touched(positionCount);
+	std::vector<Collapse> collapses;
+	size_t indexCount = indices.size();
+	double errorLimit = (double)maxError * maxError;
+	double largestError = 0.0;
+
+	//Every pass collapses the cheapest edges that do not share a triangle with a collapse already made this pass
+	while (indexCount > targetIndexCount) {
+		collapses.clear();
+		for (size_t t = 0; t < triangleCount; t++) {
+			if (removed[t]) continue;
+			for (int e = 0; e < 3; e++) {
+				unsigned a = welded[result[t * 3 + e]];
+				unsigned b = welded[result[t * 3 + (e + 1) % 3]];
+
+				Quadric q = quadrics[a];
+				q.Add(quadrics[b]);
+
+				Collapse collapse;
+				if (!locked[a]) {
+					collapse.from = a;
+					collapse.to = b;
+					collapse.error = q.Error(positions[b]);
+					collapses.push_back(collapse);
+				}
+				if (!locked[b]) {
+					collapse.from = b;
+					collapse.to = a;
+					collapse.error = q.Error(positions[a]);
+					collapses.push_back(collapse);
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end());
+		std::fill(touched.begin(), touched.end(), false);
+		size_t collapsed = 0;
+
+		for (size_t c = 0; c < collapses.size() && indexCount > targetIndexCount && collapses[c].error <= errorLimit; c++) {
+			unsigned from = collapses[c].from;
+			unsigned to = collapses[c].to;
+			if (touched[from] || touched[to]) continue;
+
+			//Reject the collapse if any remaining triangle would flip, become degenerate or turn too far from its normal before simplifying,
+			//comparing with the current normal instead would let a triangle turn a little further with every collapse until it stands on its side
+			bool valid = true;
+			std::vector<unsigned>& fromTriangles = positionTriangles[from];
+			for (size_t i = 0; i < fromTriangles.size() && valid; i++) {
+				unsigned t = fromTriangles[i];
+				if (removed[t]) continue;
+
+				unsigned corners[3] = { welded[result[t * 3]], welded[result[t * 3 + 1]], welded[result[t * 3 + 2]] };
+				if (corners[0] == to || corners[1] == to || corners[2] == to) continue; // Removed by the collapse
+
+				glm::vec3 before = glm::cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+				for (int k = 0; k < 3; k++) {
+					if (corners[k] == from) corners[k] = to;
+				}
+				glm::vec3 after = glm::cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+				float longestEdge = std::max(glm::distance(positions[corners[0]], positions[corners[1]]), std::max(glm::distance(positions[corners[1]], positions[corners[2]]), glm::distance(positions[corners[2]], positions[corners[0]])));
+				valid = glm::length(after) > LOD_MIN_TRIANGLE_AREA * longestEdge * longestEdge; // Corners on a line leave only rounding noise
+				valid = valid && glm::dot(before, after) > 0.0f && glm::dot(triangleNormals[t], after) > LOD_MIN_NORMAL_DOT * glm::length(after);
+			}
+			if (!valid) continue;
+
+			for (size_t i = 0; i < fromTriangles.size(); i++) {
+				unsigned t = fromTriangles[i];
+				if (removed[t]) continue;
+
+				unsigned* triangle = &result[t * 3];
+				for (int k = 0; k < 3; k++) touched[welded[triangle[k]]] = true;
+
+				if (welded[triangle[0]] == to || welded[triangle[1]] == to || welded[triangle[2]] == to) {
+					removed[t] = true;
+					indexCount -= 3;
+					continue;
+				}
+
+				//The corner moves to the vertex at the new position with the closest uv and normal
+				for (int k = 0; k < 3; k++) {
+					if (welded[triangle[k]] != from) continue;
+
+					const std::vector<unsigned>& candidates = splitVertices[to];
+					unsigned best = candidates[0];
+					float bestDistance = AttributeDistance(vertices, stride, triangle[k], best);
+					for (size_t v = 1; v < candidates.size(); v++) {
+						float distance = AttributeDistance(vertices, stride, triangle[k], candidates[v]);
+						if (distance < bestDistance) {
+							best = candidates[v];
+							bestDistance = distance;
+						}
+					}
+					triangle[k] = best;
+				}
+				positionTriangles[to].push_back(t);
+			}
+
+			fromTriangles.clear();
+			quadrics[to].Add(quadrics[from]);
+			largestError = std::max(largestError, collapses[c].error);
+			collapsed++;
+		}
+
+		if (collapsed == 0) break; // Nothing left that can be collapsed
+	}
+
+	//Compact the remaining triangles
+	size_t write = 0;
+	for (size_t t = 0; t < triangleCount; t++) {
+		if (removed[t]) continue;
+		for (int k = 0; k < 3; k++) result[write++] = result[t * 3 + k];
+	}
+	result.resize(write);
+
+	return (float)std::sqrt(largestError);
+}
+
+size_t MeshSimplifier::GenerateLodChain(const std::vector<float>& vertices, size_t stride, const std::vector<unsigned>& indices, size_t levels, std::vector<std::vector<unsigned>>& lods) {
+	lods.clear();
+	if (vertices.size() < stride) return 0;
+
+	//The allowed error is relative to the size of the mesh, and doubles every level
+	glm::vec3 min(vertices[0], vertices[1], vertices[2]), max = min;
+	for (size_t i = 0; i + 2 < vertices.size(); i += stride) {
+		glm::vec3 position(vertices[i], vertices[i + 1], vertices[i + 2]);
+		min = glm::min(min, position);
+		max = glm::max(max, position);
+	}
+	float maxError = glm::length(max - min) * LOD_MAX_ERROR;
+
+	for (size_t level = 0; level < levels; level++) {
+		const std::vector<unsigned>& previous = level == 0 ? indices : lods[level - 1];
+		size_t target = (size_t)(previous.size() / 3 * LOD_REDUCTION) * 3;
+		std::vector<unsigned> lod;
+		Simplify(vertices, stride, indices, target, maxError, lod); // From the full mesh, so triangles can not turn further with every level
+		maxError *= 2.0f;
+
+		if (lod.empty() || lod.size() > previous.size() * LOD_MIN_REDUCTION) break;
+		lods.push_back(lod);
+	}
+
+	return lods.size();
+}
@@ -0,0 +1,40 @@
+/**
+*	Filename: meshsimplifier.h
+*
+*	Description: Header file for MeshSimplifier class, reduces the triangle count of a mesh using quadric error metrics
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+#include <vector>
+#include <cstddef>
+
+#define LOD_REDUCTION 0.5f // Part of the triangles of the previous level kept by every level of a lod chain
+#define LOD_MIN_REDUCTION 0.9f // A level keeping more than this part of the triangles of the previous level ends the chain
+#define LOD_MAX_ERROR 0.01f // Error allowed for the first level of a lod chain, relative to the diagonal of the mesh bounds
+#define LOD_MIN_TRIANGLE_AREA 0.001f // Smallest area of a triangle after a collapse, relative to its longest edge squared
+#define LOD_MIN_NORMAL_DOT 0.25f // Cosine of the largest angle a triangle may turn away from its original normal, stops folds and slivers
+
+class MeshSimplifier {
+public:
+	/**
+	* Collapses edges in order of their quadric error until the index count is at most targetIndexCount, or no edge can be collapsed
+	* without moving the surface further than maxError.
+	* A position is always collapsed onto the other position of the edge, so the vertex buffer is shared and only indices change.
+	* Vertices split by a seam move to the vertex at the new position with the closest attributes, positions on borders are not moved.
+	* Positions are read from the first 3 floats of every vertex.
+	* Returns the largest error of the collapses made, as a distance.
+	*/
+	static float Simplify(const std::vector<float>& vertices, size_t stride, const std::vector<unsigned>& indices, size_t targetIndexCount, float maxError, std::vector<unsigned>& result);
+
+	/**
+	* Builds a lod chain, every level simplifies the mesh to LOD_REDUCTION of the triangles of the previous level, allowing twice the error of the previous level.
+	* Level 0 is not included, stops early when a level can not be reduced any further. Returns the amount of levels
+	*/
+	static size_t GenerateLodChain(const std::vector<float>& vertices, size_t stride, const std::vector<unsigned>& indices, size_t levels, std::vector<std::vector<unsigned>>& lods);
+};
+
+#endif // !MESHSIMPLIFIER_H
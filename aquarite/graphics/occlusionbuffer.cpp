@@ -0,0 +1,256 @@
+/**
+*	Filename: occlusionbuffer.cpp
+*
+*	Description: Source file for OcclusionBuffer class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <algorithm>
+#include <cmath>
+#include "occlusionbuffer.h"
+#include "../jobsystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SSE
+#include <emmintrin.h>
+#endif
+
+OcclusionBuffer::OcclusionBuffer(int width, int height) {
+	this->width = width;
+	this->height = height;
+	this->tilesX = width / OCCLUSION_TILE_SIZE;
+	this->tilesY = height / OCCLUSION_TILE_SIZE;
+	this->viewProjection = glm::mat4(1.0f);
+	this->depth.assign(width * height, 1.0f);
+	this->tileDepth.assign(tilesX * tilesY, 1.0f);
+}
+
+glm::vec3 OcclusionBuffer::ToBuffer(const glm::vec4& clip) {
+	glm::vec3 ndc = glm::vec3(clip) / clip.w;
+	return glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+}
+
+void OcclusionBuffer::AddClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+	//Clip against the near plane z = -w, a triangle becomes at most a quad
+	const glm::vec4 input[3] = { a, b, c };
+	glm::vec4 polygon[4];
+	int count = 0;
+
+	for (int i = 0; i < 3; i++) {
+		const glm::vec4& current = input[i];
+		const glm::vec4& next = input[(i + 1) % 3];
+		float currentDistance = current.z + current.w;
+		float nextDistance = next.z + next.w;
+		bool currentInside = currentDistance >= 0.0f;
+		bool nextInside = nextDistance >= 0.0f;
+
+		if (currentInside) polygon[count++] = current;
+		if (currentInside != nextInside) {
+			float t = currentDistance / (currentDistance - nextDistance);
+			polygon[count++] = current + (next - current) * t;
+		}
+	}
+
+	for (int i = 2; i < count; i++) {
+		OcclusionTriangle triangle;
+		triangle.vertices[0] = ToBuffer(polygon[0]);
+		triangle.vertices[1] = ToBuffer(polygon[i - 1]);
+		triangle.vertices[2] = ToBuffer(polygon[i]);
+
+		//Make the winding counter clockwise, occluders are not back face culled
+		glm::vec3 e1 = triangle.vertices[1] - triangle.vertices[0];
+		glm::vec3 e2 = triangle.vertices[2] - triangle.vertices[0];
+		float area = e1.x * e2.y - e2.x * e1.y;
+		if (std::fabs(area) < 1e-6f) continue;
+		if (area < 0.0f) std::swap(triangle.vertices[1], triangle.vertices[2]);
+
+		//Skip triangles outside the buffer, or fully behind the far plane
+		float minX = std::min(std::min(triangle.vertices[0].x, triangle.vertices[1].x), triangle.vertices[2].x);
+		float maxX = std::max(std::max(triangle.vertices[0].x, triangle.vertices[1].x), triangle.vertices[2].x);
+		float minY = std::min(std::min(triangle.vertices[0].y, triangle.vertices[1].y), triangle.vertices[2].y);
+		float maxY = std::max(std::max(triangle.vertices[0].y, triangle.vertices[1].y), triangle.vertices[2].y);
+		float minZ = std::min(std::min(triangle.vertices[0].z, triangle.vertices[1].z), triangle.vertices[2].z);
+		if (maxX < 0.0f || minX > width || maxY < 0.0f || minY > height || minZ > 1.0f) continue;
+
+		triangle.minY = std::max((int)std::floor(minY), 0);
+		triangle.maxY = std::min((int)std::ceil(maxY), height - 1);
+		triangles.push_back(triangle);
+	}
+}
+
+void OcclusionBuffer::RasterizeTriangle(const OcclusionTriangle& triangle, int firstRow, int lastRow) {
+	const glm::vec3& v0 = triangle.vertices[0];
+	const glm::vec3& v1 = triangle.vertices[1];
+	const glm::vec3& v2 = triangle.vertices[2];
+
+	int minY = std::max(triangle.minY, firstRow);
+	int maxY = std::min(triangle.maxY, lastRow - 1);
+	if (minY > maxY) return;
+
+	//Start at a multiple of 4, the width is a multiple of 4 as well so 4 pixels at a time never cross the end of the row
+	int minX = std::max((int)std::floor(std::min(std::min(v0.x, v1.x), v2.x)), 0) & ~3;
+	int maxX = std::min((int)std::ceil(std::max(std::max(v0.x, v1.x), v2.x)), width - 1);
+
+	//Edge functions, positive inside for a counter clockwise triangle
+	const glm::vec3* from[3] = { &v0, &v1, &v2 };
+	const glm::vec3* to[3] = { &v1, &v2, &v0 };
+	float edgeA[3], edgeB[3], edgeC[3];
+	for (int e = 0; e < 3; e++) {
+		edgeA[e] = from[e]->y - to[e]->y;
+		edgeB[e] = to[e]->x - from[e]->x;
+		edgeC[e] = -edgeA[e] * from[e]->x - edgeB[e] * from[e]->y;
+	}
+
+	//Depth plane, z = z0 + dzdx * (x - x0) + dzdy * (y - y0)
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+	float dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+	float dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+	float depthC = v0.z - dzdx * v0.x - dzdy * v0.y;
+
+	for (int y = minY; y <= maxY; y++) {
+		float py = y + 0.5f;
+		float* row = &depth[y * width];
+		int x = minX;
+
+#ifdef OCCLUSION_SSE
+		const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		const __m128 zero = _mm_setzero_ps();
+		__m128 rowE0 = _mm_set1_ps(edgeB[0] * py + edgeC[0]);
+		__m128 rowE1 = _mm_set1_ps(edgeB[1] * py + edgeC[1]);
+		__m128 rowE2 = _mm_set1_ps(edgeB[2] * py + edgeC[2]);
+		__m128 rowZ = _mm_set1_ps(dzdy * py + depthC);
+		__m128 a0 = _mm_set1_ps(edgeA[0]), a1 = _mm_set1_ps(edgeA[1]), a2 = _mm_set1_ps(edgeA[2]), dz = _mm_set1_ps(dzdx);
+
+		for (; x <= maxX; x += 4) {
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+			__m128 inside = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), rowE0), zero), _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), rowE1), zero));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), rowE2), zero));
+			if (_mm_movemask_ps(inside) == 0) continue;
+
+			__m128 current = _mm_loadu_ps(row + x);
+			__m128 z = _mm_max_ps(_mm_add_ps(_mm_mul_ps(dz, px), rowZ), zero);
+			__m128 nearest = _mm_min_ps(current, z);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+		}
+#endif
+
+		for (; x <= maxX; x++) {
+			float px = x + 0.5f;
+			if (edgeA[0] * px + edgeB[0] * py + edgeC[0] < 0.0f) continue;
+			if (edgeA[1] * px + edgeB[1] * py + edgeC[1] < 0.0f) continue;
+			if (edgeA[2] * px + edgeB[2] * py + edgeC[2] < 0.0f) continue;
+
+			float z = std::max(dzdx * px + dzdy * py + depthC, 0.0f);
+			row[x] = std::min(row[x], z);
+		}
+	}
+}
+
+void OcclusionBuffer::Begin(const glm::mat4& viewProjection) {
+	this->viewProjection = viewProjection;
+	this->triangles.clear();
+}
+
+void OcclusionBuffer::AddOccluder(const glm::mat4& world, const std::vector<glm::vec3>& positions, const std::vector<unsigned>& indices) {
+	glm::mat4 transform = viewProjection * world;
+
+	std::vector<glm::vec4> clip(positions.size());
+	for (size_t i = 0; i < positions.size(); i++) {
+		clip[i] = transform * glm::vec4(positions[i], 1.0f);
+	}
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		AddClipTriangle(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]]);
+	}
+}
+
+void OcclusionBuffer::RasterizeTileRows(int firstTileRow, int lastTileRow) {
+	int firstRow = firstTileRow * OCCLUSION_TILE_SIZE;
+	int lastRow = lastTileRow * OCCLUSION_TILE_SIZE;
+	std::fill(depth.begin() + firstRow * width, depth.begin() + lastRow * width, 1.0f);
+
+	for (size_t i = 0; i < triangles.size(); i++) {
+		if (triangles[i].maxY < firstRow || triangles[i].minY >= lastRow) continue;
+		RasterizeTriangle(triangles[i], firstRow, lastRow);
+	}
+
+	//Every tile keeps the farthest depth of its pixels, a box nearer than that is in front of something in the tile
+	for (int tileY = firstTileRow; tileY < lastTileRow; tileY++) {
+		for (int tileX = 0; tileX < tilesX; tileX++) {
+			float farthest = 0.0f;
+			for (int y = tileY * OCCLUSION_TILE_SIZE; y < (tileY + 1) * OCCLUSION_TILE_SIZE; y++) {
+				const float* row = &depth[y * width + tileX * OCCLUSION_TILE_SIZE];
+				for (int x = 0; x < OCCLUSION_TILE_SIZE; x++) {
+					farthest = std::max(farthest, row[x]);
+				}
+			}
+			tileDepth[tileY * tilesX + tileX] = farthest;
+		}
+	}
+}
+
+void OcclusionBuffer::Rasterize() {
+	if (triangles.empty()) {
+		std::fill(depth.begin(), depth.end(), 1.0f);
+		std::fill(tileDepth.begin(), tileDepth.end(), 1.0f);
+		return;
+	}
+
+	JobSystem::ParallelFor(tilesY, 1, [this](size_t first, size_t last) {
+		RasterizeTileRows((int)first, (int)last);
+	});
+}
+
+bool OcclusionBuffer::IsVisible(const glm::vec3& min, const glm::vec3& max) {
+	glm::vec2 screenMin(1e30f), screenMax(-1e30f);
+	float nearest = 1.0f;
+
+	for (int i = 0; i < 8; i++) {
+		glm::vec3 corner((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+		glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+
+		//A box crossing the near plane covers the camera, it can not be behind anything
+		if (clip.z < -clip.w || clip.w <= 0.0f) return true;
+
+		glm::vec3 position = ToBuffer(clip);
+		screenMin = glm::min(screenMin, glm::vec2(position));
+		screenMax = glm::max(screenMax, glm::vec2(position));
+		nearest = std::min(nearest, position.z);
+	}
+
+	int minTileX = std::max((int)std::floor(screenMin.x) / OCCLUSION_TILE_SIZE, 0);
+	int minTileY = std::max((int)std::floor(screenMin.y) / OCCLUSION_TILE_SIZE, 0);
+	int maxTileX = std::min((int)std::floor(screenMax.x) / OCCLUSION_TILE_SIZE, tilesX - 1);
+	int maxTileY = std::min((int)std::floor(screenMax.y) / OCCLUSION_TILE_SIZE, tilesY - 1);
+	if (screenMax.x < 0.0f || screenMax.y < 0.0f || minTileX > maxTileX || minTileY > maxTileY) return true;
+
+	for (int tileY = minTileY; tileY <= maxTileY; tileY++) {
+		for (int tileX = minTileX; tileX <= maxTileX; tileX++) {
+			if (nearest <= tileDepth[tileY * tilesX + tileX]) return true;
+		}
+	}
+
+	return false;
+}
+
+float OcclusionBuffer::GetDepth(int x, int y) {
+	return depth[y * width + x];
+}
+
+float OcclusionBuffer::GetTileDepth(int tileX, int tileY) {
+	return tileDepth[tileY * tilesX + tileX];
+}
+
+size_t OcclusionBuffer::GetTriangleCount() {
+	return triangles.size();
+}
+
+int OcclusionBuffer::GetWidth() {
+	return width;
+}
+
+int OcclusionBuffer::GetHeight() {
+	return height;
+}
@@ -0,0 +1,113 @@
+/**
+*	Filename: occlusionbuffer.h
+*
+*	Description: Header file for OcclusionBuffer class, a low resolution software depth buffer that occluders are rasterized into
+*				 and that the bounds of other objects are tested against
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef OCCLUSIONBUFFER_H
+#define OCCLUSIONBUFFER_H
+#include <vector>
+#include <glm/glm.hpp>
+
+#define OCCLUSION_WIDTH 256 // Width of the depth buffer in pixels, must be a multiple of OCCLUSION_TILE_SIZE
+#define OCCLUSION_HEIGHT 144 // Height of the depth buffer in pixels, must be a multiple of OCCLUSION_TILE_SIZE
+#define OCCLUSION_TILE_SIZE 8 // Width and height of a tile, every tile stores the farthest depth of its pixels
+
+/**
+* A occluder triangle in buffer space, x and y in pixels and z the depth in [0, 1]
+*/
+struct OcclusionTriangle {
+	glm::vec3 vertices[3]; /// @brief The corners, counter clockwise
+	int minY, maxY; /// @brief Pixel rows covered by the triangle, inclusive
+};
+
+/**
+* Occluders are added on the calling thread, rasterizing is split in bands of tile rows that are spread over the job system.
+* After rasterizing every tile knows the farthest depth of its pixels, boxes are tested against those tiles only.
+* Nothing in here touches OpenGL, so the buffer can be used without a window.
+*/
+class OcclusionBuffer {
+private:
+	int width, height; /// @brief Size of the buffer in pixels
+	int tilesX, tilesY; /// @brief Size of the buffer in tiles
+	glm::mat4 viewProjection; /// @brief The view projection matrix of the camera
+	std::vector<float> depth; /// @brief Nearest depth of every pixel, row by row
+	std::vector<float> tileDepth; /// @brief Farthest depth of every tile, row by row
+	std::vector<OcclusionTriangle> triangles; /// @brief The occluder triangles to rasterize
+
+	/**
+	* Maps a clip space position to buffer space
+	*/
+	glm::vec3 ToBuffer(const glm::vec4& clip);
+
+	/**
+	* Adds a clip space triangle, clipped against the near plane
+	*/
+	void AddClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+
+	/**
+	* Rasterizes a triangle into the pixel rows [firstRow, lastRow)
+	*/
+	void RasterizeTriangle(const OcclusionTriangle& triangle, int firstRow, int lastRow);
+public:
+	/**
+	* Constructor
+	*/
+	OcclusionBuffer(int width = OCCLUSION_WIDTH, int height = OCCLUSION_HEIGHT);
+
+	/**
+	* Sets the camera and removes all occluders, the depth buffer is cleared by Rasterize
+	*/
+	void Begin(const glm::mat4& viewProjection);
+
+	/**
+	* Adds a occluder mesh, positions are in model space and every 3 indices form a triangle
+	*/
+	void AddOccluder(const glm::mat4& world, const std::vector<glm::vec3>& positions, const std::vector<unsigned>& indices);
+
+	/**
+	* Clears and rasterizes the tile rows [firstTileRow, lastTileRow), different ranges can run at the same time
+	*/
+	void RasterizeTileRows(int firstTileRow, int lastTileRow);
+
+	/**
+	* Rasterizes all occluders spread over the job system
+	*/
+	void Rasterize();
+
+	/**
+	* Returns false if the world space box is fully behind the occluders. Must be called after rasterizing
+	*/
+	bool IsVisible(const glm::vec3& min, const glm::vec3& max);
+
+	/**
+	* Returns the depth of a pixel, 1 if no occluder covers it
+	*/
+	float GetDepth(int x, int y);
+
+	/**
+	* Returns the farthest depth of a tile
+	*/
+	float GetTileDepth(int tileX, int tileY);
+
+	/**
+	* Returns the amount of occluder triangles after clipping
+	*/
+	size_t GetTriangleCount();
+
+	/**
+	* Returns the width in pixels
+	*/
+	int GetWidth();
+
+	/**
+	* Returns the height in pixels
+	*/
+	int GetHeight();
+};
+
+#endif // !OCCLUSIONBUFFER_H
@@ -0,0 +1,417 @@
+/**
+*	Filename: pixelconverter.cpp
+*
+*	Description: Source file for PixelConverter class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include "pixelconverter.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define PIXEL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PIXEL_TARGET_SSSE3
+#define PIXEL_TARGET_AVX2
+#else
+#define PIXEL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define PIXEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+//Packs the color of a pixel into the little endian layout of a 4 byte pixel, alpha is 0 for 3 byte pixels
+static uint32_t PackColor(const unsigned char* color, unsigned bytesPerPixel) {
+	return (uint32_t)color[0] | ((uint32_t)color[1] << 8) | ((uint32_t)color[2] << 16) | (bytesPerPixel == 4 ? (uint32_t)color[3] << 24 : 0u);
+}
+
+static void SwapScalar(unsigned char* pixels, size_t count, unsigned bytesPerPixel) {
+	for (size_t i = 0; i < count; i++, pixels += bytesPerPixel) {
+		unsigned char first = pixels[0];
+		pixels[0] = pixels[2];
+		pixels[2] = first;
+	}
+}
+
+static void FillScalar(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	for (size_t i = 0; i < count; i++, pixels += bytesPerPixel) {
+		memcpy(pixels, color, bytesPerPixel);
+	}
+}
+
+static void TintScalar(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	for (size_t i = 0; i < count; i++, pixels += bytesPerPixel) {
+		if (pixels[0] == 0 && pixels[1] == 0 && pixels[2] == 0) continue; // Black pixels are kept
+		memcpy(pixels, color, bytesPerPixel);
+	}
+}
+
+#ifdef PIXEL_X86
+PIXEL_TARGET_SSSE3
+static void SwapSSSE3(unsigned char* pixels, size_t count, unsigned bytesPerPixel) {
+	size_t size = count * bytesPerPixel;
+	size_t i = 0;
+
+	if (bytesPerPixel == 4) {
+		const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		for (; i + 16 <= size; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(pixels + i));
+			_mm_storeu_si128((__m128i*)(pixels + i), _mm_shuffle_epi8(v, shuffle));
+		}
+	}
+	else {
+		//16 pixels in 3 registers, every output register gathers its bytes from the input registers it overlaps
+		alignas(16) signed char masks[3][3][16];
+		for (int j = 0; j < 48; j++) {
+			int from = j / 3 * 3 + 2 - j % 3;
+			for (int r = 0; r < 3; r++) masks[j / 16][r][j % 16] = from / 16 == r ? (signed char)(from % 16) : -128;
+		}
+		const __m128i m00 = _mm_load_si128((const __m128i*)masks[0][0]), m01 = _mm_load_si128((const __m128i*)masks[0][1]);
+		const __m128i m10 = _mm_load_si128((const __m128i*)masks[1][0]), m11 = _mm_load_si128((const __m128i*)masks[1][1]), m12 = _mm_load_si128((const __m128i*)masks[1][2]);
+		const __m128i m21 = _mm_load_si128((const __m128i*)masks[2][1]), m22 = _mm_load_si128((const __m128i*)masks[2][2]);
+		for (; i + 48 <= size; i += 48) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(pixels + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(pixels + i + 16));
+			__m128i c = _mm_loadu_si128((const __m128i*)(pixels + i + 32));
+			_mm_storeu_si128((__m128i*)(pixels + i), _mm_or_si128(_mm_shuffle_epi8(a, m00), _mm_shuffle_epi8(b, m01)));
+			_mm_storeu_si128((__m128i*)(pixels + i + 16), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m10), _mm_shuffle_epi8(b, m11)), _mm_shuffle_epi8(c, m12)));
+			_mm_storeu_si128((__m128i*)(pixels + i + 32), _mm_or_si128(_mm_shuffle_epi8(b, m21), _mm_shuffle_epi8(c, m22)));
+		}
+	}
+
+	SwapScalar(pixels + i, (size - i) / bytesPerPixel, bytesPerPixel); // Remaining pixels
+}
+
+PIXEL_TARGET_SSSE3
+static void FillSSSE3(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	size_t size = count * bytesPerPixel;
+	size_t i = 0;
+
+	if (bytesPerPixel == 4) {
+		const __m128i v = _mm_set1_epi32((int)PackColor(color, 4));
+		for (; i + 16 <= size; i += 16) {
+			_mm_storeu_si128((__m128i*)(pixels + i), v);
+		}
+	}
+	else {
+		//16 pixels repeat every 3 registers
+		unsigned char pattern[48];
+		FillScalar(pattern, 16, 3, color);
+		const __m128i a = _mm_loadu_si128((const __m128i*)pattern);
+		const __m128i b = _mm_loadu_si128((const __m128i*)(pattern + 16));
+		const __m128i c = _mm_loadu_si128((const __m128i*)(pattern + 32));
+		for (; i + 48 <= size; i += 48) {
+			_mm_storeu_si128((__m128i*)(pixels + i), a);
+			_mm_storeu_si128((__m128i*)(pixels + i + 16), b);
+			_mm_storeu_si128((__m128i*)(pixels + i + 32), c);
+		}
+	}
+
+	FillScalar(pixels + i, (size - i) / bytesPerPixel, bytesPerPixel, color); // Remaining pixels
+}
+
+PIXEL_TARGET_SSSE3
+static void TintSSSE3(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	size_t size = count * bytesPerPixel;
+	size_t i = 0;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i tint = _mm_set1_epi32((int)PackColor(color, bytesPerPixel));
+
+	if (bytesPerPixel == 4) {
+		const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+		for (; i + 16 <= size; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(pixels + i));
+			__m128i black = _mm_cmpeq_epi32(_mm_and_si128(v, rgb), zero);
+			v = _mm_or_si128(_mm_and_si128(black, v), _mm_andnot_si128(black, tint));
+			_mm_storeu_si128((__m128i*)(pixels + i), v);
+		}
+	}
+	else {
+		//16 pixels in 3 registers, every group of 4 pixels is spread over 4 byte lanes, tinted and packed again
+		const __m128i expand = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+		const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128);
+		for (; i + 48 <= size; i += 48) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(pixels + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(pixels + i + 16));
+			__m128i c = _mm_loadu_si128((const __m128i*)(pixels + i + 32));
+			__m128i groups[4] = { a, _mm_alignr_epi8(b, a, 12), _mm_alignr_epi8(c, b, 8), _mm_srli_si128(c, 4) };
+
+			for (int g = 0; g < 4; g++) {
+				__m128i spread = _mm_shuffle_epi8(groups[g], expand);
+				__m128i black = _mm_cmpeq_epi32(spread, zero);
+				spread = _mm_or_si128(_mm_and_si128(black, spread), _mm_andnot_si128(black, tint));
+				groups[g] = _mm_shuffle_epi8(spread, pack); // 12 bytes, the last 4 are 0
+			}
+
+			_mm_storeu_si128((__m128i*)(pixels + i), _mm_or_si128(groups[0], _mm_slli_si128(groups[1], 12)));
+			_mm_storeu_si128((__m128i*)(pixels + i + 16), _mm_or_si128(_mm_srli_si128(groups[1], 4), _mm_slli_si128(groups[2], 8)));
+			_mm_storeu_si128((__m128i*)(pixels + i + 32), _mm_or_si128(_mm_srli_si128(groups[2], 8), _mm_slli_si128(groups[3], 4)));
+		}
+	}
+
+	TintScalar(pixels + i, (size - i) / bytesPerPixel, bytesPerPixel, color); // Remaining pixels
+}
+
+PIXEL_TARGET_AVX2
+static void SwapAVX2(unsigned char* pixels, size_t count, unsigned bytesPerPixel) {
+	size_t size = count * bytesPerPixel;
+	size_t i = 0;
+
+	if (bytesPerPixel == 4) {
+		const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		for (; i + 32 <= size; i += 32) {
+			__m256i v = _mm256_loadu_si256((const __m256i*)(pixels + i));
+			_mm256_storeu_si256((__m256i*)(pixels + i), _mm256_shuffle_epi8(v, shuffle));
+		}
+	}
+	else {
+		SwapSSSE3(pixels, count, bytesPerPixel); // 3 byte pixels cross the 16 byte lanes the 32 byte shuffle is limited to
+		return;
+	}
+
+	SwapScalar(pixels + i, (size - i) / bytesPerPixel, bytesPerPixel); // Remaining pixels
+}
+
+PIXEL_TARGET_AVX2
+static void FillAVX2(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	size_t size = count * bytesPerPixel;
+	size_t i = 0;
+
+	if (bytesPerPixel == 4) {
+		const __m256i v = _mm256_set1_epi32((int)PackColor(color, 4));
+		for (; i + 32 <= size; i += 32) {
+			_mm256_storeu_si256((__m256i*)(pixels + i), v);
+		}
+	}
+	else {
+		//32 pixels repeat every 3 registers
+		unsigned char pattern[96];
+		FillScalar(pattern, 32, 3, color);
+		const __m256i a = _mm256_loadu_si256((const __m256i*)pattern);
+		const __m256i b = _mm256_loadu_si256((const __m256i*)(pattern + 32));
+		const __m256i c = _mm256_loadu_si256((const __m256i*)(pattern + 64));
+		for (; i + 96 <= size; i += 96) {
+			_mm256_storeu_si256((__m256i*)(pixels + i), a);
+			_mm256_storeu_si256((__m256i*)(pixels + i + 32), b);
+			_mm256_storeu_si256((__m256i*)(pixels + i + 64), c);
+		}
+	}
+
+	FillScalar(pixels + i, (size - i) / bytesPerPixel, bytesPerPixel, color); // Remaining pixels
+}
+
+PIXEL_TARGET_AVX2
+static void TintAVX2(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	size_t size = count * bytesPerPixel;
+	size_t i = 0;
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i tint = _mm256_set1_epi32((int)PackColor(color, bytesPerPixel));
+
+	if (bytesPerPixel == 4) {
+		const __m256i rgb = _mm256_set1_epi32(0x00FFFFFF);
+		for (; i + 32 <= size; i += 32) {
+			__m256i v = _mm256_loadu_si256((const __m256i*)(pixels + i));
+			__m256i black = _mm256_cmpeq_epi32(_mm256_and_si256(v, rgb), zero);
+			v = _mm256_blendv_epi8(tint, v, black);
+			_mm256_storeu_si256((__m256i*)(pixels + i), v);
+		}
+	}
+	else {
+		TintSSSE3(pixels, count, bytesPerPixel, color); // 3 byte pixels cross the 16 byte lanes the 32 byte shuffle is limited to
+		return;
+	}
+
+	TintScalar(pixels + i, (size - i) / bytesPerPixel, bytesPerPixel, color); // Remaining pixels
+}
+
+//Returns true if the cpu supports ssse3 (ssse3) or avx2 with the os saving the ymm registers (avx2)
+static bool CpuSupports(bool avx2) {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	if (!avx2) return (info[2] & (1 << 9)) != 0;
+
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || maxLeaf < 7) return false;
+	if ((_xgetbv(0) & 6) != 6) return false; // The os does not save the xmm and ymm registers
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	if (!avx2) return __builtin_cpu_supports("ssse3") != 0;
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+//Returns the best kernel supported by the cpu
+static PixelKernel DetectKernel() {
+#ifdef PIXEL_X86
+	if (CpuSupports(true)) return AVX2PixelKernel;
+	if (CpuSupports(false)) return SSSE3PixelKernel;
+#endif
+	return ScalarPixelKernel;
+}
+
+PixelKernel PixelConverter::_kernel = DetectKernel(); // Declare static member, chosen once at startup
+
+void PixelConverter::SwapRedBlue(unsigned char* pixels, size_t count, unsigned bytesPerPixel) {
+	SwapRedBlue(_kernel, pixels, count, bytesPerPixel);
+}
+
+void PixelConverter::SwapRedBlue(PixelKernel kernel, unsigned char* pixels, size_t count, unsigned bytesPerPixel) {
+	switch (kernel) {
+#ifdef PIXEL_X86
+	case AVX2PixelKernel:
+		SwapAVX2(pixels, count, bytesPerPixel);
+		break;
+	case SSSE3PixelKernel:
+		SwapSSSE3(pixels, count, bytesPerPixel);
+		break;
+#endif
+	default:
+		SwapScalar(pixels, count, bytesPerPixel);
+		break;
+	}
+}
+
+void PixelConverter::Fill(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	Fill(_kernel, pixels, count, bytesPerPixel, color);
+}
+
+void PixelConverter::Fill(PixelKernel kernel, unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	switch (kernel) {
+#ifdef PIXEL_X86
+	case AVX2PixelKernel:
+		FillAVX2(pixels, count, bytesPerPixel, color);
+		break;
+	case SSSE3PixelKernel:
+		FillSSSE3(pixels, count, bytesPerPixel, color);
+		break;
+#endif
+	default:
+		FillScalar(pixels, count, bytesPerPixel, color);
+		break;
+	}
+}
+
+void PixelConverter::Tint(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	Tint(_kernel, pixels, count, bytesPerPixel, color);
+}
+
+void PixelConverter::Tint(PixelKernel kernel, unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	switch (kernel) {
+#ifdef PIXEL_X86
+	case AVX2PixelKernel:
+		TintAVX2(pixels, count, bytesPerPixel, color);
+		break;
+	case SSSE3PixelKernel:
+		TintSSSE3(pixels, count, bytesPerPixel, color);
+		break;
+#endif
+	default:
+		TintScalar(pixels, count, bytesPerPixel, color);
+		break;
+	}
+}
+
+bool PixelConverter::IsSupported(PixelKernel kernel) {
+	switch (kernel) {
+	case ScalarPixelKernel:
+		return true;
+#ifdef PIXEL_X86
+	case SSSE3PixelKernel:
+		return CpuSupports(false);
+	case AVX2PixelKernel:
+		return CpuSupports(true);
+#endif
+	default:
+		return false;
+	}
+}
+
+bool PixelConverter::SetKernel(PixelKernel kernel) {
+	if (!IsSupported(kernel)) return false;
+	_kernel = kernel;
+	return true;
+}
+
+PixelKernel PixelConverter::GetKernel() {
+	return _kernel;
+}
+
+const char* PixelConverter::GetKernelName(PixelKernel kernel) {
+	switch (kernel) {
+	case ScalarPixelKernel: return "Scalar";
+	case SSSE3PixelKernel: return "SSSE3";
+	case AVX2PixelKernel: return "AVX2";
+	default: return "Unknown";
+	}
+}
+
+std::string PixelConverter::Benchmark(size_t size) {
+	//Random pixels, a quarter of them black so the tint keeps some
+	std::mt19937 random(1337);
+	size_t count = size * size;
+	std::vector<unsigned char> source(count * 4);
+	for (size_t i = 0; i < source.size(); i++) {
+		source[i] = (unsigned char)random();
+	}
+	for (size_t i = 0; i < count; i += 4) {
+		memset(&source[i * 3], 0, 3); // Black in the RGB image
+		memset(&source[i * 4], 0, 3); // Black in the RGBA image
+	}
+
+	const unsigned char color[4] = { 255, 128, 64, 200 };
+	std::stringstream report;
+	report << "Converting " << size << "x" << size << " pixels" << std::endl;
+
+	for (unsigned bytesPerPixel = 3; bytesPerPixel <= 4; bytesPerPixel++) {
+		size_t bytes = count * bytesPerPixel;
+		std::vector<unsigned char> expected[3]; // Scalar results of the swizzle, fill and tint
+		std::vector<unsigned char> pixels(bytes);
+
+		for (int k = 0; k < PixelKernelCount; k++) {
+			PixelKernel kernel = (PixelKernel)k;
+			if (!IsSupported(kernel)) continue;
+
+			//Best of a few runs, the first run also warms up the caches
+			double times[3] = { 1e9, 1e9, 1e9 };
+			bool matches = true;
+			for (int test = 0; test < 3; test++) {
+				for (int run = 0; run < 5; run++) {
+					memcpy(pixels.data(), source.data(), bytes);
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+					if (test == 0) SwapRedBlue(kernel, pixels.data(), count, bytesPerPixel);
+					else if (test == 1) Fill(kernel, pixels.data(), count, bytesPerPixel, color);
+					else Tint(kernel, pixels.data(), count, bytesPerPixel, color);
+					std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+					times[test] = std::min(times[test], std::chrono::duration<double, std::milli>(end - start).count());
+				}
+
+				if (kernel == ScalarPixelKernel) expected[test] = pixels;
+				else matches = matches && pixels == expected[test];
+			}
+
+			report << (bytesPerPixel == 3 ? "RGB " : "RGBA ") << GetKernelName(kernel) << ": swizzle " << times[0] << " ms, fill " << times[1]
+				<< " ms, tint " << times[2] << " ms" << (matches ? "" : ", does not match scalar") << std::endl;
+		}
+	}
+
+	return report.str();
+}
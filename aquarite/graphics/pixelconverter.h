@@ -0,0 +1,91 @@
+/**
+*	Filename: pixelconverter.h
+*
+*	Description: Header file for PixelConverter class, swizzles, fills and tints RGB and RGBA pixels 16 or 32 bytes at a time
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef PIXELCONVERTER_H
+#define PIXELCONVERTER_H
+#include <string>
+#include <cstddef>
+
+#define PIXEL_BENCHMARK_SIZE 2048 // Width and height of the images converted by the benchmark
+
+/**
+* The kernels the converter can use, the best one supported by the cpu is chosen at runtime
+*/
+enum PixelKernel {
+	ScalarPixelKernel,
+	SSSE3PixelKernel,
+	AVX2PixelKernel,
+	PixelKernelCount
+};
+
+/**
+* Pixels are tightly packed with 3 or 4 bytes per pixel. The vector kernels convert whole registers and finish the
+* remaining pixels with the scalar kernel, 3 byte pixels are converted 16 at a time from 3 registers.
+*/
+class PixelConverter {
+private:
+	static PixelKernel _kernel; /// @brief The kernel used by the conversions
+public:
+	/**
+	* Swaps the first and third channel of every pixel, converts BGR(A) to RGB(A) and back
+	*/
+	static void SwapRedBlue(unsigned char* pixels, size_t count, unsigned bytesPerPixel);
+
+	/**
+	* Swaps the first and third channel of every pixel with a specific kernel, the kernel must be supported
+	*/
+	static void SwapRedBlue(PixelKernel kernel, unsigned char* pixels, size_t count, unsigned bytesPerPixel);
+
+	/**
+	* Sets every pixel to color, the first bytesPerPixel bytes of color are used
+	*/
+	static void Fill(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color);
+
+	/**
+	* Sets every pixel to color with a specific kernel, the kernel must be supported
+	*/
+	static void Fill(PixelKernel kernel, unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color);
+
+	/**
+	* Sets every pixel that is not black to color, the alpha of a black pixel is kept as well
+	*/
+	static void Tint(unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color);
+
+	/**
+	* Tints every pixel with a specific kernel, the kernel must be supported
+	*/
+	static void Tint(PixelKernel kernel, unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color);
+
+	/**
+	* Returns true if the cpu supports the kernel
+	*/
+	static bool IsSupported(PixelKernel kernel);
+
+	/**
+	* Sets the kernel used by the conversions, returns false if the cpu does not support it
+	*/
+	static bool SetKernel(PixelKernel kernel);
+
+	/**
+	* Returns the kernel used by the conversions
+	*/
+	static PixelKernel GetKernel();
+
+	/**
+	* Returns the name of a kernel
+	*/
+	static const char* GetKernelName(PixelKernel kernel);
+
+	/**
+	* Converts a size x size RGB and RGBA image with every supported kernel and returns the timings
+	*/
+	static std::string Benchmark(size_t size = PIXEL_BENCHMARK_SIZE);
+};
+
+#endif // !PIXELCONVERTER_H
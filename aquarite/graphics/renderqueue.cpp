@@ -0,0 +1,115 @@
+/**
+*	Filename: renderqueue.cpp
+*
+*	Description: Source file for RenderQueue class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "renderqueue.h"
+
+uint64_t RenderQueue::MakeKey(int pass, unsigned program, unsigned material, unsigned vao, float depth) {
+	//Clamp and quantize the depth
+	if (depth < 0.0f) depth = 0.0f;
+	if (depth > 1.0f) depth = 1.0f;
+	uint64_t depthBits = (uint64_t)(depth * (float)((1 << RENDERKEY_DEPTH_BITS) - 1));
+
+	uint64_t state = 0;
+	state |= (uint64_t)(program & ((1 << RENDERKEY_PROGRAM_BITS) - 1)) << (RENDERKEY_MATERIAL_BITS + RENDERKEY_VAO_BITS);
+	state |= (uint64_t)(material & ((1 << RENDERKEY_MATERIAL_BITS) - 1)) << RENDERKEY_VAO_BITS;
+	state |= (uint64_t)(vao & ((1 << RENDERKEY_VAO_BITS) - 1));
+
+	const int stateBits = RENDERKEY_PROGRAM_BITS + RENDERKEY_MATERIAL_BITS + RENDERKEY_VAO_BITS;
+	const int unusedBits = 63 - stateBits - RENDERKEY_DEPTH_BITS;
+
+	uint64_t key = (uint64_t)(pass != 0) << 63;
+
+	if (pass == 0) {
+		//Opaque, group by state first then draw front to back to make use of early depth testing
+		key |= state << (RENDERKEY_DEPTH_BITS + unusedBits);
+		key |= depthBits << unusedBits;
+	}
+	else {
+		//Transparent, depth has to come first, inverted so the farthest objects are drawn first
+		uint64_t invertedDepth = ((1 << RENDERKEY_DEPTH_BITS) - 1) - depthBits;
+		key |= invertedDepth << (stateBits + unusedBits);
+		key |= state << unusedBits;
+	}
+
+	return key;
+}
+
+int RenderQueue::GetPass(uint64_t key) {
+	return (int)(key >> 63);
+}
+
+void RenderQueue::Clear() {
+	commands.clear();
+}
+
+void RenderQueue::Push(uint64_t key, Entity* entity, Mesh* mesh, int meshIndex, unsigned transformIndex) {
+	RenderCommand command;
+	command.key = key;
+	command.entity = entity;
+	command.mesh = mesh;
+	command.meshIndex = meshIndex;
+	command.transformIndex = transformIndex;
+	commands.push_back(command);
+}
+
+void RenderQueue::Sort() {
+	size_t count = commands.size();
+	if (count < 2) return;
+
+	sortBuffer.resize(count);
+
+	//Build histograms for all 8 bytes in a single pass over the keys
+	size_t histograms[8][256] = {};
+	for (size_t i = 0; i < count; i++) {
+		uint64_t key = commands[i].key;
+		for (int b = 0; b < 8; b++) {
+			histograms[b][(key >> (b * 8)) & 0xFF]++;
+		}
+	}
+
+	RenderCommand* source = commands.data();
+	RenderCommand* destination = sortBuffer.data();
+
+	for (int b = 0; b < 8; b++) {
+		size_t* histogram = histograms[b];
+
+		//If all keys share this byte the pass would not change the order, so we skip it
+		if (histogram[(source[0].key >> (b * 8)) & 0xFF] == count) continue;
+
+		//Convert counts to offsets
+		size_t offset = 0;
+		for (int n = 0; n < 256; n++) {
+			size_t amount = histogram[n];
+			histogram[n] = offset;
+			offset += amount;
+		}
+
+		//Scatter, this is stable so the order of earlier passes is kept
+		for (size_t i = 0; i < count; i++) {
+			destination[histogram[(source[i].key >> (b * 8)) & 0xFF]++] = source[i];
+		}
+
+		RenderCommand* temp = source;
+		source = destination;
+		destination = temp;
+	}
+
+	//If the sorted data ended up in the scratch buffer, swap it into place
+	if (source != commands.data()) {
+		commands.swap(sortBuffer);
+	}
+}
+
+size_t RenderQueue::Size() {
+	return commands.size();
+}
+
+RenderCommand& RenderQueue::Get(size_t index) {
+	return commands[index];
+}
\ No newline at end of file
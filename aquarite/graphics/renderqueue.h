@@ -0,0 +1,84 @@
+/**
+*	Filename: renderqueue.h
+*
+*	Description: Header file for RenderQueue class, draw commands are sorted on a packed 64 bit key
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Forward declarations
+class Entity;
+class Mesh;
+
+/**
+* Bit layout of a render key, most significant bits first:
+* Default pass: [pass:1][program:10][material:12][vao:12][depth:24][unused:5]
+* Late pass:    [pass:1][inverted depth:24][program:10][material:12][vao:12][unused:5]
+* Default draws are grouped by state and then drawn front to back, late draws are drawn back to front.
+*/
+#define RENDERKEY_PROGRAM_BITS 10
+#define RENDERKEY_MATERIAL_BITS 12
+#define RENDERKEY_VAO_BITS 12
+#define RENDERKEY_DEPTH_BITS 24
+
+/**
+* A single draw, one mesh/material pair of a entity's model
+*/
+struct RenderCommand {
+	uint64_t key; /// @brief The sort key of the command
+	Entity* entity; /// @brief The entity to be drawn
+	Mesh* mesh; /// @brief The mesh to be drawn, the lod level of the mesh at meshIndex
+	int meshIndex; /// @brief The index of the mesh and material on the entity's model
+	unsigned transformIndex; /// @brief Index of the entity's world matrix, kept by the renderer for the current frame
+};
+
+class RenderQueue {
+private:
+	std::vector<RenderCommand> commands; /// @brief The commands to be drawn, will reset each frame
+	std::vector<RenderCommand> sortBuffer; /// @brief Scratch buffer for the radix sort, kept to avoid allocating each frame
+public:
+	/**
+	* Packs the draw state into a sort key, depth should be normalized between 0 and 1.
+	* Values that do not fit their bit range wrap, this only affects grouping and not the correctness of the draw.
+	*/
+	static uint64_t MakeKey(int pass, unsigned program, unsigned material, unsigned vao, float depth);
+
+	/**
+	* Returns the pass stored in the key
+	*/
+	static int GetPass(uint64_t key);
+
+	/**
+	* Removes all commands from the queue
+	*/
+	void Clear();
+
+	/**
+	* Adds a command to the queue
+	*/
+	void Push(uint64_t key, Entity* entity, Mesh* mesh, int meshIndex, unsigned transformIndex);
+
+	/**
+	* Sorts the queue on key, using a 8 bit LSD radix sort. Passes where all keys share the same byte are skipped.
+	*/
+	void Sort();
+
+	/**
+	* Returns the amount of commands in the queue
+	*/
+	size_t Size();
+
+	/**
+	* Returns the command where index matches
+	*/
+	RenderCommand& Get(size_t index);
+};
+
+#endif // !RENDERQUEUE_H
\ No newline at end of file
@@ -13,6 +13,8 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
 
 std::string Shader::LoadShaderFile(std::string shaderPath) {
 	std::string buildPath = Core::GetBuildDirectory();
@@ -92,16 +94,105 @@ bool Shader::LoadShader(std::string vertexShaderPath, std::string fragmentShader
 		return 1;
 	}
 
-	this->_vertexShaderPath = vertexShader;
+	this->_vertexShaderPath = vertexShaderPath;
 	this->_fragmentShaderPath = fragmentShaderPath;
 
 	//Cleanup
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
 
+	this->BindUniformBlocks();
+	this->ReflectUniforms();
+
 	return 0;
 }
 
+void Shader::BindUniformBlocks() {
+	struct UniformBlockBinding { const char* name; GLuint binding; };
+	static const UniformBlockBinding bindings[] = {
+		{ UNIFORMBLOCK_LIGHTS, UNIFORMBLOCK_LIGHTS_BINDING }
+	};
+
+	for (size_t i = 0; i < sizeof(bindings) / sizeof(bindings[0]); i++) {
+		GLuint blockIndex = glGetUniformBlockIndex(_shaderProgram, bindings[i].name);
+		if (blockIndex == GL_INVALID_INDEX) continue; // Program does not declare this block
+
+		glUniformBlockBinding(_shaderProgram, blockIndex, bindings[i].binding);
+	}
+}
+
+void Shader::ReflectUniforms() {
+	_uniforms.clear();
+
+	GLint uniformCount = 0;
+	glGetProgramiv(_shaderProgram, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+	char nameBuffer[256];
+	for (GLint i = 0; i < uniformCount; i++) {
+		GLsizei nameLength = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(_shaderProgram, (GLuint)i, sizeof(nameBuffer), &nameLength, &size, &type, nameBuffer);
+
+		std::string name(nameBuffer, nameLength);
+
+		//Uniforms inside a uniform block have no location
+		GLint location = glGetUniformLocation(_shaderProgram, name.c_str());
+		if (location == -1) continue;
+
+		//Arrays of basic types are reported once as "name[0]", we add a entry for every element
+		size_t bracket = name.rfind("[0]");
+		bool isArray = size > 1 && bracket != std::string::npos && bracket + 3 == name.length();
+		std::string baseName = isArray ? name.substr(0, bracket) : name;
+
+		for (GLint element = 0; element < (isArray ? size : 1); element++) {
+			ShaderUniform uniform;
+			uniform.name = isArray ? baseName + "[" + std::to_string(element) + "]" : name;
+			uniform.location = element == 0 ? location : glGetUniformLocation(_shaderProgram, uniform.name.c_str());
+			uniform.type = type;
+			uniform.hasValue = false;
+			_uniforms.push_back(uniform);
+		}
+	}
+
+	//Resolve all handles given out against the new table
+	for (size_t i = 0; i < _handleNames.size(); i++) {
+		_handleSlots[i] = this->FindUniformSlot(_handleNames[i]);
+	}
+}
+
+int Shader::FindUniformSlot(const std::string& uniformName) {
+	for (size_t i = 0; i < _uniforms.size(); i++) {
+		if (_uniforms[i].name == uniformName) {
+			return (int)i;
+		}
+	}
+
+	//The base name of a array refers to the first element, same as in GLSL
+	std::string firstElement = uniformName + "[0]";
+	for (size_t i = 0; i < _uniforms.size(); i++) {
+		if (_uniforms[i].name == firstElement) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+ShaderUniform* Shader::UniformForUpload(UniformHandle handle, const void* value, size_t size) {
+	if (handle < 0 || handle >= (int)_handleSlots.size() || _handleSlots[handle] == -1) {
+		return nullptr;
+	}
+
+	ShaderUniform* uniform = &_uniforms[_handleSlots[handle]];
+	if (uniform->hasValue && memcmp(uniform->value, value, size) == 0) {
+		return nullptr; // Same as the last upload
+	}
+
+	memcpy(uniform->value, value, size);
+	uniform->hasValue = true;
+	return uniform;
+}
+
 Shader::Shader(std::string vertexShaderPath, std::string fragmentShaderPath) {
 	if (this->LoadShader(vertexShaderPath, fragmentShaderPath) != 0) {
 		Debug::Log("Failed to create shader program...", typeid(*this).name());
@@ -118,11 +209,74 @@ void Shader::Recompile() {
 
 	glDeleteProgram(this->_shaderProgram); // Delete shader program
 	
-	if (this->LoadShader(this->_vertexShaderPath, this->_fragmentShaderPath) == 0) {
+	//LoadShader reflects the uniforms of the new program and re-resolves all handles
+	if (this->LoadShader(this->_vertexShaderPath, this->_fragmentShaderPath) != 0) {
 		Debug::Log("Failed to recompile Shader Program", typeid(*this).name());
 	}
 }
 
 unsigned int Shader::GetShaderProgram() {
 	return this->_shaderProgram;
+}
+
+UniformHandle Shader::Uniform(const std::string& uniformName) {
+	std::unordered_map<std::string, UniformHandle>::iterator it = _handleLookup.find(uniformName);
+	if (it != _handleLookup.end()) {
+		return it->second;
+	}
+
+	//New handle, resolve it against the current table
+	UniformHandle handle = (UniformHandle)_handleNames.size();
+	_handleNames.push_back(uniformName);
+	_handleSlots.push_back(this->FindUniformSlot(uniformName));
+	_handleLookup[uniformName] = handle;
+	return handle;
+}
+
+bool Shader::HasUniform(UniformHandle handle) {
+	return handle >= 0 && handle < (int)_handleSlots.size() && _handleSlots[handle] != -1;
+}
+
+void Shader::SetBool(UniformHandle handle, bool value) {
+	SetInt(handle, (int)value);
+}
+
+void Shader::SetInt(UniformHandle handle, int value) {
+	ShaderUniform* uniform = UniformForUpload(handle, &value, sizeof(int));
+	if (uniform) glUniform1i(uniform->location, value);
+}
+
+void Shader::SetFloat(UniformHandle handle, float value) {
+	ShaderUniform* uniform = UniformForUpload(handle, &value, sizeof(float));
+	if (uniform) glUniform1f(uniform->location, value);
+}
+
+void Shader::SetVec2(UniformHandle handle, const glm::vec2& value) {
+	ShaderUniform* uniform = UniformForUpload(handle, glm::value_ptr(value), sizeof(glm::vec2));
+	if (uniform) glUniform2fv(uniform->location, 1, glm::value_ptr(value));
+}
+
+void Shader::SetVec3(UniformHandle handle, const glm::vec3& value) {
+	ShaderUniform* uniform = UniformForUpload(handle, glm::value_ptr(value), sizeof(glm::vec3));
+	if (uniform) glUniform3fv(uniform->location, 1, glm::value_ptr(value));
+}
+
+void Shader::SetVec4(UniformHandle handle, const glm::vec4& value) {
+	ShaderUniform* uniform = UniformForUpload(handle, glm::value_ptr(value), sizeof(glm::vec4));
+	if (uniform) glUniform4fv(uniform->location, 1, glm::value_ptr(value));
+}
+
+void Shader::SetMat2(UniformHandle handle, const glm::mat2& value) {
+	ShaderUniform* uniform = UniformForUpload(handle, glm::value_ptr(value), sizeof(glm::mat2));
+	if (uniform) glUniformMatrix2fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::SetMat3(UniformHandle handle, const glm::mat3& value) {
+	ShaderUniform* uniform = UniformForUpload(handle, glm::value_ptr(value), sizeof(glm::mat3));
+	if (uniform) glUniformMatrix3fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::SetMat4(UniformHandle handle, const glm::mat4& value) {
+	ShaderUniform* uniform = UniformForUpload(handle, glm::value_ptr(value), sizeof(glm::mat4));
+	if (uniform) glUniformMatrix4fv(uniform->location, 1, GL_FALSE, glm::value_ptr(value));
 }
\ No newline at end of file
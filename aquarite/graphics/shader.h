@@ -12,6 +12,31 @@
 #include "glm/glm.hpp"
 #include "GL/glew.h"
 #include <string>
+#include <vector>
+#include <unordered_map>
+
+/**
+* Handle to a uniform of a shader, handles are resolved once and stay valid when the shader is recompiled
+*/
+typedef int UniformHandle;
+#define INVALID_UNIFORM_HANDLE -1
+
+/**
+* Fixed uniform block binding points, every program declaring one of these blocks gets it bound when linked
+*/
+#define UNIFORMBLOCK_LIGHTS "Lights"
+#define UNIFORMBLOCK_LIGHTS_BINDING 0
+
+/**
+* A active uniform of the shader program, as reflected at link time
+*/
+struct ShaderUniform {
+	std::string name; /// @brief The name of the uniform, arrays of basic types get a entry per element
+	GLint location; /// @brief The location of the uniform in the program
+	GLenum type; /// @brief The OpenGL type of the uniform
+	float value[16]; /// @brief The last uploaded value, ints are stored bitwise
+	bool hasValue; /// @brief True if a value has been uploaded since linking
+};
 
 class Shader {
 private:
@@ -19,6 +44,11 @@ private:
 	std::string _vertexShaderPath; /// @brief the path to the vertex shader
 	std::string _fragmentShaderPath; /// @brief the path to the fragment shader
 
+	std::vector<ShaderUniform> _uniforms; /// @brief Flat table of all active uniforms, rebuild each time the program is linked
+	std::vector<std::string> _handleNames; /// @brief The uniform name of every handle given out
+	std::vector<int> _handleSlots; /// @brief Index in the uniform table for every handle, -1 if the uniform is not active
+	std::unordered_map<std::string, UniformHandle> _handleLookup; /// @brief Map from uniform name to handle, used by the string setters
+
 	/**
 	* Reads and returns the shader data
 	*/
@@ -29,6 +59,27 @@ private:
 	*/
 	bool LoadShader(std::string vertexShaderPath, std::string fragmentShaderPath);
 
+	/**
+	* Binds the uniform blocks declared by the program to their fixed binding points
+	*/
+	void BindUniformBlocks();
+
+	/**
+	* Reflects all active uniforms of the program into the uniform table, and resolves all handles given out
+	*/
+	void ReflectUniforms();
+
+	/**
+	* Returns the index in the uniform table where name matches, or -1 if the uniform is not active
+	*/
+	int FindUniformSlot(const std::string& uniformName);
+
+	/**
+	* Returns the uniform table entry if the value differs from the cached value, then caches the new value.
+	* Returns nullptr if the upload can be skipped.
+	*/
+	ShaderUniform* UniformForUpload(UniformHandle handle, const void* value, size_t size);
+
 public:
 	/**
 	* Constructor
@@ -41,46 +92,42 @@ public:
 	unsigned int GetShaderProgram();
 
 	/**
-	* Recompiles the shader program
+	* Recompiles the shader program, and rebuilds the uniform table
 	*/
 	void Recompile();
 
-	//Uniform setters
-	void SetBool(std::string uniformName, bool value) const {
-		glUniform1i(glGetUniformLocation(_shaderProgram, uniformName.c_str()), (int)value);
-	};
-
-	void SetInt(std::string uniformName, int value) const { 
-		glUniform1i(glGetUniformLocation(_shaderProgram, uniformName.c_str()), value);
-	}
-
-	void SetFloat(std::string uniformName, float value) const { 
-		glUniform1f(glGetUniformLocation(_shaderProgram, uniformName.c_str()), value);
-	}
-
-	void SetVec2(std::string uniformName, glm::vec2& value) const {
-		glUniform2f(glGetUniformLocation(_shaderProgram, uniformName.c_str()), value[0], value[1]);
-	}
-
-	void SetVec3(std::string uniformName, glm::vec3& value) const {
-		glUniform3f(glGetUniformLocation(_shaderProgram, uniformName.c_str()), value[0], value[1], value[2]);
-	}
-
-	void SetVec4(std::string uniformName, glm::vec4& value) const {
-		glUniform4f(glGetUniformLocation(_shaderProgram, uniformName.c_str()), value[0], value[1], value[2], value[3]);
-	}
-
-	void SetMat2(std::string uniformName, glm::mat2 value) const { 
-		glUniformMatrix2fv(glGetUniformLocation(_shaderProgram, uniformName.c_str()), 1, GL_FALSE, &value[0][0]);
-	}
-
-	void SetMat3(std::string uniformName, glm::mat3 value) const {
-		glUniformMatrix3fv(glGetUniformLocation(_shaderProgram, uniformName.c_str()), 1, GL_FALSE, &value[0][0]);
-	}
+	/**
+	* Returns a handle to the uniform, handles can be requested for uniforms that are not active,
+	* setting those is a no-op. Resolve handles once and keep them, looking up by name is not free.
+	*/
+	UniformHandle Uniform(const std::string& uniformName);
 
-	void SetMat4(std::string uniformName, glm::mat4 value) const {
-		glUniformMatrix4fv(glGetUniformLocation(_shaderProgram, uniformName.c_str()), 1, GL_FALSE, &value[0][0]);
-	}
+	/**
+	* Returns true if the handle refers to a active uniform
+	*/
+	bool HasUniform(UniformHandle handle);
+
+	//Uniform setters by handle, the program has to be bound. Values equal to the last upload are skipped.
+	void SetBool(UniformHandle handle, bool value);
+	void SetInt(UniformHandle handle, int value);
+	void SetFloat(UniformHandle handle, float value);
+	void SetVec2(UniformHandle handle, const glm::vec2& value);
+	void SetVec3(UniformHandle handle, const glm::vec3& value);
+	void SetVec4(UniformHandle handle, const glm::vec4& value);
+	void SetMat2(UniformHandle handle, const glm::mat2& value);
+	void SetMat3(UniformHandle handle, const glm::mat3& value);
+	void SetMat4(UniformHandle handle, const glm::mat4& value);
+
+	//Uniform setters by name, these resolve the handle first
+	void SetBool(const std::string& uniformName, bool value) { SetBool(Uniform(uniformName), value); }
+	void SetInt(const std::string& uniformName, int value) { SetInt(Uniform(uniformName), value); }
+	void SetFloat(const std::string& uniformName, float value) { SetFloat(Uniform(uniformName), value); }
+	void SetVec2(const std::string& uniformName, const glm::vec2& value) { SetVec2(Uniform(uniformName), value); }
+	void SetVec3(const std::string& uniformName, const glm::vec3& value) { SetVec3(Uniform(uniformName), value); }
+	void SetVec4(const std::string& uniformName, const glm::vec4& value) { SetVec4(Uniform(uniformName), value); }
+	void SetMat2(const std::string& uniformName, const glm::mat2& value) { SetMat2(Uniform(uniformName), value); }
+	void SetMat3(const std::string& uniformName, const glm::mat3& value) { SetMat3(Uniform(uniformName), value); }
+	void SetMat4(const std::string& uniformName, const glm::mat4& value) { SetMat4(Uniform(uniformName), value); }
 };
 
 #endif // !SHADER_H
@@ -0,0 +1,170 @@
+/**
+*	Filename: spritebatch.cpp
+*
+*	Description: Source file for SpriteBatch class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <GL/glew.h>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include "spritebatch.h"
+#include "shader.h"
+#include "../texture.h"
+
+SpriteBatch::SpriteBatch(Shader* shader) {
+	this->vao = 0;
+	this->vbo = 0;
+	this->ebo = 0;
+	this->shader = nullptr;
+	this->textureCount = 0;
+	this->bufferOffset = 0;
+	this->drawCalls = 0;
+
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+
+	glBindVertexArray(vao);
+
+	//Streaming buffer, the contents are written each flush
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, SPRITEBATCH_BUFFER_QUADS * 4 * sizeof(SpriteVertex), NULL, GL_STREAM_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, position));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, uv));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, texture));
+	glEnableVertexAttribArray(3);
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, color));
+
+	//Every quad uses the same indices, so they only have to be uploaded once. Draws offset them with a base vertex.
+	std::vector<unsigned short> indices(SPRITEBATCH_MAX_QUADS * 6);
+	for (unsigned short i = 0; i < SPRITEBATCH_MAX_QUADS; i++) {
+		indices[i * 6 + 0] = i * 4 + 0;
+		indices[i * 6 + 1] = i * 4 + 1;
+		indices[i * 6 + 2] = i * 4 + 2;
+		indices[i * 6 + 3] = i * 4 + 0;
+		indices[i * 6 + 4] = i * 4 + 2;
+		indices[i * 6 + 5] = i * 4 + 3;
+	}
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW);
+
+	glBindVertexArray(0);
+
+	vertices.reserve(SPRITEBATCH_MAX_QUADS * 4);
+	SetShader(shader);
+}
+
+void SpriteBatch::SetShader(Shader* shader) {
+	if (this->shader == shader) return;
+
+	Flush();
+	this->shader = shader;
+
+	//Point every sampler of the array at its own texture unit
+	glUseProgram(shader->GetShaderProgram());
+	for (int i = 0; i < SPRITEBATCH_MAX_TEXTURES; i++) {
+		shader->SetInt("textures[" + std::to_string(i) + "]", i);
+	}
+}
+
+int SpriteBatch::GetTextureUnit(unsigned int texture) {
+	for (int i = 0; i < textureCount; i++) {
+		if (textures[i] == texture) return i;
+	}
+
+	if (textureCount == SPRITEBATCH_MAX_TEXTURES) {
+		Flush();
+	}
+
+	textures[textureCount] = texture;
+	return textureCount++;
+}
+
+void SpriteBatch::Begin() {
+	vertices.clear();
+	textureCount = 0;
+	drawCalls = 0;
+
+	glDisable(GL_DEPTH_TEST); // Sprites are drawn on top, in order of submission
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void SpriteBatch::Draw(Texture* texture, glm::vec2 min, glm::vec2 max, glm::vec2 uvMin, glm::vec2 uvMax, glm::vec4 color) {
+	if (texture == nullptr) return;
+
+	Draw(texture->GetGLTexture(), min, max, uvMin, uvMax, color);
+}
+
+void SpriteBatch::Draw(unsigned int texture, glm::vec2 min, glm::vec2 max, glm::vec2 uvMin, glm::vec2 uvMax, glm::vec4 color) {
+	if (vertices.size() == SPRITEBATCH_MAX_QUADS * 4) {
+		Flush();
+	}
+
+	float unit = (float)GetTextureUnit(texture);
+
+	vertices.push_back({ glm::vec2(min.x, max.y), glm::vec2(uvMin.x, uvMax.y), unit, color });
+	vertices.push_back({ glm::vec2(min.x, min.y), glm::vec2(uvMin.x, uvMin.y), unit, color });
+	vertices.push_back({ glm::vec2(max.x, min.y), glm::vec2(uvMax.x, uvMin.y), unit, color });
+	vertices.push_back({ glm::vec2(max.x, max.y), glm::vec2(uvMax.x, uvMax.y), unit, color });
+}
+
+void SpriteBatch::Flush() {
+	if (vertices.empty()) {
+		textureCount = 0;
+		return;
+	}
+
+	//Orphan the buffer when the batch does not fit in the remaining space, the driver hands us fresh storage
+	//while the previous draws still read from the old one
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	if (bufferOffset + vertices.size() > SPRITEBATCH_BUFFER_QUADS * 4) {
+		glBufferData(GL_ARRAY_BUFFER, SPRITEBATCH_BUFFER_QUADS * 4 * sizeof(SpriteVertex), NULL, GL_STREAM_DRAW);
+		bufferOffset = 0;
+	}
+
+	//Write to a range no draw has used since the last orphan, so there is no need to synchronize
+	size_t size = vertices.size() * sizeof(SpriteVertex);
+	void* data = glMapBufferRange(GL_ARRAY_BUFFER, bufferOffset * sizeof(SpriteVertex), size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (data != nullptr) {
+		memcpy(data, &vertices[0], size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+
+		glUseProgram(shader->GetShaderProgram());
+		glBindVertexArray(vao);
+		for (int i = 0; i < textureCount; i++) {
+			glActiveTexture(GL_TEXTURE0 + i);
+			glBindTexture(GL_TEXTURE_2D, textures[i]);
+		}
+		glActiveTexture(GL_TEXTURE0);
+
+		glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(vertices.size() / 4 * 6), GL_UNSIGNED_SHORT, (void*)0, (GLint)bufferOffset);
+		drawCalls++;
+	}
+
+	bufferOffset += vertices.size();
+	vertices.clear();
+	textureCount = 0;
+}
+
+void SpriteBatch::End() {
+	Flush();
+	glBindVertexArray(0);
+}
+
+unsigned SpriteBatch::GetDrawCalls() {
+	return this->drawCalls;
+}
+
+SpriteBatch::~SpriteBatch() {
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ebo);
+}
\ No newline at end of file
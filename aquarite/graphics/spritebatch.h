@@ -0,0 +1,94 @@
+/**
+*	Filename: spritebatch.h
+*
+*	Description: Header file for SpriteBatch class, collects sprite quads into a streaming vertex buffer and draws them in as few draws as possible
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+#include <vector>
+#include <glm/glm.hpp>
+
+#define SPRITEBATCH_MAX_QUADS 2048 // Maximum amount of quads in a single draw, the batch flushes when it is full
+#define SPRITEBATCH_BUFFER_QUADS 8192 // Size of the streaming vertex buffer in quads, it is orphaned when the end is reached
+#define SPRITEBATCH_MAX_TEXTURES 8 // Amount of texture units a single draw can sample from, must match the sprite shader
+
+//Forward declarations
+class Shader;
+class Texture;
+
+/**
+* A single sprite vertex, positions are in normalized device coordinates
+*/
+struct SpriteVertex {
+	glm::vec2 position; /// @brief The position of the vertex
+	glm::vec2 uv; /// @brief The texture coordinate of the vertex
+	float texture; /// @brief Index of the texture unit the vertex samples from
+	glm::vec4 color; /// @brief The color the texture is multiplied with
+};
+
+class SpriteBatch {
+private:
+	unsigned int vao, vbo, ebo; /// @brief Vertex Array Object, streaming Vertex Buffer Object and static Element Buffer Object
+	Shader* shader; /// @brief The shader the current batch is drawn with
+	std::vector<SpriteVertex> vertices; /// @brief The vertices of the current batch
+	unsigned int textures[SPRITEBATCH_MAX_TEXTURES]; /// @brief The textures bound by the current batch, by texture unit
+	int textureCount; /// @brief The amount of texture units used by the current batch
+	size_t bufferOffset; /// @brief The first free vertex in the streaming buffer
+	unsigned drawCalls; /// @brief The amount of draws since Begin
+
+	/**
+	* Returns the texture unit of the texture in the current batch, flushes first when all units are in use
+	*/
+	int GetTextureUnit(unsigned int texture);
+public:
+	/**
+	* Constructor, creates the buffers and sets up the shader
+	*/
+	SpriteBatch(Shader* shader);
+
+	/**
+	* Sets the shader used for the next sprites, the batch is flushed if the shader changes
+	*/
+	void SetShader(Shader* shader);
+
+	/**
+	* Starts a new batch, sets the blend and depth state for drawing sprites
+	*/
+	void Begin();
+
+	/**
+	* Adds a quad to the batch, min and max are the corners in normalized device coordinates
+	*/
+	void Draw(Texture* texture, glm::vec2 min, glm::vec2 max, glm::vec2 uvMin = glm::vec2(0.0f), glm::vec2 uvMax = glm::vec2(1.0f), glm::vec4 color = glm::vec4(1.0f));
+
+	/**
+	* Adds a quad sampling an OpenGL texture to the batch, for textures that are not owned by a Texture like the glyph atlas
+	*/
+	void Draw(unsigned int texture, glm::vec2 min, glm::vec2 max, glm::vec2 uvMin, glm::vec2 uvMax, glm::vec4 color = glm::vec4(1.0f));
+
+	/**
+	* Draws all quads in the batch
+	*/
+	void Flush();
+
+	/**
+	* Flushes the remaining quads
+	*/
+	void End();
+
+	/**
+	* Returns the amount of draws since Begin
+	*/
+	unsigned GetDrawCalls();
+
+	/**
+	* Destructor
+	*/
+	~SpriteBatch();
+};
+
+#endif // !SPRITEBATCH_H
\ No newline at end of file
@@ -0,0 +1,69 @@
+/**
+*	Filename: tgadecoder.cpp
+*
+*	Description: Source file for TGADecoder class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <algorithm>
+#include <cstring>
+#include "tgadecoder.h"
+#include "pixelconverter.h"
+
+bool TGADecoder::DecodeRLE(const unsigned char* data, size_t size, unsigned char* pixels, size_t count, unsigned bytesPerPixel) {
+	size_t pixel = 0, position = 0;
+	while (pixel < count) {
+		if (position >= size) return false;
+		unsigned char packet = data[position++];
+		size_t length = std::min((size_t)(packet & 0x7F) + 1, count - pixel);
+
+		if (packet & 0x80) { // A single pixel repeated
+			if (position + bytesPerPixel > size) return false;
+			PixelConverter::Fill(pixels + pixel * bytesPerPixel, length, bytesPerPixel, data + position);
+			position += bytesPerPixel;
+		}
+		else { // Raw pixels
+			if (position + length * bytesPerPixel > size) return false;
+			memcpy(pixels + pixel * bytesPerPixel, data + position, length * bytesPerPixel);
+			position += length * bytesPerPixel;
+		}
+		pixel += length;
+	}
+	return true;
+}
+
+void TGADecoder::FlipRows(unsigned char* pixels, uint32_t width, uint32_t height, size_t bytesPerPixel) {
+	size_t stride = (size_t)width * bytesPerPixel;
+	for (uint32_t y = 0; y < height / 2; y++) {
+		std::swap_ranges(pixels + y * stride, pixels + (y + 1) * stride, pixels + (height - 1 - y) * stride);
+	}
+}
+
+void TGADecoder::MirrorRows(unsigned char* pixels, uint32_t width, uint32_t height, size_t bytesPerPixel) {
+	for (uint32_t y = 0; y < height; y++) {
+		unsigned char* row = pixels + (size_t)y * width * bytesPerPixel;
+		for (uint32_t x = 0; x < width / 2; x++) {
+			std::swap_ranges(row + x * bytesPerPixel, row + (x + 1) * bytesPerPixel, row + (width - 1 - x) * bytesPerPixel);
+		}
+	}
+}
+
+bool TGADecoder::DecodePixels(const unsigned char* data, size_t size, uint32_t width, uint32_t height, unsigned bytesPerPixel, unsigned char imageType, unsigned char descriptor, unsigned char* pixels) {
+	size_t count = (size_t)width * height;
+	if (imageType == TGA_TYPE_RLE_RGB) {
+		if (!DecodeRLE(data, size, pixels, count, bytesPerPixel)) return false;
+	}
+	else if (imageType == TGA_TYPE_RGB && size >= count * bytesPerPixel) {
+		memcpy(pixels, data, count * bytesPerPixel);
+	}
+	else {
+		return false;
+	}
+
+	//OpenGL expects the rows bottom to top, left to right
+	if (descriptor & TGA_TOP_TO_BOTTOM) FlipRows(pixels, width, height, bytesPerPixel);
+	if (descriptor & TGA_RIGHT_TO_LEFT) MirrorRows(pixels, width, height, bytesPerPixel);
+	return true;
+}
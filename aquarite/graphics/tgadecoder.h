@@ -0,0 +1,48 @@
+/**
+*	Filename: tgadecoder.h
+*
+*	Description: Header file for TGADecoder class, decodes the pixels of Targa Files without OpenGL
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef TGADECODER_H
+#define TGADECODER_H
+#include <cstddef>
+#include <cstdint>
+
+#define TGA_TYPE_RGB 2 // Uncompressed true color Targa
+#define TGA_TYPE_RLE_RGB 10 // Run length encoded true color Targa
+#define TGA_RIGHT_TO_LEFT 0x10 // Descriptor bit, the pixels of a row are stored right to left
+#define TGA_TOP_TO_BOTTOM 0x20 // Descriptor bit, the rows are stored top to bottom
+
+/**
+* Decodes the pixel data that follows the header and image id of a true color Targa File. Pixels stay in the BGR(A) order of the file,
+* the rows are returned bottom to top and left to right as OpenGL expects them
+*/
+class TGADecoder {
+public:
+	/**
+	* Decodes the run length encoded pixels, returns false if the data ends before all pixels are decoded
+	*/
+	static bool DecodeRLE(const unsigned char* data, size_t size, unsigned char* pixels, size_t count, unsigned bytesPerPixel);
+
+	/**
+	* Reverses the order of the rows
+	*/
+	static void FlipRows(unsigned char* pixels, uint32_t width, uint32_t height, size_t bytesPerPixel);
+
+	/**
+	* Reverses the order of the pixels in every row
+	*/
+	static void MirrorRows(unsigned char* pixels, uint32_t width, uint32_t height, size_t bytesPerPixel);
+
+	/**
+	* Decodes width x height pixels of a image of type TGA_TYPE_RGB or TGA_TYPE_RLE_RGB into pixels, and orders the rows as the descriptor
+	* byte of the header describes them. Returns false if the type is not supported or the data ends before all pixels are read
+	*/
+	static bool DecodePixels(const unsigned char* data, size_t size, uint32_t width, uint32_t height, unsigned bytesPerPixel, unsigned char imageType, unsigned char descriptor, unsigned char* pixels);
+};
+
+#endif // !TGADECODER_H
@@ -122,4 +122,8 @@ Vec3 Input::GetMousePositionWorldSpace() {
 
 Vec3 Input::GetMouseRayPositionWorldSpace(Camera* camera, float distance) {
 	return Input::GetInstance()->mousePicker->GetPointOnRay(camera, distance);
+}
+
+Entity* Input::GetMouseRayEntity(Camera* camera, float maxDistance) {
+	return Input::GetInstance()->mousePicker->PickEntity(camera, maxDistance);
 }
\ No newline at end of file
@@ -245,6 +245,11 @@ public:
 	* Returns the coordinated of the mouse position + distance, requires camera as second parameter
 	*/
 	static Vec3 GetMouseRayPositionWorldSpace(Camera* camera, float distance);
+
+	/**
+	* Returns the entity under the mouse within maxDistance, requires camera as first parameter
+	*/
+	static Entity* GetMouseRayEntity(Camera* camera, float maxDistance);
 };
 
 #endif // !INPUT_H
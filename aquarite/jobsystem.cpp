@@ -0,0 +1,315 @@
+/**
+*	Filename: jobsystem.cpp
+*
+*	Description: Source file for JobSystem class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "jobsystem.h"
+#include <algorithm>
+
+JobSystem* JobSystem::_instance; // Declare static member
+thread_local int JobSystem::_workerIndex = -1;
+thread_local ScriptJob* JobSystem::_currentScript = nullptr;
+
+JobSystem::JobSystem() {
+	this->running = true;
+	this->pendingJobs = 0;
+	this->scriptsRunning = true;
+	this->nextScriptId = 1;
+
+	//The thread that waits on jobs helps executing them, so it does not need a worker of its own
+	unsigned workerCount = std::thread::hardware_concurrency();
+	workerCount = workerCount > 1 ? workerCount - 1 : 1;
+
+	for (unsigned i = 0; i <= workerCount; i++) {
+		queues.push_back(new JobQueue());
+	}
+
+	for (unsigned i = 0; i < workerCount; i++) {
+		workers.push_back(std::thread(&JobSystem::WorkerLoop, this, (int)i));
+	}
+
+	for (unsigned i = 0; i < JOBSYSTEM_SCRIPT_THREADS; i++) {
+		scriptThreads.push_back(std::thread(&JobSystem::ScriptLoop, this));
+	}
+}
+
+JobSystem* JobSystem::GetInstance() {
+	if (!_instance) {
+		_instance = new JobSystem();
+	}
+
+	return _instance;
+}
+
+void JobSystem::WorkerLoop(int index) {
+	_workerIndex = index;
+
+	Job job;
+	while (running) {
+		if (Pop(job)) {
+			Execute(job);
+			continue;
+		}
+
+		//Nothing to do, sleep until a job is pushed
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCondition.wait(lock, [this]() { return pendingJobs > 0 || !running; });
+	}
+}
+
+void JobSystem::ScriptLoop() {
+	while (true) {
+		ScriptJob* script;
+		{
+			std::unique_lock<std::mutex> lock(scriptMutex);
+			scriptCondition.wait(lock, [this]() { return !scriptQueue.empty() || !scriptsRunning; });
+			if (!scriptsRunning) return;
+
+			script = scriptQueue.front();
+			scriptQueue.pop_front();
+			runningScripts.push_back(script);
+		}
+
+		_currentScript = script;
+		script->function();
+		_currentScript = nullptr;
+
+		std::lock_guard<std::mutex> lock(scriptMutex);
+		runningScripts.erase(std::find(runningScripts.begin(), runningScripts.end(), script));
+		delete script;
+	}
+}
+
+void JobSystem::Push(const Job& job) {
+	//Threads outside of the pool share the last queue
+	JobQueue* queue = _workerIndex >= 0 ? queues[_workerIndex] : queues.back();
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->jobs.push_back(job);
+	}
+	pendingJobs++;
+
+	//Take the sleep mutex so a worker can not miss the wake up between checking pendingJobs and sleeping
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	sleepCondition.notify_one();
+}
+
+bool JobSystem::Pop(Job& job) {
+	if (pendingJobs <= 0) return false;
+
+	//Newest job of the own queue first, it is most likely to still be in cache
+	if (_workerIndex >= 0) {
+		JobQueue* queue = queues[_workerIndex];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (!queue->jobs.empty()) {
+			job = queue->jobs.back();
+			queue->jobs.pop_back();
+			pendingJobs--;
+			return true;
+		}
+	}
+
+	//Steal the oldest job of another queue, starting after our own so workers spread over the queues
+	size_t start = _workerIndex >= 0 ? _workerIndex + 1 : 0;
+	for (size_t i = 0; i < queues.size(); i++) {
+		JobQueue* queue = queues[(start + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (!queue->jobs.empty()) {
+			job = queue->jobs.front();
+			queue->jobs.pop_front();
+			pendingJobs--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::Execute(Job& job) {
+	job.function();
+
+	JobCounter* counter = job.counter;
+	if (counter == nullptr) return;
+
+	//The counter is only touched while holding its mutex, Wait takes it as well before returning
+	std::vector<Job> ready;
+	{
+		std::lock_guard<std::mutex> lock(counter->mutex);
+		if (--counter->count == 0) {
+			ready.swap(counter->waiting);
+		}
+	}
+
+	for (size_t i = 0; i < ready.size(); i++) {
+		Push(ready[i]);
+	}
+}
+
+void JobSystem::Initialize() {
+	GetInstance();
+}
+
+void JobSystem::Destroy() {
+	if (!_instance) return;
+
+	delete _instance;
+	_instance = nullptr;
+}
+
+void JobSystem::Run(JobFunction function, JobCounter* counter, JobCounter* dependency) {
+	JobSystem* instance = GetInstance();
+
+	Job job;
+	job.function = function;
+	job.counter = counter;
+	if (counter) counter->count++;
+
+	if (dependency) {
+		std::lock_guard<std::mutex> lock(dependency->mutex);
+		if (dependency->count > 0) {
+			dependency->waiting.push_back(job);
+			return;
+		}
+	}
+
+	instance->Push(job);
+}
+
+unsigned JobSystem::RunScript(JobFunction function) {
+	JobSystem* instance = GetInstance();
+
+	ScriptJob* script = new ScriptJob();
+	script->function = function;
+	{
+		std::lock_guard<std::mutex> lock(instance->scriptMutex);
+		script->id = instance->nextScriptId++;
+		instance->scriptQueue.push_back(script);
+	}
+	instance->scriptCondition.notify_one();
+	return script->id;
+}
+
+bool JobSystem::StopScript(unsigned id) {
+	JobSystem* instance = GetInstance();
+	std::lock_guard<std::mutex> lock(instance->scriptMutex);
+
+	for (size_t i = 0; i < instance->scriptQueue.size(); i++) {
+		if (instance->scriptQueue[i]->id == id) {
+			delete instance->scriptQueue[i];
+			instance->scriptQueue.erase(instance->scriptQueue.begin() + i);
+			return true;
+		}
+	}
+
+	//The script thread deletes the script once its function returned
+	for (size_t i = 0; i < instance->runningScripts.size(); i++) {
+		if (instance->runningScripts[i]->id == id) {
+			instance->runningScripts[i]->stopped = true;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool JobSystem::IsScriptStopped() {
+	return _currentScript && _currentScript->stopped;
+}
+
+std::vector<unsigned> JobSystem::GetScripts() {
+	JobSystem* instance = GetInstance();
+	std::lock_guard<std::mutex> lock(instance->scriptMutex);
+
+	std::vector<unsigned> ids;
+	for (size_t i = 0; i < instance->runningScripts.size(); i++) {
+		ids.push_back(instance->runningScripts[i]->id);
+	}
+	for (size_t i = 0; i < instance->scriptQueue.size(); i++) {
+		ids.push_back(instance->scriptQueue[i]->id);
+	}
+	return ids;
+}
+
+void JobSystem::Wait(JobCounter* counter) {
+	JobSystem* instance = GetInstance();
+
+	Job job;
+	while (counter->count > 0) {
+		if (instance->Pop(job)) {
+			instance->Execute(job);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+	//Make sure the last job is done with the counter before it can go out of scope
+	std::lock_guard<std::mutex> lock(counter->mutex);
+}
+
+void JobSystem::ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t, size_t)>& function) {
+	if (count == 0) return;
+	if (batchSize == 0) batchSize = 1;
+
+	JobCounter counter;
+	for (size_t first = batchSize; first < count; first += batchSize) {
+		size_t last = std::min(first + batchSize, count);
+		Run([&function, first, last]() { function(first, last); }, &counter);
+	}
+
+	function(0, std::min(batchSize, count));
+	Wait(&counter);
+}
+
+size_t JobSystem::GetWorkerCount() {
+	return GetInstance()->workers.size();
+}
+
+JobSystem::~JobSystem() {
+	//Scripts are the only submitters left besides this thread, drop the queued ones and stop the running ones
+	{
+		std::lock_guard<std::mutex> lock(scriptMutex);
+		for (size_t i = 0; i < scriptQueue.size(); i++) {
+			delete scriptQueue[i];
+		}
+		scriptQueue.clear();
+
+		for (size_t i = 0; i < runningScripts.size(); i++) {
+			runningScripts[i]->stopped = true;
+		}
+		scriptsRunning = false;
+	}
+	scriptCondition.notify_all();
+
+	//The workers still run, so a stopping script waiting on jobs can finish. Once joined nothing new comes in from outside
+	for (size_t i = 0; i < scriptThreads.size(); i++) {
+		scriptThreads[i].join();
+	}
+
+	//Stop and join the workers first, jobs they release while finishing are pushed and picked up below
+	running = false;
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	sleepCondition.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+
+	//Only this thread is left, finish the queued jobs including the dependent jobs they release
+	Job job;
+	while (Pop(job)) {
+		Execute(job);
+	}
+
+	for (size_t i = 0; i < queues.size(); i++) {
+		delete queues[i];
+	}
+}
@@ -0,0 +1,183 @@
+/**
+*	Filename: jobsystem.h
+*
+*	Description: Header file for JobSystem class, a fixed pool of worker threads that execute jobs and steal work from each other
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define JOBSYSTEM_SCRIPT_THREADS 2 // Amount of threads running long running functions like spawned lua scripts
+
+typedef std::function<void()> JobFunction;
+
+struct JobCounter;
+
+/**
+* A single unit of work, the counter is decremented when the function returns
+*/
+struct Job {
+	JobFunction function; /// @brief The work to be done
+	JobCounter* counter; /// @brief Counter of the job, can be nullptr
+};
+
+/**
+* Counts the unfinished jobs it was passed to. Jobs can depend on a counter, they are started once it reaches 0.
+* A counter must outlive its jobs, wait on it before it goes out of scope.
+*/
+struct JobCounter {
+	std::atomic<int> count; /// @brief Amount of unfinished jobs
+	std::mutex mutex; /// @brief Guards waiting and the moment count reaches 0
+	std::vector<Job> waiting; /// @brief Jobs that are started when count reaches 0
+
+	JobCounter() : count(0) {}
+};
+
+/**
+* A job queue, the owning worker pushes and pops at the back, other workers steal from the front
+*/
+struct JobQueue {
+	std::deque<Job> jobs; /// @brief The queued jobs
+	std::mutex mutex; /// @brief Guards jobs
+};
+
+/**
+* A long running function, run by one of the script threads. stopped is set when the script should return early.
+*/
+struct ScriptJob {
+	unsigned id; /// @brief Id returned by RunScript, used to stop the script
+	JobFunction function; /// @brief The work to be done
+	std::atomic<bool> stopped; /// @brief Set by StopScript and Destroy, checked by the function through IsScriptStopped
+
+	ScriptJob() : id(0), stopped(false) {}
+};
+
+class JobSystem {
+private:
+	static JobSystem* _instance; /// @brief Static job system singleton instance
+	static thread_local int _workerIndex; /// @brief Index of the worker on the current thread, -1 on threads outside of the pool
+	static thread_local ScriptJob* _currentScript; /// @brief The script running on the current thread, nullptr on other threads
+
+	std::vector<std::thread> workers; /// @brief The worker threads
+	std::vector<JobQueue*> queues; /// @brief A queue per worker, the last queue holds the jobs pushed from outside of the pool
+	std::atomic<bool> running; /// @brief False when the workers should stop
+	std::atomic<int> pendingJobs; /// @brief Amount of jobs in the queues
+
+	std::vector<std::thread> scriptThreads; /// @brief Threads running the scripts, workers never take work from these
+	std::deque<ScriptJob*> scriptQueue; /// @brief Scripts waiting for a free script thread
+	std::vector<ScriptJob*> runningScripts; /// @brief Scripts being run by a script thread
+	bool scriptsRunning; /// @brief False when the script threads should stop
+	unsigned nextScriptId; /// @brief Id of the next script
+	std::mutex scriptMutex; /// @brief Guards the script members above
+	std::condition_variable scriptCondition; /// @brief Script threads without a script sleep on this until one is queued
+
+	std::mutex sleepMutex; /// @brief Mutex for sleepCondition
+	std::condition_variable sleepCondition; /// @brief Workers without work sleep on this until a job is pushed
+
+	/**
+	* Constructor, starts a worker per hardware thread except for the calling thread, and the script threads
+	*/
+	JobSystem();
+
+	/**
+	* Returns the instance, if none is existant it will create a new instance
+	*/
+	static JobSystem* GetInstance();
+
+	/**
+	* The loop of a worker thread
+	*/
+	void WorkerLoop(int index);
+
+	/**
+	* The loop of a script thread
+	*/
+	void ScriptLoop();
+
+	/**
+	* Pushes a job to the queue of the current thread and wakes a worker
+	*/
+	void Push(const Job& job);
+
+	/**
+	* Takes a job from the own queue, or steals one from another queue. Returns false if all queues are empty
+	*/
+	bool Pop(Job& job);
+
+	/**
+	* Runs a job and finishes its counter, starting the jobs that were waiting on it
+	*/
+	void Execute(Job& job);
+public:
+	/**
+	* Starts the workers, is done automatically on first use
+	*/
+	static void Initialize();
+
+	/**
+	* Stops the scripts and joins the script threads, stops the workers and then finishes the queued jobs on the calling thread.
+	* Scripts still queued are dropped, running scripts are stopped so they have to check IsScriptStopped.
+	*/
+	static void Destroy();
+
+	/**
+	* Queues a function, counter is incremented now and decremented once the function returns.
+	* If dependency is set the function is started after the dependency counter reaches 0.
+	*/
+	static void Run(JobFunction function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+	/**
+	* Queues a function that may take long or never return, like a spawned lua script, for one of the script threads.
+	* It never enters the job queues, so Wait and ParallelFor can not end up running it. Returns the id of the script.
+	*/
+	static unsigned RunScript(JobFunction function);
+
+	/**
+	* Stops a script, a queued script is dropped and a running one is flagged. Returns false if no script has the id.
+	*/
+	static bool StopScript(unsigned id);
+
+	/**
+	* Returns true if the script running on the calling thread was stopped, long running functions should return when it is
+	*/
+	static bool IsScriptStopped();
+
+	/**
+	* Returns the ids of the queued and running scripts
+	*/
+	static std::vector<unsigned> GetScripts();
+
+	/**
+	* Waits until the counter reaches 0, the calling thread executes queued jobs in the meantime.
+	* Only jobs passed to Run are queued, these should be short so the waiting thread is not held up.
+	*/
+	static void Wait(JobCounter* counter);
+
+	/**
+	* Calls function(first, last) for [0, count) split in batches of batchSize, and returns when all batches are done.
+	* The first batch runs on the calling thread, so a single batch does not involve the workers at all.
+	*/
+	static void ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t, size_t)>& function);
+
+	/**
+	* Returns the amount of worker threads
+	*/
+	static size_t GetWorkerCount();
+
+	/**
+	* Destructor
+	*/
+	~JobSystem();
+};
+
+#endif // !JOBSYSTEM_H
\ No newline at end of file
@@ -6,9 +6,17 @@
 #include "luascript.h"
 #include "debug.h"
 #include "core.h"
+#include "jobsystem.h"
 
 LuaScript* LuaScript::instance; // Pointer to instance
 
+//Called every few thousand instructions, ends a spawned script once it was stopped with the stop command or on shutdown
+static void StopHook(lua_State* state, lua_Debug* debug) {
+	if (JobSystem::IsScriptStopped()) {
+		luaL_error(state, "Script stopped");
+	}
+}
+
 LuaScript* LuaScript::GetInstance() {
 	if (!instance) {
 		instance = new LuaScript(); // Create instance
@@ -19,6 +27,7 @@ LuaScript* LuaScript::GetInstance() {
 LuaScript::LuaScript() {
 	this->state = luaL_newstate(); // Create a new lua state
 	luaopen_base(this->state); // Open base functions
+	lua_sethook(this->state, StopHook, LUA_MASKCOUNT, 1000);
 }
 
 int LuaScript::Run(std::string script) {
@@ -0,0 +1,153 @@
+/**
+*	Filename: lz4block.cpp
+*
+*	Description: Source file for LZ4Block class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "lz4block.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static inline uint32_t Read32(const unsigned char* p) {
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static inline uint32_t HashSequence(uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+/**
+* Writes the 255 continuation bytes of a length that did not fit in the token
+*/
+static inline unsigned char* WriteLength(unsigned char* out, size_t length) {
+	while (length >= 255) {
+		*out++ = 255;
+		length -= 255;
+	}
+	*out++ = (unsigned char)length;
+	return out;
+}
+
+/**
+* Writes a sequence of literals followed by a match, matchLength 0 writes only the literals of the last sequence.
+* Returns nullptr if it does not fit before end
+*/
+static unsigned char* WriteSequence(unsigned char* out, unsigned char* end, const unsigned char* literals, size_t literalLength, size_t offset, size_t matchLength) {
+	size_t needed = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+	if ((size_t)(end - out) < needed) return nullptr;
+
+	unsigned char* token = out++;
+	*token = (unsigned char)((literalLength < 15 ? literalLength : 15) << 4);
+	if (literalLength >= 15) out = WriteLength(out, literalLength - 15);
+
+	if (literalLength > 0) memcpy(out, literals, literalLength); // An empty block has no literals to point at
+	out += literalLength;
+	if (matchLength == 0) return out;
+
+	*out++ = (unsigned char)(offset & 0xFF);
+	*out++ = (unsigned char)(offset >> 8);
+
+	size_t length = matchLength - LZ4_MIN_MATCH;
+	*token |= (unsigned char)(length < 15 ? length : 15);
+	if (length >= 15) out = WriteLength(out, length - 15);
+	return out;
+}
+
+size_t LZ4Block::GetMaxCompressedSize(size_t size) {
+	return size + size / 255 + 16;
+}
+
+size_t LZ4Block::Compress(const unsigned char* source, size_t size, unsigned char* destination, size_t capacity) {
+	unsigned char* out = destination;
+	unsigned char* end = destination + capacity;
+	size_t anchor = 0;
+
+	if (size > LZ4_MATCH_LIMIT) {
+		std::vector<uint32_t> table((size_t)1 << LZ4_HASH_BITS, UINT32_MAX); // Last position of every hashed sequence
+		size_t matchStartLimit = size - LZ4_MATCH_LIMIT;
+		size_t matchEndLimit = size - LZ4_LAST_LITERALS;
+		size_t position = 0;
+
+		while (position < matchStartLimit) {
+			uint32_t sequence = Read32(source + position);
+			uint32_t hash = HashSequence(sequence);
+			size_t candidate = table[hash];
+			table[hash] = (uint32_t)position;
+
+			if (candidate == UINT32_MAX || position - candidate > LZ4_MAX_OFFSET || Read32(source + candidate) != sequence) {
+				position++;
+				continue;
+			}
+
+			size_t length = LZ4_MIN_MATCH;
+			while (position + length < matchEndLimit && source[candidate + length] == source[position + length]) length++;
+
+			out = WriteSequence(out, end, source + anchor, position - anchor, position - candidate, length);
+			if (!out) return 0;
+
+			position += length;
+			anchor = position;
+		}
+	}
+
+	out = WriteSequence(out, end, source + anchor, size - anchor, 0, 0);
+	return out ? (size_t)(out - destination) : 0;
+}
+
+bool LZ4Block::Decompress(const unsigned char* source, size_t size, unsigned char* destination, size_t destinationSize) {
+	const unsigned char* in = source;
+	const unsigned char* inEnd = source + size;
+	unsigned char* out = destination;
+	unsigned char* outEnd = destination + destinationSize;
+
+	while (in < inEnd) {
+		unsigned token = *in++;
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15) {
+			unsigned char byte;
+			do {
+				if (in >= inEnd) return false;
+				byte = *in++;
+				literalLength += byte;
+			} while (byte == 255);
+		}
+
+		if ((size_t)(inEnd - in) < literalLength || (size_t)(outEnd - out) < literalLength) return false;
+		if (literalLength > 0) memcpy(out, in, literalLength);
+		in += literalLength;
+		out += literalLength;
+
+		if (in == inEnd) break; // The last sequence has no match
+
+		if (inEnd - in < 2) return false;
+		size_t offset = in[0] | ((size_t)in[1] << 8);
+		in += 2;
+		if (offset == 0 || offset > (size_t)(out - destination)) return false;
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15) {
+			unsigned char byte;
+			do {
+				if (in >= inEnd) return false;
+				byte = *in++;
+				matchLength += byte;
+			} while (byte == 255);
+		}
+		matchLength += LZ4_MIN_MATCH;
+		if ((size_t)(outEnd - out) < matchLength) return false;
+
+		//Byte by byte, the match may overlap the bytes it writes
+		const unsigned char* match = out - offset;
+		for (size_t i = 0; i < matchLength; i++) out[i] = match[i];
+		out += matchLength;
+	}
+
+	return out == outEnd;
+}
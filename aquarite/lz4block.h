@@ -0,0 +1,42 @@
+/**
+*	Filename: lz4block.h
+*
+*	Description: Header file for LZ4Block class, compresses and decompresses the LZ4 block format
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef LZ4BLOCK_H
+#define LZ4BLOCK_H
+#include <cstddef>
+
+#define LZ4_HASH_BITS 14 // Size of the match finder table, 2^LZ4_HASH_BITS positions
+#define LZ4_MIN_MATCH 4 // Shortest match the format can express
+#define LZ4_MAX_OFFSET 65535 // Farthest a match can look back
+#define LZ4_LAST_LITERALS 5 // The last bytes of a block are always literals
+#define LZ4_MATCH_LIMIT 12 // A match can not start in the last bytes of a block
+
+/**
+* Plain LZ4 blocks without the frame format, the decompressed size has to be stored next to the block.
+* Compression is greedy with a single hash table, decompression checks every length and offset so corrupt data can not overrun.
+*/
+class LZ4Block {
+public:
+	/**
+	* Returns the largest size a compressed block of size bytes can have
+	*/
+	static size_t GetMaxCompressedSize(size_t size);
+
+	/**
+	* Compresses size bytes of source into destination, returns the compressed size or 0 if it does not fit in capacity
+	*/
+	static size_t Compress(const unsigned char* source, size_t size, unsigned char* destination, size_t capacity);
+
+	/**
+	* Decompresses a block into destination, returns false if the block is corrupt or does not decompress to exactly destinationSize bytes
+	*/
+	static bool Decompress(const unsigned char* source, size_t size, unsigned char* destination, size_t destinationSize);
+};
+
+#endif // !LZ4BLOCK_H
@@ -0,0 +1,58 @@
+/**
+*	Filename: mappedfile.h
+*
+*	Description: Header file for MappedFile class, maps a file read only into memory
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <string>
+#include <cstddef>
+
+class MappedFile {
+private:
+	const unsigned char* data; /// @brief Pointer to the mapped file, nullptr if no file is open
+	size_t size; /// @brief The size of the mapped file in bytes
+#ifdef _WIN32
+	void* fileHandle; /// @brief Handle of the opened file
+	void* mappingHandle; /// @brief Handle of the file mapping
+#else
+	int fileDescriptor; /// @brief Descriptor of the opened file
+#endif
+public:
+	/**
+	* Constructor
+	*/
+	MappedFile();
+
+	/**
+	* Maps the file at path into memory, returns false if the file cannot be opened or mapped.
+	* An empty file opens with a size of zero and no data
+	*/
+	bool Open(std::string path);
+
+	/**
+	* Unmaps the file, pointers returned by GetData are no longer valid
+	*/
+	void Close();
+
+	/**
+	* Returns the mapped data, nullptr if the file is empty
+	*/
+	const unsigned char* GetData();
+
+	/**
+	* Returns the size of the mapped data
+	*/
+	size_t GetSize();
+
+	/**
+	* Destructor, closes the file
+	*/
+	~MappedFile();
+};
+
+#endif // !MAPPEDFILE_H
\ No newline at end of file
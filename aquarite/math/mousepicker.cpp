@@ -5,6 +5,7 @@
 #include "glm/gtx/transform.hpp"
 #include "../core.h"
 #include "../input.h"
+#include "../scenemanager.h"
 #include "mousepicker.h"
 
 glm::vec3 MousePicker::CalculateMouseRay() {
@@ -47,4 +48,13 @@ Vec3 MousePicker::GetPointOnRay(Camera* camera, float distance) {
 	glm::vec3 cameraPos = camera->GetPos();
 	glm::vec3 extendedRay = glm::vec3((currentRay.x - cameraPos.x) * distance, (currentRay.y - cameraPos.y) * distance, (currentRay.z - cameraPos.z) * distance);
 	return Vec3::ToVec3(cameraPos + extendedRay);
+}
+
+Entity* MousePicker::PickEntity(Camera* camera, float maxDistance) {
+	Scene* scene = SceneManager::GetActiveScene();
+	if (!scene) return nullptr;
+
+	//The current ray holds a point in front of the camera, not a direction
+	glm::vec3 cameraPos = camera->GetPos();
+	return scene->Raycast(Vec3::ToVec3(cameraPos), Vec3::ToVec3(currentRay - cameraPos), maxDistance);
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 #include "vec3.h"
 #include "../camera.h"
 
+class Entity; // Forward Declaration
+
 /**
 * Mousepicker handles transformations for mouse from view space to world space.
 */
@@ -53,6 +55,11 @@ public:
 	* Returns the point of the ray, from the mouse position.
 	*/
 	Vec3 GetPointOnRay(Camera* camera, float distance);
+
+	/**
+	* Returns the entity of the active scene under the mouse within maxDistance of the camera, or nullptr
+	*/
+	Entity* PickEntity(Camera* camera, float maxDistance);
 };
 
 #endif // !MOUSEPICKER_H
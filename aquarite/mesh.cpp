@@ -9,168 +9,614 @@
 */
 #include <iostream>
 #include <string>
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 #include "mesh.h"
 #include "debug.h"
+#include "objloader.h"
+#include "assetfile.h"
+#include "graphics/meshoptimizer.h"
+#include "graphics/meshsimplifier.h"
 
-Mesh::Mesh() {
+/**
+* The vertex layout used by meshes generated at runtime, position(3) uv(2) normal(3)
+*/
+static const AMeshAttribute DEFAULT_ATTRIBUTES[] = {
+	{ 0, 3, GL_FLOAT, 0, 0 * sizeof(float) },
+	{ 1, 2, GL_FLOAT, 0, 3 * sizeof(float) },
+	{ 2, 3, GL_FLOAT, 0, 5 * sizeof(float) }
+};
+
+/**
+* Hash for obj corners, corners with the same position/uv/normal triple share a vertex
+*/
+struct ObjCornerHash {
+	size_t operator()(const ObjCorner& corner) const {
+		size_t hash = (size_t)corner.position * 73856093u;
+		hash ^= (size_t)corner.uv * 19349663u;
+		hash ^= (size_t)corner.normal * 83492791u;
+		return hash;
+	}
+};
+
+Mesh::Mesh() : Resident(ResidentMesh) {
 	this->_verticesCount = 0;
+	this->_indicesCount = 0;
+	this->_indexType = GL_UNSIGNED_INT;
+	this->_vertexStride = 0;
+	this->_positionOffset = -1;
+	this->_occluder = false;
+	this->_pendingFile = nullptr;
+	this->_evicted = false;
+	this->_gpuBytes = 0;
 	this->_vao = NULL;
 	this->_vbo = NULL;
+	this->_ebo = NULL;
+	this->_bounds.min = glm::vec3(0);
+	this->_bounds.max = glm::vec3(0);
+	this->_bounds.center = glm::vec3(0);
+	this->_bounds.radius = 0.0f;
 }
 
 GLuint Mesh::GetVBO() {
+	MakeResident();
 	return this->_vbo;
 }
 
 GLuint Mesh::GetVAO() {
+	MakeResident();
 	return this->_vao;
 }
 
+GLuint Mesh::GetEBO() {
+	MakeResident();
+	return this->_ebo;
+}
+
+void Mesh::MakeResident() {
+	if (this->_evicted) {
+		this->_evicted = false; // A mesh that fails to load is not tried again every frame
+		if (Decode(this->_sourcePath)) {
+			Upload();
+			ResidencyManager::CountReload();
+		}
+	}
+	this->MarkUsed();
+}
+
+void Mesh::UpdateResidentSize() {
+	size_t cpuBytes = this->_occluderPositions.size() * sizeof(glm::vec3) + this->_occluderIndices.size() * sizeof(unsigned);
+	this->SetResidentSize(cpuBytes, this->_vao != NULL ? this->_gpuBytes : 0);
+}
+
+bool Mesh::ReleaseCpu() {
+	return false;
+}
+
+bool Mesh::ReleaseGpu() {
+	if (this->_sourcePath.empty() || this->_vao == NULL) return false;
+
+	glDeleteVertexArrays(1, &_vao);
+	glDeleteBuffers(1, &_vbo);
+	glDeleteBuffers(1, &_ebo);
+	this->_vao = NULL;
+	this->_vbo = NULL;
+	this->_ebo = NULL;
+	this->_evicted = true;
+	UpdateResidentSize();
+	return true;
+}
+
 unsigned Mesh::GetVerticesCount() {
 	return this->_verticesCount;
 }
 
+unsigned Mesh::GetIndicesCount() {
+	return this->_indicesCount;
+}
+
+bool Mesh::IsEvicted() {
+	return this->_evicted;
+}
+
+const std::string& Mesh::GetSourcePath() {
+	return this->_sourcePath;
+}
+
+GLenum Mesh::GetIndexType() {
+	return this->_indexType;
+}
+
+MeshBounds Mesh::GetBounds() {
+	return this->_bounds;
+}
+
+void Mesh::SetOccluder(bool state) {
+	this->_occluder = state;
+	if (!state) {
+		std::vector<glm::vec3>().swap(this->_occluderPositions);
+		std::vector<unsigned>().swap(this->_occluderIndices);
+		UpdateResidentSize();
+		return;
+	}
+
+	//Meshes that are not uploaded yet copy the data when they are
+	if (this->_occluderIndices.empty() && !IsUploadPending() && (this->_vao != NULL || this->_evicted)) {
+		ReadOccluderData();
+	}
+}
+
+const std::vector<glm::vec3>& Mesh::GetOccluderPositions() {
+	return this->_occluderPositions;
+}
+
+const std::vector<unsigned>& Mesh::GetOccluderIndices() {
+	return this->_occluderIndices;
+}
+
+void Mesh::ReadOccluderData() {
+	//Decoded on the cpu only, the buffers are left as they are. Generated meshes have no file and keep no occluder data
+	if (this->_sourcePath.empty() || !Decode(this->_sourcePath)) return;
+
+	if (this->_pendingFile) {
+		const unsigned char* data = this->_pendingFile->GetData();
+		AMeshHeader header;
+		memcpy(&header, data, sizeof(AMeshHeader));
+
+		AMeshAttribute attributes[AMESH_MAX_ATTRIBUTES];
+		memcpy(attributes, data + sizeof(AMeshHeader), header.attributeCount * sizeof(AMeshAttribute));
+
+		CopyOccluderData(data + header.vertexOffset, (size_t)header.vertexSize, header.vertexStride,
+			data + header.indexOffset, (size_t)header.indexSize, header.indexType, attributes, header.attributeCount);
+
+		delete this->_pendingFile;
+		this->_pendingFile = nullptr;
+		return;
+	}
+
+	CopyOccluderData(this->_pendingVertices.data(), this->_pendingVertices.size() * sizeof(float), MESH_VERTEX_STRIDE * sizeof(float),
+		this->_pendingIndices.data(), this->_pendingIndices.size() * sizeof(unsigned), GL_UNSIGNED_INT, DEFAULT_ATTRIBUTES, sizeof(DEFAULT_ATTRIBUTES) / sizeof(DEFAULT_ATTRIBUTES[0]));
+
+	std::vector<float>().swap(this->_pendingVertices);
+	std::vector<unsigned>().swap(this->_pendingIndices);
+}
+
+void Mesh::CopyOccluderData(const void* vertexData, size_t vertexSize, unsigned vertexStride, const void* indexData, size_t indexSize, GLenum indexType, const AMeshAttribute* attributes, unsigned attributeCount) {
+	int positionOffset = -1;
+	for (unsigned i = 0; i < attributeCount; i++) {
+		if (attributes[i].location == 0 && attributes[i].components == 3 && attributes[i].type == GL_FLOAT) {
+			positionOffset = (int)attributes[i].offset;
+		}
+	}
+	if (positionOffset < 0 || vertexStride == 0) return;
+
+	const unsigned char* vertices = (const unsigned char*)vertexData;
+	size_t vertexCount = vertexSize / vertexStride;
+	this->_occluderPositions.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) {
+		memcpy(&this->_occluderPositions[i], vertices + i * vertexStride + positionOffset, sizeof(glm::vec3));
+	}
+
+	size_t indexCount = indexSize / (indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned));
+	this->_occluderIndices.resize(indexCount);
+	for (size_t i = 0; i < indexCount; i++) {
+		if (indexType == GL_UNSIGNED_SHORT) this->_occluderIndices[i] = ((const unsigned short*)indexData)[i];
+		else this->_occluderIndices[i] = ((const unsigned*)indexData)[i];
+	}
+	UpdateResidentSize();
+}
+
+bool Mesh::Decode(std::string path) {
+	if (this->_sourcePath != path) this->_sourcePath = path; // A reload decodes on a worker while the main thread may read the path
+	if (path.size() > 6 && path.compare(path.size() - 6, 6, ".amesh") == 0) {
+		return DecodeAMesh(path); // Cooked binary mesh
+	}
+
+	if (!Mesh::ReadObj(path, this->_pendingVertices, this->_pendingIndices)) return false;
+	Mesh::Optimize(this->_pendingVertices, this->_pendingIndices);
+	return true;
+}
+
+void Mesh::Upload() {
+	if (this->_pendingFile) {
+		//Upload straight from the mapped file, it was validated by DecodeAMesh
+		const unsigned char* data = this->_pendingFile->GetData();
+		AMeshHeader header;
+		memcpy(&header, data, sizeof(AMeshHeader));
+
+		AMeshAttribute attributes[AMESH_MAX_ATTRIBUTES];
+		memcpy(attributes, data + sizeof(AMeshHeader), header.attributeCount * sizeof(AMeshAttribute));
+
+		UploadBuffers(data + header.vertexOffset, (size_t)header.vertexSize, header.vertexStride,
+			data + header.indexOffset, (size_t)header.indexSize, header.indexType, attributes, header.attributeCount);
+
+		this->_verticesCount = header.vertexCount;
+		this->_indicesCount = header.indexCount;
+		this->_bounds.min = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+		this->_bounds.max = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+		this->_bounds.center = glm::vec3(header.sphereCenter[0], header.sphereCenter[1], header.sphereCenter[2]);
+		this->_bounds.radius = header.sphereRadius;
+
+		delete this->_pendingFile;
+		this->_pendingFile = nullptr;
+		return;
+	}
+
+	if (this->_pendingIndices.empty()) return;
+	UploadVertices(this->_pendingVertices, this->_pendingIndices);
+
+	//Free the decoded data, swapping with empty vectors releases the memory
+	std::vector<float>().swap(this->_pendingVertices);
+	std::vector<unsigned>().swap(this->_pendingIndices);
+}
+
+bool Mesh::IsUploadPending() {
+	return this->_pendingFile != nullptr || !this->_pendingIndices.empty();
+}
+
 void Mesh::LoadObj(std::string path) {
-	// Create Temporary arrays
-	std::vector<glm::vec3> _vertices; // vector containing all vertices
-	std::vector<glm::vec2> _uvs; // vector containing all uv coordinates
-	std::vector<glm::vec3> _normals; // vector containing all normals
-	std::vector<Triangle> _triangles; // vector containing triangles
-
-
-	//Read the file and parse data to temporary arrays
-	std::string line;
-	std::ifstream file(path);
-	
-	if (file.is_open()) {
-		while (getline(file, line)) {
-			std::stringstream ss(line);
-			std::string segment;
-			std::vector<std::string> segments;
-			while (std::getline(ss, segment, ' ')) { // Split by space character
-				segments.push_back(segment);
-			}
-
-			// If Vertex
-			if (segments[0] == "v") {
-				_vertices.push_back(glm::vec3(std::stof(segments[1]), std::stof(segments[2]), std::stof(segments[3]))); //Push back
-			}
-
-			// If UV Coordinate
-			if (segments[0] == "vt") {
-				_uvs.push_back(glm::vec2(std::stof(segments[1]),std::stof(segments[2]))); // Push back
-			}
-
-			// If Normal
-			if (segments[0] == "vn") {
-				_normals.push_back(glm::vec3(std::stof(segments[1]), std::stof(segments[2]), std::stof(segments[3]))); //Push back
-			}
-
-			// If face
-			if (segments[0] == "f") {
-				Triangle triangle; // The triangle where data is to be stored in
-
-				std::vector<std::string> _xtriangleInfo;
-				std::vector<std::string> _ytriangleInfo;
-				std::vector<std::string> _ztriangleInfo;
-
-				std::stringstream ss(segments[1]);
-				std::string segment;
-				while (std::getline(ss, segment, '/')) { // Split by space character
-					_xtriangleInfo.push_back(segment);
-				}
-
-				std::stringstream ss1(segments[2]);
-				while (std::getline(ss1, segment, '/')) { // Split by space character
-					_ytriangleInfo.push_back(segment);
-				}
-
-				std::stringstream ss2(segments[3]);
-				while (std::getline(ss2, segment, '/')) { // Split by space character
-					_ztriangleInfo.push_back(segment);
-				}
-
-				triangle.xCoord = _vertices[std::stoi(_xtriangleInfo[0]) - 1];
-				triangle.xUvCoord = _uvs[std::stoi(_xtriangleInfo[1]) - 1];
-				triangle.xNormalCoord = _normals[std::stoi(_xtriangleInfo[2]) - 1];
-
-				triangle.yCoord = _vertices[std::stoi(_ytriangleInfo[0]) - 1];
-				triangle.yUvCoord = _uvs[std::stoi(_ytriangleInfo[1]) - 1];
-				triangle.yNormalCoord = _normals[std::stoi(_ytriangleInfo[2]) - 1];
-
-				triangle.zCoord = _vertices[std::stoi(_ztriangleInfo[0]) - 1];
-				triangle.zUvCoord = _uvs[std::stoi(_ztriangleInfo[1]) - 1];
-				triangle.zNormalCoord = _normals[std::stoi(_ztriangleInfo[2]) - 1];
-
-				_triangles.push_back(triangle);
-			}
+	if (!Decode(path)) return;
+	Upload();
+}
+
+bool Mesh::ReadObj(std::string path, std::vector<float>& vertices, std::vector<unsigned>& indices) {
+	ObjData _data;
+	if (!ObjLoader::Load(path, _data)) {
+		Debug::Log("Cannot open obj file " + path, typeid(Mesh).name());
+		return false;
+	}
+
+	if (_data.invalidTriangles > 0) {
+		Debug::Log("Skipped " + std::to_string(_data.invalidTriangles) + " triangles with invalid indices in " + path, typeid(Mesh).name());
+	}
+
+	std::vector<ObjCorner>& _corners = _data.corners;
+
+	//Corners without a normal get a smooth normal, accumulated from the faces around their position
+	std::vector<glm::vec3> _smoothNormals;
+	for (size_t i = 0; i < _corners.size(); i += 3) {
+		if (_corners[i].normal != -1 && _corners[i + 1].normal != -1 && _corners[i + 2].normal != -1) continue;
+
+		if (_smoothNormals.empty()) _smoothNormals.resize(_data.positions.size(), glm::vec3(0));
+
+		glm::vec3 p0 = _data.positions[_corners[i].position];
+		glm::vec3 p1 = _data.positions[_corners[i + 1].position];
+		glm::vec3 p2 = _data.positions[_corners[i + 2].position];
+		glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0); // Area weighted
+
+		for (int c = 0; c < 3; c++) {
+			_smoothNormals[_corners[i + c].position] += faceNormal;
 		}
-		file.close();
-	}
-	
-	std::vector<float> _finalVertices;
-
-	for (size_t i = 0; i < _triangles.size(); i++) {
-		_finalVertices.push_back(_triangles[i].xCoord.x);
-		_finalVertices.push_back(_triangles[i].xCoord.y);
-		_finalVertices.push_back(_triangles[i].xCoord.z);
-		_finalVertices.push_back(_triangles[i].xUvCoord.x);
-		_finalVertices.push_back(_triangles[i].xUvCoord.y);
-		_finalVertices.push_back(_triangles[i].xNormalCoord.x);
-		_finalVertices.push_back(_triangles[i].xNormalCoord.y);
-		_finalVertices.push_back(_triangles[i].xNormalCoord.z);
-
-		_finalVertices.push_back(_triangles[i].yCoord.x);
-		_finalVertices.push_back(_triangles[i].yCoord.y);
-		_finalVertices.push_back(_triangles[i].yCoord.z);
-		_finalVertices.push_back(_triangles[i].yUvCoord.x);
-		_finalVertices.push_back(_triangles[i].yUvCoord.y);
-		_finalVertices.push_back(_triangles[i].yNormalCoord.x);
-		_finalVertices.push_back(_triangles[i].yNormalCoord.y);
-		_finalVertices.push_back(_triangles[i].yNormalCoord.z);
-
-		_finalVertices.push_back(_triangles[i].zCoord.x);
-		_finalVertices.push_back(_triangles[i].zCoord.y);
-		_finalVertices.push_back(_triangles[i].zCoord.z);
-		_finalVertices.push_back(_triangles[i].zUvCoord.x);
-		_finalVertices.push_back(_triangles[i].zUvCoord.y);
-		_finalVertices.push_back(_triangles[i].zNormalCoord.x);
-		_finalVertices.push_back(_triangles[i].zNormalCoord.y);
-		_finalVertices.push_back(_triangles[i].zNormalCoord.z);
-	}
-
-	GenerateBuffers(_finalVertices);
+	}
+
+	//Every unique corner becomes a vertex, corners sharing position, uv and normal are merged
+	std::vector<float>& _finalVertices = vertices;
+	std::vector<unsigned>& _indices = indices;
+	std::unordered_map<ObjCorner, unsigned, ObjCornerHash> _cornerVertices;
+	_finalVertices.clear();
+	_indices.clear();
+	_cornerVertices.reserve(_corners.size());
+	_indices.reserve(_corners.size());
+
+	for (size_t i = 0; i < _corners.size(); i++) {
+		std::unordered_map<ObjCorner, unsigned, ObjCornerHash>::iterator it = _cornerVertices.find(_corners[i]);
+		if (it != _cornerVertices.end()) {
+			_indices.push_back(it->second);
+			continue;
+		}
+
+		unsigned index = (unsigned)(_finalVertices.size() / MESH_VERTEX_STRIDE);
+		_cornerVertices[_corners[i]] = index;
+		_indices.push_back(index);
+
+		glm::vec3 position = _data.positions[_corners[i].position];
+		glm::vec2 uv = _corners[i].uv != -1 ? _data.uvs[_corners[i].uv] : glm::vec2(0);
+		glm::vec3 normal;
+		if (_corners[i].normal != -1) {
+			normal = _data.normals[_corners[i].normal];
+		}
+		else {
+			glm::vec3 smoothNormal = _smoothNormals[_corners[i].position];
+			float length = glm::length(smoothNormal);
+			normal = length > 0.0f ? smoothNormal / length : glm::vec3(0, 1, 0);
+		}
+		_finalVertices.push_back(position.x);
+		_finalVertices.push_back(position.y);
+		_finalVertices.push_back(position.z);
+		_finalVertices.push_back(uv.x);
+		_finalVertices.push_back(uv.y);
+		_finalVertices.push_back(normal.x);
+		_finalVertices.push_back(normal.y);
+		_finalVertices.push_back(normal.z);
+	}
+
+	return true;
+}
+
+bool Mesh::LoadAMesh(std::string path) {
+	if (!DecodeAMesh(path)) return false;
+	Upload();
+	return true;
+}
+
+bool Mesh::DecodeAMesh(std::string path) {
+	AssetFile* file = new AssetFile();
+	if (!file->Open(path)) {
+		Debug::Log("Cannot open amesh file " + path, typeid(*this).name());
+		delete file;
+		return false;
+	}
+
+	const unsigned char* data = file->GetData();
+	size_t size = file->GetSize();
+
+	//Validate before handing anything to OpenGL
+	if (size < sizeof(AMeshHeader)) {
+		Debug::Log("Invalid amesh file " + path, typeid(*this).name());
+		delete file;
+		return false;
+	}
+
+	AMeshHeader header;
+	memcpy(&header, data, sizeof(AMeshHeader));
+
+	if (header.magic != AMESH_MAGIC || header.version != AMESH_VERSION) {
+		Debug::Log("Invalid amesh file or version " + path, typeid(*this).name());
+		delete file;
+		return false;
+	}
+
+	size_t indexSize = header.indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned);
+	if (header.attributeCount > AMESH_MAX_ATTRIBUTES || sizeof(AMeshHeader) + header.attributeCount * sizeof(AMeshAttribute) > size ||
+		(header.indexType != GL_UNSIGNED_SHORT && header.indexType != GL_UNSIGNED_INT) ||
+		header.indexSize != (uint64_t)header.indexCount * indexSize || header.vertexSize != (uint64_t)header.vertexCount * header.vertexStride ||
+		header.indexOffset + header.indexSize > size || header.vertexOffset + header.vertexSize > size) {
+		Debug::Log("Corrupt amesh file " + path, typeid(*this).name());
+		delete file;
+		return false;
+	}
+
+	//The contents are kept until Upload, which also takes the counts and bounds so culling can read them while a reload decodes
+	delete this->_pendingFile;
+	this->_pendingFile = file;
+	if (this->_sourcePath != path) this->_sourcePath = path;
+	return true;
+}
+
+/**
+* Pads the stream with zeros up to the alignment
+*/
+static void AlignStream(std::ofstream& stream, size_t alignment) {
+	static const char zeros[AMESH_ALIGNMENT] = {};
+	size_t position = (size_t)stream.tellp();
+	size_t padding = (alignment - (position % alignment)) % alignment;
+	stream.write(zeros, padding);
+}
+
+bool Mesh::ConvertObj(std::string objPath, std::string ameshPath) {
+	std::vector<float> _vertices;
+	std::vector<unsigned> _indices;
+	if (!Mesh::ReadObj(objPath, _vertices, _indices)) return false;
+
+	return Mesh::WriteAMesh(_vertices, _indices, ameshPath);
+}
+
+int Mesh::ConvertObjLods(std::string objPath, std::string ameshPath, int levels) {
+	std::vector<float> _vertices;
+	std::vector<unsigned> _indices;
+	if (!Mesh::ReadObj(objPath, _vertices, _indices)) return -1;
+
+	//Every level indexes the full vertex buffer, unused vertices are dropped when the level is optimized
+	std::vector<std::vector<unsigned>> _lods;
+	MeshSimplifier::GenerateLodChain(_vertices, MESH_VERTEX_STRIDE, _indices, levels, _lods);
+
+	for (size_t i = 0; i < _lods.size(); i++) {
+		std::vector<float> _lodVertices = _vertices;
+		if (!Mesh::WriteAMesh(_lodVertices, _lods[i], Mesh::GetLodPath(ameshPath, (int)i + 1))) return -1;
+	}
+
+	if (!Mesh::WriteAMesh(_vertices, _indices, ameshPath)) return -1;
+	return (int)_lods.size();
+}
+
+std::string Mesh::GetLodPath(std::string ameshPath, int level) {
+	std::string _base = ameshPath;
+	if (_base.size() > 6 && _base.compare(_base.size() - 6, 6, ".amesh") == 0) _base.erase(_base.size() - 6);
+	return _base + "_lod" + std::to_string(level) + ".amesh";
+}
+
+bool Mesh::WriteAMesh(std::vector<float>& _vertices, std::vector<unsigned>& _indices, std::string ameshPath) {
+	//Report the average cache miss ratio per triangle, so the effect of the optimization shows up in the conversion log
+	float _acmrBefore = MeshOptimizer::CalculateACMR(_indices, _vertices.size() / MESH_VERTEX_STRIDE);
+	Mesh::Optimize(_vertices, _indices);
+	float _acmrAfter = MeshOptimizer::CalculateACMR(_indices, _vertices.size() / MESH_VERTEX_STRIDE);
+	MeshBounds bounds = Mesh::CalculateBounds(_vertices);
+
+	AMeshHeader header = {};
+	header.magic = AMESH_MAGIC;
+	header.version = AMESH_VERSION;
+	header.vertexCount = (uint32_t)(_vertices.size() / MESH_VERTEX_STRIDE);
+	header.indexCount = (uint32_t)_indices.size();
+	header.vertexStride = MESH_VERTEX_STRIDE * sizeof(float);
+	header.indexType = header.vertexCount <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	header.attributeCount = sizeof(DEFAULT_ATTRIBUTES) / sizeof(DEFAULT_ATTRIBUTES[0]);
+	for (int i = 0; i < 3; i++) {
+		header.boundsMin[i] = bounds.min[i];
+		header.boundsMax[i] = bounds.max[i];
+		header.sphereCenter[i] = bounds.center[i];
+	}
+	header.sphereRadius = bounds.radius;
+
+	//Offsets follow the layout, every block starts aligned
+	size_t headerEnd = sizeof(AMeshHeader) + header.attributeCount * sizeof(AMeshAttribute);
+	header.indexOffset = (headerEnd + AMESH_ALIGNMENT - 1) / AMESH_ALIGNMENT * AMESH_ALIGNMENT;
+	header.indexSize = header.indexCount * (header.indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned));
+	header.vertexOffset = (header.indexOffset + header.indexSize + AMESH_ALIGNMENT - 1) / AMESH_ALIGNMENT * AMESH_ALIGNMENT;
+	header.vertexSize = _vertices.size() * sizeof(float);
+
+	std::ofstream file(ameshPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		Debug::Log("Cannot write amesh file " + ameshPath, typeid(Mesh).name());
+		return false;
+	}
+
+	file.write((const char*)&header, sizeof(AMeshHeader));
+	file.write((const char*)DEFAULT_ATTRIBUTES, header.attributeCount * sizeof(AMeshAttribute));
+
+	AlignStream(file, AMESH_ALIGNMENT);
+	if (header.indexType == GL_UNSIGNED_SHORT) {
+		std::vector<unsigned short> _shortIndices(_indices.begin(), _indices.end());
+		file.write((const char*)_shortIndices.data(), header.indexSize);
+	}
+	else {
+		file.write((const char*)_indices.data(), header.indexSize);
+	}
+
+	AlignStream(file, AMESH_ALIGNMENT);
+	file.write((const char*)_vertices.data(), header.vertexSize);
+
+	std::stringstream _log;
+	_log << "Wrote " << ameshPath << ", " << header.indexCount / 3 << " triangles, ACMR " << _acmrBefore << " -> " << _acmrAfter;
+	Debug::Log(_log.str(), typeid(Mesh).name());
+	return file.good();
 }
 
 void Mesh::GenerateBuffers(std::vector<float>& vertices) {
+	std::vector<float> _uniqueVertices;
+	std::vector<unsigned> _indices;
+	MeshOptimizer::GenerateIndexBuffer(vertices, MESH_VERTEX_STRIDE, _uniqueVertices, _indices);
+
+	GenerateBuffers(_uniqueVertices, _indices);
+}
+
+void Mesh::Optimize(std::vector<float>& vertices, std::vector<unsigned>& indices) {
+	//Reorder for the post transform cache first, then cluster for overdraw, and finally lay out the vertices in the order they are used
+	MeshOptimizer::OptimizeVertexCache(indices, vertices.size() / MESH_VERTEX_STRIDE);
+	MeshOptimizer::OptimizeOverdraw(indices, vertices, MESH_VERTEX_STRIDE);
+	MeshOptimizer::OptimizeVertexFetch(vertices, MESH_VERTEX_STRIDE, indices);
+}
+
+MeshBounds Mesh::CalculateBounds(const std::vector<float>& vertices) {
+	MeshBounds bounds;
+	bounds.min = glm::vec3(0);
+	bounds.max = glm::vec3(0);
+	bounds.center = glm::vec3(0);
+	bounds.radius = 0.0f;
+	if (vertices.empty()) return bounds;
+
+	//Box, and the vertices with the smallest and largest coordinate on every axis
+	glm::vec3 minPoints[3], maxPoints[3];
+	for (size_t i = 0; i < vertices.size(); i += MESH_VERTEX_STRIDE) {
+		glm::vec3 position(vertices[i], vertices[i + 1], vertices[i + 2]);
+		for (int axis = 0; axis < 3; axis++) {
+			if (i == 0 || position[axis] < minPoints[axis][axis]) minPoints[axis] = position;
+			if (i == 0 || position[axis] > maxPoints[axis][axis]) maxPoints[axis] = position;
+		}
+	}
+	bounds.min = glm::vec3(minPoints[0].x, minPoints[1].y, minPoints[2].z);
+	bounds.max = glm::vec3(maxPoints[0].x, maxPoints[1].y, maxPoints[2].z);
+
+	//Ritter, start with the sphere over the most distant pair of extreme points
+	int widest = 0;
+	for (int axis = 1; axis < 3; axis++) {
+		if (glm::distance(minPoints[axis], maxPoints[axis]) > glm::distance(minPoints[widest], maxPoints[widest])) widest = axis;
+	}
+	glm::vec3 center = (minPoints[widest] + maxPoints[widest]) * 0.5f;
+	float radius = glm::distance(minPoints[widest], maxPoints[widest]) * 0.5f;
+
+	//Then grow it just enough to include every vertex outside of it
+	for (size_t i = 0; i < vertices.size(); i += MESH_VERTEX_STRIDE) {
+		glm::vec3 position(vertices[i], vertices[i + 1], vertices[i + 2]);
+		float distance = glm::distance(position, center);
+		if (distance <= radius) continue;
+
+		float grownRadius = (radius + distance) * 0.5f;
+		center += (position - center) * ((grownRadius - radius) / distance);
+		radius = grownRadius;
+	}
+
+	//Ritter is not always tighter than the sphere around the center of the box, keep the smallest
+	glm::vec3 boxCenter = (bounds.min + bounds.max) * 0.5f;
+	float boxRadius = 0.0f;
+	for (size_t i = 0; i < vertices.size(); i += MESH_VERTEX_STRIDE) {
+		glm::vec3 position(vertices[i], vertices[i + 1], vertices[i + 2]);
+		boxRadius = glm::max(boxRadius, glm::length(position - boxCenter));
+	}
+
+	bounds.center = boxRadius < radius ? boxCenter : center;
+	bounds.radius = glm::min(boxRadius, radius);
+	return bounds;
+}
+
+void Mesh::GenerateBuffers(std::vector<float>& vertices, std::vector<unsigned>& indices) {
+	this->_sourcePath.clear(); // Generated, it can not be read again
+	Mesh::Optimize(vertices, indices);
+	UploadVertices(vertices, indices);
+}
+
+void Mesh::UploadVertices(const std::vector<float>& vertices, const std::vector<unsigned>& indices) {
+	//Use 16 bit indices when possible to halve the index memory
+	if (vertices.size() / MESH_VERTEX_STRIDE <= 0xFFFF) {
+		std::vector<unsigned short> _shortIndices(indices.begin(), indices.end());
+		UploadBuffers(vertices.data(), vertices.size() * sizeof(float), MESH_VERTEX_STRIDE * sizeof(float),
+			_shortIndices.data(), _shortIndices.size() * sizeof(unsigned short), GL_UNSIGNED_SHORT, DEFAULT_ATTRIBUTES, sizeof(DEFAULT_ATTRIBUTES) / sizeof(DEFAULT_ATTRIBUTES[0]));
+	}
+	else {
+		UploadBuffers(vertices.data(), vertices.size() * sizeof(float), MESH_VERTEX_STRIDE * sizeof(float),
+			indices.data(), indices.size() * sizeof(unsigned), GL_UNSIGNED_INT, DEFAULT_ATTRIBUTES, sizeof(DEFAULT_ATTRIBUTES) / sizeof(DEFAULT_ATTRIBUTES[0]));
+	}
+
+	//Set counts
+	this->_verticesCount = (unsigned)(vertices.size() / MESH_VERTEX_STRIDE);
+	this->_indicesCount = (unsigned)indices.size();
+	this->_bounds = Mesh::CalculateBounds(vertices);
+}
+
+void Mesh::UploadBuffers(const void* vertexData, size_t vertexSize, unsigned vertexStride, const void* indexData, size_t indexSize, GLenum indexType, const AMeshAttribute* attributes, unsigned attributeCount) {
 	// Generate VAO
 	glGenVertexArrays(1, &_vao);
 	glBindVertexArray(_vao);
 
 	// Generate Buffers
 	glGenBuffers(1, &_vbo);
+	glGenBuffers(1, &_ebo);
 
 	//Copy vertices to VBO
 	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, vertexSize, vertexData, GL_STATIC_DRAW);
 
-	//Handle VAO
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(0 * sizeof(float)));
-	glEnableVertexAttribArray(0);
+	//Copy indices to EBO
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize, indexData, GL_STATIC_DRAW);
+	this->_indexType = indexType;
+	this->_vertexStride = vertexStride;
 
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
+	//Handle VAO
+	this->_positionOffset = -1;
+	for (unsigned i = 0; i < attributeCount; i++) {
+		if (attributes[i].location == 0 && attributes[i].components == 3 && attributes[i].type == GL_FLOAT) {
+			this->_positionOffset = (int)attributes[i].offset;
+		}
+		glVertexAttribPointer(attributes[i].location, attributes[i].components, attributes[i].type, attributes[i].normalized ? GL_TRUE : GL_FALSE, vertexStride, (void*)(size_t)attributes[i].offset);
+		glEnableVertexAttribArray(attributes[i].location);
+	}
 
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float)));
-	glEnableVertexAttribArray(2);
+	this->_gpuBytes = vertexSize + indexSize;
+	this->_evicted = false;
+	this->MarkUsed();
+	UpdateResidentSize();
 
-	//Set Vertices Count
-	this->_verticesCount = vertices.size();
+	//Copied while the decoded data is still in system memory, a reload after eviction keeps the earlier copy
+	if (this->_occluder && this->_occluderIndices.empty()) {
+		CopyOccluderData(vertexData, vertexSize, vertexStride, indexData, indexSize, indexType, attributes, attributeCount);
+	}
 }
 
 Mesh::~Mesh() {
+	delete this->_pendingFile;
+
 	if (this->_vao != NULL) {
 		glDeleteVertexArrays(1, &_vao);
 	}
@@ -178,4 +624,8 @@ Mesh::~Mesh() {
 	if (this->_vbo != NULL) {
 		glDeleteBuffers(1, &_vbo);
 	}
+
+	if (this->_ebo != NULL) {
+		glDeleteBuffers(1, &_ebo);
+	}
 }
\ No newline at end of file
@@ -11,8 +11,16 @@
 #define MESH_H
 
 #include <vector>
+#include <string>
 #include <GL/glew.h>
 #include "glm/glm.hpp"
+#include "amesh.h"
+#include "residency.h"
+
+//Forward declarations
+class AssetFile;
+
+#define MESH_VERTEX_STRIDE 8 // Floats per vertex, position(3) uv(2) normal(3)
 
 struct Triangle {
 	glm::vec3 xCoord; /// @ brief The First verte3x of the Triangle.
@@ -26,16 +34,108 @@ struct Triangle {
 	glm::vec3 zNormalCoord; /// @brief The Third Normal Coordinate of the Triangle.
 };
 
-class Mesh {
+/**
+* Bounds of a mesh in model space
+*/
+struct MeshBounds {
+	glm::vec3 min; /// @brief Minimum of the axis aligned bounding box
+	glm::vec3 max; /// @brief Maximum of the axis aligned bounding box
+	glm::vec3 center; /// @brief Center of the bounding sphere
+	float radius; /// @brief Radius of the bounding sphere
+};
+
+/**
+* A mesh, the vertex data only lives in video memory. When evicted by the ResidencyManager a mesh read from a file is read
+* again the next time its buffers are used
+*/
+class Mesh : public Resident {
 private:
 	GLuint _vbo; /// @brief The Vertex Buffer Object
+	GLuint _ebo; /// @brief The Element Buffer Object, holding the indices
 	GLuint _vao; /// @brief The Vertex Array Object
-	unsigned _verticesCount; /// @brief Amount of vertices that this object contains
+	unsigned _verticesCount; /// @brief Amount of unique vertices that this object contains
+	unsigned _indicesCount; /// @brief Amount of indices that this object contains
+	GLenum _indexType; /// @brief Type of the indices, GL_UNSIGNED_SHORT if all vertices can be adressed with 16 bits, else GL_UNSIGNED_INT
+	MeshBounds _bounds; /// @brief The bounds of the mesh
+	unsigned _vertexStride; /// @brief Size of a vertex in bytes
+	int _positionOffset; /// @brief Offset of the position in a vertex, -1 if the position is not 3 floats
+	bool _occluder; /// @brief True if the positions and indices are kept in system memory for the occlusion culler
+	std::vector<glm::vec3> _occluderPositions; /// @brief Positions copied from the decoded data for the occlusion culler
+	std::vector<unsigned> _occluderIndices; /// @brief Indices copied from the decoded data for the occlusion culler
+
+	//Decoded data waiting for Upload
+	std::vector<float> _pendingVertices; /// @brief Optimized vertices of a decoded obj file
+	std::vector<unsigned> _pendingIndices; /// @brief Optimized indices of a decoded obj file
+	AssetFile* _pendingFile; /// @brief The validated .amesh file, uploaded straight from the archive or file mapping
+
+	std::string _sourcePath; /// @brief The file the mesh was read from, empty for generated meshes which can not be read again
+	bool _evicted; /// @brief True if the buffers were released, they are read again on the next use
+	size_t _gpuBytes; /// @brief Bytes of video memory of the buffers
+
+	/**
+	* Decodes the source file again and copies the positions and indices from it, for meshes that became occluders after their upload
+	*/
+	void ReadOccluderData();
+
+	/**
+	* Copies the positions and indices from decoded vertex and index data, which has the layout given to UploadBuffers
+	*/
+	void CopyOccluderData(const void* vertexData, size_t vertexSize, unsigned vertexStride, const void* indexData, size_t indexSize, GLenum indexType, const AMeshAttribute* attributes, unsigned attributeCount);
+
+	/**
+	* Reorders the vertices and indices for the vertex cache, overdraw and vertex fetch
+	*/
+	static void Optimize(std::vector<float>& vertices, std::vector<unsigned>& indices);
+
+	/**
+	* Calculates the bounds of the vertices, the sphere is the smaller of a Ritter sphere and the sphere around the box
+	*/
+	static MeshBounds CalculateBounds(const std::vector<float>& vertices);
+
+	/**
+	* Optimizes the vertices and indices and writes them to a .amesh file, returns false if writing failed
+	*/
+	static bool WriteAMesh(std::vector<float>& vertices, std::vector<unsigned>& indices, std::string ameshPath);
+
+	/**
+	* Maps and validates a .amesh file and reads its counts and bounds, does not need a OpenGL context
+	*/
+	bool DecodeAMesh(std::string path);
+
+	/**
+	* Uploads the vertices and indices with the default vertex layout and sets the counts and bounds, the data is uploaded as is
+	*/
+	void UploadVertices(const std::vector<float>& vertices, const std::vector<unsigned>& indices);
+
+	/**
+	* Creates the buffers and the vertex array, data is uploaded as is
+	*/
+	void UploadBuffers(const void* vertexData, size_t vertexSize, unsigned vertexStride, const void* indexData, size_t indexSize, GLenum indexType, const AMeshAttribute* attributes, unsigned attributeCount);
+
+	/**
+	* Reads and uploads the buffers again if the mesh was evicted, and marks it as used
+	*/
+	void MakeResident();
+
+	/**
+	* Reports the memory in use to the ResidencyManager
+	*/
+	void UpdateResidentSize();
+protected:
+	/**
+	* The occluder data is the only copy in system memory and it can not be released, returns false
+	*/
+	bool ReleaseCpu() override;
+
+	/**
+	* Deletes the buffers if the mesh can be read again
+	*/
+	bool ReleaseGpu() override;
 public:
 	Mesh();
 
 	/**
-	* Returns the Vertex Buffer Object
+	* Returns the Vertex Buffer Object, the buffer getters load a evicted mesh again first
 	*/
 	GLuint GetVBO();
 
@@ -45,20 +145,114 @@ public:
 	GLuint GetVAO();
 
 	/**
-	* Returns the amount of vertices in this mesh
+	* Returns the Element Buffer Object
+	*/
+	GLuint GetEBO();
+
+	/**
+	* Returns the amount of unique vertices in this mesh
 	*/
 	unsigned GetVerticesCount();
 
+	/**
+	* Returns the amount of indices in this mesh, 3 for every triangle
+	*/
+	unsigned GetIndicesCount();
+
+	/**
+	* Returns true if the buffers were released by the ResidencyManager. Culling skips the mesh and queues it with ResourceLoader::ReloadMesh
+	*/
+	bool IsEvicted();
+
+	/**
+	* Returns the file the mesh was read from, empty for generated meshes
+	*/
+	const std::string& GetSourcePath();
+
+	/**
+	* Returns the type of the indices, to be passed to glDrawElements
+	*/
+	GLenum GetIndexType();
+
+	/**
+	* Returns the bounds of the mesh
+	*/
+	MeshBounds GetBounds();
+
+	/**
+	* Keeps a copy of the positions and indices in system memory for the occlusion culler. The copy is taken from the decoded data
+	* when it is uploaded, a mesh that was uploaded before is decoded again from its file. Never reads back from OpenGL
+	*/
+	void SetOccluder(bool state);
+
+	/**
+	* Returns the positions for the occlusion culler, empty if the mesh is not an occluder or not decoded yet
+	*/
+	const std::vector<glm::vec3>& GetOccluderPositions();
+
+	/**
+	* Returns the triangle indices for the occlusion culler, empty if the mesh is not an occluder or not decoded yet
+	*/
+	const std::vector<unsigned>& GetOccluderIndices();
+
+	/**
+	* Reads a .obj or .amesh file into memory, ready for Upload. Does not need a OpenGL context, so it can run on a worker thread.
+	* Only the pending data is written, the counts and bounds are set by Upload. Returns false if the file cannot be read
+	*/
+	bool Decode(std::string path);
+
+	/**
+	* Creates the buffers from the data read by Decode, must be called on the thread owning the OpenGL context
+	*/
+	void Upload();
+
+	/**
+	* Returns true if decoded data is waiting for Upload
+	*/
+	bool IsUploadPending();
+
 	/**
 	* Loads a obj file and generates buffers
 	*/
 	void LoadObj(std::string path);
 
 	/**
-	* Generate a buffer for given vertices
+	* Loads a cooked .amesh file and generates buffers, the file is mapped and uploaded without any processing.
+	* Returns false if the file cannot be read or is not a valid .amesh file
+	*/
+	bool LoadAMesh(std::string path);
+
+	/**
+	* Reads a obj file into unique vertices and triangle indices, does not need a OpenGL context
+	*/
+	static bool ReadObj(std::string path, std::vector<float>& vertices, std::vector<unsigned>& indices);
+
+	/**
+	* Converts a obj file to a optimized .amesh file, returns false if reading or writing failed
+	*/
+	static bool ConvertObj(std::string objPath, std::string ameshPath);
+
+	/**
+	* Converts a obj file to a .amesh file and simplified lod levels next to it, see GetLodPath. Levels that can not be simplified
+	* any further are not written. Returns the amount of lod levels written, or -1 if reading or writing failed
+	*/
+	static int ConvertObjLods(std::string objPath, std::string ameshPath, int levels);
+
+	/**
+	* Returns the path of a lod level of a .amesh file, level 1 of mesh.amesh is mesh_lod1.amesh
+	*/
+	static std::string GetLodPath(std::string ameshPath, int level);
+
+	/**
+	* Generate buffers for given non indexed triangle list, identical vertices are merged
 	*/
 	void GenerateBuffers(std::vector<float>& vertices);
 
+	/**
+	* Generate buffers for given vertices and triangle indices, the buffers are optimized for the vertex cache, overdraw and vertex fetch
+	*/
+	void GenerateBuffers(std::vector<float>& vertices, std::vector<unsigned>& indices);
+
 	/**
 	* Destructor
 	*/
@@ -11,8 +11,10 @@
 
 Model::Model() {
 	this->name = "Unnamed Model";
-	this->sphereRadius = 1.0f; // Default sphere radius
+	this->sphereRadius = 0.0f; // Use the bounds of the meshes
+	this->boundsDirty = true;
 	this->ignoreFrustum = false; // we dont want to ignore frustum by default
+	this->occluder = false;
 	this->drawMode = DrawMode::Default; // set drawmode to default
 }
 
@@ -37,17 +39,61 @@ Mesh* Model::GetMesh(int index) {
 }
 
 void Model::AddMesh(Mesh* mesh) {
+	mesh->AddRef();
 	this->meshes.push_back(mesh);
+	this->boundsDirty = true;
+	if (this->occluder) mesh->SetOccluder(true);
 }
 
 void Model::RemoveMesh(int index) {
+	this->meshes[index]->Release();
 	this->meshes.erase(this->meshes.begin() + index);
+	if (index < (int)this->lodMeshes.size()) {
+		for (size_t i = 0; i < this->lodMeshes[index].size(); i++) this->lodMeshes[index][i]->Release();
+		this->lodMeshes.erase(this->lodMeshes.begin() + index);
+	}
+	this->boundsDirty = true;
 }
 
 int Model::GetMeshesCount() {
 	return (int)this->meshes.size();
 }
 
+void Model::AddLod(int index, Mesh* mesh, float screenSize) {
+	if ((int)this->lodMeshes.size() <= index) this->lodMeshes.resize(index + 1);
+	mesh->AddRef();
+	this->lodMeshes[index].push_back(mesh);
+
+	//The first mesh to reach a level sets its screen size
+	if (this->lodMeshes[index].size() > this->lodScreenSizes.size()) this->lodScreenSizes.push_back(screenSize);
+	if (this->occluder) mesh->SetOccluder(true);
+}
+
+Mesh* Model::GetMesh(int index, int lod) {
+	if (lod <= 0 || index >= (int)this->lodMeshes.size() || this->lodMeshes[index].empty()) return this->meshes[index];
+	std::vector<Mesh*>& levels = this->lodMeshes[index];
+	return levels[glm::min(lod, (int)levels.size()) - 1];
+}
+
+int Model::GetLodCount() {
+	return (int)this->lodScreenSizes.size() + 1;
+}
+
+float Model::GetLodScreenSize(int lod) {
+	return lod <= 0 ? 1.0f : this->lodScreenSizes[lod - 1];
+}
+
+int Model::SelectLod(float screenSize, int currentLod) {
+	//A coarser level than the current one needs the size to drop below its threshold by the hysteresis, a finer one to rise above it
+	int lod = 0;
+	for (int level = 1; level <= (int)this->lodScreenSizes.size(); level++) {
+		float threshold = this->lodScreenSizes[level - 1] * (level <= currentLod ? 1.0f + LOD_HYSTERESIS : 1.0f - LOD_HYSTERESIS);
+		if (screenSize >= threshold) break;
+		lod = level;
+	}
+	return lod;
+}
+
 void Model::SetName(std::string name) {
 	this->name = name;
 }
@@ -57,11 +103,79 @@ std::string Model::GetName() {
 }
 
 float Model::GetSphereRadius() {
-	return this->sphereRadius;
+	return GetBounds().radius;
 }
 
 void Model::SetSphereRadius(float amount) {
 	this->sphereRadius = amount;
+	this->boundsDirty = true;
+}
+
+bool Model::HasManualRadius() {
+	return this->sphereRadius > 0.0f;
+}
+
+MeshBounds Model::GetBounds() {
+	if (!boundsDirty) return this->bounds;
+
+	for (size_t i = 0; i < meshes.size(); i++) {
+		MeshBounds meshBounds = meshes[i]->GetBounds();
+		if (i == 0) {
+			bounds = meshBounds;
+			continue;
+		}
+
+		bounds.min = glm::min(bounds.min, meshBounds.min);
+		bounds.max = glm::max(bounds.max, meshBounds.max);
+
+		//Smallest sphere enclosing both spheres
+		float distance = glm::distance(bounds.center, meshBounds.center);
+		if (distance + meshBounds.radius <= bounds.radius) continue; // Already inside
+		if (distance + bounds.radius <= meshBounds.radius) {
+			bounds.center = meshBounds.center;
+			bounds.radius = meshBounds.radius;
+			continue;
+		}
+
+		float radius = (distance + bounds.radius + meshBounds.radius) * 0.5f;
+		bounds.center += (meshBounds.center - bounds.center) * ((radius - bounds.radius) / distance);
+		bounds.radius = radius;
+	}
+
+	if (meshes.empty()) {
+		bounds.min = bounds.max = bounds.center = glm::vec3(0);
+		bounds.radius = 0.0f;
+	}
+
+	//A manual radius overrides the sphere
+	if (sphereRadius > 0.0f) {
+		bounds.center = glm::vec3(0);
+		bounds.radius = sphereRadius;
+	}
+
+	boundsDirty = false;
+	return this->bounds;
+}
+
+MeshBounds Model::GetWorldBounds(const glm::mat4& world) {
+	MeshBounds local = GetBounds();
+	MeshBounds result;
+
+	result.center = glm::vec3(world * glm::vec4(local.center, 1.0f));
+	float scale = glm::max(glm::dot(glm::vec3(world[0]), glm::vec3(world[0])), glm::max(glm::dot(glm::vec3(world[1]), glm::vec3(world[1])), glm::dot(glm::vec3(world[2]), glm::vec3(world[2]))));
+	result.radius = local.radius * glm::sqrt(scale);
+
+	//Box around the transformed box, every matrix element adds its smallest and largest contribution
+	result.min = result.max = glm::vec3(world[3]);
+	for (int column = 0; column < 3; column++) {
+		for (int row = 0; row < 3; row++) {
+			float a = world[column][row] * local.min[column];
+			float b = world[column][row] * local.max[column];
+			result.min[row] += glm::min(a, b);
+			result.max[row] += glm::max(a, b);
+		}
+	}
+	return result;
 }
 
 bool Model::IgnoreFrustumState() {
@@ -72,10 +186,30 @@ void Model::IgnoreFrustum(bool state) {
 	this->ignoreFrustum = state;
 }
 
+bool Model::IsOccluder() {
+	return this->occluder;
+}
+
+void Model::SetOccluder(bool state) {
+	this->occluder = state;
+
+	//The meshes keep their geometry in system memory, so culling does not have to touch OpenGL. Meshes can be shared, so they are not unset
+	for (size_t i = 0; state && i < meshes.size(); i++) {
+		meshes[i]->SetOccluder(true);
+	}
+}
+
 DrawMode Model::GetDrawMode() {
 	return this->drawMode;
 }
 
 void Model::SetDrawMode(DrawMode mode) {
 	this->drawMode = mode;
+}
+
+Model::~Model() {
+	for (size_t i = 0; i < this->meshes.size(); i++) this->meshes[i]->Release();
+	for (size_t i = 0; i < this->lodMeshes.size(); i++) {
+		for (size_t j = 0; j < this->lodMeshes[i].size(); j++) this->lodMeshes[i][j]->Release();
+	}
 }
\ No newline at end of file
@@ -13,6 +13,8 @@
 #include "graphics\material.h"
 #include "mesh.h"
 
+#define LOD_HYSTERESIS 0.1f // Part of the lod screen size the screen size has to pass it by before the lod changes, prevents popping
+
 enum DrawMode {
 	Default = 0,
 	Late
@@ -22,9 +24,14 @@ class Model {
 private:
 	std::vector<Material*> materials; /// @brief List of materials used on this model, material index should match mesh index
 	std::vector<Mesh*> meshes; /// @brief List of meshes used on this Model, material index should match mesh index
+	std::vector<std::vector<Mesh*>> lodMeshes; /// @brief The lod meshes of every mesh, lodMeshes[mesh][level - 1]
+	std::vector<float> lodScreenSizes; /// @brief Screen size below which every lod level is used, lodScreenSizes[level - 1]
 	std::string name; /// @brief Name of the model
-	float sphereRadius; /// @brief The radius of the sphere of the model, for frustum culling
+	float sphereRadius; /// @brief Manual radius of the sphere of the model around its origin, 0 uses the bounds of the meshes
+	MeshBounds bounds; /// @brief The merged bounds of the meshes, in model space
+	bool boundsDirty; /// @brief True if meshes were added or removed since the bounds were merged
 	bool ignoreFrustum; /// @brief If true frustum culling will be ignored for this model
+	bool occluder; /// @brief If true the meshes are rasterized into the occlusion buffer, hiding the models behind it
 	DrawMode drawMode; /// @brief The mode in wich to draw
 public:
 
@@ -59,7 +66,7 @@ public:
 	Mesh* GetMesh(int index);
 
 	/**
-	* Adds a new mesh to the meshes list
+	* Adds a new mesh to the meshes list, the model holds a reference to it
 	*/
 	void AddMesh(Mesh* material);
 
@@ -73,6 +80,33 @@ public:
 	*/
 	int GetMeshesCount();
 
+	/**
+	* Adds the next lod level to the mesh where index matches. The level is used when the model covers less than screenSize of the
+	* screen height, levels should be added with decreasing screen sizes. Meshes with fewer levels use their last level
+	*/
+	void AddLod(int index, Mesh* mesh, float screenSize);
+
+	/**
+	* Returns the mesh where index matches at the lod level, level 0 is the mesh itself
+	*/
+	Mesh* GetMesh(int index, int lod);
+
+	/**
+	* Returns the amount of lod levels, including level 0
+	*/
+	int GetLodCount();
+
+	/**
+	* Returns the screen size below which the lod level is used
+	*/
+	float GetLodScreenSize(int lod);
+
+	/**
+	* Returns the lod level for the part of the screen height the model covers. Levels further from currentLod have to be passed
+	* by LOD_HYSTERESIS before they are chosen
+	*/
+	int SelectLod(float screenSize, int currentLod);
+
 	/**
 	* Sets the name of the model
 	*/
@@ -84,15 +118,30 @@ public:
 	std::string GetName();
 
 	/**
-	* Returns the sphere radius for this model
+	* Returns the sphere radius for this model, the manual radius if set, else the radius of the merged mesh bounds
 	*/
 	float GetSphereRadius();
 
 	/**
-	* Sets the sphere radius for this model
+	* Sets a manual sphere radius for this model, the sphere is centered at the origin of the model. 0 uses the mesh bounds again
 	*/
 	void SetSphereRadius(float amount);
 
+	/**
+	* Returns true if a manual sphere radius is set
+	*/
+	bool HasManualRadius();
+
+	/**
+	* Returns the bounds of all meshes merged, in model space. If a manual radius is set the sphere uses it
+	*/
+	MeshBounds GetBounds();
+
+	/**
+	* Returns the bounds transformed by a world matrix, the box encloses the rotated box and the radius is scaled by the largest axis scale
+	*/
+	MeshBounds GetWorldBounds(const glm::mat4& world);
+
 	/**
 	* Returns the IgnoreFrustum state
 	*/
@@ -103,6 +152,16 @@ public:
 	*/
 	void IgnoreFrustum(bool state);
 
+	/**
+	* Returns true if the model hides models behind it from the occlusion culler
+	*/
+	bool IsOccluder();
+
+	/**
+	* Sets if the model hides models behind it, occluders should be large, closed and cheap, like walls and floors
+	*/
+	void SetOccluder(bool state);
+
 	/**
 	* Returns the drawMode
 	*/
@@ -112,5 +171,10 @@ public:
 	* Sets the drawMode
 	*/
 	void SetDrawMode(DrawMode mode);
+
+	/**
+	* Destructor, releases the meshes
+	*/
+	~Model();
 };
 #endif // !MODEL_H
\ No newline at end of file
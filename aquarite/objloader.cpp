@@ -0,0 +1,255 @@
+/**
+*	Filename: objloader.cpp
+*
+*	Description: Source file for ObjLoader class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "objloader.h"
+#include "assetfile.h"
+#include <charconv>
+#include "jobsystem.h"
+
+//Relative flags of a chunk corner, set when the index was negative and still has to be offset by the preceding chunks
+#define OBJ_RELATIVE_POSITION 1
+#define OBJ_RELATIVE_UV 2
+#define OBJ_RELATIVE_NORMAL 4
+
+/**
+* A corner as parsed by a chunk, relative indices are local to the chunk until fixed up
+*/
+struct ObjChunkCorner {
+	ObjCorner corner;
+	unsigned char relative;
+};
+
+/**
+* The output of a single chunk
+*/
+struct ObjChunk {
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	std::vector<ObjChunkCorner> corners;
+};
+
+static inline bool IsSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char* SkipSpaces(const char* p, const char* end) {
+	while (p < end && IsSpace(*p)) p++;
+	return p;
+}
+
+static inline const char* ParseFloat(const char* p, const char* end, float& value) {
+	p = SkipSpaces(p, end);
+	if (p < end && *p == '+') p++; // from_chars does not accept a plus sign
+
+	std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec != std::errc()) {
+		value = 0.0f;
+		return p;
+	}
+	return result.ptr;
+}
+
+/**
+* Parses a single index of a face corner, resolves it to a 0 based index. Negative indices are made local to the chunk and flagged.
+*/
+static inline const char* ParseIndex(const char* p, const char* end, int count, int& index, unsigned char& relative, unsigned char flag) {
+	int value = 0;
+	std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec != std::errc() || value == 0) {
+		index = -1; // Missing
+		return result.ec != std::errc() ? p : result.ptr;
+	}
+
+	if (value < 0) {
+		index = count + value;
+		relative |= flag;
+	}
+	else {
+		index = value - 1;
+	}
+	return result.ptr;
+}
+
+static void ParseChunk(const char* begin, const char* end, ObjChunk& chunk) {
+	std::vector<ObjChunkCorner> face; // Corners of the current face, before triangulation
+
+	const char* p = begin;
+	while (p < end) {
+		//Find the end of the line
+		const char* lineEnd = p;
+		while (lineEnd < end && *lineEnd != '\n') lineEnd++;
+
+		p = SkipSpaces(p, lineEnd);
+
+		if (lineEnd - p >= 2 && p[0] == 'v' && IsSpace(p[1])) {
+			glm::vec3 position;
+			p = ParseFloat(p + 2, lineEnd, position.x);
+			p = ParseFloat(p, lineEnd, position.y);
+			p = ParseFloat(p, lineEnd, position.z);
+			chunk.positions.push_back(position);
+		}
+		else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && IsSpace(p[2])) {
+			glm::vec2 uv;
+			p = ParseFloat(p + 3, lineEnd, uv.x);
+			p = ParseFloat(p, lineEnd, uv.y);
+			chunk.uvs.push_back(uv);
+		}
+		else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && IsSpace(p[2])) {
+			glm::vec3 normal;
+			p = ParseFloat(p + 3, lineEnd, normal.x);
+			p = ParseFloat(p, lineEnd, normal.y);
+			p = ParseFloat(p, lineEnd, normal.z);
+			chunk.normals.push_back(normal);
+		}
+		else if (lineEnd - p >= 2 && p[0] == 'f' && IsSpace(p[1])) {
+			face.clear();
+			p += 2;
+
+			while (true) {
+				p = SkipSpaces(p, lineEnd);
+				if (p >= lineEnd || *p == '#') break;
+
+				//Corner formats: v, v/vt, v//vn, v/vt/vn
+				ObjChunkCorner corner;
+				corner.relative = 0;
+				corner.corner.uv = -1;
+				corner.corner.normal = -1;
+
+				const char* start = p;
+				p = ParseIndex(p, lineEnd, (int)chunk.positions.size(), corner.corner.position, corner.relative, OBJ_RELATIVE_POSITION);
+				if (p < lineEnd && *p == '/') {
+					p = ParseIndex(p + 1, lineEnd, (int)chunk.uvs.size(), corner.corner.uv, corner.relative, OBJ_RELATIVE_UV);
+					if (p < lineEnd && *p == '/') {
+						p = ParseIndex(p + 1, lineEnd, (int)chunk.normals.size(), corner.corner.normal, corner.relative, OBJ_RELATIVE_NORMAL);
+					}
+				}
+
+				//Skip whatever we could not parse, so bad data can not stall the loop
+				if (p == start) {
+					while (p < lineEnd && !IsSpace(*p)) p++;
+					continue;
+				}
+				face.push_back(corner);
+			}
+
+			//Triangulate as a fan, this handles triangles, quads and convex n-gons
+			for (size_t i = 1; i + 1 < face.size(); i++) {
+				chunk.corners.push_back(face[0]);
+				chunk.corners.push_back(face[i]);
+				chunk.corners.push_back(face[i + 1]);
+			}
+		}
+
+		//Other statements (comments, groups, materials, smoothing) are ignored
+		p = lineEnd + 1;
+	}
+}
+
+/**
+* Resolves a index against the total count, returns false if it does not exist
+*/
+static inline bool ResolveIndex(int& index, bool relative, int base, int count) {
+	if (relative) index += base;
+	else if (index == -1) return true; // Missing, allowed for uv and normal
+	return index >= 0 && index < count;
+}
+
+bool ObjLoader::Load(std::string path, ObjData& data) {
+	AssetFile file;
+	if (!file.Open(path)) {
+		return false;
+	}
+
+	//The whole file is in memory at once, parsing works on it without any per line allocations
+	const char* begin = (const char*)file.GetData();
+	Parse(begin, begin + file.GetSize(), data);
+	return true;
+}
+
+void ObjLoader::Parse(const char* begin, const char* end, ObjData& data) {
+	size_t size = end - begin;
+
+	//Split into line aligned chunks, one per thread of the job system as long as the chunks stay large enough
+	size_t chunkCount = JobSystem::GetWorkerCount() + 1;
+	if (chunkCount > size / OBJ_CHUNK_MIN_SIZE) chunkCount = size / OBJ_CHUNK_MIN_SIZE;
+	if (chunkCount == 0) chunkCount = 1;
+
+	std::vector<const char*> bounds;
+	bounds.push_back(begin);
+	for (size_t i = 1; i < chunkCount; i++) {
+		const char* split = begin + (size * i) / chunkCount;
+		if (split < bounds.back()) split = bounds.back();
+		while (split < end && *split != '\n') split++;
+		if (split < end) split++; // Start after the newline
+		bounds.push_back(split);
+	}
+	bounds.push_back(end);
+
+	std::vector<ObjChunk> chunks(chunkCount);
+	JobSystem::ParallelFor(chunkCount, 1, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++) {
+			ParseChunk(bounds[i], bounds[i + 1], chunks[i]);
+		}
+	});
+
+	//Merge the chunks, positive indices are already global, relative ones are offset by the data of the preceding chunks
+	size_t positionCount = 0, uvCount = 0, normalCount = 0, cornerCount = 0;
+	for (size_t i = 0; i < chunkCount; i++) {
+		positionCount += chunks[i].positions.size();
+		uvCount += chunks[i].uvs.size();
+		normalCount += chunks[i].normals.size();
+		cornerCount += chunks[i].corners.size();
+	}
+
+	data.positions.clear();
+	data.uvs.clear();
+	data.normals.clear();
+	data.corners.clear();
+	data.invalidTriangles = 0;
+	data.positions.reserve(positionCount);
+	data.uvs.reserve(uvCount);
+	data.normals.reserve(normalCount);
+	data.corners.reserve(cornerCount);
+
+	for (size_t i = 0; i < chunkCount; i++) {
+		ObjChunk& chunk = chunks[i];
+		int positionBase = (int)data.positions.size();
+		int uvBase = (int)data.uvs.size();
+		int normalBase = (int)data.normals.size();
+
+		data.positions.insert(data.positions.end(), chunk.positions.begin(), chunk.positions.end());
+		data.uvs.insert(data.uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+		data.normals.insert(data.normals.end(), chunk.normals.begin(), chunk.normals.end());
+
+		for (size_t t = 0; t + 2 < chunk.corners.size(); t += 3) {
+			ObjCorner triangle[3];
+			bool valid = true;
+
+			for (int c = 0; c < 3; c++) {
+				ObjChunkCorner& corner = chunk.corners[t + c];
+				triangle[c] = corner.corner;
+
+				valid &= triangle[c].position != -1 || (corner.relative & OBJ_RELATIVE_POSITION);
+				valid &= ResolveIndex(triangle[c].position, (corner.relative & OBJ_RELATIVE_POSITION) != 0, positionBase, (int)positionCount);
+				valid &= ResolveIndex(triangle[c].uv, (corner.relative & OBJ_RELATIVE_UV) != 0, uvBase, (int)uvCount);
+				valid &= ResolveIndex(triangle[c].normal, (corner.relative & OBJ_RELATIVE_NORMAL) != 0, normalBase, (int)normalCount);
+			}
+
+			if (!valid) {
+				data.invalidTriangles++;
+				continue;
+			}
+
+			data.corners.push_back(triangle[0]);
+			data.corners.push_back(triangle[1]);
+			data.corners.push_back(triangle[2]);
+		}
+	}
+}
\ No newline at end of file
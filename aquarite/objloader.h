@@ -0,0 +1,54 @@
+/**
+*	Filename: objloader.h
+*
+*	Description: Header file for ObjLoader class, parses wavefront obj files into triangulated index data
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+#include <string>
+#include <vector>
+#include "glm/glm.hpp"
+
+#define OBJ_CHUNK_MIN_SIZE (1 << 20) // Files are only split into chunks of at least this many bytes, smaller files are parsed on one thread
+
+/**
+* A obj face corner, the position/uv/normal index triple. Indices start at 0, missing uv or normal indices are -1
+*/
+struct ObjCorner {
+	int position, uv, normal;
+
+	bool operator==(const ObjCorner& other) const {
+		return position == other.position && uv == other.uv && normal == other.normal;
+	}
+};
+
+/**
+* The parsed data of a obj file, faces are triangulated so every 3 corners form a triangle
+*/
+struct ObjData {
+	std::vector<glm::vec3> positions; /// @brief All positions in the file
+	std::vector<glm::vec2> uvs; /// @brief All uv coordinates in the file
+	std::vector<glm::vec3> normals; /// @brief All normals in the file
+	std::vector<ObjCorner> corners; /// @brief The corners of all triangles
+	size_t invalidTriangles; /// @brief Amount of triangles skipped because they referenced data that does not exist
+};
+
+class ObjLoader {
+public:
+	/**
+	* Reads the file at once and parses it, returns false if the file cannot be read
+	*/
+	static bool Load(std::string path, ObjData& data);
+
+	/**
+	* Parses obj data from memory. Large buffers are split into line aligned chunks which are parsed in parallel,
+	* relative (negative) indices are fixed up after all chunks are done.
+	*/
+	static void Parse(const char* begin, const char* end, ObjData& data);
+};
+
+#endif // !OBJLOADER_H
\ No newline at end of file
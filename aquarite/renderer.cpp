@@ -7,9 +7,10 @@
 *
 *	 2018, Jens Heukers
 */
+#include <cfloat>
 #include <glm/gtc/type_ptr.hpp>
-#include <map>
 #include "resourcemanager.h"
+#include "resourceloader.h"
 #include "renderer.h"
 #include "core.h"
 #include "debug.h"
@@ -18,15 +19,35 @@
 #include "graphics/light.h"
 #include "ui/uielement.h"
 #include "ui/text.h"
+#include "jobsystem.h"
 #include "../external/imgui/imgui.h"
 #include "../external/imgui/imgui_impl_glfw.h"
 #include "../external/imgui/imgui_impl_opengl3.h"
 
-//Include glText external header file
+//Include glText external header file, only its glyph atlas is used. Texts are drawn by the sprite batch
+#define GLT_MANUAL_VIEWPORT
 #define GLT_IMPLEMENTATION
 #include "../external/gltext.h"
 
-#define MAX_LIGHTS 25
+#define NEAR_PLANE 0.1f
+#define FAR_PLANE 100.0f
+#define CLUSTER_PARALLEL_MIN_LIGHTS 256 // Fewer point lights are binned on the render thread, spreading them is not worth it
+#define CLUSTER_LIGHT_BATCH 128 // Point lights per job when preparing the lights
+#define CLUSTER_SLICE_BATCH 4 // Depth slices per job when binning
+
+void GenerateTextureBuffer(unsigned int &buffer, unsigned int &texture, GLenum format) {
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+	glBufferData(GL_TEXTURE_BUFFER, 0, NULL, GL_STREAM_DRAW);
+
+	//The texture keeps pointing to the buffer when its data is respecified
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
 
 void GenerateScreenQuadBuffers(unsigned int &vao, unsigned int &vbo) {
 	float quadVertices[] = {
@@ -53,197 +74,287 @@ void GenerateScreenQuadBuffers(unsigned int &vao, unsigned int &vbo) {
 void FrameBufferSizeCallback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
-	gltViewport(width, height);
 	Core::SetResolutionReference(Point2i(width, height));
 }
 
-bool Renderer::InFrustum(Camera* camera, Model* model, Vec3 position) {
-	//Calculate distance from camera to model
-	//Some math here that somehow magicly works, lets just keep calling this magic it does its thing :)
-	float sphereSize = model->GetSphereRadius();
-
-	//If we dont want to ignore frustum state
-	if (!model->IgnoreFrustumState()) {
-		//If the sphere is in our frustum
-		if (camera->GetFrustum()->sphereInFrustum(position, sphereSize) == Frustum::OUTSIDE) return false;
+MeshShaderUniforms* Renderer::GetMeshShaderUniforms(Shader* shader) {
+	std::map<Shader*, MeshShaderUniforms>::iterator it = meshShaderUniforms.find(shader);
+	if (it != meshShaderUniforms.end()) {
+		return &it->second;
 	}
 
-	return true; // Pass test
+	//First time we draw with this shader, resolve all handles once
+	MeshShaderUniforms uniforms;
+	uniforms.model = shader->Uniform("model");
+	uniforms.view = shader->Uniform("view");
+	uniforms.projection = shader->Uniform("projection");
+	uniforms.viewPos = shader->Uniform("viewPos");
+	uniforms.hasTexture = shader->Uniform("hasTexture");
+
+	uniforms.materialAmbientColor = shader->Uniform("material.ambientColor");
+	uniforms.materialDiffuseColor = shader->Uniform("material.diffuseColor");
+	uniforms.materialSpecular = shader->Uniform("material.specular");
+	uniforms.materialShininess = shader->Uniform("material.shininess");
+
+	//Samplers of the clustered lights never change, the program is bound so set them now
+	uniforms.clusterGrid = shader->Uniform("clusterGrid");
+	uniforms.clusterLightIndices = shader->Uniform("clusterLightIndices");
+	uniforms.pointLights = shader->Uniform("pointLights");
+	shader->SetInt(uniforms.clusterGrid, TEXTURE_UNIT_CLUSTER_GRID);
+	shader->SetInt(uniforms.clusterLightIndices, TEXTURE_UNIT_CLUSTER_LIGHTS);
+	shader->SetInt(uniforms.pointLights, TEXTURE_UNIT_POINT_LIGHTS);
+
+	meshShaderUniforms[shader] = uniforms;
+	return &meshShaderUniforms[shader];
 }
 
-void Renderer::HandleShaderLighting(Model* model, int i) {
+void Renderer::HandleShaderLighting(Shader* shader, MeshShaderUniforms* uniforms, Material* material) {
 	//Handle lighting
-	glm::vec3 diffuseColor = model->GetMaterial(i)->GetColor() * model->GetMaterial(i)->GetDiffuseColor();
-	glm::vec3 ambientColor = diffuseColor * model->GetMaterial(i)->GetAmbientColor();
-
-	//Turn off directional Lighting
-	model->GetMaterial(i)->GetShader()->SetVec3("dirLight.direction", glm::vec3(0, 0, 0));
-	model->GetMaterial(i)->GetShader()->SetVec3("dirLight.ambient", glm::vec3(0, 0, 0));
-	model->GetMaterial(i)->GetShader()->SetVec3("dirLight.diffuse", glm::vec3(0, 0, 0));
-	model->GetMaterial(i)->GetShader()->SetVec3("dirLight.specular", glm::vec3(0, 0, 0));
-
-	model->GetMaterial(i)->GetShader()->SetVec3("material.ambientColor", ambientColor);
-	model->GetMaterial(i)->GetShader()->SetVec3("material.diffuseColor", diffuseColor);
-	model->GetMaterial(i)->GetShader()->SetVec3("material.specular", model->GetMaterial(i)->GetSpecular());
-	model->GetMaterial(i)->GetShader()->SetFloat("material.shininess", model->GetMaterial(i)->GetShine());
-
-	for (size_t n = 0; n < MAX_LIGHTS; n += 1) {
-		if (lights.size() > MAX_LIGHTS) continue; // make sure we dont render more than MAX LIGHTS
-
-		if (n >= lights.size()) {
-			std::string _positionString = "pointLights[";
-			_positionString.append(std::to_string(n));
-			_positionString.append("]");
-			model->GetMaterial(i)->GetShader()->SetVec3(_positionString + ".position", glm::vec3(0, 0, 0));
-			model->GetMaterial(i)->GetShader()->SetVec3(_positionString + ".ambient", glm::vec3(0, 0, 0));
-			model->GetMaterial(i)->GetShader()->SetVec3(_positionString + ".diffuse", glm::vec3(0, 0, 0));
-			model->GetMaterial(i)->GetShader()->SetVec3(_positionString + ".specular", glm::vec3(0, 0, 0));
-			continue;
-		}
+	glm::vec3 diffuseColor = material->GetColor() * material->GetDiffuseColor();
+	glm::vec3 ambientColor = diffuseColor * material->GetAmbientColor();
+
+	shader->SetVec3(uniforms->materialAmbientColor, ambientColor);
+	shader->SetVec3(uniforms->materialDiffuseColor, diffuseColor);
+	shader->SetVec3(uniforms->materialSpecular, material->GetSpecular());
+	shader->SetFloat(uniforms->materialShininess, material->GetShine());
+}
 
+void Renderer::UploadLights() {
+	LightBlock block = {};
+
+	pointLightBounds.clear();
+	pointLightData.clear();
+	for (size_t n = 0; n < lights.size(); n++) {
 		if (lights[n]->GetLightType() == LightType::PointLight) {
-			std::string _positionString = "pointLights[";
-			_positionString.append(std::to_string(n));
-			_positionString.append("]");
-
-			//Handle 
-			model->GetMaterial(i)->GetShader()->SetVec3(_positionString + ".position", glm::vec3(lights[n]->position.x, lights[n]->position.y, lights[n]->position.z));
-			model->GetMaterial(i)->GetShader()->SetVec3(_positionString + ".ambient", lights[n]->GetAmbient());
-			model->GetMaterial(i)->GetShader()->SetVec3(_positionString + ".diffuse", lights[n]->GetDiffuse());
-			model->GetMaterial(i)->GetShader()->SetVec3(_positionString + ".specular", lights[n]->GetSpecular());
+			glm::vec3 position = lights[n]->GetPositionGlobal().ToGLM();
+			pointLightBounds.push_back(glm::vec4(position, lights[n]->GetRadius()));
+
+			LightBlockEntry entry;
+			entry.position = glm::vec4(position, lights[n]->GetRadius());
+			entry.ambient = glm::vec4(lights[n]->GetAmbient(), 0);
+			entry.diffuse = glm::vec4(lights[n]->GetDiffuse(), 0);
+			entry.specular = glm::vec4(lights[n]->GetSpecular(), 0);
+			pointLightData.push_back(entry);
 		}
 
 		if (lights[n]->GetLightType() == LightType::Directional) {
 			// Handle Directional Light, also cast down
 			DirectionalLight* light = static_cast<DirectionalLight*>(lights[n]);
-			model->GetMaterial(i)->GetShader()->SetVec3("dirLight.direction", light->GetDirection());
-			model->GetMaterial(i)->GetShader()->SetVec3("dirLight.ambient", light->GetAmbient());
-			model->GetMaterial(i)->GetShader()->SetVec3("dirLight.diffuse", light->GetDiffuse());
-			model->GetMaterial(i)->GetShader()->SetVec3("dirLight.specular", light->GetSpecular());
+			block.dirLight.position = glm::vec4(light->GetDirection(), 0);
+			block.dirLight.ambient = glm::vec4(light->GetAmbient(), 0);
+			block.dirLight.diffuse = glm::vec4(light->GetDiffuse(), 0);
+			block.dirLight.specular = glm::vec4(light->GetSpecular(), 0);
+			block.clusterSize.w = 1;
 		}
 	}
-}
 
-void Renderer::DrawModel(Camera* camera, Model* model, Vec3 position, Vec3 rotation, Vec3 scale) {
-	static Model* lastModel = nullptr; // Note static!, we can only declare once so we can use this property over the course of the program
-	bool sameModelAsLastDraw = false;
+	//Bin the point lights, so fragments only loop over the lights of their own cluster
+	if (pointLightBounds.size() < CLUSTER_PARALLEL_MIN_LIGHTS) {
+		lightClusters.Build(view, projection, NEAR_PLANE, FAR_PLANE, pointLightBounds.data(), pointLightBounds.size());
+	}
+	else {
+		lightClusters.SetView(view, projection, NEAR_PLANE, FAR_PLANE);
+		lightClusters.SetLights(pointLightBounds.data(), pointLightBounds.size());
+		JobSystem::ParallelFor(pointLightBounds.size(), CLUSTER_LIGHT_BATCH, [this](size_t first, size_t last) {
+			lightClusters.PrepareLights(first, last);
+		});
+		JobSystem::ParallelFor(CLUSTER_GRID_Z, CLUSTER_SLICE_BATCH, [this](size_t first, size_t last) {
+			lightClusters.BinSlices((int)first, (int)last);
+		});
+		lightClusters.Compact();
+	}
 
-	if (lastModel == model && model->GetMeshesCount() == 1) sameModelAsLastDraw = true; // Last model was same model, we dont have to bind VAO & Shader program again!
+	block.clusterSize = glm::ivec4(CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z, block.clusterSize.w);
+	block.clusterScale = glm::vec4((float)Core::GetResolution().x, (float)Core::GetResolution().y, lightClusters.GetSliceScale(), lightClusters.GetSliceBias());
+
+	//Respecify the whole buffers so the driver does not have to wait on last frame's draws
+	glBindBuffer(GL_UNIFORM_BUFFER, lightsUBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlock), &block, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	const std::vector<glm::uvec2>& grid = lightClusters.GetGrid();
+	const std::vector<unsigned>& indices = lightClusters.GetIndices();
+	glBindBuffer(GL_TEXTURE_BUFFER, clusterGridBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, grid.size() * sizeof(glm::uvec2), grid.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, clusterIndexBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, indices.size() * sizeof(unsigned), indices.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, pointLightBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, pointLightData.size() * sizeof(LightBlockEntry), pointLightData.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	//Bind the buffer textures to their units, the material texture stays on unit 0
+	glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_CLUSTER_GRID);
+	glBindTexture(GL_TEXTURE_BUFFER, clusterGridTexture);
+	glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_CLUSTER_LIGHTS);
+	glBindTexture(GL_TEXTURE_BUFFER, clusterIndexTexture);
+	glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_POINT_LIGHTS);
+	glBindTexture(GL_TEXTURE_BUFFER, pointLightTexture);
+	glActiveTexture(GL_TEXTURE0);
+}
 
-																						//Check if there are as equal meshes as there are materials
-	if (model->GetMeshesCount() != model->GetMaterialCount()) {
-		if (model->GetMeshesCount() > model->GetMaterialCount())
-			Debug::Log("Error: Model " + model->GetName() + " has more meshes than materials", typeid(*this).name());
-		else
-			Debug::Log("Error: Model " + model->GetName() + " has more materials than meshes", typeid(*this).name());
-		return; // Returns if not equal
-	}
+void Renderer::ResetBoundState() {
+	boundProgram = 0;
+	boundVAO = 0;
+	boundMaterial = nullptr;
+	boundUniforms = nullptr;
+}
 
-	for (int i = 0; i < model->GetMeshesCount(); i++) { // For every mesh on the model
-		if (!sameModelAsLastDraw) { // If model is different we have to bind some stuff
-			glUseProgram(model->GetMaterial(i)->GetShader()->GetShaderProgram()); // Use shader program
+void Renderer::BindDrawState(Shader* shader, Mesh* mesh, Material* material) {
+	//The render queue keeps draws with equal state together, so most of these binds are skipped
+	if (shader->GetShaderProgram() != boundProgram) {
+		glUseProgram(shader->GetShaderProgram()); // Use shader program
+		boundProgram = shader->GetShaderProgram();
+		boundUniforms = GetMeshShaderUniforms(shader);
+		boundMaterial = nullptr; // Material uniforms are stored per program
+	}
 
-			if (model->GetMesh(i)->GetVAO() == NULL) return; // If the Vertex Array Object equals NULL return
+	if (mesh->GetVAO() != boundVAO) {
+		glBindVertexArray(mesh->GetVAO());
+		boundVAO = mesh->GetVAO();
+	}
 
-			glBindVertexArray(model->GetMesh(i)->GetVAO());
-			if (model->GetMaterial(i)->GetDiffuse()) {
-				model->GetMaterial(i)->GetShader()->SetBool("hasTexture", true); // Set hasTexture to true
-				glBindTexture(GL_TEXTURE_2D, model->GetMaterial(i)->GetDiffuse()->GetGLTexture());
-			}
-			else {
-				model->GetMaterial(i)->GetShader()->SetBool("hasTexture", false); // Set hasTexture to true
-			}
+	if (material != boundMaterial) {
+		if (material->GetDiffuse()) {
+			shader->SetBool(boundUniforms->hasTexture, true); // Set hasTexture to true
+			glBindTexture(GL_TEXTURE_2D, material->GetDiffuse()->GetGLTexture());
+		}
+		else {
+			shader->SetBool(boundUniforms->hasTexture, false); // Set hasTexture to false
 		}
 
-		//Handle shader lighting
-		HandleShaderLighting(model, i);
-
-		//Model transform
-		glm::mat4 modelTransform(1);
-		modelTransform = glm::translate(modelTransform, glm::vec3(position.x, position.y, position.z)); // position
-		modelTransform = glm::rotate(modelTransform, Vec3::DegToRad(rotation.x), glm::vec3(1, 0, 0)); // Rotation
-		modelTransform = glm::rotate(modelTransform, Vec3::DegToRad(rotation.y), glm::vec3(0, 1, 0)); // Rotation
-		modelTransform = glm::rotate(modelTransform, Vec3::DegToRad(rotation.z), glm::vec3(0, 0, 1)); // Rotation
-		modelTransform = glm::scale(modelTransform, glm::vec3(scale.x, scale.y, scale.z)); // scale
-
-																						   //Handle view position and matrixes
-		model->GetMaterial(i)->GetShader()->SetVec3("viewPos", camera->GetPos());
-		GLint modelLoc = glGetUniformLocation(model->GetMaterial(i)->GetShader()->GetShaderProgram(), "model");
-		GLint viewLoc = glGetUniformLocation(model->GetMaterial(i)->GetShader()->GetShaderProgram(), "view");
-		GLint projLoc = glGetUniformLocation(model->GetMaterial(i)->GetShader()->GetShaderProgram(), "projection");
-
-		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelTransform));
-		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-		glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-		// Draw
-		glDrawArrays(GL_TRIANGLES, 0, model->GetMesh(i)->GetVerticesCount());
+		//Handle shader lighting, uniforms are kept by the program so we only have to do this when the material changes
+		HandleShaderLighting(shader, boundUniforms, material);
+		boundMaterial = material;
 	}
 }
 
-void Renderer::DrawSprite(Texture* texture, Vec3 position, Vec3 scale) {
-	if (texture == nullptr) return;
+void Renderer::DrawMesh(Camera* camera, Mesh* mesh, Material* material, const glm::mat4& modelTransform) {
+	Shader* shader = material->GetShader();
 
-	float tx = (((float)texture->textureData->width / Core::GetResolution().x) * 2) - 1.f;
-	float ty = (((float)texture->textureData->height / Core::GetResolution().y) * 2) - 1.f;
+	BindDrawState(shader, mesh, material);
 
-	float quadVertices[] = {
-		-1.0f,  ty,  0.0f, 1.0f,
-		-1.0f, -1.0f,  0.0f, 0.0f,
-		tx, -1.0f,  1.0f, 0.0f,
+	//Handle view position and matrixes, the shader skips the ones that did not change since the last draw
+	shader->SetVec3(boundUniforms->viewPos, camera->GetPos());
+	shader->SetMat4(boundUniforms->model, modelTransform);
+	shader->SetMat4(boundUniforms->view, view);
+	shader->SetMat4(boundUniforms->projection, projection);
 
-		-1.0f,  ty,  0.0f, 1.0f,
-		tx, -1.0f,  1.0f, 0.0f,
-		tx,  ty,  1.0f, 1.0f
-	};
+	// Draw
+	glDrawElements(GL_TRIANGLES, mesh->GetIndicesCount(), mesh->GetIndexType(), (void*)0);
+}
 
-	//Check if vao and vbo are not set, if not we generate buffers
-	if (spriteVAO == 0 && spriteVBO == 0) {
-		glGenVertexArrays(1, &spriteVAO);
-		glGenBuffers(1, &spriteVBO);
-		glBindVertexArray(spriteVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, spriteVBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-	}
-	else {
-		glBindBuffer(GL_ARRAY_BUFFER, spriteVBO);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(quadVertices), &quadVertices);
+void Renderer::DrawMeshInstanced(Camera* camera, Mesh* mesh, Material* material, size_t firstInstance, size_t count) {
+	BindDrawState(instancedShader, mesh, material);
+
+	//Point the instance matrix attributes at this group, a mat4 attribute takes up 4 vec4 locations
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	for (int c = 0; c < 4; c++) {
+		GLuint location = INSTANCE_ATTRIB_LOCATION + c;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(firstInstance * sizeof(glm::mat4) + c * sizeof(glm::vec4)));
+		glVertexAttribDivisor(location, 1);
 	}
 
-	glDisable(GL_DEPTH_TEST); // Disable depth testing
+	instancedShader->SetVec3(boundUniforms->viewPos, camera->GetPos());
+	instancedShader->SetMat4(boundUniforms->view, view);
+	instancedShader->SetMat4(boundUniforms->projection, projection);
+
+	// Draw
+	glDrawElementsInstanced(GL_TRIANGLES, mesh->GetIndicesCount(), mesh->GetIndexType(), (void*)0, (GLsizei)count);
+
+	//The attributes are stored in the vertex array of the mesh, reset them so non instanced draws of the mesh do not read them
+	for (int c = 0; c < 4; c++) {
+		GLuint location = INSTANCE_ATTRIB_LOCATION + c;
+		glVertexAttribDivisor(location, 0);
+		glDisableVertexAttribArray(location);
+	}
+}
 
-	glUseProgram(spriteShader->GetShaderProgram()); // Bind framebuffer shader program
-	glBindVertexArray(spriteVAO); // Bind Vertex Array Object
+void Renderer::DrawSprite(Texture* texture, Vec3 position, Vec3 scale) {
+	if (texture == nullptr) return;
 
-	//Normalize positions to get OpenGL coordinates
+	//Size of the texture and position in OpenGL coordinates, the quad starts at the bottom left of the screen
+	float tx = (((float)texture->textureData->width / Core::GetResolution().x) * 2) - 1.f;
+	float ty = (((float)texture->textureData->height / Core::GetResolution().y) * 2) - 1.f;
 	float x = (position.x / Core::GetResolution().x) * 2;
 	float y = (position.y / Core::GetResolution().y) * 2;
 
-	//Set uniforms
-	spriteShader->SetVec2("position", glm::vec2(x, y));
-	spriteShader->SetVec2("scale", glm::vec2(scale.x, scale.y));
+	glm::vec2 min = glm::vec2((-1.0f + x) * scale.x, (-1.0f + y) * scale.y);
+	glm::vec2 max = glm::vec2((tx + x) * scale.x, (ty + y) * scale.y);
+	spriteBatch->Draw(texture, min, max);
+}
+
+//Lays out the glyphs of a string the same way glText does, using its glyph table
+void BuildTextGlyphs(const std::string& text, std::vector<TextGlyph>& glyphs) {
+	glyphs.clear();
 
-	glBindTexture(GL_TEXTURE_2D, texture->GetGLTexture()); // Bind framebuffer texture
-	glDrawArrays(GL_TRIANGLES, 0, 6); // Draw quad
+	glm::vec2 cursor = glm::vec2(0.0f);
+	const float height = (float)_gltFontGlyphHeight;
+	for (size_t i = 0; i < text.size(); i++) {
+		char c = text[i];
+		if (c == '\n') {
+			cursor = glm::vec2(0.0f, cursor.y + height);
+			continue;
+		}
+		if (c == '\r') {
+			cursor.x = 0.0f;
+			continue;
+		}
+		if (!gltIsCharacterSupported(c)) continue;
+
+		const _GLTglyph& glyph = _gltFontGlyphs2[c - _gltFontGlyphMinChar];
+		if (glyph.drawable) {
+			TextGlyph quad;
+			quad.min = cursor;
+			quad.max = cursor + glm::vec2((float)glyph.w, height);
+			quad.uvMin = glm::vec2(glyph.u1, glyph.v1);
+			quad.uvMax = glm::vec2(glyph.u2, glyph.v2);
+			glyphs.push_back(quad);
+		}
+		cursor.x += (float)glyph.w;
+	}
 }
 
-void Renderer::DrawText(std::string text, Point4f color, Point2f position, float scale) {
-	GLTtext* glText = gltCreateText();
-	gltSetText(glText, text.c_str());
+void Renderer::DrawText(Text* text) {
+	TextMesh& mesh = textMeshes[text->GetId()];
+
+	//Only lay out the text when it changed, a new mesh starts at revision 0 like an empty text. Colour, position and scale are applied per draw
+	if (mesh.revision != text->GetRevision()) {
+		BuildTextGlyphs(text->GetText(), mesh.glyphs);
+		mesh.revision = text->GetRevision();
+	}
+	mesh.drawn = true;
+
+	Point4f color = text->GetColor();
+	glm::vec4 tint = glm::vec4(color.x, color.y, color.z, color.w);
 
-	gltBeginDraw();
+	//The text is positioned from the bottom left of the screen, the glyphs from its top left with y pointing down
+	glm::vec2 resolution = glm::vec2((float)Core::GetResolution().x, (float)Core::GetResolution().y);
+	glm::vec2 origin = glm::vec2(text->GetPosition().x, resolution.y - text->GetPosition().y);
+	float scale = text->GetTextScale();
 
-	gltColor(color.x, color.y, color.z, color.w);
+	for (size_t i = 0; i < mesh.glyphs.size(); i++) {
+		const TextGlyph& glyph = mesh.glyphs[i];
+		glm::vec2 topLeft = origin + glyph.min * scale;
+		glm::vec2 bottomRight = origin + glyph.max * scale;
 
-	//We want to calculate y position from the Core::GetResolution().x value
-	gltDrawText2D(glText, position.x, Core::GetResolution().y - position.y, scale);
+		//To normalized device coordinates, the bottom of the glyph is the minimum and samples the bottom of the atlas
+		glm::vec2 min = glm::vec2(topLeft.x / resolution.x * 2.0f - 1.0f, 1.0f - bottomRight.y / resolution.y * 2.0f);
+		glm::vec2 max = glm::vec2(bottomRight.x / resolution.x * 2.0f - 1.0f, 1.0f - topLeft.y / resolution.y * 2.0f);
+		spriteBatch->Draw(_gltText2DFontTexture, min, max, glm::vec2(glyph.uvMin.x, glyph.uvMax.y), glm::vec2(glyph.uvMax.x, glyph.uvMin.y), tint);
+	}
+}
 
-	gltEndDraw();
-	gltDeleteText(glText);
+void Renderer::ReleaseUnusedTextMeshes() {
+	for (std::unordered_map<unsigned, TextMesh>::iterator it = textMeshes.begin(); it != textMeshes.end();) {
+		if (!it->second.drawn) {
+			it = textMeshes.erase(it);
+		}
+		else {
+			it->second.drawn = false;
+			++it;
+		}
+	}
 }
 
 void Renderer::DrawSkybox() {
@@ -252,12 +363,9 @@ void Renderer::DrawSkybox() {
 	glDepthFunc(GL_LEQUAL);
 	glUseProgram(skybox->GetShader()->GetShaderProgram());
 
-	GLint viewLoc = glGetUniformLocation(skybox->GetShader()->GetShaderProgram(), "view");
-	GLint projLoc = glGetUniformLocation(skybox->GetShader()->GetShaderProgram(), "projection");
-
 	glm::mat4 convertedView = glm::mat4(glm::mat3(view)); // remove translation from view matrix
-	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(convertedView));
-	glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+	skybox->GetShader()->SetMat4("view", convertedView);
+	skybox->GetShader()->SetMat4("projection", projection);
 
 	glBindVertexArray(skybox->GetVAO());
 	glBindTexture(GL_TEXTURE_CUBE_MAP, skybox->GetCubeMapTexture());
@@ -304,22 +412,42 @@ int Renderer::Initialize(const char* windowTitle, int width, int height) {
 
 	//Create framebuffer instance and set shader
 	frameBuffer = new FrameBuffer(Core::GetResolution(), GL_COLOR_ATTACHMENT0);
-	frameBuffer->SetShader(ResourceManager::GetShader("_aquariteDefaultFrameBufferShader"));
+	frameBuffer->SetShader(ResourceManager::GetShader(ResourceManager::GetShaderHandle(RESOURCE_ID("_aquariteDefaultFrameBufferShader"))));
+	glUseProgram(frameBuffer->GetShader()->GetShaderProgram()); // Uniforms are set on the bound program
 	frameBuffer->GetShader()->SetInt("screenTexture", 0);
 
 	//Create skybox instance and set shader
 	//We wont set any textures, as this is up to the user
 	//The skybox is pure a holder
 	skybox = new SkyBox();
+	glUseProgram(skybox->GetShader()->GetShaderProgram());
 	skybox->GetShader()->SetInt("skybox", 0);
 
 	//Init sprite shader
 	spriteShader = new Shader("shaders/sprite_default.vs", "shaders/sprite_default.fs");
+	spriteBatch = new SpriteBatch(spriteShader);
+
+	//Create the lights uniform buffer, it stays bound to its binding point for every program
+	glGenBuffers(1, &lightsUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, lightsUBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlock), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, UNIFORMBLOCK_LIGHTS_BINDING, lightsUBO);
+
+	//Create the instance buffer, it is filled each frame
+	glGenBuffers(1, &instanceVBO);
+
+	//Create the clustered light buffers, they are filled each frame
+	GenerateTextureBuffer(clusterGridBuffer, clusterGridTexture, GL_RG32UI);
+	GenerateTextureBuffer(clusterIndexBuffer, clusterIndexTexture, GL_R32UI);
+	GenerateTextureBuffer(pointLightBuffer, pointLightTexture, GL_RGBA32F);
+	defaultShader = ResourceManager::GetShader(ResourceManager::GetShaderHandle(RESOURCE_ID("_aquariteDefaultShader")));
+	instancedShader = ResourceManager::GetShader(ResourceManager::GetShaderHandle(RESOURCE_ID("_aquariteDefaultInstancedShader")));
 
 	//Generate screen quad vbo
 	GenerateScreenQuadBuffers(screenVAO, screenVBO);
 
-	//Initialize GlText
+	//Initialize GlText, creates the glyph atlas the texts are drawn from
 	gltInit();
 
 	// Setup Dear ImGui context
@@ -337,13 +465,13 @@ int Renderer::Initialize(const char* windowTitle, int width, int height) {
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
 	ImGui_ImplOpenGL3_Init("#version 330");
 
-	//Start a new IMGUI Frame
-	ImGui_ImplOpenGL3_NewFrame();
-	ImGui_ImplGlfw_NewFrame();
-	ImGui::NewFrame();
+	//Nothing is bound yet
+	ResetBoundState();
 
 	//Set booleans
 	renderFrameBuffer = true; // Draw frame buffer to screen vao as texture by default
+	occlusionCulling = true; // Occlusion culling only costs time when there are occluders in view
+	occlusionStats = OcclusionStats();
 
 	return 0; // Return 0 (No errors)
 }
@@ -362,8 +490,8 @@ void Renderer::HandleTranslations(Camera* camera, float fov) {
 	view = glm::lookAt(cameraPos, cameraPos + cameraTarget, cameraUp);
 
 	//Projection matrix
-	projection = glm::perspective(glm::radians(fov), (float)size.x / (float)size.y, 0.1f, 100.0f);
-	camera->GetFrustum()->setCamInternals(fov, (float)size.x / (float)size.y, 0.1f, 100.0f);
+	projection = glm::perspective(glm::radians(fov), (float)size.x / (float)size.y, NEAR_PLANE, FAR_PLANE);
+	camera->GetFrustum()->setCamInternals(fov, (float)size.x / (float)size.y, NEAR_PLANE, FAR_PLANE);
 }
 
 void Renderer::EnableCursor(bool state) {
@@ -394,20 +522,12 @@ void Renderer::Clear() {
 	glBindVertexArray(0); // Unbind
 	glBindTexture(GL_TEXTURE_2D, 0); // Unbind current texture unit
 
-	//Clear drawlist
-	for (size_t i = 0; i < drawList.size(); i++) {
-		drawList.erase(drawList.begin() + i); // Erase pointer
-	}
-
-	for (size_t i = 0; i < uiElementList.size(); i++) {
-		uiElementList.erase(uiElementList.begin() + i); // Erase pointer
-	}
-
-	for (size_t i = 0; i < textList.size(); i++) {
-		textList.erase(textList.begin() + i); // Erase pointer
-	}
+	//Clear drawlist, erasing while iterating would skip every other pointer, so clear entirely
+	drawList.clear();
+	uiElementList.clear();
+	textList.clear();
 
-	//We start a new imgui frame here so we can draw in between frames
+	//We start a new imgui frame here, Clear is called at the start of a frame so everything after it can draw with imgui
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
@@ -426,6 +546,15 @@ void Renderer::RemoveLight(Light* light) {
 	}
 }
 
+void Renderer::RemoveShader(Shader* shader) {
+	std::map<Shader*, MeshShaderUniforms>::iterator it = meshShaderUniforms.find(shader);
+	if (it == meshShaderUniforms.end()) return;
+
+	//A new shader can get the same address, so the handles must not outlive the shader
+	if (boundUniforms == &it->second) ResetBoundState();
+	meshShaderUniforms.erase(it);
+}
+
 void Renderer::RegisterEntity(Entity* entity) {
 	drawList.push_back(entity); // Add pointer
 }
@@ -438,55 +567,207 @@ void Renderer::RegisterText(Text* text) {
 	textList.push_back(text);
 }
 
-void Renderer::Render(Camera* camera) {
-	std::vector<Entity*> renderEntities; // vector will be filled with entities that are ready for draw
+void Renderer::Cull(Camera* camera) {
 	size_t i;
-	for (i = 0; i < drawList.size(); i++) { // Do checks
-		//We do a frustum culling check and filter out all objects that are not in sight.
-		if (!drawList[i]->GetModel()->IgnoreFrustumState()) {
-			if (!InFrustum(camera, drawList[i]->GetModel(), drawList[i]->GetPositionGlobal())) continue;
+	glm::vec3 cameraPos = camera->GetPos();
+
+	//Test the world space bounding spheres of all entities against the frustum at once, models that ignore the frustum get a infinite sphere
+	cullSpheres.Clear();
+	cullBounds.clear();
+	for (i = 0; i < drawList.size(); i++) {
+		Model* model = drawList[i]->GetModel();
+		MeshBounds bounds = model->GetWorldBounds(drawList[i]->GetWorldMatrix());
+		cullSpheres.Push(bounds.center, model->IgnoreFrustumState() ? FLT_MAX : bounds.radius);
+		cullBounds.push_back(bounds);
+	}
+
+	glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+	FrustumCuller::ExtractPlanes(projection * view, planes);
+	FrustumCuller::CullParallel(planes, cullSpheres, visibility);
+
+	//Collect the entities in the frustum
+	cullCandidates.clear();
+	for (i = 0; i < drawList.size(); i++) {
+		if (!FrustumCuller::IsVisible(visibility.data(), i)) continue; // Filter out all objects that are not in sight
+		Model* model = drawList[i]->GetModel();
+
+		//The box is tighter for long or flat models, a manual radius is left as the only test
+		if (!model->IgnoreFrustumState() && !model->HasManualRadius()) {
+			if (!FrustumCuller::BoxInFrustum(planes, cullBounds[i].min, cullBounds[i].max)) continue;
+		}
+
+		//Check if there are as equal meshes as there are materials
+		if (model->GetMeshesCount() != model->GetMaterialCount()) {
+			if (model->GetMeshesCount() > model->GetMaterialCount())
+				Debug::Log("Error: Model " + model->GetName() + " has more meshes than materials", typeid(*this).name());
+			else
+				Debug::Log("Error: Model " + model->GetName() + " has more materials than meshes", typeid(*this).name());
+			continue; // Skip if not equal
+		}
+
+		cullCandidates.push_back(i);
+	}
+
+	//Rasterize the occluders in view, then drop the candidates that are fully behind them. The occluder geometry is a copy in system memory
+	occlusionStats = OcclusionStats();
+	if (occlusionCulling) {
+		occlusionBuffer.Begin(projection * view);
+		for (size_t c = 0; c < cullCandidates.size(); c++) {
+			Entity* entity = drawList[cullCandidates[c]];
+			Model* model = entity->GetModel();
+			if (!model->IsOccluder()) continue;
+
+			for (int m = 0; m < model->GetMeshesCount(); m++) {
+				occlusionBuffer.AddOccluder(entity->GetWorldMatrix(), model->GetMesh(m)->GetOccluderPositions(), model->GetMesh(m)->GetOccluderIndices());
+			}
+			occlusionStats.occluders++;
+		}
+
+		if (occlusionStats.occluders > 0) {
+			occlusionBuffer.Rasterize();
+			occlusionStats.triangles = occlusionBuffer.GetTriangleCount();
+
+			size_t visible = 0;
+			for (size_t c = 0; c < cullCandidates.size(); c++) {
+				size_t index = cullCandidates[c];
+				Model* model = drawList[index]->GetModel();
+
+				//Occluders are not tested, they are in front of their own depth. Models that ignore the frustum are always drawn
+				if (!model->IsOccluder() && !model->IgnoreFrustumState()) {
+					occlusionStats.tested++;
+					if (!occlusionBuffer.IsVisible(cullBounds[index].min, cullBounds[index].max)) {
+						occlusionStats.rejected++;
+						continue;
+					}
+				}
+				cullCandidates[visible++] = index;
+			}
+			cullCandidates.resize(visible);
+		}
+	}
+
+	//Build the render queue, every visible mesh gets a command with a packed sort key
+	renderQueue.Clear();
+	transforms.clear();
+	for (size_t c = 0; c < cullCandidates.size(); c++) {
+		i = cullCandidates[c];
+		Model* model = drawList[i]->GetModel();
+
+		//The bounds are already world space, this walks no transform hierarchy
+		float distance = glm::distance(cameraPos, cullBounds[i].center);
+		float depth = distance / FAR_PLANE;
+
+		//Pick the lod level on the part of the screen height covered by the bounding sphere
+		int lod = 0;
+		if (model->GetLodCount() > 1) {
+			distance = glm::max(distance, NEAR_PLANE);
+			lod = model->SelectLod(cullBounds[i].radius * projection[1][1] / distance, drawList[i]->GetLod());
+		}
+		drawList[i]->SetLod(lod);
+
+		//The world matrix is cached by the transform hierarchy, and shared by all of its meshes
+		unsigned transformIndex = (unsigned)transforms.size();
+		transforms.push_back(drawList[i]->GetWorldMatrix());
+
+		for (int m = 0; m < model->GetMeshesCount(); m++) {
+			Mesh* mesh = model->GetMesh(m, lod);
+
+			//A evicted mesh is skipped until the loader has read it again on a worker and uploaded it within the frame budget
+			if (mesh->IsEvicted()) {
+				ResourceLoader::ReloadMesh(mesh);
+				continue;
+			}
+			if (mesh->GetVAO() == NULL) continue; // If the Vertex Array Object equals NULL skip
+
+			uint64_t key = RenderQueue::MakeKey(model->GetDrawMode(),
+				model->GetMaterial(m)->GetShader()->GetShaderProgram(),
+				model->GetMaterial(m)->GetId(),
+				mesh->GetVAO(),
+				depth);
+
+			renderQueue.Push(key, drawList[i], mesh, m, transformIndex);
 		}
-		renderEntities.push_back(drawList[i]);
 	}
 
-	// We want to draw from back to front, so we have to do some sorting
-	//We can use a map for this and then draw those values to the screen
-	std::map<float, Entity*> sorted;
-	for (i = 0; i < renderEntities.size(); i++) { //Sort
-		float distance = Vec3::Distance(Vec3::ToVec3(camera->GetPos()), renderEntities[i]->position); // Get distance
-		sorted[distance] = renderEntities[i]; // Add to map
+	//Default draws are now grouped by state front to back, followed by late draws back to front
+	renderQueue.Sort();
+
+	//Fill the instance buffer with the world matrices of the default pass, in queue order so every instanced group is a contiguous range
+	instanceData.clear();
+	for (i = 0; i < renderQueue.Size(); i++) {
+		RenderCommand& command = renderQueue.Get(i);
+		if (RenderQueue::GetPass(command.key) != DrawMode::Default) break;
+		instanceData.push_back(transforms[command.transformIndex]);
+	}
+}
+
+void Renderer::Render(Camera* camera) {
+	size_t i;
+
+	if (instanceData.size() > 0) {
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, instanceData.size() * sizeof(glm::mat4), instanceData.data(), GL_STREAM_DRAW);
 	}
 
 	//Bind framebuffer and enable depth test
 	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer->GetFBO());
 	glEnable(GL_DEPTH_TEST);
 
-	//Render default models
-	for (std::map<float, Entity*>::reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it) { //Finally draw to screen
-		if (it->second->GetModel()->GetDrawMode() != DrawMode::Default) continue; // continue iteration if drawmode is not Default
-		DrawModel(camera, it->second->GetModel(), it->second->GetPositionGlobal(), it->second->GetRotationGlobal(), it->second->GetScale());
-	}
+	ResetBoundState(); // Other draws may have changed state since last frame
+	UploadLights();
+
+	bool skyboxDrawn = false;
+	for (i = 0; i < renderQueue.Size(); i++) {
+		RenderCommand& command = renderQueue.Get(i);
+		int pass = RenderQueue::GetPass(command.key);
+
+		// We want to draw the skybox before the late draw calls, this is due to transparancy
+		if (!skyboxDrawn && pass == DrawMode::Late) {
+			DrawSkybox();
+			ResetBoundState();
+			skyboxDrawn = true;
+		}
+
+		Mesh* mesh = command.mesh;
+		Material* material = command.entity->GetModel()->GetMaterial(command.meshIndex);
+
+		//Default draws using the default shader can be instanced, count how many following commands share the mesh and material
+		size_t count = 1;
+		if (pass == DrawMode::Default && material->GetShader() == defaultShader) {
+			while (i + count < instanceData.size()) {
+				RenderCommand& next = renderQueue.Get(i + count);
+				if (next.mesh != mesh || next.entity->GetModel()->GetMaterial(next.meshIndex) != material) break;
+				count++;
+			}
+		}
 
-	DrawSkybox(); // We want to draw the skybox before the late draw calls, this is due to transparancy
+		if (count >= MIN_INSTANCES) {
+			DrawMeshInstanced(camera, mesh, material, i, count);
+			i += count - 1; // Skip the instanced commands
+		}
+		else {
+			DrawMesh(camera, mesh, material, transforms[command.transformIndex]);
+		}
+	}
 
-	//Render models with late drawmode
-	for (std::map<float, Entity*>::reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it) { //Finally draw to screen
-		if (it->second->GetModel()->GetDrawMode() != DrawMode::Late) continue; // continue iteration if drawmode is not Late
-		DrawModel(camera, it->second->GetModel(), it->second->GetPositionGlobal(), it->second->GetRotationGlobal(), it->second->GetScale());
+	if (!skyboxDrawn) {
+		DrawSkybox();
 	}
 
-	//Draw all sprites
+	//Draw all sprites and texts, in as few draws as the textures allow. The glyphs of all texts come from one atlas,
+	//so they add a single texture to the batch and are drawn together with the sprites
+	spriteBatch->Begin();
 	for (i = 0; i < uiElementList.size(); i++) {
 		DrawSprite(uiElementList[i]->GetImage(), uiElementList[i]->GetPositionGlobal(), uiElementList[i]->GetScale());
 	}
-
-	//Disable depth testing (For drawing quad to screen & drawing text)
-	glDisable(GL_DEPTH_TEST); // Disable depth testing
-
-	//Draw all texts
 	for (i = 0; i < textList.size(); i++) {
-		DrawText(textList[i]->GetText(), textList[i]->GetColor(), Point2f(textList[i]->position.x, textList[i]->position.y), textList[i]->GetTextScale());
+		DrawText(textList[i]);
 	}
+	spriteBatch->End();
+	ReleaseUnusedTextMeshes();
+
+	//Disable depth testing (For drawing quad to screen)
+	glDisable(GL_DEPTH_TEST); // Disable depth testing
 
 	//Unbind framebuffer
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -530,7 +811,31 @@ void Renderer::DrawFrameBufferToScreenObject(bool state) {
 	this->renderFrameBuffer = state;
 }
 
+void Renderer::SetOcclusionCulling(bool state) {
+	this->occlusionCulling = state;
+}
+
+bool Renderer::GetOcclusionCulling() {
+	return this->occlusionCulling;
+}
+
+OcclusionStats Renderer::GetOcclusionStats() {
+	return this->occlusionStats;
+}
+
 Renderer::~Renderer() {
+	delete spriteBatch;
+	gltTerminate();
+
+	glDeleteBuffers(1, &lightsUBO);
+	glDeleteBuffers(1, &instanceVBO);
+	glDeleteBuffers(1, &clusterGridBuffer);
+	glDeleteBuffers(1, &clusterIndexBuffer);
+	glDeleteBuffers(1, &pointLightBuffer);
+	glDeleteTextures(1, &clusterGridTexture);
+	glDeleteTextures(1, &clusterIndexTexture);
+	glDeleteTextures(1, &pointLightTexture);
+
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
@@ -14,12 +14,37 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
+#include <map>
+#include <unordered_map>
 #include "math/vec3.h"
 #include "math/pointx.h"
+#include "mesh.h"
 #include "graphics/framebuffer.h"
 #include "graphics/cubemap.h"
+#include "graphics/renderqueue.h"
+#include "graphics/shader.h"
+#include "graphics/spritebatch.h"
+#include "graphics/lightclusters.h"
+#include "graphics/frustumculler.h"
+#include "graphics/occlusionbuffer.h"
 
-//Forward declarations
+#define MIN_INSTANCES 2 // Groups smaller than this are drawn without instancing
+#define INSTANCE_ATTRIB_LOCATION 3 // First attribute location of the instance matrix, it takes up 4 locations
+
+//Texture units of the clustered light buffers, unit 0 is used by the material
+#define TEXTURE_UNIT_CLUSTER_GRID 1
+#define TEXTURE_UNIT_CLUSTER_LIGHTS 2
+#define TEXTURE_UNIT_POINT_LIGHTS 3
+
+/**
+* Occlusion culling stats of the last frame
+*/
+struct OcclusionStats {
+	size_t occluders; /// @brief Occluders rasterized into the occlusion buffer
+	size_t triangles; /// @brief Occluder triangles after clipping
+	size_t tested; /// @brief Objects tested against the occlusion buffer
+	size_t rejected; /// @brief Objects found to be fully behind the occluders
+};
 class Entity;
 class UIElement;
 class Text;
@@ -27,6 +52,53 @@ class Camera;
 class Model;
 class Light;
 class Texture;
+class Material;
+class Mesh;
+
+/**
+* Uniform handles of a shader used to draw meshes, resolved once per shader
+*/
+struct MeshShaderUniforms {
+	UniformHandle model, view, projection, viewPos, hasTexture;
+	UniformHandle materialAmbientColor, materialDiffuseColor, materialSpecular, materialShininess;
+	UniformHandle clusterGrid, clusterLightIndices, pointLights;
+};
+
+/**
+* A glyph quad of a text, in pixels relative to the top left of the text with y pointing down
+*/
+struct TextGlyph {
+	glm::vec2 min, max; /// @brief The corners of the quad
+	glm::vec2 uvMin, uvMax; /// @brief The corners of the glyph in the glyph atlas
+};
+
+/**
+* The cached glyph quads of a Text entity
+*/
+struct TextMesh {
+	std::vector<TextGlyph> glyphs; /// @brief The quads of the drawable characters
+	unsigned revision; /// @brief The revision of the Text the quads were built from
+	bool drawn; /// @brief True if the mesh was drawn this frame, meshes that are not drawn are released
+};
+
+/**
+* A light as stored in the Lights uniform block and the point light buffer, std140 pads vec3 to vec4
+*/
+struct LightBlockEntry {
+	glm::vec4 position; /// @brief Position and radius of a point light, or direction of a directional light
+	glm::vec4 ambient;
+	glm::vec4 diffuse;
+	glm::vec4 specular;
+};
+
+/**
+* CPU side of the std140 Lights uniform block, has to match the block declared in the shaders
+*/
+struct LightBlock {
+	LightBlockEntry dirLight; /// @brief The directional light
+	glm::ivec4 clusterSize; /// @brief xyz holds the cluster grid size, w is 1 if there is a directional light
+	glm::vec4 clusterScale; /// @brief xy holds the screen size, z and w map log(depth) to a depth slice
+};
 
 class Renderer {
 private:
@@ -34,7 +106,9 @@ private:
 	std::vector<Entity*> drawList; /// @brief The vector of entities to be drawn, will reset each frame
 	std::vector<UIElement*> uiElementList; /// @brief The vector of sprites to be drawn, will reset each frame
 	std::vector<Text*> textList; /// @brief The vector of text to be drawn, will reset each frame
+	std::unordered_map<unsigned, TextMesh> textMeshes; /// @brief Cached text meshes by entity id, kept for as long as the text is drawn each frame
 	std::vector<Light*> lights; /// @brief Vector containing lights.
+	RenderQueue renderQueue; /// @brief Sorted queue of draw commands, will be rebuild each frame
 	glm::mat4 view, projection; /// @brief The view and projection matrixes
 
 	//Custom object holders
@@ -43,38 +117,100 @@ private:
 
 	//Shader used for drawing sprites
 	Shader* spriteShader; ///@brief The shader used to draw sprites
+	SpriteBatch* spriteBatch; /// @brief Collects the sprites of a frame, so they are drawn in as few draws as possible
 
 	//We need to create a screen vbo so we can render our scene to a quad, for post processing purposes
 	unsigned int screenVAO, screenVBO; /// @brief Screen Vertex Array Object, Screen Vertex Buffer Object
-	unsigned int spriteVAO, spriteVBO; /// @brief Sprite VBO and VAO, will be rebuffered each sprite draw, to fit size
+	unsigned int lightsUBO; /// @brief Uniform buffer holding the Lights block, uploaded once per frame
+	unsigned int instanceVBO; /// @brief Instance buffer holding the world matrices of the default pass in queue order, uploaded once per frame
+	unsigned int clusterGridBuffer, clusterGridTexture; /// @brief Buffer texture holding the offset and light count of every cluster
+	unsigned int clusterIndexBuffer, clusterIndexTexture; /// @brief Buffer texture holding the light indices of all clusters
+	unsigned int pointLightBuffer, pointLightTexture; /// @brief Buffer texture holding the point lights, 4 texels per light
+
+	//Clustered lighting
+	LightClusters lightClusters; /// @brief Bins the point lights into clusters of the view frustum
+	std::vector<glm::vec4> pointLightBounds; /// @brief World position and radius of the point lights, will reset each frame
+	std::vector<LightBlockEntry> pointLightData; /// @brief The point lights as uploaded to the point light buffer, will reset each frame
+
+	//Per frame transform data
+	std::vector<glm::mat4> transforms; /// @brief World matrices of the entities in the render queue, will reset each frame
+	std::vector<glm::mat4> instanceData; /// @brief World matrices of the default pass commands in queue order, will reset each frame
+
+	//Frustum culling
+	SphereArrays cullSpheres; /// @brief World space bounding spheres of the entities in the draw list, will reset each frame
+	std::vector<MeshBounds> cullBounds; /// @brief World space bounds of the entities in the draw list, will reset each frame
+	std::vector<uint32_t> visibility; /// @brief Visibility bitmask of the draw list, a bit per entity
+	std::vector<size_t> cullCandidates; /// @brief Draw list indices that passed frustum culling, will reset each frame
+
+	//Occlusion culling
+	OcclusionBuffer occlusionBuffer; /// @brief Software depth buffer the occluders in view are rasterized into
+	OcclusionStats occlusionStats; /// @brief Occlusion culling stats of the last frame
+	bool occlusionCulling; /// @brief If true, objects behind the occluders are not drawn
+
+	//Instancing
+	Shader* defaultShader; /// @brief The default mesh shader, materials using it can be drawn instanced
+	Shader* instancedShader; /// @brief Instanced variant of the default shader, reads the world matrix from vertex attributes
+
+	//Currently bound state, so we only rebind what changes between draws
+	unsigned boundProgram; /// @brief The currently bound shader program
+	unsigned boundVAO; /// @brief The currently bound vertex array object
+	Material* boundMaterial; /// @brief The material of which the uniforms and textures are currently bound
+	MeshShaderUniforms* boundUniforms; /// @brief The uniform handles of the currently bound shader
+	std::map<Shader*, MeshShaderUniforms> meshShaderUniforms; /// @brief Resolved uniform handles for every shader drawn with
 
 	//Booleans
 	bool renderFrameBuffer; /// @brief If true, the frameBuffer will be rendered to screen quad, and displayed
 
 	/**
-	* Returns true if model is indeed inside our frustum
+	* Returns the uniform handles of the shader, resolves them the first time the shader is used
+	*/
+	MeshShaderUniforms* GetMeshShaderUniforms(Shader* shader);
+
+	/**
+	* Packs the lights into the Lights uniform buffer and bins the point lights into clusters,
+	* the buffers are shared by all programs so this happens once per frame
 	*/
-	bool InFrustum(Camera* camera, Model* model, Vec3 position);
+	void UploadLights();
 
 	/**
-	* Handles the lighting in the shader, i defines the currently rendered material/mesh
+	* Handles the lighting properties of the material in the shader, shader must be bound
 	*/
-	void HandleShaderLighting(Model* model, int i);
+	void HandleShaderLighting(Shader* shader, MeshShaderUniforms* uniforms, Material* material);
 
 	/**
-	* Renders a model to the screen
+	* Resets the bound state, should be called whenever state is changed outside of DrawMesh
 	*/
-	void DrawModel(Camera* camera, Model* model, Vec3 position, Vec3 rotation, Vec3 scale);
+	void ResetBoundState();
 
 	/**
-	* Draws a 2d sprite on the screen
+	* Binds the program, vertex array and material, only binds state that differs from the last draw
+	*/
+	void BindDrawState(Shader* shader, Mesh* mesh, Material* material);
+
+	/**
+	* Renders a single mesh of the entity's model to the screen
+	*/
+	void DrawMesh(Camera* camera, Mesh* mesh, Material* material, const glm::mat4& modelTransform);
+
+	/**
+	* Renders count instances of the mesh, the world matrices are read from the instance buffer starting at firstInstance
+	*/
+	void DrawMeshInstanced(Camera* camera, Mesh* mesh, Material* material, size_t firstInstance, size_t count);
+
+	/**
+	* Adds a 2d sprite to the sprite batch, the batch must be started
 	*/
 	void DrawSprite(Texture* texture, Vec3 position, Vec3 scale);
 
 	/**
-	* Draws text to the screen
+	* Adds the glyph quads of a text to the sprite batch, the quads are only rebuild when the text changed. The batch must be started
 	*/
-	void DrawText(std::string text, Point4f colour, Point2f position, float scale);
+	void DrawText(Text* text);
+
+	/**
+	* Releases the text meshes that were not drawn this frame
+	*/
+	void ReleaseUnusedTextMeshes();
 
 	/**
 	* Renders the skybox
@@ -121,6 +257,11 @@ public:
 	*/
 	void RemoveLight(Light* light);
 
+	/**
+	* Drops the uniform handles resolved for a shader, must be called before the shader is deleted
+	*/
+	void RemoveShader(Shader* shader);
+
 
 	/**
 	* Registers a entity to the drawList
@@ -138,7 +279,14 @@ public:
 	void RegisterText(Text* sprite);
 
 	/**
-	* Prepares and renders the entire drawList
+	* Frustum and occlusion culls the drawList and builds the sorted render queue and instance data, does not touch OpenGL.
+	* Occluders are rasterized from the positions and indices their meshes copied when they were decoded.
+	* Evicted meshes are not loaded here, they are skipped and queued with ResourceLoader::ReloadMesh
+	*/
+	void Cull(Camera* camera);
+
+	/**
+	* Renders the render queue build by Cull, the sprites, texts and imgui
 	*/
 	void Render(Camera* camera);
 
@@ -173,6 +321,21 @@ public:
 	*/
 	void DrawFrameBufferToScreenObject(bool state);
 
+	/**
+	* Enables or disables occlusion culling
+	*/
+	void SetOcclusionCulling(bool state);
+
+	/**
+	* Returns true if occlusion culling is enabled
+	*/
+	bool GetOcclusionCulling();
+
+	/**
+	* Returns the occlusion culling stats of the last frame
+	*/
+	OcclusionStats GetOcclusionStats();
+
 	/**
 	* Destructor
 	*/
@@ -0,0 +1,168 @@
+/**
+*	Filename: residency.cpp
+*
+*	Description: Source file for Resident and ResidencyManager classes.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include "residency.h"
+
+ResidencyManager* ResidencyManager::_instance;
+
+/**
+* Returns bytes as megabytes
+*/
+static double ToMegabytes(size_t bytes) {
+	return (double)bytes / (1024.0 * 1024.0);
+}
+
+Resident::Resident(ResidentType type) {
+	this->residentType = type;
+	this->cpuSize = 0;
+	this->gpuSize = 0;
+	this->lastUsedFrame = 0;
+	this->refCount = 0;
+	this->residentIndex = (size_t)-1;
+}
+
+void Resident::SetResidentSize(size_t cpuSize, size_t gpuSize) {
+	ResidencyManager* manager = ResidencyManager::GetInstance();
+	if (this->residentIndex == (size_t)-1) {
+		this->residentIndex = manager->residents.size();
+		manager->residents.push_back(this);
+		this->lastUsedFrame = manager->frame; // Just loaded counts as used
+	}
+
+	manager->cpuSize = manager->cpuSize - this->cpuSize + cpuSize;
+	manager->gpuSize = manager->gpuSize - this->gpuSize + gpuSize;
+	this->cpuSize = cpuSize;
+	this->gpuSize = gpuSize;
+}
+
+void Resident::MarkUsed() {
+	if (ResidencyManager::_instance) this->lastUsedFrame = ResidencyManager::_instance->frame;
+}
+
+void Resident::AddRef() {
+	this->refCount++;
+}
+
+void Resident::Release() {
+	if (this->refCount > 0) this->refCount--;
+}
+
+int Resident::GetRefCount() {
+	return this->refCount;
+}
+
+Resident::~Resident() {
+	if (this->residentIndex == (size_t)-1 || !ResidencyManager::_instance) return;
+
+	//Swap with the last resident so removing is constant time
+	ResidencyManager* manager = ResidencyManager::_instance;
+	manager->cpuSize -= this->cpuSize;
+	manager->gpuSize -= this->gpuSize;
+	manager->residents[this->residentIndex] = manager->residents.back();
+	manager->residents[this->residentIndex]->residentIndex = this->residentIndex;
+	manager->residents.pop_back();
+}
+
+ResidencyManager::ResidencyManager() {
+	this->cpuBudget = (size_t)RESIDENCY_CPU_BUDGET;
+	this->gpuBudget = (size_t)RESIDENCY_GPU_BUDGET;
+	this->cpuSize = 0;
+	this->gpuSize = 0;
+	this->frame = 1;
+	this->evictions = 0;
+	this->reloads = 0;
+}
+
+ResidencyManager* ResidencyManager::GetInstance() {
+	if (!_instance) {
+		_instance = new ResidencyManager();
+	}
+	return _instance;
+}
+
+void ResidencyManager::Evict(bool gpu) {
+	size_t& usage = gpu ? gpuSize : cpuSize;
+	size_t budget = gpu ? gpuBudget : cpuBudget;
+	if (usage <= budget) return;
+
+	//Resources used in the last frame are likely used in the next one as well
+	std::vector<Resident*> candidates;
+	for (size_t i = 0; i < residents.size(); i++) {
+		Resident* resident = residents[i];
+		if (resident->lastUsedFrame < frame && (gpu ? resident->gpuSize : resident->cpuSize) > 0) candidates.push_back(resident);
+	}
+
+	//Unreferenced first, then the least recently used
+	std::sort(candidates.begin(), candidates.end(), [](const Resident* a, const Resident* b) {
+		if ((a->refCount == 0) != (b->refCount == 0)) return a->refCount == 0;
+		return a->lastUsedFrame < b->lastUsedFrame;
+	});
+
+	for (size_t i = 0; i < candidates.size() && usage > budget; i++) {
+		if (gpu ? candidates[i]->ReleaseGpu() : candidates[i]->ReleaseCpu()) evictions++;
+	}
+}
+
+void ResidencyManager::Update() {
+	ResidencyManager* instance = GetInstance();
+	instance->Evict(true); // Releasing video memory releases the system memory copy as well
+	instance->Evict(false);
+	instance->frame++;
+}
+
+void ResidencyManager::SetBudgets(size_t cpuBudget, size_t gpuBudget) {
+	GetInstance()->cpuBudget = cpuBudget;
+	GetInstance()->gpuBudget = gpuBudget;
+}
+
+void ResidencyManager::CountReload() {
+	GetInstance()->reloads++;
+}
+
+ResidencyStats ResidencyManager::GetStats(ResidentType type) {
+	ResidencyStats stats = {};
+	std::vector<Resident*>& residents = GetInstance()->residents;
+	for (size_t i = 0; i < residents.size(); i++) {
+		if (residents[i]->residentType != type) continue;
+		stats.count++;
+		if (residents[i]->gpuSize == 0) stats.evicted++;
+		stats.cpuSize += residents[i]->cpuSize;
+		stats.gpuSize += residents[i]->gpuSize;
+	}
+	return stats;
+}
+
+std::string ResidencyManager::GetReport() {
+	static const char* names[ResidentTypeCount] = { "Textures", "Meshes" };
+	ResidencyManager* instance = GetInstance();
+
+	std::stringstream report;
+	report << std::fixed << std::setprecision(1);
+	report << "CPU " << ToMegabytes(instance->cpuSize) << " / " << ToMegabytes(instance->cpuBudget) << " MB, ";
+	report << "GPU " << ToMegabytes(instance->gpuSize) << " / " << ToMegabytes(instance->gpuBudget) << " MB\n";
+	for (int type = 0; type < ResidentTypeCount; type++) {
+		ResidencyStats stats = GetStats((ResidentType)type);
+		report << names[type] << ": " << stats.count << " (" << stats.evicted << " evicted), ";
+		report << "CPU " << ToMegabytes(stats.cpuSize) << " MB, GPU " << ToMegabytes(stats.gpuSize) << " MB\n";
+	}
+	report << instance->evictions << " evictions, " << instance->reloads << " reloads";
+	return report.str();
+}
+
+void ResidencyManager::Destroy() {
+	if (!_instance) return;
+	for (size_t i = 0; i < _instance->residents.size(); i++) {
+		_instance->residents[i]->residentIndex = (size_t)-1; // Resources deleted later do not touch the manager
+	}
+	delete _instance;
+	_instance = nullptr;
+}
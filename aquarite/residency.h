@@ -0,0 +1,162 @@
+/**
+*	Filename: residency.h
+*
+*	Description: Header file for Resident and ResidencyManager classes, keeps the memory of loaded resources within a budget
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef RESIDENCY_H
+#define RESIDENCY_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define RESIDENCY_CPU_BUDGET (256ull * 1024 * 1024) // Default bytes of system memory resources may use
+#define RESIDENCY_GPU_BUDGET (512ull * 1024 * 1024) // Default bytes of video memory resources may use
+
+/**
+* The kinds of resident resources, for the statistics
+*/
+enum ResidentType {
+	ResidentTexture,
+	ResidentMesh,
+	ResidentTypeCount
+};
+
+/**
+* A resource whose memory is tracked. Resources read from a file can give up their memory and load it again when used,
+* the derived class decides what can be released. Sizes must be reported from the main thread
+*/
+class Resident {
+	friend class ResidencyManager;
+private:
+	ResidentType residentType; /// @brief The kind of resource
+	size_t cpuSize; /// @brief Reported bytes of system memory
+	size_t gpuSize; /// @brief Reported bytes of video memory
+	uint64_t lastUsedFrame; /// @brief Frame the resource was last used in
+	int refCount; /// @brief Amount of materials, models and other resources using this one
+	size_t residentIndex; /// @brief Index in the residents of the manager, (size_t)-1 if not registered
+protected:
+	/**
+	* Reports the memory used, registers the resource with the manager the first time
+	*/
+	void SetResidentSize(size_t cpuSize, size_t gpuSize);
+
+	/**
+	* Marks the resource as used in the current frame
+	*/
+	void MarkUsed();
+
+	/**
+	* Frees the system memory copy if it can be read again, returns true if anything was freed
+	*/
+	virtual bool ReleaseCpu() = 0;
+
+	/**
+	* Frees the video memory if it can be loaded again on the next use, returns true if anything was freed
+	*/
+	virtual bool ReleaseGpu() = 0;
+public:
+	/**
+	* Constructor
+	*/
+	Resident(ResidentType type);
+
+	/**
+	* Adds a reference, done by every object that keeps a pointer to the resource
+	*/
+	void AddRef();
+
+	/**
+	* Removes a reference
+	*/
+	void Release();
+
+	/**
+	* Returns the amount of references
+	*/
+	int GetRefCount();
+
+	/**
+	* Destructor, unregisters the resource
+	*/
+	virtual ~Resident();
+};
+
+/**
+* Residency statistics of a kind of resource
+*/
+struct ResidencyStats {
+	size_t count; /// @brief Amount of registered resources
+	size_t evicted; /// @brief Amount of resources without video memory
+	size_t cpuSize; /// @brief Bytes of system memory
+	size_t gpuSize; /// @brief Bytes of video memory
+};
+
+/**
+* Tracks the memory of all resident resources. When a budget is exceeded the least recently used resources release their memory,
+* unreferenced ones first. Resources used in the last frame are never released, an evicted resource loads itself again when used.
+*/
+class ResidencyManager {
+	friend class Resident;
+private:
+	static ResidencyManager* _instance; /// @brief Residency manager singleton instance
+	std::vector<Resident*> residents; /// @brief All registered resources
+	size_t cpuBudget; /// @brief Bytes of system memory resources may use
+	size_t gpuBudget; /// @brief Bytes of video memory resources may use
+	size_t cpuSize; /// @brief Bytes of system memory in use
+	size_t gpuSize; /// @brief Bytes of video memory in use
+	uint64_t frame; /// @brief Current frame
+	size_t evictions; /// @brief Amount of times a resource released memory
+	size_t reloads; /// @brief Amount of times a evicted resource was loaded again
+
+	/**
+	* Constructor
+	*/
+	ResidencyManager();
+
+	/**
+	* Returns the instance, if none is existant it will create a new instance
+	*/
+	static ResidencyManager* GetInstance();
+
+	/**
+	* Releases memory of the least recently used resources until the usage is within the budget, gpu selects the budget
+	*/
+	void Evict(bool gpu);
+public:
+	/**
+	* Enforces the budgets and starts a new frame, called once per frame on the main thread
+	*/
+	static void Update();
+
+	/**
+	* Sets the budgets in bytes, they are enforced on the next Update
+	*/
+	static void SetBudgets(size_t cpuBudget, size_t gpuBudget);
+
+	/**
+	* Counts a evicted resource being loaded again
+	*/
+	static void CountReload();
+
+	/**
+	* Returns the statistics of a kind of resource
+	*/
+	static ResidencyStats GetStats(ResidentType type);
+
+	/**
+	* Returns the usage against the budgets, the statistics per kind and the evictions and reloads
+	*/
+	static std::string GetReport();
+
+	/**
+	* Deletes the instance, the resources must already be deleted
+	*/
+	static void Destroy();
+};
+
+#endif // !RESIDENCY_H
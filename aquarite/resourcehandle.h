@@ -0,0 +1,207 @@
+/**
+*	Filename: resourcehandle.h
+*
+*	Description: Header file for resource ids, handles and the ResourceTable they index
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef RESOURCEHANDLE_H
+#define RESOURCEHANDLE_H
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+
+#define RESOURCE_TABLE_MIN_CAPACITY 64 // Initial amount of buckets of a resource table, must be a power of two
+
+typedef uint32_t ResourceId; // FNV-1a hash of a resource name
+
+/**
+* Returns the 32 bit FNV-1a hash of a name, can be evaluated at compile time
+*/
+constexpr ResourceId HashResourceName(const char* name, ResourceId hash = 2166136261u) {
+	return *name == 0 ? hash : HashResourceName(name + 1, (hash ^ (ResourceId)(unsigned char)*name) * 16777619u);
+}
+
+/**
+* Returns the 32 bit FNV-1a hash of a name
+*/
+inline ResourceId HashResourceName(const std::string& name) {
+	return HashResourceName(name.c_str());
+}
+
+// Hashes a string literal at compile time, for example RESOURCE_ID("_aquariteDefaultShader")
+#define RESOURCE_ID(name) std::integral_constant<ResourceId, HashResourceName(name)>::value
+
+/**
+* Refers to a slot of a ResourceTable. The generation is bumped when the resource is removed, so old handles stop resolving,
+* replacing a resource under the same name keeps the handle valid.
+*/
+template<typename T>
+struct ResourceHandle {
+	uint32_t index; /// @brief Slot in the table
+	uint32_t generation; /// @brief Generation of the slot when the handle was made, 0 is never used
+
+	ResourceHandle() : index(0), generation(0) {}
+	ResourceHandle(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+	/**
+	* Returns false for the null handle, a handle can still be stale when true
+	*/
+	bool IsValid() const { return generation != 0; }
+
+	/**
+	* Packs the handle into a single integer, used to pass handles to lua
+	*/
+	uint64_t ToInteger() const { return ((uint64_t)generation << 32) | index; }
+
+	/**
+	* Unpacks a handle packed by ToInteger
+	*/
+	static ResourceHandle FromInteger(uint64_t value) { return ResourceHandle((uint32_t)(value & 0xFFFFFFFF), (uint32_t)(value >> 32)); }
+};
+
+/**
+* A name to resource map. Names are interned in slots that are never reused for another name, the ids are looked up
+* in a open addressing table with linear probing. Resources are not owned by the table.
+*/
+template<typename T>
+class ResourceTable {
+private:
+	/**
+	* A interned name and the resource currently added under it
+	*/
+	struct Slot {
+		ResourceId id; /// @brief Hash of the name
+		std::string name; /// @brief The name
+		T* resource; /// @brief The resource, nullptr if removed
+		uint32_t generation; /// @brief Bumped every time the resource is removed
+	};
+
+	std::vector<Slot> slots; /// @brief All names ever added
+	std::vector<uint32_t> buckets; /// @brief Slot index + 1 per bucket, 0 if empty
+	std::unordered_map<const T*, uint32_t> slotOfResource; /// @brief Slot of every added resource, for the reverse lookup
+
+	/**
+	* Returns the bucket holding the id, or the empty bucket where it belongs
+	*/
+	size_t FindBucket(ResourceId id) const {
+		size_t mask = buckets.size() - 1;
+		size_t bucket = id & mask;
+		while (buckets[bucket] != 0 && slots[buckets[bucket] - 1].id != id) {
+			bucket = (bucket + 1) & mask;
+		}
+		return bucket;
+	}
+
+	/**
+	* Doubles the buckets and inserts all slots again
+	*/
+	void Grow() {
+		buckets.assign(buckets.empty() ? RESOURCE_TABLE_MIN_CAPACITY : buckets.size() * 2, 0);
+		for (size_t i = 0; i < slots.size(); i++) {
+			buckets[FindBucket(slots[i].id)] = (uint32_t)i + 1;
+		}
+	}
+public:
+	/**
+	* Adds or replaces the resource of a name and returns its handle. Returns the null handle if the hash of the name collides
+	* with a different name
+	*/
+	ResourceHandle<T> Add(const std::string& name, T* resource) {
+		if ((slots.size() + 1) * 2 > buckets.size()) Grow(); // Keep the load factor at most a half
+
+		ResourceId id = HashResourceName(name);
+		size_t bucket = FindBucket(id);
+		if (buckets[bucket] == 0) {
+			Slot slot = { id, name, nullptr, 1 };
+			slots.push_back(slot);
+			buckets[bucket] = (uint32_t)slots.size();
+		}
+
+		uint32_t index = buckets[bucket] - 1;
+		Slot& slot = slots[index];
+		if (slot.name != name) return ResourceHandle<T>();
+
+		if (slot.resource) slotOfResource.erase(slot.resource);
+		slot.resource = resource;
+		if (resource) slotOfResource[resource] = index;
+		return ResourceHandle<T>(index, slot.generation);
+	}
+
+	/**
+	* Returns the handle of a id, the null handle if nothing is added under it
+	*/
+	ResourceHandle<T> Find(ResourceId id) const {
+		if (buckets.empty()) return ResourceHandle<T>();
+
+		uint32_t bucket = buckets[FindBucket(id)];
+		if (bucket == 0 || !slots[bucket - 1].resource) return ResourceHandle<T>();
+		return ResourceHandle<T>(bucket - 1, slots[bucket - 1].generation);
+	}
+
+	/**
+	* Returns the handle of a name, the null handle if nothing is added under it
+	*/
+	ResourceHandle<T> Find(const std::string& name) const {
+		ResourceHandle<T> handle = Find(HashResourceName(name));
+		if (handle.IsValid() && slots[handle.index].name != name) return ResourceHandle<T>(); // Other name with the same hash
+		return handle;
+	}
+
+	/**
+	* Returns the resource of a handle, nullptr if the handle is stale
+	*/
+	T* Get(ResourceHandle<T> handle) const {
+		if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation) return nullptr;
+		return slots[handle.index].resource;
+	}
+
+	/**
+	* Returns the resource of a id, nullptr if nothing is added under it
+	*/
+	T* Get(ResourceId id) const {
+		return Get(Find(id));
+	}
+
+	/**
+	* Removes the resource of a handle and returns it, all handles to it become stale
+	*/
+	T* Remove(ResourceHandle<T> handle) {
+		T* resource = Get(handle);
+		if (!resource) return nullptr;
+
+		slotOfResource.erase(resource);
+		slots[handle.index].resource = nullptr;
+		slots[handle.index].generation++;
+		return resource;
+	}
+
+	/**
+	* Returns the name a resource is added under, an empty string if it is not added
+	*/
+	std::string GetName(const T* resource) const {
+		typename std::unordered_map<const T*, uint32_t>::const_iterator it = slotOfResource.find(resource);
+		return it == slotOfResource.end() ? std::string() : slots[it->second].name;
+	}
+
+	/**
+	* Returns the amount of slots, including the ones whose resource is removed
+	*/
+	size_t GetSlotCount() const { return slots.size(); }
+
+	/**
+	* Returns the name of a slot
+	*/
+	const std::string& GetSlotName(size_t index) const { return slots[index].name; }
+
+	/**
+	* Returns the resource of a slot, nullptr if removed
+	*/
+	T* GetSlotResource(size_t index) const { return slots[index].resource; }
+};
+
+#endif // !RESOURCEHANDLE_H
@@ -0,0 +1,496 @@
+/**
+*	Filename: resourceloader.cpp
+*
+*	Description: Source file for ResourceLoader class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include "resourceloader.h"
+#include "resourcemanager.h"
+#include "core.h"
+#include "model.h"
+#include "assetfile.h"
+#include "residency.h"
+#include "debug.h"
+
+/**
+* Splits a line at every separator
+*/
+static std::vector<std::string> Split(const std::string& line, char separator) {
+	std::stringstream ss(line);
+	std::string segment;
+	std::vector<std::string> segments;
+	while (std::getline(ss, segment, separator)) {
+		segments.push_back(segment);
+	}
+	return segments;
+}
+
+/**
+* Removes the carriage return of a line read from a file with windows line endings
+*/
+static void StripCarriageReturn(std::string& line) {
+	if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+}
+
+/**
+* Parses three comma separated floats
+*/
+static glm::vec3 ParseVec3(const std::string& value) {
+	std::vector<std::string> commas = Split(value, ',');
+	if (commas.size() < 3) return glm::vec3(0);
+	return glm::vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2]));
+}
+
+ResourceLoadHandle::ResourceLoadHandle(std::shared_ptr<ResourceLoadBatch> batch) {
+	this->batch = batch;
+}
+
+bool ResourceLoadHandle::IsDone() {
+	return !batch || batch->finished == batch->requests.size();
+}
+
+float ResourceLoadHandle::GetProgress() {
+	if (!batch || batch->requests.empty()) return 1.0f;
+	return (float)batch->finished.load() / (float)batch->requests.size();
+}
+
+size_t ResourceLoadHandle::GetFailedCount() {
+	return batch ? batch->failed.load() : 0;
+}
+
+void ResourceLoadHandle::Wait() {
+	while (!IsDone()) {
+		//Help decoding, then finish everything that can be finished
+		for (size_t i = 0; i < batch->requests.size(); i++) {
+			JobSystem::Wait(&batch->requests[i]->counter);
+		}
+
+		if (ResourceLoader::Update(-1.0f) == 0 && !IsDone()) {
+			//Only requests of other batches can block this batch, those may still be decoding
+			std::this_thread::yield();
+		}
+	}
+}
+
+ResourceLoader* ResourceLoader::_instance; // declare instance
+
+ResourceLoader* ResourceLoader::GetInstance() {
+	if (!_instance) {
+		_instance = new ResourceLoader();
+		_instance->lastUpdateTime = 0.0f;
+	}
+
+	return _instance;
+}
+
+void ResourceLoader::Decode(LoadRequest* request) {
+	bool decoded = false;
+
+	if (request->type == TextureResource) {
+		request->texture = new Texture();
+		decoded = request->texture->Decode(request->path);
+	}
+	else if (request->type == MeshResource) {
+		if (!request->reload) request->mesh = new Mesh();
+		decoded = request->mesh->Decode(request->path);
+	}
+	else {
+		AssetFile file;
+		decoded = file.Open(request->path);
+		std::istringstream text(file.GetText());
+
+		//Collect what the file adds and what it references, so it is finished after its dependencies
+		std::string line;
+		while (decoded && std::getline(text, line)) {
+			StripCarriageReturn(line);
+			if (line == "") continue;
+			request->lines.push_back(line);
+
+			std::vector<std::string> segments = Split(line, '=');
+			if (segments.size() < 2) continue;
+
+			if (segments[0] == "name") {
+				request->provides.push_back(segments[1]);
+			}
+			else if (segments[0] == "diffuseMap") {
+				request->dependencies.push_back({ TextureResource, segments[1] });
+			}
+			else if (segments[0] == "mesh") {
+				request->dependencies.push_back({ MeshResource, segments[1] });
+			}
+			else if (segments[0] == "lod") {
+				request->dependencies.push_back({ MeshResource, segments[1].substr(0, segments[1].find(',')) });
+			}
+			else if (segments[0] == "material") {
+				request->dependencies.push_back({ MaterialResource, segments[1] });
+			}
+		}
+	}
+
+	if (!decoded) {
+		Debug::Log("Could not decode " + request->path, typeid(ResourceLoader).name());
+	}
+	request->state = decoded ? LoadDecoded : LoadFailed;
+}
+
+void ResourceLoader::TakeQueued() {
+	std::vector<std::shared_ptr<ResourceLoadBatch>> queued;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		queued.swap(queuedBatches);
+	}
+
+	for (size_t b = 0; b < queued.size(); b++) {
+		requests.insert(requests.end(), queued[b]->requests.begin(), queued[b]->requests.end());
+		batches.push_back(queued[b]);
+	}
+}
+
+bool ResourceLoader::IsAvailable(const ResourceDependency& dependency) {
+	for (size_t i = 0; i < requests.size(); i++) {
+		LoadRequest* request = requests[i].get();
+		if (request->type != dependency.type) continue;
+
+		//Textures and meshes are added by the key they are listed with in the meta file
+		if (request->type == TextureResource || request->type == MeshResource) {
+			if (request->key == dependency.name) return false;
+			continue;
+		}
+
+		//What a material or model file adds is only known once it is read
+		int state = request->state;
+		if (state == LoadFailed) continue;
+		if (state == LoadQueued) return false;
+
+		for (size_t j = 0; j < request->provides.size(); j++) {
+			if (request->provides[j] == dependency.name) return false;
+		}
+	}
+
+	return true;
+}
+
+bool ResourceLoader::Finish(LoadRequest* request) {
+	switch (request->type) {
+	case TextureResource:
+		request->texture->UploadToGPU();
+		ResourceManager::AddTexture(request->key, request->texture);
+		request->texture = nullptr; // Owned by the resource manager now
+		break;
+	case MeshResource:
+		request->mesh->Upload();
+		if (request->reload) {
+			ResourceLoader* loader = GetInstance();
+			loader->reloadingMeshes.erase(std::find(loader->reloadingMeshes.begin(), loader->reloadingMeshes.end(), request->mesh));
+			ResidencyManager::CountReload();
+		}
+		else {
+			ResourceManager::AddMesh(request->key, request->mesh);
+		}
+		request->mesh = nullptr;
+		break;
+	case MaterialResource:
+		CreateMaterials(request->lines);
+		break;
+	case ModelResource:
+		CreateModels(request->lines);
+		break;
+	}
+
+	std::vector<std::string>().swap(request->lines);
+	return true;
+}
+
+void ResourceLoader::CreateMaterials(const std::vector<std::string>& lines) {
+	Material* currentMaterial = nullptr;
+	for (size_t i = 0; i < lines.size(); i++) {
+		if (lines[i] == "#MAT") {
+			currentMaterial = new Material();
+			continue;
+		}
+
+		if (!currentMaterial) continue;
+
+		std::vector<std::string> segments = Split(lines[i], '=');
+		if (segments.size() < 2) continue;
+
+		if (segments[0] == "name") {
+			ResourceManager::AddMaterial(segments[1], currentMaterial);
+			continue;
+		}
+
+		if (segments[0] == "diffuseMap") {
+			currentMaterial->SetDiffuse(ResourceManager::GetTexture(segments[1]));
+			continue;
+		}
+
+		if (segments[0] == "shader") {
+			currentMaterial->SetShader(ResourceManager::GetShader(segments[1]));
+			continue;
+		}
+
+		if (segments[0] == "shininess") {
+			currentMaterial->SetShine(std::stof(segments[1]));
+			continue;
+		}
+
+		if (segments[0] == "color") {
+			currentMaterial->SetColor(ParseVec3(segments[1]));
+			continue;
+		}
+
+		if (segments[0] == "diffuseColor") {
+			currentMaterial->SetDiffuseColor(ParseVec3(segments[1]));
+			continue;
+		}
+
+		if (segments[0] == "ambientColor") {
+			currentMaterial->SetAmbientColor(ParseVec3(segments[1]));
+			continue;
+		}
+
+		if (segments[0] == "specular") {
+			currentMaterial->SetSpecular(ParseVec3(segments[1]));
+			continue;
+		}
+	}
+}
+
+void ResourceLoader::CreateModels(const std::vector<std::string>& lines) {
+	Model* currentModel = nullptr;
+	for (size_t i = 0; i < lines.size(); i++) {
+		if (lines[i] == "#MODEL") {
+			currentModel = new Model();
+			continue;
+		}
+
+		if (!currentModel) continue;
+
+		std::vector<std::string> segments = Split(lines[i], '=');
+		if (segments.size() < 2) continue;
+
+		if (segments[0] == "name") {
+			ResourceManager::AddModel(segments[1], currentModel);
+			currentModel->SetName(segments[1]);
+		}
+
+		if (segments[0] == "mesh") {
+			currentModel->AddMesh(ResourceManager::GetMesh(segments[1]));
+		}
+
+		if (segments[0] == "material") {
+			currentModel->AddMaterial(ResourceManager::GetMaterial(segments[1]));
+		}
+
+		if (segments[0] == "lod") { // lod=mesh,screenSize adds a lod level to the last mesh
+			size_t comma = segments[1].find(',');
+			if (comma != std::string::npos && currentModel->GetMeshesCount() > 0) {
+				currentModel->AddLod(currentModel->GetMeshesCount() - 1, ResourceManager::GetMesh(segments[1].substr(0, comma)), std::stof(segments[1].substr(comma + 1)));
+			}
+		}
+
+		if (segments[0] == "radius") {
+			currentModel->SetSphereRadius(std::stof(segments[1]));
+		}
+
+		if (segments[0] == "ignoreFrustum") {
+			currentModel->IgnoreFrustum(std::stoi(segments[1]));
+		}
+
+		if (segments[0] == "occluder") {
+			currentModel->SetOccluder(std::stoi(segments[1]));
+		}
+
+		if (segments[0] == "drawMode") {
+			if (segments[1] == "Late") {
+				currentModel->SetDrawMode(DrawMode::Late);
+			}
+		}
+	}
+}
+
+ResourceLoadHandle ResourceLoader::LoadMeta(std::string offset) {
+	std::shared_ptr<ResourceLoadBatch> batch = std::make_shared<ResourceLoadBatch>();
+	if (offset == "") return ResourceLoadHandle(batch); // Return if size is less then 1
+
+	//Read meta
+	std::string metaPath = Core::GetBuildDirectory();
+	metaPath.append(offset);
+
+	std::string metaLine;
+	AssetFile metaFile;
+	if (!metaFile.Open(metaPath)) {
+		Debug::Log("Could not open meta file " + metaPath, typeid(ResourceLoader).name());
+		return ResourceLoadHandle(batch);
+	}
+
+	Meta currentMeta;
+	bool hasMeta = false;
+	std::string curType = "";
+
+	std::istringstream metaText(metaFile.GetText());
+	while (std::getline(metaText, metaLine)) {
+		StripCarriageReturn(metaLine);
+		if (metaLine == "") continue;
+		if (metaLine.size() > 1 && metaLine.at(0) == '/' && metaLine.at(1) == '/') continue; //Comment
+
+		if (metaLine == "#META") {
+			hasMeta = true;
+			curType = metaLine;
+			continue;
+		}
+
+		if (metaLine == "#TEXTURES" || metaLine == "#MESHES" || metaLine == "#MATERIALS" || metaLine == "#MODELS") {
+			curType = metaLine;
+			continue;
+		}
+
+		if (!hasMeta) continue;
+
+		std::vector<std::string> metaSegments = Split(metaLine, '=');
+		if (metaSegments.size() < 2) continue;
+
+		if (curType == "#META") {
+			if (metaSegments[0] == "resourceName") currentMeta.resourceName = metaSegments[1];
+			if (metaSegments[0] == "offset") currentMeta.offset = metaSegments[1];
+			if (metaSegments[0] == "author") currentMeta.author = metaSegments[1];
+			if (metaSegments[0] == "version") currentMeta.version = std::stof(metaSegments[1]);
+			continue;
+		}
+
+		std::shared_ptr<LoadRequest> request = std::make_shared<LoadRequest>();
+		if (curType == "#TEXTURES") request->type = TextureResource;
+		else if (curType == "#MESHES") request->type = MeshResource;
+		else if (curType == "#MATERIALS") request->type = MaterialResource;
+		else if (curType == "#MODELS") request->type = ModelResource;
+		else continue;
+
+		request->key = metaSegments[0];
+		request->path = Core::GetBuildDirectory();
+		request->path.append(currentMeta.offset);
+		request->path.append(metaSegments[1]);
+		batch->requests.push_back(request);
+	}
+	metaFile.Close();
+
+	//Queue the decoding only after the batch is complete, so the requests are not touched while it grows
+	for (size_t i = 0; i < batch->requests.size(); i++) {
+		LoadRequest* request = batch->requests[i].get();
+		JobSystem::Run([request]() { ResourceLoader::Decode(request); }, &request->counter);
+	}
+
+	//This may run on a spawned script, the main thread takes the batch into its requests on the next Update
+	ResourceLoader* loader = GetInstance();
+	{
+		std::lock_guard<std::mutex> lock(loader->queueMutex);
+		loader->queuedBatches.push_back(batch);
+	}
+
+	return ResourceLoadHandle(batch);
+}
+
+void ResourceLoader::ReloadMesh(Mesh* mesh) {
+	ResourceLoader* loader = GetInstance();
+	if (std::find(loader->reloadingMeshes.begin(), loader->reloadingMeshes.end(), mesh) != loader->reloadingMeshes.end()) return;
+	loader->reloadingMeshes.push_back(mesh);
+
+	//Not part of a batch, nothing waits on it. Update finishes it in order with the other requests
+	std::shared_ptr<LoadRequest> request = std::make_shared<LoadRequest>();
+	request->type = MeshResource;
+	request->path = mesh->GetSourcePath();
+	request->mesh = mesh;
+	request->reload = true;
+	loader->requests.push_back(request);
+
+	LoadRequest* decoding = request.get();
+	JobSystem::Run([decoding]() { ResourceLoader::Decode(decoding); }, &decoding->counter);
+}
+
+size_t ResourceLoader::Update(float budget) {
+	ResourceLoader* loader = GetInstance();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	size_t finishedCount = 0;
+
+	loader->TakeQueued();
+	for (size_t i = 0; i < loader->requests.size(); i++) {
+		if (budget >= 0.0f && std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() >= budget) break;
+
+		LoadRequest* request = loader->requests[i].get();
+		int state = request->state;
+		if (state == LoadQueued) continue;
+
+		if (state == LoadDecoded) {
+			bool available = true;
+			for (size_t d = 0; d < request->dependencies.size() && available; d++) {
+				available = loader->IsAvailable(request->dependencies[d]);
+			}
+			if (!available) continue;
+
+			request->state = Finish(request) ? LoadFinished : LoadFailed;
+		}
+
+		//Resources that failed to decode are deleted with the request, except reloaded meshes which stay evicted
+		if (request->reload) request->mesh = nullptr;
+		delete request->texture;
+		delete request->mesh;
+		request->texture = nullptr;
+		request->mesh = nullptr;
+
+		for (size_t b = 0; b < loader->batches.size(); b++) {
+			ResourceLoadBatch* batch = loader->batches[b].get();
+			for (size_t r = 0; r < batch->requests.size(); r++) {
+				if (batch->requests[r].get() != request) continue;
+				batch->finished++;
+				if (request->state == LoadFailed) batch->failed++;
+			}
+		}
+
+		loader->requests.erase(loader->requests.begin() + i);
+		i--;
+		finishedCount++;
+	}
+
+	//Batches that are done are only kept alive by their handles
+	for (size_t b = 0; b < loader->batches.size(); b++) {
+		if (loader->batches[b]->finished != loader->batches[b]->requests.size()) continue;
+		loader->batches.erase(loader->batches.begin() + b);
+		b--;
+	}
+
+	loader->lastUpdateTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return finishedCount;
+}
+
+size_t ResourceLoader::GetPendingCount() {
+	ResourceLoader* loader = GetInstance();
+	loader->TakeQueued();
+	return loader->requests.size();
+}
+
+float ResourceLoader::GetLastUpdateTime() {
+	return GetInstance()->lastUpdateTime;
+}
+
+void ResourceLoader::Destroy() {
+	if (!_instance) return;
+
+	_instance->TakeQueued();
+	for (size_t i = 0; i < _instance->requests.size(); i++) {
+		LoadRequest* request = _instance->requests[i].get();
+		JobSystem::Wait(&request->counter);
+		if (request->reload) request->mesh = nullptr; // Owned by the resource manager, its pending data is freed with it
+		delete request->texture;
+		delete request->mesh;
+		request->texture = nullptr;
+		request->mesh = nullptr;
+	}
+
+	delete _instance;
+	_instance = nullptr;
+}
@@ -0,0 +1,203 @@
+/**
+*	Filename: resourceloader.h
+*
+*	Description: Header file for ResourceLoader class, loads the resources of a meta file in the background
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef RESOURCELOADER_H
+#define RESOURCELOADER_H
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "jobsystem.h"
+
+#define RESOURCE_UPLOAD_BUDGET 2.0f // Milliseconds per frame the loader may spend on uploads and creating materials and models
+
+//Forward Declarations
+class Texture;
+class Mesh;
+
+/**
+* The kinds of resources a meta file lists
+*/
+enum ResourceType {
+	TextureResource,
+	MeshResource,
+	MaterialResource,
+	ModelResource
+};
+
+/**
+* The states of a load request, a request moves through them in order. Failed requests are finished as well
+*/
+enum LoadState {
+	LoadQueued,
+	LoadDecoded,
+	LoadFinished,
+	LoadFailed
+};
+
+/**
+* A resource referenced by another resource, by type and name
+*/
+struct ResourceDependency {
+	ResourceType type; /// @brief Type of the resource
+	std::string name; /// @brief Name of the resource
+};
+
+/**
+* A single file of a meta file, decoded on a worker and finished on the main thread
+*/
+struct LoadRequest {
+	ResourceType type; /// @brief The kind of file
+	std::string key; /// @brief Name the texture or mesh is added as, unused for materials and models
+	std::string path; /// @brief Full path of the file
+	std::atomic<int> state; /// @brief The LoadState, set to decoded or failed by the worker
+	JobCounter counter; /// @brief Counter of the decode job
+
+	Texture* texture; /// @brief The decoded texture
+	Mesh* mesh; /// @brief The decoded mesh
+	std::vector<std::string> lines; /// @brief Lines of a material or model file
+	bool reload; /// @brief True if mesh is a evicted mesh read again, it is owned by the resource manager and only uploaded
+
+	//Filled by the worker, read by the main thread after the state is decoded
+	std::vector<std::string> provides; /// @brief Names of the materials or models this file adds
+	std::vector<ResourceDependency> dependencies; /// @brief Resources that must be finished before this file
+
+	LoadRequest() : state(LoadQueued), texture(nullptr), mesh(nullptr), reload(false) {}
+};
+
+/**
+* The requests of a single meta file
+*/
+struct ResourceLoadBatch {
+	std::vector<std::shared_ptr<LoadRequest>> requests; /// @brief All requests of the meta file
+	std::atomic<size_t> finished; /// @brief Amount of finished or failed requests, read by handles on any thread
+	std::atomic<size_t> failed; /// @brief Amount of failed requests
+
+	ResourceLoadBatch() : finished(0), failed(0) {}
+};
+
+/**
+* Handle to a meta file being loaded, can be polled every frame or waited on. Copies share the same batch
+*/
+class ResourceLoadHandle {
+private:
+	std::shared_ptr<ResourceLoadBatch> batch; /// @brief The batch, shared with the loader
+public:
+	/**
+	* Constructor
+	*/
+	ResourceLoadHandle(std::shared_ptr<ResourceLoadBatch> batch = nullptr);
+
+	/**
+	* Returns true if all resources are finished or failed
+	*/
+	bool IsDone();
+
+	/**
+	* Returns the part of the resources that is finished, between 0 and 1
+	*/
+	float GetProgress();
+
+	/**
+	* Returns the amount of resources that could not be loaded
+	*/
+	size_t GetFailedCount();
+
+	/**
+	* Blocks until all resources are finished, decoding on the calling thread as well. Must be called from the main thread.
+	* Spawned scripts never enter the job queues, so waiting only ever runs decode jobs and other short jobs
+	*/
+	void Wait();
+};
+
+/**
+* Files are decoded on the job system as soon as the meta file is read. Finishing a file uploads it to OpenGL or creates its materials
+* and models, which is done on the main thread in Update, in meta order but never before the resources it references are finished.
+* LoadMeta can be called from any thread, its batch is queued and only taken into the requests by Update.
+*/
+class ResourceLoader {
+private:
+	static ResourceLoader* _instance; /// @brief Resource Loader singleton instance
+	std::vector<std::shared_ptr<LoadRequest>> requests; /// @brief Unfinished requests of all batches, in meta order
+	std::vector<std::shared_ptr<ResourceLoadBatch>> batches; /// @brief Unfinished batches
+	std::vector<std::shared_ptr<ResourceLoadBatch>> queuedBatches; /// @brief Batches of LoadMeta calls that Update did not take yet
+	std::mutex queueMutex; /// @brief Guards queuedBatches, requests and batches are only touched on the main thread
+	std::vector<Mesh*> reloadingMeshes; /// @brief Evicted meshes queued by ReloadMesh, meshes that failed to load stay in it so they are not tried again
+	float lastUpdateTime; /// @brief Time spent in the last Update, in milliseconds
+
+	/**
+	* Returns the instance, if none is existant it will create a new instance
+	*/
+	static ResourceLoader* GetInstance();
+
+	/**
+	* Reads the file of a request, runs on a worker
+	*/
+	static void Decode(LoadRequest* request);
+
+	/**
+	* Moves the queued batches into the requests and batches, called on the main thread
+	*/
+	void TakeQueued();
+
+	/**
+	* Returns true if no unfinished request still adds the resource
+	*/
+	bool IsAvailable(const ResourceDependency& dependency);
+
+	/**
+	* Uploads or creates the resources of a decoded request, returns false if it failed
+	*/
+	static bool Finish(LoadRequest* request);
+
+	/**
+	* Creates and adds the materials of a material file
+	*/
+	static void CreateMaterials(const std::vector<std::string>& lines);
+
+	/**
+	* Creates and adds the models of a model file
+	*/
+	static void CreateModels(const std::vector<std::string>& lines);
+public:
+	/**
+	* Reads a meta file and starts decoding its resources, the returned handle reports the progress. Can be called from any thread
+	*/
+	static ResourceLoadHandle LoadMeta(std::string offset);
+
+	/**
+	* Queues a evicted mesh to be read again on a worker and uploaded by Update within its budget, the mesh is skipped until then.
+	* A mesh that is already queued is ignored. Must be called from the main thread
+	*/
+	static void ReloadMesh(Mesh* mesh);
+
+	/**
+	* Finishes decoded requests until budget milliseconds are spent, a negative budget finishes all that can be finished.
+	* Returns the amount of requests finished. Must be called from the main thread
+	*/
+	static size_t Update(float budget = RESOURCE_UPLOAD_BUDGET);
+
+	/**
+	* Returns the amount of unfinished requests. Must be called from the main thread
+	*/
+	static size_t GetPendingCount();
+
+	/**
+	* Returns the time spent in the last Update, in milliseconds
+	*/
+	static float GetLastUpdateTime();
+
+	/**
+	* Waits for the decoding jobs and deletes the unfinished requests and the instance
+	*/
+	static void Destroy();
+};
+
+#endif // !RESOURCELOADER_H
@@ -8,11 +8,12 @@
 *	 2019, Jens Heukers
 */
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include "core.h"
 #include "model.h"
+#include "entity.h"
 #include "resourcemanager.h"
+#include "resourceloader.h"
+#include "assetarchive.h"
 #include "debug.h"
 
 ResourceManager* ResourceManager::_instance; // declare instance
@@ -25,6 +26,7 @@ ResourceManager* ResourceManager::GetInstance() {
 
 	// Add default shaders to shader list
 	_instance->AddShader("_aquariteDefaultShader", new Shader("shaders/default.vs", "shaders/default.fs"));
+	_instance->AddShader("_aquariteDefaultInstancedShader", new Shader("shaders/default_instanced.vs", "shaders/default.fs"));
 	_instance->AddShader("_aquariteDefaultSpriteShader", new Shader("shaders/sprite_default.vs", "shaders/sprite_default.fs"));
 	_instance->AddShader("_aquariteDefaultFrameBufferShader", new Shader("shaders/framebuffer_default.vs", "shaders/framebuffer_default.fs"));
 	_instance->AddShader("_aquariteDefaultSkyBoxShader", new Shader("shaders/skybox_default.vs", "shaders/skybox_default.fs"));
@@ -36,23 +38,46 @@ ResourceManager* ResourceManager::GetInstance() {
 	return _instance;
 }
 
-void ResourceManager::AddTexture(std::string key, Texture* texture) {
-	ResourceManager::GetInstance()->_textures[key] = texture;
+TextureHandle ResourceManager::AddTexture(std::string key, Texture* texture) {
+	TextureHandle handle = ResourceManager::GetInstance()->_textures.Add(key, texture);
+	if (!handle.IsValid()) {
+		Debug::Log("Texture key has the same hash as a other key: " + key, typeid(*ResourceManager::GetInstance()).name());
+		return handle;
+	}
 
 	std::string _formattedMsg = "Added Texture Resource: ";
 	_formattedMsg.append(key);
 	Debug::Log(_formattedMsg, typeid(*ResourceManager::GetInstance()).name());
+	return handle;
 }
 
 Texture* ResourceManager::GetTexture(std::string key) {
-	return ResourceManager::GetInstance()->_textures[key];
+	ResourceTable<Texture>& table = ResourceManager::GetInstance()->_textures;
+	return table.Get(table.Find(key));
+}
+
+Texture* ResourceManager::GetTexture(TextureHandle handle) {
+	return ResourceManager::GetInstance()->_textures.Get(handle);
+}
+
+TextureHandle ResourceManager::GetTextureHandle(ResourceId id) {
+	return ResourceManager::GetInstance()->_textures.Find(id);
+}
+
+TextureHandle ResourceManager::GetTextureHandle(std::string key) {
+	return ResourceManager::GetInstance()->_textures.Find(key);
 }
 
 void ResourceManager::RemoveTexture(std::string key) {
-	if (ResourceManager::GetInstance()->_textures[key] == nullptr) return;
-	delete ResourceManager::GetTexture(key);
-	
-	ResourceManager::GetInstance()->_textures[key] = nullptr;
+	ResourceTable<Texture>& table = ResourceManager::GetInstance()->_textures;
+	TextureHandle handle = table.Find(key);
+	Texture* texture = table.Get(handle);
+	if (texture == nullptr) return;
+	if (texture->GetRefCount() > 0) { // Materials point to it, deleting it would leave them dangling
+		Debug::Log("Texture " + key + " is not removed, " + std::to_string(texture->GetRefCount()) + " materials still use it", typeid(*ResourceManager::GetInstance()).name());
+		return;
+	}
+	delete table.Remove(handle);
 
 	std::string _convertedString = "Removed Texture resource: ";
 	_convertedString.append(key);
@@ -60,366 +85,242 @@ void ResourceManager::RemoveTexture(std::string key) {
 }
 
 std::string ResourceManager::GetTextureKeyName(Texture* texture) {
-	for (std::map<std::string, Texture*>::reverse_iterator it = ResourceManager::GetInstance()->_textures.rbegin(); it != ResourceManager::GetInstance()->_textures.rend(); ++it) {
-		if (it->second == texture) {
-			return it->first;
-		}
-	}
+	return ResourceManager::GetInstance()->_textures.GetName(texture);
 }
 
-void ResourceManager::AddMesh(std::string key, Mesh* mesh) {
-	ResourceManager::GetInstance()->_meshes[key] = mesh;
+MeshHandle ResourceManager::AddMesh(std::string key, Mesh* mesh) {
+	MeshHandle handle = ResourceManager::GetInstance()->_meshes.Add(key, mesh);
+	if (!handle.IsValid()) {
+		Debug::Log("Mesh key has the same hash as a other key: " + key, typeid(*ResourceManager::GetInstance()).name());
+		return handle;
+	}
 
 	std::string _formattedMsg = "Added Mesh Resource: ";
 	_formattedMsg.append(key);
 	Debug::Log(_formattedMsg, typeid(*ResourceManager::GetInstance()).name());
+	return handle;
 }
 
 Mesh* ResourceManager::GetMesh(std::string key) {
-	return ResourceManager::GetInstance()->_meshes[key];
+	ResourceTable<Mesh>& table = ResourceManager::GetInstance()->_meshes;
+	return table.Get(table.Find(key));
 }
 
-void ResourceManager::RemoveMesh(std::string key) {
-	if (ResourceManager::GetInstance()->_meshes[key] == nullptr) return;
-	delete ResourceManager::GetMesh(key);
+Mesh* ResourceManager::GetMesh(MeshHandle handle) {
+	return ResourceManager::GetInstance()->_meshes.Get(handle);
+}
 
-	ResourceManager::GetInstance()->_meshes[key] = nullptr;
+MeshHandle ResourceManager::GetMeshHandle(ResourceId id) {
+	return ResourceManager::GetInstance()->_meshes.Find(id);
+}
+
+MeshHandle ResourceManager::GetMeshHandle(std::string key) {
+	return ResourceManager::GetInstance()->_meshes.Find(key);
+}
+
+void ResourceManager::RemoveMesh(std::string key) {
+	ResourceTable<Mesh>& table = ResourceManager::GetInstance()->_meshes;
+	MeshHandle handle = table.Find(key);
+	Mesh* mesh = table.Get(handle);
+	if (mesh == nullptr) return;
+	if (mesh->GetRefCount() > 0) { // Models point to it, deleting it would leave them dangling
+		Debug::Log("Mesh " + key + " is not removed, " + std::to_string(mesh->GetRefCount()) + " models still use it", typeid(*ResourceManager::GetInstance()).name());
+		return;
+	}
+	delete table.Remove(handle);
 
 	std::string _convertedString = "Removed Mesh resource: ";
 	_convertedString.append(key);
 	Debug::Log(_convertedString, typeid(*ResourceManager::GetInstance()).name());
 }
 
-void ResourceManager::AddShader(std::string key, Shader* shader) {
-	ResourceManager::GetInstance()->_shaders[key] = shader;
+ShaderHandle ResourceManager::AddShader(std::string key, Shader* shader) {
+	ShaderHandle handle = ResourceManager::GetInstance()->_shaders.Add(key, shader);
+	if (!handle.IsValid()) {
+		Debug::Log("Shader key has the same hash as a other key: " + key, typeid(*ResourceManager::GetInstance()).name());
+		return handle;
+	}
 
 	std::string _formattedMsg = "Added Shader Resource: ";
 	_formattedMsg.append(key);
 	Debug::Log(_formattedMsg, typeid(*ResourceManager::GetInstance()).name());
+	return handle;
 }
 
 Shader* ResourceManager::GetShader(std::string key) {
-	return ResourceManager::GetInstance()->_shaders[key];
+	ResourceTable<Shader>& table = ResourceManager::GetInstance()->_shaders;
+	return table.Get(table.Find(key));
 }
 
-void ResourceManager::RemoveShader(std::string key) {
-	if (ResourceManager::GetInstance()->_shaders[key] == nullptr) return;
-	delete ResourceManager::GetShader(key);
+Shader* ResourceManager::GetShader(ShaderHandle handle) {
+	return ResourceManager::GetInstance()->_shaders.Get(handle);
+}
+
+ShaderHandle ResourceManager::GetShaderHandle(ResourceId id) {
+	return ResourceManager::GetInstance()->_shaders.Find(id);
+}
+
+ShaderHandle ResourceManager::GetShaderHandle(std::string key) {
+	return ResourceManager::GetInstance()->_shaders.Find(key);
+}
 
-	ResourceManager::GetInstance()->_shaders[key] = nullptr;
+void ResourceManager::RemoveShader(std::string key) {
+	ResourceTable<Shader>& table = ResourceManager::GetInstance()->_shaders;
+	Shader* shader = table.Remove(table.Find(key));
+	if (shader == nullptr) return;
+	if (Core::GetRenderer()) Core::GetRenderer()->RemoveShader(shader); // The renderer caches uniform handles per shader
+	delete shader;
 
 	std::string _convertedString = "Removed Shader resource: ";
 	_convertedString.append(key);
 	Debug::Log(_convertedString, typeid(*ResourceManager::GetInstance()).name());
 }
 
-void ResourceManager::AddMaterial(std::string key, Material* material) {
-	ResourceManager::GetInstance()->_materials[key] = material;
+MaterialHandle ResourceManager::AddMaterial(std::string key, Material* material) {
+	MaterialHandle handle = ResourceManager::GetInstance()->_materials.Add(key, material);
+	if (!handle.IsValid()) {
+		Debug::Log("Material key has the same hash as a other key: " + key, typeid(*ResourceManager::GetInstance()).name());
+		return handle;
+	}
 
 	std::string _formattedMsg = "Added Material Resource: ";
 	_formattedMsg.append(key);
 	Debug::Log(_formattedMsg, typeid(*ResourceManager::GetInstance()).name());
+	return handle;
 }
 
 Material* ResourceManager::GetMaterial(std::string key) {
-	return ResourceManager::GetInstance()->_materials[key];
+	ResourceTable<Material>& table = ResourceManager::GetInstance()->_materials;
+	return table.Get(table.Find(key));
 }
 
-void ResourceManager::RemoveMaterial(std::string key) {
-	if (ResourceManager::GetInstance()->_materials[key] == nullptr) return;
-	delete ResourceManager::GetMaterial(key);
+Material* ResourceManager::GetMaterial(MaterialHandle handle) {
+	return ResourceManager::GetInstance()->_materials.Get(handle);
+}
+
+MaterialHandle ResourceManager::GetMaterialHandle(ResourceId id) {
+	return ResourceManager::GetInstance()->_materials.Find(id);
+}
 
-	ResourceManager::GetInstance()->_materials[key] = nullptr;
+MaterialHandle ResourceManager::GetMaterialHandle(std::string key) {
+	return ResourceManager::GetInstance()->_materials.Find(key);
+}
+
+void ResourceManager::RemoveMaterial(std::string key) {
+	ResourceManager* instance = ResourceManager::GetInstance();
+	ResourceTable<Material>& table = instance->_materials;
+	MaterialHandle handle = table.Find(key);
+	Material* material = table.Get(handle);
+	if (material == nullptr) return;
+
+	//Materials are not reference counted, look for models that point to it
+	int users = 0;
+	for (size_t i = 0; i < instance->_models.GetSlotCount(); i++) {
+		Model* model = instance->_models.GetSlotResource(i);
+		if (model == nullptr) continue;
+		for (int m = 0; m < model->GetMaterialCount(); m++) {
+			if (model->GetMaterial(m) == material) users++;
+		}
+	}
+	if (users > 0) {
+		Debug::Log("Material " + key + " is not removed, " + std::to_string(users) + " models still use it", typeid(*instance).name());
+		return;
+	}
+	delete table.Remove(handle);
 
 	std::string _convertedString = "Removed Material resource: ";
 	_convertedString.append(key);
 	Debug::Log(_convertedString, typeid(*ResourceManager::GetInstance()).name());
 }
 
-void ResourceManager::AddModel(std::string key, Model* material) {
-	ResourceManager::GetInstance()->_models[key] = material;
+ModelHandle ResourceManager::AddModel(std::string key, Model* model) {
+	ModelHandle handle = ResourceManager::GetInstance()->_models.Add(key, model);
+	if (!handle.IsValid()) {
+		Debug::Log("Model key has the same hash as a other key: " + key, typeid(*ResourceManager::GetInstance()).name());
+		return handle;
+	}
 
 	std::string _formattedMsg = "Added Model Resource: ";
 	_formattedMsg.append(key);
 	Debug::Log(_formattedMsg, typeid(*ResourceManager::GetInstance()).name());
+	return handle;
 }
 
 Model* ResourceManager::GetModel(std::string key) {
-	return ResourceManager::GetInstance()->_models[key];
+	ResourceTable<Model>& table = ResourceManager::GetInstance()->_models;
+	return table.Get(table.Find(key));
 }
 
-void ResourceManager::RemoveModel(std::string key) {
-	if (ResourceManager::GetInstance()->_models[key] == nullptr) return;
-	delete ResourceManager::GetModel(key);
+Model* ResourceManager::GetModel(ModelHandle handle) {
+	return ResourceManager::GetInstance()->_models.Get(handle);
+}
 
-	ResourceManager::GetInstance()->_models[key] = nullptr;
+ModelHandle ResourceManager::GetModelHandle(ResourceId id) {
+	return ResourceManager::GetInstance()->_models.Find(id);
+}
+
+ModelHandle ResourceManager::GetModelHandle(std::string key) {
+	return ResourceManager::GetInstance()->_models.Find(key);
+}
+
+void ResourceManager::RemoveModel(std::string key) {
+	ResourceTable<Model>& table = ResourceManager::GetInstance()->_models;
+	Model* model = table.Remove(table.Find(key));
+	if (model == nullptr) return;
+
+	//Entities point to the model, clear it on the ones that use it so they do not draw a deleted model
+	std::vector<Entity*> entities = Core::GetGlobalEntityList();
+	for (size_t i = 0; i < entities.size(); i++) {
+		if (entities[i]->GetModel() == model) entities[i]->SetModel(nullptr);
+	}
+	delete model;
 
 	std::string _convertedString = "Removed Model resource: ";
 	_convertedString.append(key);
 	Debug::Log(_convertedString, typeid(*ResourceManager::GetInstance()).name());
 }
 
+bool ResourceManager::MountArchive(std::string offset) {
+	return AssetArchive::Mount(Core::GetBuildDirectory() + offset, Core::GetBuildDirectory());
+}
+
 void ResourceManager::LoadMeta(std::string offset) {
-	if (offset == "") return; // Return if size is less then 1
-	
-	//Read meta
-	std::string metaPath = Core::GetBuildDirectory();
-	metaPath.append(offset);
-
-	std::string metaLine;
-	std::ifstream metaFile = std::ifstream(metaPath);
-
-	if (metaFile.is_open()) {
-		Meta* currentMeta = nullptr;
-		std::string curType = "";
-
-		while (std::getline(metaFile, metaLine)) {
-			if (metaLine == "") continue;
-			if (metaLine.at(0) == '/' && metaLine.at(1) == '/') continue; //Comment
-
-			if (metaLine == "#META") {
-				currentMeta = new Meta();
-				curType = metaLine;
-				continue;
-			}
-
-			if (metaLine == "#TEXTURES" || metaLine == "#MESHES" || metaLine == "#MATERIALS" || metaLine == "#MODELS") {
-				curType = metaLine;
-				continue;
-			}
-
-			if (currentMeta == nullptr) continue;
-
-			//We know we can split here at character =
-
-			std::stringstream metaSs(metaLine);
-			std::string metaSegment;
-			std::vector<std::string> metaSegments;
-			while (std::getline(metaSs, metaSegment, '=')) {
-				metaSegments.push_back(metaSegment);
-			}
-
-			if (curType == "#META") {
-				if (metaSegments[0] == "resourceName") {
-					currentMeta->resourceName = metaSegments[1];
-					continue;
-				}
-
-				if (metaSegments[0] == "offset") {
-					currentMeta->offset = metaSegments[1];
-					continue;
-				}
-
-				if (metaSegments[0] == "author") {
-					currentMeta->author = metaSegments[1];
-					continue;
-				}
-
-				if (metaSegments[0] == "version") {
-					currentMeta->version = std::stof(metaSegments[1]);
-					continue;
-				}
-				continue;
-			}
-
-			if (curType == "#TEXTURES") {
-				std::string _path = Core::GetBuildDirectory();
-				_path.append(currentMeta->offset);
-				_path.append(metaSegments[1]);
-
-				Texture* texture = new Texture();
-				texture->LoadTGA((char*)_path.c_str());
-
-				ResourceManager::AddTexture(metaSegments[0], texture);
-				continue;
-			}
-
-			if(curType == "#MESHES") {
-				std::string _path = Core::GetBuildDirectory();
-				_path.append(currentMeta->offset);
-				_path.append(metaSegments[1]);
-
-				Mesh* mesh = new Mesh();
-				mesh->LoadObj(_path);
-
-				ResourceManager::AddMesh(metaSegments[0], mesh);
-				continue;
-			}
-
-			if (curType == "#MATERIALS") {
-				std::string _path = Core::GetBuildDirectory();
-				_path.append(currentMeta->offset);
-				_path.append(metaSegments[1]);
-
-				std::string line;
-				std::ifstream file = std::ifstream(_path);
-
-				if (file.is_open()) {
-					Material* currentMaterial;
-					while (std::getline(file, line))
-					{
-						if (line == "") continue;
-
-						if (line == "#MAT") {
-							currentMaterial = new Material();
-							continue;
-						}
-
-						if (!currentMaterial) continue;
-
-						std::stringstream ss(line);
-						std::string segment;
-						std::vector<std::string> segments;
-						while (std::getline(ss, segment, '=')) {
-							segments.push_back(segment);
-						}
-
-						if (segments[0] == "name") {
-							ResourceManager::AddMaterial(segments[1], currentMaterial);
-							continue;
-						}
-
-						if (segments[0] == "diffuseMap") {
-							currentMaterial->SetDiffuse(ResourceManager::GetTexture(segments[1]));
-							continue;
-						}
-
-						if (segments[0] == "shader") {
-							currentMaterial->SetShader(ResourceManager::GetShader(segments[1]));
-							continue;
-						}
-
-						if (segments[0] == "shininess") {
-							currentMaterial->SetShine(std::stof(segments[1]));
-							continue;
-						}
-
-						//If reached this point we can assume that comma's are existant in values so we can split
-
-						std::stringstream ss2(segments[1]);
-						std::string segment2;
-						std::vector<std::string> commas;
-						while (std::getline(ss2, segment2, ',')) {
-							commas.push_back(segment2);
-						}
-
-
-						if (segments[0] == "color") {
-							currentMaterial->SetColor(glm::vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2])));
-							continue;
-						}
-
-						if (segments[0] == "diffuseColor") {
-							currentMaterial->SetDiffuseColor(glm::vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2])));
-							continue;
-						}
-
-						if (segments[0] == "ambientColor") {
-							currentMaterial->SetAmbientColor(glm::vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2])));
-							continue;
-						}
-
-						if (segments[0] == "specular") {
-							currentMaterial->SetSpecular(glm::vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2])));
-							continue;
-						}
-					}
-					file.close();
-				}
-			}
-
-			if (curType == "#MODELS") {
-				std::string _path = Core::GetBuildDirectory();
-				_path.append(currentMeta->offset);
-				_path.append(metaSegments[1]);
-
-				std::string line;
-				std::ifstream file;
-				file = std::ifstream(_path);
-
-				if (file.is_open()) {
-					Model* currentModel;
-					while (std::getline(file, line))
-					{
-						if (line == "") continue;
-
-						if (line == "#MODEL") {
-							currentModel = new Model();
-							continue;
-						}
-
-						std::stringstream ss(line);
-						std::string segment;
-						std::vector<std::string> segments;
-						while (std::getline(ss, segment, '=')) {
-							segments.push_back(segment);
-						}
-
-						if (segments[0] == "name") {
-							ResourceManager::AddModel(segments[1], currentModel);
-							currentModel->SetName(segments[1]);
-						}
-
-						if (segments[0] == "mesh") {
-							currentModel->AddMesh(ResourceManager::GetMesh(segments[1]));
-						}
-
-						if (segments[0] == "material") {
-							currentModel->AddMaterial(ResourceManager::GetMaterial(segments[1]));
-						}
-
-						if (segments[0] == "radius") {
-							currentModel->SetSphereRadius(std::stof(segments[1]));
-						}
-
-						if (segments[0] == "ignoreFrustum") {
-							currentModel->IgnoreFrustum(std::stoi(segments[1]));
-						}
-
-						if (segments[0] == "drawMode") {
-							if (segments[1] == "Late") {
-								currentModel->SetDrawMode(DrawMode::Late);
-							}
-						}
-					}
-					file.close();
-				}
-			}
-		}
-		metaFile.close();
-	}
+	ResourceLoader::LoadMeta(offset).Wait(); // Decodes on all workers, and finishes everything before returning
+}
+
+ResourceLoadHandle ResourceManager::LoadMetaAsync(std::string offset) {
+	return ResourceLoader::LoadMeta(offset);
 }
 
 void ResourceManager::UnLoad() {
 	//Safely delete all resources
-	//Textures
-	std::map<std::string, Texture*>::iterator tex_it;
-	for (tex_it = ResourceManager::GetInstance()->_textures.begin(); tex_it != ResourceManager::GetInstance()->_textures.end(); ++tex_it) {
-		if (tex_it->second != nullptr) RemoveTexture(tex_it->first);
+	ResourceManager* instance = ResourceManager::GetInstance();
+
+	//Users first, models and materials release the meshes and textures they reference
+
+	//Models
+	for (size_t i = 0; i < instance->_models.GetSlotCount(); i++) {
+		if (instance->_models.GetSlotResource(i) != nullptr) RemoveModel(instance->_models.GetSlotName(i));
 	}
 
-	//Meshes
-	std::map<std::string, Mesh*>::iterator mesh_it;
-	for (mesh_it = ResourceManager::GetInstance()->_meshes.begin(); mesh_it != ResourceManager::GetInstance()->_meshes.end(); ++mesh_it) {
-		if (mesh_it->second != nullptr) RemoveMesh(mesh_it->first);
+	//Materials
+	for (size_t i = 0; i < instance->_materials.GetSlotCount(); i++) {
+		if (instance->_materials.GetSlotResource(i) != nullptr) RemoveMaterial(instance->_materials.GetSlotName(i));
 	}
 
-	//Shaders
-	std::map<std::string, Shader*>::iterator shad_it;
-	for (shad_it = ResourceManager::GetInstance()->_shaders.begin(); shad_it != ResourceManager::GetInstance()->_shaders.end(); ++shad_it) {
-		if (shad_it->second != nullptr) RemoveShader(shad_it->first);
+	//Textures
+	for (size_t i = 0; i < instance->_textures.GetSlotCount(); i++) {
+		if (instance->_textures.GetSlotResource(i) != nullptr) RemoveTexture(instance->_textures.GetSlotName(i));
 	}
 
-	//Materials
-	std::map<std::string, Material*>::iterator mat_it;
-	for (mat_it = ResourceManager::GetInstance()->_materials.begin(); mat_it != ResourceManager::GetInstance()->_materials.end(); ++mat_it) {
-		if (mat_it->second != nullptr) RemoveMaterial(mat_it->first);
+	//Meshes
+	for (size_t i = 0; i < instance->_meshes.GetSlotCount(); i++) {
+		if (instance->_meshes.GetSlotResource(i) != nullptr) RemoveMesh(instance->_meshes.GetSlotName(i));
 	}
 
-	//Models
-	std::map<std::string, Model*>::iterator model_it;
-	for (model_it = ResourceManager::GetInstance()->_models.begin(); model_it != ResourceManager::GetInstance()->_models.end(); ++model_it) {
-		if (model_it->second != nullptr) RemoveModel(model_it->first);
+	//Shaders
+	for (size_t i = 0; i < instance->_shaders.GetSlotCount(); i++) {
+		if (instance->_shaders.GetSlotResource(i) != nullptr) RemoveShader(instance->_shaders.GetSlotName(i));
 	}
 }
 
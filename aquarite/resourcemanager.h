@@ -10,7 +10,8 @@
 #ifndef RESOURCEMANAGER_H
 #define RESOURCEMANAGER_H
 #include <vector>
-#include <map>
+#include <string>
+#include "resourcehandle.h"
 
 struct Meta {
 	std::string resourceName;
@@ -25,15 +26,22 @@ class Mesh;
 class Shader;
 class Material;
 class Model;
+class ResourceLoadHandle;
+
+typedef ResourceHandle<Texture> TextureHandle;
+typedef ResourceHandle<Mesh> MeshHandle;
+typedef ResourceHandle<Shader> ShaderHandle;
+typedef ResourceHandle<Material> MaterialHandle;
+typedef ResourceHandle<Model> ModelHandle;
 
 class ResourceManager {
 private:
 	static ResourceManager* _instance; /// @brief Resource Manager singleton instance
-	std::map<std::string, Texture*> _textures; /// @brief Map containing all textures
-	std::map<std::string, Mesh*> _meshes; /// @brief Map containing all meshes
-	std::map<std::string, Shader*> _shaders; /// @brief Map containing all shaders
-	std::map<std::string, Material*> _materials; /// @brief Map containing all shaders
-	std::map<std::string, Model*> _models; /// @brief Map containing all models
+	ResourceTable<Texture> _textures; /// @brief Table containing all textures
+	ResourceTable<Mesh> _meshes; /// @brief Table containing all meshes
+	ResourceTable<Shader> _shaders; /// @brief Table containing all shaders
+	ResourceTable<Material> _materials; /// @brief Table containing all materials
+	ResourceTable<Model> _models; /// @brief Table containing all models
 public:
 	/**
 	* Returns the instance
@@ -41,17 +49,33 @@ public:
 	static ResourceManager* GetInstance();
 
 	/**
-	* Adds a new texture to the textures map
+	* Adds a new texture to the textures table and returns its handle, a texture added under the same key is replaced and keeps its handle
 	*/
-	static void AddTexture(std::string key, Texture* texture);
+	static TextureHandle AddTexture(std::string key, Texture* texture);
 
 	/**
-	* Retrieves a texture from the textures map
+	* Retrieves a texture from the textures table, nullptr if none is added under the key
 	*/
 	static Texture* GetTexture(std::string key);
 
 	/**
-	* Deletes a texture from the textures map
+	* Retrieves the texture of a handle in constant time, nullptr if the handle is stale
+	*/
+	static Texture* GetTexture(TextureHandle handle);
+
+	/**
+	* Returns the handle of a texture by id, RESOURCE_ID("name") hashes a name at compile time
+	*/
+	static TextureHandle GetTextureHandle(ResourceId id);
+
+	/**
+	* Returns the handle of a texture by name, unlike the id lookup a other name with the same hash is never returned
+	*/
+	static TextureHandle GetTextureHandle(std::string key);
+
+	/**
+	* Deletes a texture from the textures table, its handles become stale. Materials hold the texture by pointer,
+	* so a texture that is still used is kept and the removal is logged
 	*/
 	static void RemoveTexture(std::string key);
 
@@ -61,70 +85,145 @@ public:
 	static std::string GetTextureKeyName(Texture* texture);
 
 	/**
-	* Adds a new mesh to the meshes map
+	* Adds a new mesh to the meshes table and returns its handle, a mesh added under the same key is replaced and keeps its handle
 	*/
-	static void AddMesh(std::string key, Mesh* mesh);
+	static MeshHandle AddMesh(std::string key, Mesh* mesh);
 
 	/**
-	* Retrieves a mesh from the meshes map
+	* Retrieves a mesh from the meshes table, nullptr if none is added under the key
 	*/
 	static Mesh* GetMesh(std::string key);
 
 	/**
-	* Deletes a mesh from the meshes map
+	* Retrieves the mesh of a handle in constant time, nullptr if the handle is stale
+	*/
+	static Mesh* GetMesh(MeshHandle handle);
+
+	/**
+	* Returns the handle of a mesh by id, RESOURCE_ID("name") hashes a name at compile time
+	*/
+	static MeshHandle GetMeshHandle(ResourceId id);
+
+	/**
+	* Returns the handle of a mesh by name, unlike the id lookup a other name with the same hash is never returned
+	*/
+	static MeshHandle GetMeshHandle(std::string key);
+
+	/**
+	* Deletes a mesh from the meshes table, its handles become stale. Models hold the mesh by pointer,
+	* so a mesh that is still used is kept and the removal is logged
 	*/
 	static void RemoveMesh(std::string key);
 
 	/**
-	* Adds a new shader to the shaders map
+	* Adds a new shader to the shaders table and returns its handle, a shader added under the same key is replaced and keeps its handle
 	*/
-	static void AddShader(std::string key, Shader* shader);
+	static ShaderHandle AddShader(std::string key, Shader* shader);
 
 	/**
-	* Retrieves a shader from the shaders map
+	* Retrieves a shader from the shaders table, nullptr if none is added under the key
 	*/
 	static Shader* GetShader(std::string key);
 
 	/**
-	* Deletes a shader from the shaders map
+	* Retrieves the shader of a handle in constant time, nullptr if the handle is stale
+	*/
+	static Shader* GetShader(ShaderHandle handle);
+
+	/**
+	* Returns the handle of a shader by id, RESOURCE_ID("name") hashes a name at compile time
+	*/
+	static ShaderHandle GetShaderHandle(ResourceId id);
+
+	/**
+	* Returns the handle of a shader by name, unlike the id lookup a other name with the same hash is never returned
+	*/
+	static ShaderHandle GetShaderHandle(std::string key);
+
+	/**
+	* Deletes a shader from the shaders table, its handles become stale
 	*/
 	static void RemoveShader(std::string key);
 
 	/**
-	* Adds a new material to the materials map
+	* Adds a new material to the materials table and returns its handle, a material added under the same key is replaced and keeps its handle
 	*/
-	static void AddMaterial(std::string key, Material* material);
+	static MaterialHandle AddMaterial(std::string key, Material* material);
 
 	/**
-	* Retrieves a material from the materials map
+	* Retrieves a material from the materials table, nullptr if none is added under the key
 	*/
 	static Material* GetMaterial(std::string key);
 
 	/**
-	* Deletes a material from the materials map
+	* Retrieves the material of a handle in constant time, nullptr if the handle is stale
+	*/
+	static Material* GetMaterial(MaterialHandle handle);
+
+	/**
+	* Returns the handle of a material by id, RESOURCE_ID("name") hashes a name at compile time
+	*/
+	static MaterialHandle GetMaterialHandle(ResourceId id);
+
+	/**
+	* Returns the handle of a material by name, unlike the id lookup a other name with the same hash is never returned
+	*/
+	static MaterialHandle GetMaterialHandle(std::string key);
+
+	/**
+	* Deletes a material from the materials table, its handles become stale. Models hold the material by pointer,
+	* so a material that is still used is kept and the removal is logged
 	*/
 	static void RemoveMaterial(std::string key);
 
 	/**
-	* Adds a new model to the materials map
+	* Adds a new model to the models table and returns its handle, a model added under the same key is replaced and keeps its handle
 	*/
-	static void AddModel(std::string key, Model* material);
+	static ModelHandle AddModel(std::string key, Model* model);
 
 	/**
-	* Retrieves a model from the materials map
+	* Retrieves a model from the models table, nullptr if none is added under the key
 	*/
 	static Model* GetModel(std::string key);
 
 	/**
-	* Deletes a model from the models map
+	* Retrieves the model of a handle in constant time, nullptr if the handle is stale
+	*/
+	static Model* GetModel(ModelHandle handle);
+
+	/**
+	* Returns the handle of a model by id, RESOURCE_ID("name") hashes a name at compile time
+	*/
+	static ModelHandle GetModelHandle(ResourceId id);
+
+	/**
+	* Returns the handle of a model by name, unlike the id lookup a other name with the same hash is never returned
+	*/
+	static ModelHandle GetModelHandle(std::string key);
+
+	/**
+	* Deletes a model from the models table, its handles become stale. Entities hold the model by pointer,
+	* the entities in the global entity list that use it have their model cleared first
 	*/
 	static void RemoveModel(std::string key);
 
 	/**
-	* Loads external meta file and loads specified resources into memory
+	* Mounts a .apak archive relative to the build directory, assets are read from it before looking for loose files.
+	* Mount before loading anything, returns false if the archive can not be opened
+	*/
+	static bool MountArchive(std::string offset);
+
+	/**
+	* Loads external meta file and loads specified resources into memory, returns once all resources are loaded
 	*/
 	static void LoadMeta(std::string offset);
 
+	/**
+	* Starts loading a meta file in the background and returns at once, the resources are added while Core runs its frames.
+	* Poll the handle to show progress, a resource can be used once the handle is done
+	*/
+	static ResourceLoadHandle LoadMetaAsync(std::string offset);
+
 	/**
 	* Unloads all resources from the heap.
 	*/
@@ -10,9 +10,13 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 #include "scene.h"
 #include "core.h"
+#include "assetfile.h"
 #include "graphics/light.h"
+#include "transformhierarchy.h"
+#include "graphics/frustumculler.h"
 
 Scene::~Scene() {
 	for (size_t i = 0; i < GetChildren().size(); i++) {
@@ -20,6 +24,9 @@ Scene::~Scene() {
 			RemoveLight(static_cast<Light*>(GetChild(i)));
 		}
 	}
+
+	//Delete the children now, the base destructor runs after the spatial index they are removed from is gone
+	DeleteChildren();
 }
 
 Scene::Scene() {
@@ -28,12 +35,147 @@ Scene::Scene() {
 }
 
 void Scene::UpdateSceneChildren() {
-	this->UpdateChildren(); // Update children
-	this->Update(); // call Update function
+	this->Update();
+
+	//Indexed, an entity may add or remove entities from its Update
+	for (size_t i = 0; i < updateList.size(); i++) {
+		updateList[i]->Update();
+	}
+}
+
+void Scene::UpdateSceneTransforms() {
+	TransformHierarchy::Update(); // Only changed subtrees are recalculated
+
+	//Only entities that moved are refitted in the spatial index of their scene
+	queryResults.clear();
+	TransformHierarchy::GetChangedUserData(queryResults);
+	for (size_t i = 0; i < queryResults.size(); i++) {
+		static_cast<Entity*>(queryResults[i])->RefitIndex();
+	}
 }
 
 void Scene::RenderSceneChildren(Renderer* renderer, Camera* camera) {
-	this->Render(renderer, camera); // Render all the scene Children
+	//Only entities that register something themselves are visited, like text and ui elements
+	for (size_t i = 0; i < renderList.size(); i++) {
+		renderList[i]->Render(renderer, camera);
+	}
+
+	//Entities with a model are found in the spatial index, so only the ones near the frustum are visited
+	glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+	FrustumCuller::ExtractPlanes(renderer->GetProjectionMatrix() * renderer->GetViewMatrix(), planes);
+
+	queryResults.clear();
+	spatialIndex.QueryFrustum(planes, queryResults);
+	for (size_t i = 0; i < queryResults.size(); i++) {
+		renderer->RegisterEntity(static_cast<Entity*>(queryResults[i]));
+	}
+
+	for (size_t i = 0; i < unboundedEntities.size(); i++) {
+		renderer->RegisterEntity(unboundedEntities[i]);
+	}
+}
+
+int Scene::AddToIndex(Entity* entity) {
+	if (entity->GetModel()->IgnoreFrustumState()) {
+		unboundedEntities.push_back(entity);
+		return TREE_NULL;
+	}
+
+	MeshBounds bounds = entity->GetWorldBounds();
+	return spatialIndex.CreateProxy(AABB(bounds.min, bounds.max), entity);
+}
+
+void Scene::RemoveFromIndex(Entity* entity, int proxy) {
+	if (proxy != TREE_NULL) {
+		spatialIndex.DestroyProxy(proxy);
+		return;
+	}
+
+	for (size_t i = 0; i < unboundedEntities.size(); i++) {
+		if (unboundedEntities[i] == entity) {
+			unboundedEntities.erase(unboundedEntities.begin() + i);
+			return;
+		}
+	}
+}
+
+void Scene::RefitInIndex(Entity* entity, int proxy) {
+	MeshBounds bounds = entity->GetWorldBounds();
+	spatialIndex.MoveProxy(proxy, AABB(bounds.min, bounds.max));
+}
+
+void Scene::AddToLists(Entity* entity) {
+	if (entity->updateEnabled) updateList.push_back(entity);
+	if (entity->renderEnabled) renderList.push_back(entity);
+}
+
+void Scene::RemoveFromLists(Entity* entity) {
+	std::vector<Entity*>::iterator it = std::find(updateList.begin(), updateList.end(), entity);
+	if (it != updateList.end()) updateList.erase(it);
+
+	it = std::find(renderList.begin(), renderList.end(), entity);
+	if (it != renderList.end()) renderList.erase(it);
+}
+
+std::vector<Entity*> Scene::FindEntitiesInRadius(Vec3 centre, float radius) {
+	glm::vec3 point = centre.ToGLM();
+	std::vector<Entity*> found;
+
+	//The tree holds fattened boxes, so the candidates are tested against their bounding sphere
+	queryResults.clear();
+	spatialIndex.QuerySphere(point, radius, queryResults);
+	queryResults.insert(queryResults.end(), unboundedEntities.begin(), unboundedEntities.end());
+	for (size_t i = 0; i < queryResults.size(); i++) {
+		Entity* entity = static_cast<Entity*>(queryResults[i]);
+		MeshBounds bounds = entity->GetWorldBounds();
+		if (glm::distance(point, bounds.center) <= radius + bounds.radius) found.push_back(entity);
+	}
+	return found;
+}
+
+std::vector<Entity*> Scene::FindEntitiesInBox(Vec3 min, Vec3 max) {
+	AABB box(min.ToGLM(), max.ToGLM());
+	std::vector<Entity*> found;
+
+	queryResults.clear();
+	spatialIndex.QueryBox(box, queryResults);
+	queryResults.insert(queryResults.end(), unboundedEntities.begin(), unboundedEntities.end());
+	for (size_t i = 0; i < queryResults.size(); i++) {
+		Entity* entity = static_cast<Entity*>(queryResults[i]);
+		MeshBounds bounds = entity->GetWorldBounds();
+		if (box.Overlaps(AABB(bounds.min, bounds.max))) found.push_back(entity);
+	}
+	return found;
+}
+
+Entity* Scene::Raycast(Vec3 origin, Vec3 direction, float maxDistance, float* distance) {
+	glm::vec3 rayOrigin = origin.ToGLM();
+	if (glm::dot(direction.ToGLM(), direction.ToGLM()) < 1e-12f) return nullptr; // No direction, normalizing would give NaN
+	glm::vec3 rayDirection = glm::normalize(direction.ToGLM());
+	glm::vec3 inverseDirection = 1.0f / rayDirection;
+
+	//Hits are tested against the world box of the entity, not the fattened box in the tree
+	std::function<float(void*)> test = [rayOrigin, inverseDirection, maxDistance](void* data) {
+		MeshBounds bounds = static_cast<Entity*>(data)->GetWorldBounds();
+		return AABB(bounds.min, bounds.max).Raycast(rayOrigin, inverseDirection, maxDistance);
+	};
+
+	float closest;
+	Entity* hit = static_cast<Entity*>(spatialIndex.Raycast(rayOrigin, rayDirection, maxDistance, test, closest));
+	for (size_t i = 0; i < unboundedEntities.size(); i++) {
+		float hitDistance = test(unboundedEntities[i]);
+		if (hitDistance >= 0 && hitDistance < closest) {
+			closest = hitDistance;
+			hit = unboundedEntities[i];
+		}
+	}
+
+	if (distance && hit) *distance = closest;
+	return hit;
+}
+
+const DynamicTree& Scene::GetSpatialIndex() {
+	return this->spatialIndex;
 }
 
 Camera* Scene::GetActiveCamera() {
@@ -69,11 +211,13 @@ void Scene::LoadSceneData(std::string offset) {
 
 
 	std::string line;
-	std::ifstream file = std::ifstream(path);
+	AssetFile file;
 
-	if (file.is_open()) {
-		while (std::getline(file, line))
+	if (file.Open(path)) {
+		std::istringstream text(file.GetText());
+		while (std::getline(text, line))
 		{
+			if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1); // Windows line endings
 			if (line == "") continue;
 
 			if (line == "#HEADER") {
@@ -158,7 +302,7 @@ void Scene::LoadSceneData(std::string offset) {
 				}
 
 				if (segments[0] == "position") {
-					entityptr->position = Vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2]));
+					entityptr->SetPosition(Vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2])));
 				}
 
 				if (segments[0] == "rotation") {
@@ -181,7 +325,7 @@ void Scene::LoadSceneData(std::string offset) {
 				}
 
 				if (segments[0] == "position") {
-					lightptr->position = Vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2]));
+					lightptr->SetPosition(Vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2])));
 				}
 
 				if (segments[0] == "ambient") {
@@ -195,6 +339,10 @@ void Scene::LoadSceneData(std::string offset) {
 				if (segments[0] == "specular") {
 					lightptr->SetSpecular(glm::vec3(std::stof(commas[0]), std::stof(commas[1]), std::stof(commas[2])));
 				}
+
+				if (segments[0] == "radius") {
+					lightptr->SetRadius(std::stof(commas[0]));
+				}
 			}
 
 			//Direcitonal
@@ -224,6 +372,6 @@ void Scene::LoadSceneData(std::string offset) {
 				}
 			}
 		}
-		file.close();
+		file.Close();
 	}
 }
\ No newline at end of file
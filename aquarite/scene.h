@@ -11,14 +11,24 @@
 #ifndef SCENE_H
 #define SCENE_H
 #include <string>
+#include <vector>
 #include "entity.h"
 #include "camera.h"
+#include "dynamictree.h"
 
 class Light; // Forward Declaration
 
 class Scene : public Entity {
 private:
 	Camera* activeCamera; /// @ brief The currently active camera
+
+	//Spatial index
+	DynamicTree spatialIndex; /// @brief Bounding volume hierarchy over the world space bounds of all entities with a model
+	std::vector<Entity*> unboundedEntities; /// @brief Entities with a model that ignores the frustum, these are not in the tree
+	std::vector<void*> queryResults; /// @brief Reused result list of tree queries
+
+	std::vector<Entity*> updateList; /// @brief Entities with updates enabled, the only ones whose Update is called
+	std::vector<Entity*> renderList; /// @brief Entities with rendering enabled, the only ones whose Render is called
 public:
 	/**
 	* Destructor
@@ -36,12 +46,17 @@ public:
 	virtual void Update() override {};
 
 	/**
-	* Update all scene children
+	* Calls Update of the scene and of the entities in the update list, entities without updates enabled are not visited
 	*/
 	void UpdateSceneChildren();
 
 	/**
-	* Renders all scene children
+	* Recalculates the world matrices of all entities that have changed since the last call
+	*/
+	void UpdateSceneTransforms();
+
+	/**
+	* Registers the entities in the render list, and the entities with a model that the spatial index finds in the frustum
 	*/
 	void RenderSceneChildren(Renderer* renderer, Camera* camera);
 
@@ -65,6 +80,52 @@ public:
 	*/
 	void RemoveLight(Light* light);
 
+	/**
+	* Adds a entity with a model to the spatial index, returns its proxy or TREE_NULL if it is not stored in the tree
+	*/
+	int AddToIndex(Entity* entity);
+
+	/**
+	* Removes a entity from the spatial index
+	*/
+	void RemoveFromIndex(Entity* entity, int proxy);
+
+	/**
+	* Moves the proxy of a entity to its current world bounds
+	*/
+	void RefitInIndex(Entity* entity, int proxy);
+
+	/**
+	* Adds a entity to the update and render lists, depending on what it has enabled
+	*/
+	void AddToLists(Entity* entity);
+
+	/**
+	* Removes a entity from the update and render lists
+	*/
+	void RemoveFromLists(Entity* entity);
+
+	/**
+	* Returns all entities with a model whose bounding sphere overlaps the sphere
+	*/
+	std::vector<Entity*> FindEntitiesInRadius(Vec3 centre, float radius);
+
+	/**
+	* Returns all entities with a model whose bounding box overlaps the box
+	*/
+	std::vector<Entity*> FindEntitiesInBox(Vec3 min, Vec3 max);
+
+	/**
+	* Returns the entity with a model whose bounding box is hit first by the ray, or nullptr. distance is set to the hit distance if not nullptr.
+	* A direction of (near) zero length hits nothing
+	*/
+	Entity* Raycast(Vec3 origin, Vec3 direction, float maxDistance, float* distance = nullptr);
+
+	/**
+	* Returns the spatial index of the scene
+	*/
+	const DynamicTree& GetSpatialIndex();
+
 	/**
 	* Loads scene data from a .ascene file, and inserts the data, offset parameter is the path from the main build directory
 	*/
@@ -8,31 +8,42 @@ struct Material {
     float shininess;
 }; 
 
+//Light members are vec4 so the std140 layout matches the renderer, only xyz is used
 struct DirLight {
-    vec3 direction;
+    vec4 direction;
 
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
 };
 
 struct PointLight {
-    vec3 position;
+    vec4 position; // w holds the radius
 
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
 };
 
 in vec3 FragPos;  
 in vec3 Normal;  
 in vec2 texCoord;
+in float ViewDepth;
 
 uniform vec3 viewPos;
 uniform Material material;
 
-uniform DirLight dirLight;
-uniform PointLight pointLights[25];
+//Uploaded once per frame by the renderer
+layout (std140) uniform Lights {
+    DirLight dirLight;
+    ivec4 clusterSize; // xyz = cluster grid size, w = has directional light
+    vec4 clusterScale; // xy = screen size, z = depth slice scale, w = depth slice bias
+};
+
+//Clustered point lights, the grid holds the offset and count of every cluster's range in the light indices
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer clusterLightIndices;
+uniform samplerBuffer pointLights; // 4 texels per light: position and radius, ambient, diffuse, specular
 
 //Determines if object has a texture
 uniform bool hasTexture;
@@ -41,45 +52,73 @@ uniform sampler2D objectTexture;
 
 vec3 CalculateDirectionalLight(DirLight dirLight, vec3 norm, vec3 viewDir) {
 	// ambient
-    vec3 ambient = dirLight.ambient * material.ambientColor;
+    vec3 ambient = dirLight.ambient.xyz * material.ambientColor;
   	
     // diffuse 
-    vec3 lightDir = normalize(-dirLight.direction);
+    vec3 lightDir = normalize(-dirLight.direction.xyz);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = dirLight.diffuse * (diff * material.diffuseColor);
+    vec3 diffuse = dirLight.diffuse.xyz * (diff * material.diffuseColor);
     
     // specular
     vec3 reflectDir = reflect(-lightDir, norm);  
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = dirLight.specular * (spec * material.specular);
+    vec3 specular = dirLight.specular.xyz * (spec * material.specular);
 	return (ambient + diffuse + specular);
 }
 
 vec3 CalculatePointLight(PointLight pointLight, vec3 norm, vec3 viewDir) {
+	// attenuation, falls off smoothly to 0 at the radius of the light
+	float distanceRatio = length(pointLight.position.xyz - FragPos) / pointLight.position.w;
+	float attenuation = clamp(1.0 - distanceRatio * distanceRatio * distanceRatio * distanceRatio, 0.0, 1.0);
+	attenuation *= attenuation;
+	if (attenuation <= 0.0) {
+		return vec3(0.0);
+	}
+
 	// ambient
-    vec3 ambient = pointLight.ambient * material.ambientColor;
+    vec3 ambient = pointLight.ambient.xyz * material.ambientColor;
   	
     // diffuse 
-    vec3 lightDir = normalize(pointLight.position - FragPos);
+    vec3 lightDir = normalize(pointLight.position.xyz - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = pointLight.diffuse * (diff * material.diffuseColor);
+    vec3 diffuse = pointLight.diffuse.xyz * (diff * material.diffuseColor);
     
     // specular
     vec3 reflectDir = reflect(-lightDir, norm);  
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = pointLight.specular * (spec * material.specular);
-	return (ambient + diffuse + specular);
+    vec3 specular = pointLight.specular.xyz * (spec * material.specular);
+	return (ambient + diffuse + specular) * attenuation;
 }
+
+int GetClusterIndex() {
+	ivec3 cluster;
+	cluster.xy = ivec2(gl_FragCoord.xy / clusterScale.xy * vec2(clusterSize.xy));
+	cluster.z = int(floor(log(max(ViewDepth, 0.0001)) * clusterScale.z + clusterScale.w));
+	cluster = clamp(cluster, ivec3(0), clusterSize.xyz - 1);
+	return cluster.x + clusterSize.x * (cluster.y + clusterSize.y * cluster.z);
+}
+
 void main() {
 	vec3 norm = normalize(Normal);
 	vec3 viewDir = normalize(viewPos - FragPos);  
     
 	//Directional Lighting
-    vec3 result = CalculateDirectionalLight(dirLight, norm, viewDir);
+    vec3 result = vec3(0.0);
+    if(clusterSize.w != 0) {
+        result += CalculateDirectionalLight(dirLight, norm, viewDir);
+    }
 	
-	//Point Lights
-	for(int i = 0; i < 25; i++) {
-		result += CalculatePointLight(pointLights[i], norm, viewDir);
+	//Point Lights, only the lights binned in the cluster of this fragment
+	uvec2 cluster = texelFetch(clusterGrid, GetClusterIndex()).xy;
+	for(uint i = 0u; i < cluster.y; i++) {
+		int light = int(texelFetch(clusterLightIndices, int(cluster.x + i)).x) * 4;
+
+		PointLight pointLight;
+		pointLight.position = texelFetch(pointLights, light);
+		pointLight.ambient = texelFetch(pointLights, light + 1);
+		pointLight.diffuse = texelFetch(pointLights, light + 2);
+		pointLight.specular = texelFetch(pointLights, light + 3);
+		result += CalculatePointLight(pointLight, norm, viewDir);
 	}
 	
 	if(hasTexture) {
@@ -7,6 +7,7 @@ out vec3 FragPos;
 out vec3 Normal;
 
 out vec2 texCoord;
+out float ViewDepth; // Distance along the view direction, used to find the light cluster
 
 uniform mat4 model;
 uniform mat4 view;
@@ -17,6 +18,8 @@ void main()
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;  
     
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    vec4 viewPosition = view * vec4(FragPos, 1.0);
+    ViewDepth = -viewPosition.z;
+    gl_Position = projection * viewPosition;
 	texCoord = vec2(aTexCoord.x, aTexCoord.y);
 }
\ No newline at end of file
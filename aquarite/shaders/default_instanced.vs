@@ -0,0 +1,25 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec3 aNormal;
+layout (location = 3) in mat4 aModel; // Per instance world matrix, takes up locations 3 to 6
+
+out vec3 FragPos;
+out vec3 Normal;
+
+out vec2 texCoord;
+out float ViewDepth; // Distance along the view direction, used to find the light cluster
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(aModel))) * aNormal;  
+    
+    vec4 viewPosition = view * vec4(FragPos, 1.0);
+    ViewDepth = -viewPosition.z;
+    gl_Position = projection * viewPosition;
+	texCoord = vec2(aTexCoord.x, aTexCoord.y);
+}
\ No newline at end of file
@@ -2,10 +2,21 @@
 out vec4 FragColor;
 
 in vec2 TexCoords;
+flat in int TextureIndex;
+in vec4 Color;
 
-uniform sampler2D screenTexture;
+uniform sampler2D textures[8];
 
 void main()
 {
-    FragColor = texture(screenTexture, TexCoords);
+    // Sampler arrays may only be indexed with constant expressions in glsl 330
+    if (TextureIndex == 0) FragColor = texture(textures[0], TexCoords);
+    else if (TextureIndex == 1) FragColor = texture(textures[1], TexCoords);
+    else if (TextureIndex == 2) FragColor = texture(textures[2], TexCoords);
+    else if (TextureIndex == 3) FragColor = texture(textures[3], TexCoords);
+    else if (TextureIndex == 4) FragColor = texture(textures[4], TexCoords);
+    else if (TextureIndex == 5) FragColor = texture(textures[5], TexCoords);
+    else if (TextureIndex == 6) FragColor = texture(textures[6], TexCoords);
+    else FragColor = texture(textures[7], TexCoords);
+    FragColor *= Color;
 } 
\ No newline at end of file
@@ -1,14 +1,17 @@
 #version 330 core
 layout (location = 0) in vec2 aPos;
 layout (location = 1) in vec2 aTexCoords;
+layout (location = 2) in float aTexture;
+layout (location = 3) in vec4 aColor;
 
 out vec2 TexCoords;
-
-uniform vec2 scale;
-uniform vec2 position;
+flat out int TextureIndex;
+out vec4 Color;
 
 void main()
 {
     TexCoords = aTexCoords;
-    gl_Position = vec4((aPos.x + position.x) * scale.x, (aPos.y + position.y) * scale.y, 0.0, 1.0); 
+    TextureIndex = int(aTexture);
+    Color = aColor;
+    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
 }  
\ No newline at end of file
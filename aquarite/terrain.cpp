@@ -15,6 +15,8 @@ void Terrain::Construct(Texture* heightMap, Point2f dimensions, int width, int h
 	//First we want to create a array of all vertices in the terrain, then we want to fill this array
 	std::vector<glm::vec3> verts;
 
+	if (heightMap && !heightMap->RequirePixels()) heightMap = nullptr; // The pixels are freed after upload, read them again
+
 	if (heightMap)
 		dimensions = Point2f((float)heightMap->textureData->width, (float)heightMap->textureData->height);
 
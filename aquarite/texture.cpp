@@ -11,24 +11,206 @@
 #undef _CRT_SECURE_NO_WARNINGS
 #endif
 #define _CRT_SECURE_NO_WARNINGS 1
+#ifndef NOMINMAX
+#define NOMINMAX // std::min and std::max instead of the Windows.h macros
+#endif
 
 #include <Windows.h>
 #include <string>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <fstream>
 #include "texture.h"
+#include "assetfile.h"
 #include "debug.h"
+#include "graphics/bcencoder.h"
+#include "graphics/pixelconverter.h"
+#include "graphics/tgadecoder.h"
 
-void Texture::BGR2RGB() {
-	int bufferSize = (this->textureData->width * this->textureData->height) * this->textureData->bytesPerPixel;
+#define KAISER_WIDTH 3.0f // Radius of the Kaiser mip filter, in pixels of the smaller level
+#define KAISER_ALPHA 4.0f // Shape of the Kaiser window, higher is smoother
+
+bool Texture::_uploadBGR = true; // Declare static member
+
+/**
+* Pads the stream with zeros up to the alignment
+*/
+static void AlignStream(std::ofstream& stream, size_t alignment) {
+	static const char zeros[ATEX_ALIGNMENT] = {};
+	size_t position = (size_t)stream.tellp();
+	size_t padding = (alignment - (position % alignment)) % alignment;
+	stream.write(zeros, padding);
+}
+
+/**
+* Returns the OpenGL format of a block compressed format
+*/
+static GLenum GetCompressedFormat(BCFormat format) {
+	if (format == BC1Format) return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	if (format == BC3Format) return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	return GL_COMPRESSED_RGBA_BPTC_UNORM;
+}
+
+/**
+* Returns the block compressed format of a OpenGL format, false if the format is not compressed
+*/
+static bool GetBCFormat(GLenum glFormat, BCFormat& format) {
+	switch (glFormat) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: format = BC1Format; return true;
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: format = BC3Format; return true;
+	case GL_COMPRESSED_RGBA_BPTC_UNORM: format = BC7Format; return true;
+	default: return false;
+	}
+}
+
+/**
+* Returns true if the driver can sample a block compressed format
+*/
+static bool IsCompressionSupported(BCFormat format) {
+	if (format == BC7Format) return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	return GLEW_EXT_texture_compression_s3tc != 0;
+}
 
-	for (int i = 0; i < bufferSize; i += this->textureData->bytesPerPixel) {
-		int b = this->textureData->imageData[i];
-		int g = this->textureData->imageData[i + 1];
-		int r = this->textureData->imageData[i + 2];
+/**
+* Sets trilinear and anisotropic filtering for a mip chain of levelCount levels, bilinear for a single level
+*/
+static void SetSampling(uint32_t levelCount) {
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	if (levelCount > 1 && GLEW_EXT_texture_filter_anisotropic) {
+		GLfloat maximum = 1.0f;
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maximum);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(TEXTURE_MAX_ANISOTROPY, maximum));
+	}
+}
+
+/**
+* Averages 2x2 pixels of the previous level, edges of odd sizes are repeated
+*/
+static void DownsampleBox(const unsigned char* previous, uint32_t width, uint32_t height, size_t bytesPerPixel, unsigned char* next, uint32_t nextWidth, uint32_t nextHeight) {
+	for (uint32_t y = 0; y < nextHeight; y++) {
+		uint32_t y0 = y * 2 < height ? y * 2 : height - 1;
+		uint32_t y1 = y * 2 + 1 < height ? y * 2 + 1 : height - 1;
+		for (uint32_t x = 0; x < nextWidth; x++) {
+			uint32_t x0 = x * 2 < width ? x * 2 : width - 1;
+			uint32_t x1 = x * 2 + 1 < width ? x * 2 + 1 : width - 1;
+			for (size_t c = 0; c < bytesPerPixel; c++) {
+				unsigned sum = previous[((size_t)y0 * width + x0) * bytesPerPixel + c] + previous[((size_t)y0 * width + x1) * bytesPerPixel + c] +
+					previous[((size_t)y1 * width + x0) * bytesPerPixel + c] + previous[((size_t)y1 * width + x1) * bytesPerPixel + c];
+				next[((size_t)y * nextWidth + x) * bytesPerPixel + c] = (unsigned char)((sum + 2) / 4);
+			}
+		}
+	}
+}
 
-		this->textureData->imageData[i] = r;
-		this->textureData->imageData[i + 1] = g;
-		this->textureData->imageData[i + 2] = b;
+/**
+* Returns the modified Bessel function of the first kind of order 0
+*/
+static double BesselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		double factor = x / (2.0 * k);
+		term *= factor * factor;
+		sum += term;
 	}
+	return sum;
+}
+
+/**
+* Returns the weight of the Kaiser windowed sinc at distance t, in pixels of the smaller level
+*/
+static float KaiserWeight(float t) {
+	if (std::fabs(t) >= KAISER_WIDTH) return 0.0f;
+
+	const float pi = 3.14159265358979f;
+	float sinc = t == 0.0f ? 1.0f : std::sin(pi * t) / (pi * t);
+	float r = t / KAISER_WIDTH;
+	return sinc * (float)(BesselI0(KAISER_ALPHA * std::sqrt(1.0f - r * r)) / BesselI0(KAISER_ALPHA));
+}
+
+/**
+* The source pixels and normalized weights of a single pixel of the smaller level
+*/
+struct FilterTaps {
+	int first; /// @brief First source pixel, may be outside the image
+	std::vector<float> weights; /// @brief Weight of every source pixel from first
+};
+
+/**
+* Returns the taps of every pixel when resampling length pixels to nextLength pixels
+*/
+static std::vector<FilterTaps> GetKaiserTaps(uint32_t length, uint32_t nextLength) {
+	float scale = (float)length / nextLength;
+	std::vector<FilterTaps> taps(nextLength);
+	for (uint32_t i = 0; i < nextLength; i++) {
+		float center = (i + 0.5f) * scale;
+		int first = (int)std::floor(center - KAISER_WIDTH * scale);
+		int last = (int)std::ceil(center + KAISER_WIDTH * scale);
+
+		float sum = 0.0f;
+		taps[i].first = first;
+		for (int j = first; j <= last; j++) {
+			float weight = KaiserWeight((j + 0.5f - center) / scale);
+			taps[i].weights.push_back(weight);
+			sum += weight;
+		}
+		for (size_t j = 0; j < taps[i].weights.size(); j++) taps[i].weights[j] /= sum;
+	}
+	return taps;
+}
+
+/**
+* Resamples the previous level with a separable Kaiser filter, edges are repeated
+*/
+static void DownsampleKaiser(const unsigned char* previous, uint32_t width, uint32_t height, size_t bytesPerPixel, unsigned char* next, uint32_t nextWidth, uint32_t nextHeight) {
+	std::vector<FilterTaps> columns = GetKaiserTaps(width, nextWidth);
+	std::vector<FilterTaps> rows = GetKaiserTaps(height, nextHeight);
+
+	//Horizontal pass into floats, then the vertical pass rounds to bytes
+	std::vector<float> horizontal((size_t)nextWidth * height * bytesPerPixel);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < nextWidth; x++) {
+			const FilterTaps& tap = columns[x];
+			for (size_t c = 0; c < bytesPerPixel; c++) {
+				float sum = 0.0f;
+				for (size_t j = 0; j < tap.weights.size(); j++) {
+					int sx = std::min(std::max(tap.first + (int)j, 0), (int)width - 1);
+					sum += tap.weights[j] * previous[((size_t)y * width + sx) * bytesPerPixel + c];
+				}
+				horizontal[((size_t)y * nextWidth + x) * bytesPerPixel + c] = sum;
+			}
+		}
+	}
+
+	for (uint32_t y = 0; y < nextHeight; y++) {
+		const FilterTaps& tap = rows[y];
+		for (uint32_t x = 0; x < nextWidth; x++) {
+			for (size_t c = 0; c < bytesPerPixel; c++) {
+				float sum = 0.0f;
+				for (size_t j = 0; j < tap.weights.size(); j++) {
+					int sy = std::min(std::max(tap.first + (int)j, 0), (int)height - 1);
+					sum += tap.weights[j] * horizontal[((size_t)sy * nextWidth + x) * bytesPerPixel + c];
+				}
+				next[((size_t)y * nextWidth + x) * bytesPerPixel + c] = (unsigned char)std::min(std::max(sum + 0.5f, 0.0f), 255.0f);
+			}
+		}
+	}
+}
+
+Texture::Texture() : Resident(ResidentTexture) {
+	this->_glTexture = 0;
+	this->_pendingFile = nullptr;
+	this->_evicted = false;
+	this->_gpuBytes = 0;
+	this->textureData = nullptr;
+}
+
+void Texture::BGR2RGB() {
+	PixelConverter::SwapRedBlue(this->textureData->imageData, (size_t)this->textureData->width * this->textureData->height, this->textureData->bytesPerPixel);
+	this->textureData->pixelFormat = this->textureData->type;
 }
 
 void Texture::UploadToGPU() {
@@ -41,39 +223,165 @@ void Texture::UploadToGPU() {
 										 // Map the surface to the texture in video memory
 	glBindTexture(GL_TEXTURE_2D, this->_glTexture);
 
-	if (textureData->type == GL_RGB) {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, textureData->width, textureData->height, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData->imageData);
+	if (this->_pendingFile) {
+		//Upload every level straight from the file, it was validated by DecodeATex
+		const unsigned char* data = this->_pendingFile->GetData();
+		ATexHeader atex;
+		memcpy(&atex, data, sizeof(ATexHeader));
+
+		BCFormat bcFormat;
+		bool compressed = GetBCFormat(atex.format, bcFormat);
+		bool decode = compressed && !IsCompressionSupported(bcFormat); // Decoded to RGBA on the CPU instead
+		std::vector<unsigned char> decoded;
+
+		this->_gpuBytes = 0;
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Levels are tightly packed
+		for (uint32_t i = 0; i < atex.levelCount; i++) {
+			const ATexLevel& level = atex.levels[i];
+			if (decode) {
+				decoded.resize((size_t)level.width * level.height * 4);
+				BCEncoder::Decode(bcFormat, data + level.offset, level.width, level.height, decoded.data());
+				glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, decoded.data());
+				this->_gpuBytes += decoded.size();
+			}
+			else if (compressed) {
+				glCompressedTexImage2D(GL_TEXTURE_2D, i, atex.format, level.width, level.height, 0, (GLsizei)level.size, data + level.offset);
+				this->_gpuBytes += (size_t)level.size;
+			}
+			else {
+				glTexImage2D(GL_TEXTURE_2D, i, atex.format, level.width, level.height, 0, atex.format, GL_UNSIGNED_BYTE, data + level.offset);
+				this->_gpuBytes += (size_t)level.size;
+			}
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		if (decode) {
+			Debug::Log("Compressed texture format not supported, decoding " + this->_sourcePath, typeid(*this).name());
+		}
+		SetSampling(atex.levelCount);
+
+		delete this->_pendingFile;
+		this->_pendingFile = nullptr;
 	}
 	else {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureData->width, textureData->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData->imageData);
+		//Targa pixels may still be in BGR order, OpenGL swizzles those during the upload
+		glTexImage2D(GL_TEXTURE_2D, 0, textureData->type, textureData->width, textureData->height, 0, textureData->pixelFormat, GL_UNSIGNED_BYTE, textureData->imageData);
+
+		this->_gpuBytes = (size_t)textureData->width * textureData->height * textureData->bytesPerPixel;
+
+		//Textures read from a file get a generated mip chain, generated and recolored ones are changed too often
+		if (!this->_sourcePath.empty()) {
+			uint32_t levelCount = 1;
+			for (GLuint size = std::max(textureData->width, textureData->height); size > 1; size /= 2) levelCount++;
+
+			glGenerateMipmap(GL_TEXTURE_2D);
+			SetSampling(levelCount);
+			this->_gpuBytes = this->_gpuBytes * 4 / 3;
+		}
+		else {
+			SetSampling(1);
+		}
 	}
 
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	//The pixels are in video memory now, keep them only if they can not be read again
+	this->_evicted = false;
+	this->MarkUsed();
+	if (!this->_sourcePath.empty() && textureData->imageData) {
+		free(textureData->imageData);
+		textureData->imageData = nullptr;
+	}
+	this->UpdateResidentSize();
+}
+
+void Texture::UpdateResidentSize() {
+	size_t cpuBytes = textureData && textureData->imageData ? (size_t)textureData->width * textureData->height * textureData->bytesPerPixel : 0;
+	this->SetResidentSize(cpuBytes, this->_glTexture ? this->_gpuBytes : 0);
+}
+
+void Texture::Reload() {
+	this->_evicted = false; // A texture that fails to load is not tried again every frame
+	if (!this->Decode(this->_sourcePath)) return;
+	this->UploadToGPU();
+	ResidencyManager::CountReload();
+}
+
+bool Texture::ReleaseCpu() {
+	if (this->_sourcePath.empty() || !textureData || !textureData->imageData) return false;
+
+	free(textureData->imageData);
+	textureData->imageData = nullptr;
+	this->UpdateResidentSize();
+	return true;
+}
+
+bool Texture::ReleaseGpu() {
+	if (this->_sourcePath.empty() || !this->_glTexture) return false;
+
+	glDeleteTextures(1, &this->_glTexture);
+	this->_glTexture = 0;
+	this->_evicted = true;
+	if (!this->ReleaseCpu()) this->UpdateResidentSize();
+	return true;
+}
+
+bool Texture::RequirePixels() {
+	if (textureData && textureData->imageData) return true;
+	if (this->_pendingFile) return this->ReadPendingPixels(); // Decoded but not uploaded yet, the file is still needed for the upload
+	if (this->_sourcePath.empty() || !this->Decode(this->_sourcePath)) return false;
+	if (this->_pendingFile && !this->ReadPendingPixels()) return false;
+
+	//Only the pixels were needed, the video memory still holds the levels
+	delete this->_pendingFile;
+	this->_pendingFile = nullptr;
+	this->MarkUsed();
+	this->UpdateResidentSize();
+	return true;
 }
 
 bool Texture::LoadTGA(char* filepath) {
-	FILE* fTGA; //Declare file pointer
-	fTGA = fopen(filepath, "rb"); //Open file for reading
+	if (!this->DecodeTGA(filepath)) return false;
+	this->UploadToGPU();
 
-	if (fTGA == NULL) { //If error was found..
+	Debug::Log("Texture created succesfully! Texture bits per pixel = ", typeid(*this).name());
+	Debug::Log(std::to_string(textureData->bpp), typeid(*this).name()); //Print error
+	return true;
+}
+
+bool Texture::DecodeTGA(char* filepath) {
+	AssetFile file; //Archive entry or loose file
+	if (!file.Open(filepath)) { //If error was found..
 		Debug::Log("Could not open: ", typeid(*this).name());
 		Debug::Log(filepath, typeid(*this).name()); //Print error
 		return false; //Return false
 	}
 
-	if (fread(&header, sizeof(header), 1, fTGA) == 0) { //If failure to read file header
+	const unsigned char* data = file.GetData();
+	size_t size = file.GetSize();
+
+	if (size < sizeof(header)) { //If failure to read file header
 		Debug::Log("Error reading file header: ", typeid(*this).name());
 		Debug::Log(filepath, typeid(*this).name()); //Print error
 		return false; //Return false
 	}
+	memcpy(&header, data, sizeof(header));
 
-	textureData = new TextureData();
-	if (fread(targa.header, sizeof(targa.header), 1, fTGA) == 0) { //Attempt to read next 6 bytes
+	GLubyte imageType = header.header[2];
+	if (header.header[1] != 0 || (imageType != TGA_TYPE_RGB && imageType != TGA_TYPE_RLE_RGB)) { // Color mapped and grayscale files
+		Debug::Log("Unsupported Targa type " + std::to_string(imageType) + ": " + filepath, typeid(*this).name());
+		return false;
+	}
+
+	//Reading again after the pixels were freed keeps the same textureData
+	if (!textureData) textureData = new TextureData();
+	free(textureData->imageData);
+	textureData->imageData = nullptr;
+	this->_sourcePath = filepath;
+	if (size < sizeof(header) + sizeof(targa.header)) { //Attempt to read next 6 bytes
 		Debug::Log("Error reading TGA: ", typeid(*this).name());
 		Debug::Log(filepath, typeid(*this).name()); //Print error
 		return false; // Return false
 	}
+	memcpy(targa.header, data + sizeof(header), sizeof(targa.header));
 
 	textureData->width = targa.header[1] * 256 + targa.header[0]; //Calculate height
 	textureData->height = targa.header[3] * 256 + targa.header[2]; //Calculate width
@@ -108,27 +416,203 @@ bool Texture::LoadTGA(char* filepath) {
 		return false; // If Not, Return False
 	}
 
-	if (fread(textureData->imageData, 1, targa.imageSize, fTGA) != targa.imageSize) { 	// Attempt To Read All The Image Data
+	size_t pixelOffset = sizeof(header) + sizeof(targa.header) + header.header[0]; // The pixels follow the image id
+	if (pixelOffset > size || !TGADecoder::DecodePixels(data + pixelOffset, size - pixelOffset, targa.width, targa.height, targa.bytesPerPixel, imageType, targa.header[5], textureData->imageData)) { 	// Attempt To Read All The Image Data
 		Debug::Log("cant read image data : ", typeid(*this).name());
 		Debug::Log(filepath, typeid(*this).name()); //Print error
 		return false; //If we cant read the data return false
 	}
 
-	this->BGR2RGB(); //Convert from BGR to RGB
-	this->UploadToGPU();
+	if (_uploadBGR) {
+		textureData->pixelFormat = textureData->type == GL_RGBA ? GL_BGRA : GL_BGR; // Swizzled by OpenGL during the upload
+	}
+	else {
+		this->BGR2RGB(); //Convert from BGR to RGB
+	}
+	return true;                    // Return Success
+}
 
-	Debug::Log("Texture created succesfully! Texture bits per pixel = ", typeid(*this).name());
-	Debug::Log(std::to_string(textureData->bpp), typeid(*this).name()); //Print error
+bool Texture::DecodeATex(std::string path) {
+	AssetFile* file = new AssetFile();
+	if (!file->Open(path)) {
+		Debug::Log("Could not open: " + path, typeid(*this).name());
+		delete file;
+		return false;
+	}
 
-	fclose(fTGA);                   // Close The File
-	return true;                    // Return Success
+	const unsigned char* data = file->GetData();
+	size_t size = file->GetSize();
+
+	ATexHeader atex;
+	if (size < sizeof(ATexHeader)) {
+		Debug::Log("Invalid atex file " + path, typeid(*this).name());
+		delete file;
+		return false;
+	}
+	memcpy(&atex, data, sizeof(ATexHeader));
+
+	//Validate before handing anything to OpenGL
+	BCFormat bcFormat;
+	bool compressed = GetBCFormat(atex.format, bcFormat);
+	bool valid = atex.magic == ATEX_MAGIC && atex.version >= 1 && atex.version <= ATEX_VERSION && (atex.format == GL_RGB || atex.format == GL_RGBA || compressed) &&
+		atex.levelCount >= 1 && atex.levelCount <= ATEX_MAX_LEVELS;
+	size_t bytesPerPixel = atex.format == GL_RGB ? 3 : 4; // Compressed levels are read back as RGBA
+	for (uint32_t i = 0; i < atex.levelCount && valid; i++) {
+		const ATexLevel& level = atex.levels[i];
+		uint64_t expected = compressed ? (uint64_t)BCEncoder::GetEncodedSize(bcFormat, level.width, level.height) : (uint64_t)level.width * level.height * bytesPerPixel;
+		valid = level.width > 0 && level.height > 0 && level.size == expected && level.offset + level.size <= size;
+	}
+
+	if (!valid) {
+		Debug::Log("Invalid or corrupt atex file " + path, typeid(*this).name());
+		delete file;
+		return false;
+	}
+
+	//The pixels are only read from the file when RequirePixels needs them
+	if (!textureData) textureData = new TextureData();
+	free(textureData->imageData);
+	textureData->imageData = nullptr;
+	textureData->width = atex.levels[0].width;
+	textureData->height = atex.levels[0].height;
+	textureData->bytesPerPixel = (GLuint)bytesPerPixel;
+	textureData->bpp = (GLuint)bytesPerPixel * 8;
+	textureData->type = compressed ? GL_RGBA : atex.format;
+	textureData->pixelFormat = textureData->type;
+
+	//The file is kept until UploadToGPU
+	delete this->_pendingFile;
+	this->_pendingFile = file;
+	this->_sourcePath = path;
+	return true;
+}
+
+bool Texture::ReadPendingPixels() {
+	const unsigned char* data = this->_pendingFile->GetData();
+	ATexHeader atex;
+	memcpy(&atex, data, sizeof(ATexHeader));
+
+	const ATexLevel& level = atex.levels[0];
+	size_t size = (size_t)level.width * level.height * textureData->bytesPerPixel;
+	textureData->imageData = (GLubyte*)malloc(size);
+	if (textureData->imageData == NULL) return false;
+
+	BCFormat bcFormat;
+	if (GetBCFormat(atex.format, bcFormat)) {
+		BCEncoder::Decode(bcFormat, data + level.offset, level.width, level.height, textureData->imageData);
+	}
+	else {
+		memcpy(textureData->imageData, data + level.offset, size);
+	}
+	return true;
+}
+
+bool Texture::Decode(std::string path) {
+	if (path.size() > 5 && path.compare(path.size() - 5, 5, ".atex") == 0) {
+		return DecodeATex(path); // Cooked texture
+	}
+
+	return DecodeTGA((char*)path.c_str());
+}
+
+bool Texture::ConvertTGA(std::string tgaPath, std::string atexPath, TextureCompression compression, MipFilter filter) {
+	Texture texture;
+	if (!texture.DecodeTGA((char*)tgaPath.c_str())) return false;
+	if (texture.textureData->pixelFormat != texture.textureData->type) texture.BGR2RGB(); // Cooked files are RGB
+
+	return Texture::WriteATex(texture.textureData, atexPath, compression, filter);
+}
+
+bool Texture::WriteATex(const TextureData* data, std::string atexPath, TextureCompression compression, MipFilter filter) {
+	size_t bytesPerPixel = data->bytesPerPixel;
+	uint32_t width = data->width;
+	uint32_t height = data->height;
+
+	if (compression == AutoCompressTexture) {
+		compression = data->type == GL_RGBA ? BC3Texture : BC1Texture;
+	}
+	BCFormat bcFormat = compression == BC1Texture ? BC1Format : (compression == BC3Texture ? BC3Format : BC7Format);
+
+	ATexHeader atex;
+	memset(&atex, 0, sizeof(ATexHeader));
+	atex.magic = ATEX_MAGIC;
+	atex.version = ATEX_VERSION;
+	atex.format = compression == UncompressedTexture ? data->type : GetCompressedFormat(bcFormat);
+
+	//Every level is filtered from the previous one
+	std::vector<std::vector<unsigned char>> levels;
+	levels.push_back(std::vector<unsigned char>(data->imageData, data->imageData + (size_t)width * height * bytesPerPixel));
+	while (true) {
+		ATexLevel& level = atex.levels[levels.size() - 1];
+		level.width = width;
+		level.height = height;
+		if ((width == 1 && height == 1) || levels.size() == ATEX_MAX_LEVELS) break;
+
+		uint32_t nextWidth = width > 1 ? width / 2 : 1;
+		uint32_t nextHeight = height > 1 ? height / 2 : 1;
+		std::vector<unsigned char> next((size_t)nextWidth * nextHeight * bytesPerPixel);
+		if (filter == KaiserMipFilter) {
+			DownsampleKaiser(levels.back().data(), width, height, bytesPerPixel, next.data(), nextWidth, nextHeight);
+		}
+		else {
+			DownsampleBox(levels.back().data(), width, height, bytesPerPixel, next.data(), nextWidth, nextHeight);
+		}
+
+		levels.push_back(std::vector<unsigned char>());
+		levels.back().swap(next);
+		width = nextWidth;
+		height = nextHeight;
+	}
+	atex.levelCount = (uint32_t)levels.size();
+
+	if (compression != UncompressedTexture) {
+		for (uint32_t i = 0; i < atex.levelCount; i++) {
+			std::vector<unsigned char> blocks(BCEncoder::GetEncodedSize(bcFormat, atex.levels[i].width, atex.levels[i].height));
+			BCEncoder::Encode(bcFormat, levels[i].data(), atex.levels[i].width, atex.levels[i].height, (unsigned)bytesPerPixel, blocks.data());
+			levels[i].swap(blocks);
+		}
+	}
+
+	uint64_t offset = sizeof(ATexHeader);
+	for (uint32_t i = 0; i < atex.levelCount; i++) {
+		offset = (offset + ATEX_ALIGNMENT - 1) / ATEX_ALIGNMENT * ATEX_ALIGNMENT;
+		atex.levels[i].offset = offset;
+		atex.levels[i].size = levels[i].size();
+		offset += atex.levels[i].size;
+	}
+
+	std::ofstream file(atexPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		Debug::Log("Cannot write atex file " + atexPath, typeid(Texture).name());
+		return false;
+	}
+
+	file.write((const char*)&atex, sizeof(ATexHeader));
+	for (uint32_t i = 0; i < atex.levelCount; i++) {
+		AlignStream(file, ATEX_ALIGNMENT);
+		file.write((const char*)levels[i].data(), levels[i].size());
+	}
+
+	return file.good();
+}
+
+void Texture::SetUploadBGR(bool enabled) {
+	_uploadBGR = enabled;
+}
+
+bool Texture::GetUploadBGR() {
+	return _uploadBGR;
 }
 
 GLuint Texture::GetGLTexture() {
+	if (this->_evicted) this->Reload();
+	this->MarkUsed();
 	return this->_glTexture;
 }
 
 int Texture::GetPixelData(int x, int y, int offset) {
+	if (!this->RequirePixels()) return 0;
+
 	if (offset > ((int)this->textureData->bytesPerPixel - 1)) {
 		offset = (this->textureData->bytesPerPixel - 1);
 	}
@@ -137,6 +621,10 @@ int Texture::GetPixelData(int x, int y, int offset) {
 		offset = 0;
 	}
 
+	if (offset < 3 && this->textureData->pixelFormat != this->textureData->type) {
+		offset = 2 - offset; // Stored in BGR order
+	}
+
 	int height = (y * this->textureData->width) * this->textureData->bytesPerPixel;
 	int width = x * this->textureData->bytesPerPixel;
 
@@ -144,26 +632,24 @@ int Texture::GetPixelData(int x, int y, int offset) {
 }
 
 void Texture::SetColor(Point4f color) {
-	int bufferSize = (this->textureData->height * this->textureData->width) * this->textureData->bytesPerPixel; // Get the buffer size
-	for (int i = 0; i < bufferSize; i += this->textureData->bytesPerPixel) { // For every pixel
-		if (this->textureData->imageData[i] == 0 && this->textureData->imageData[i + 1] == 0 && this->textureData->imageData[i + 2] == 0) { // If a pixel has no color
-			continue; //Continue
-		}
+	if (!this->RequirePixels()) return;
+	this->_sourcePath.clear(); // The recolored pixels can not be read from the file again
 
-		this->textureData->imageData[i] = (GLubyte)color.x; // Set Red
-		this->textureData->imageData[i + 1] = (GLubyte)color.y; // Set Green
-		this->textureData->imageData[i + 2] = (GLubyte)color.z; // Set Blue
-		
-		if (this->textureData->type == GL_RGBA) {
-			this->textureData->imageData[i + 3] = (GLubyte)color.w; // Set alpha
-		}
-	}
+	//Every pixel that has color gets the new color, in the channel order of the pixels
+	bool bgr = this->textureData->pixelFormat != this->textureData->type;
+	GLubyte tint[4] = { (GLubyte)(bgr ? color.z : color.x), (GLubyte)color.y, (GLubyte)(bgr ? color.x : color.z), (GLubyte)color.w };
+	PixelConverter::Tint(this->textureData->imageData, (size_t)this->textureData->width * this->textureData->height, this->textureData->bytesPerPixel, tint);
 
 	this->UploadToGPU(); //Re-Upload the texture
 }
 
 void Texture::GenerateTexture(int width, int height, GLuint type) {
+	if (this->textureData) {
+		free(this->textureData->imageData);
+		delete this->textureData;
+	}
 	this->textureData = new TextureData();
+	this->_sourcePath.clear(); // Generated, it can not be read again
 	
 	//Set some properties
 	if (type == GL_RGB)
@@ -174,21 +660,27 @@ void Texture::GenerateTexture(int width, int height, GLuint type) {
 	this->textureData->height = height;
 	this->textureData->bytesPerPixel = (this->textureData->bpp / 8);
 	this->textureData->type = type;
+	this->textureData->pixelFormat = type;
 
 	//Allocate
 	float imageSize = (float)this->textureData->bytesPerPixel * (width * height);
 	this->textureData->imageData = (GLubyte*)malloc((size_t)imageSize); //Allocate memory
 
-	int bufferSize = (this->textureData->height * this->textureData->width) * this->textureData->bytesPerPixel; // Get the buffer size
-	for (int i = 0; i < bufferSize; i += this->textureData->bytesPerPixel) { // For every pixel
-		this->textureData->imageData[i] = (GLubyte)255; // Set Red
-		this->textureData->imageData[i + 1] = (GLubyte)255; // Set Green
-		this->textureData->imageData[i + 2] = (GLubyte)255; // Set Blue
+	const GLubyte white[4] = { 255, 255, 255, 255 };
+	PixelConverter::Fill(this->textureData->imageData, (size_t)width * height, this->textureData->bytesPerPixel, white); // Every pixel white
 
-		if (this->textureData->type == GL_RGBA) {
-			this->textureData->imageData[i + 3] = (GLubyte)255; // Set alpha
-		}
+	this->UploadToGPU(); //Re-Upload the texture
+}
+
+Texture::~Texture() {
+	delete this->_pendingFile;
+
+	if (this->textureData) {
+		free(this->textureData->imageData);
+		delete this->textureData;
 	}
 
-	this->UploadToGPU(); //Re-Upload the texture
+	if (this->_glTexture) {
+		glDeleteTextures(1, &this->_glTexture);
+	}
 }
\ No newline at end of file
@@ -16,6 +16,13 @@
 #include "glm/glm.hpp"
 #include "GL/glew.h"
 #include "math/pointx.h"
+#include "atex.h"
+#include "residency.h"
+
+#define TEXTURE_MAX_ANISOTROPY 8.0f // Anisotropic filtering of mipmapped textures, clamped to what the driver supports
+
+//Forward declarations
+class AssetFile;
 
 typedef struct {
 	/** Holds all the color values for the image*/
@@ -38,6 +45,9 @@ typedef struct {
 
 	/** Data stored in *ImageData (GL_RGB OR GL_RGBA)*/
 	GLuint type;
+
+	/** Order of the channels in *ImageData (GL_RGB, GL_RGBA, or GL_BGR, GL_BGRA as read from a Targa File)*/
+	GLuint pixelFormat;
 } TextureData;
 
 typedef struct {
@@ -68,7 +78,30 @@ typedef struct {
 	GLuint bpp;
 } TGA;
 
-class Texture {
+/**
+* The block compression of a cooked texture
+*/
+enum TextureCompression {
+	UncompressedTexture,
+	BC1Texture, // Opaque, 4 bits per pixel
+	BC3Texture, // Interpolated alpha, 8 bits per pixel
+	BC7Texture, // Higher quality RGBA, 8 bits per pixel
+	AutoCompressTexture // BC1 for RGB and BC3 for RGBA
+};
+
+/**
+* The filter used to generate the mip chain of a cooked texture
+*/
+enum MipFilter {
+	BoxMipFilter, // Averages 2x2 pixels
+	KaiserMipFilter // Kaiser windowed sinc, keeps the smaller levels sharper
+};
+
+/**
+* A texture, the pixels are only kept in system memory until uploaded if the texture was read from a file.
+* When evicted by the ResidencyManager it is read again the next time it is bound
+*/
+class Texture : public Resident {
 private:
 	// Header
 	TGAHeader header;
@@ -79,27 +112,118 @@ private:
 	// The pointer to the converted OpenGL texture in memory
 	GLuint _glTexture;
 
+	// The validated .atex file, its levels are uploaded straight from the archive or file mapping
+	AssetFile* _pendingFile;
+
+	// The file the texture was read from, empty for generated and recolored textures which can not be read again
+	std::string _sourcePath;
+
+	// True if the video memory was released, the texture is read again on the next use
+	bool _evicted;
+
+	// Bytes of video memory of the uploaded levels
+	size_t _gpuBytes;
+
+	// True if Targa pixels are kept in the BGR order of the file
+	static bool _uploadBGR;
+
 	/**
 	* Converts BGR to RGB
 	*/
 	void BGR2RGB();
 
 	/**
-	* Uploads the texture to the GPU, and sets the _glTexture pointer
+	* Reports the memory in use to the ResidencyManager
 	*/
-	void UploadToGPU();
+	void UpdateResidentSize();
+
+	/**
+	* Reads and uploads a evicted texture again
+	*/
+	void Reload();
+
+	/**
+	* Copies level 0 of the pending .atex file into textureData, compressed levels are decoded to RGBA
+	*/
+	bool ReadPendingPixels();
+protected:
+	/**
+	* Frees the pixels if the texture can be read again
+	*/
+	bool ReleaseCpu() override;
+
+	/**
+	* Deletes the OpenGL texture and the pixels if the texture can be read again
+	*/
+	bool ReleaseGpu() override;
 
 public:
 	//Texture data
 	TextureData * textureData;
 
+	/**
+	* Constructor
+	*/
+	Texture();
+
 	/**
 	* Load a Targa File.
 	*/
 	bool LoadTGA(char* filepath);
 
 	/**
-	* Returns the OpenGL Ready Texture
+	* Reads a uncompressed or RLE compressed Targa File into textureData without uploading it, does not need a OpenGL context
+	* so it can run on a worker thread. Rows are stored bottom to top whatever the origin of the file
+	*/
+	bool DecodeTGA(char* filepath);
+
+	/**
+	* Reads a cooked .atex file, the levels are uploaded straight from the file and only the size and format are set in textureData.
+	* Does not need a OpenGL context so it can run on a worker thread
+	*/
+	bool DecodeATex(std::string path);
+
+	/**
+	* Reads a .atex or .tga file without uploading it, by extension
+	*/
+	bool Decode(std::string path);
+
+	/**
+	* Uploads the texture to the GPU, and sets the _glTexture pointer. The pixels of a texture read from a file are freed afterwards.
+	* Compressed levels are decoded to RGBA if the driver does not support their format. Mipmapped textures are sampled trilinear
+	* and anisotropic, textures read from a .tga file get their mipmaps generated by OpenGL
+	*/
+	void UploadToGPU();
+
+	/**
+	* Makes sure textureData->imageData holds the pixels, reading them from the file again if they were freed.
+	* Must be called before reading the pixels, returns false if there are no pixels
+	*/
+	bool RequirePixels();
+
+	/**
+	* Converts a Targa File to a .atex file with a full mip chain, does not need a OpenGL context
+	*/
+	static bool ConvertTGA(std::string tgaPath, std::string atexPath, TextureCompression compression = AutoCompressTexture, MipFilter filter = KaiserMipFilter);
+
+	/**
+	* Writes RGB or RGBA pixels as a .atex file with a full mip chain, every level is block compressed on the job system
+	*/
+	static bool WriteATex(const TextureData* data, std::string atexPath, TextureCompression compression = AutoCompressTexture, MipFilter filter = KaiserMipFilter);
+
+	/**
+	* Sets if Targa pixels are kept in the BGR order of the file and uploaded as GL_BGR or GL_BGRA, instead of being swizzled to RGB.
+	* On by default
+	*/
+	static void SetUploadBGR(bool enabled);
+
+	/**
+	* Returns true if Targa pixels are kept in the BGR order of the file
+	*/
+	static bool GetUploadBGR();
+
+	/**
+	* Returns the OpenGL Ready Texture, a evicted texture is loaded again first
 	*/
 	GLuint GetGLTexture();
 
@@ -117,6 +241,11 @@ public:
 	* Generates a 24 bit texture buffer
 	*/
 	void GenerateTexture(int width, int height, GLuint type = GL_RGB);
+
+	/**
+	* Destructor, frees the pixels and the OpenGL texture
+	*/
+	~Texture();
 };
 
 #endif // !TEXTURE_H
\ No newline at end of file
@@ -0,0 +1,400 @@
+/**
+*	Filename: transformhierarchy.cpp
+*
+*	Description: Source file for TransformHierarchy class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <algorithm>
+#include <utility>
+#include "transformhierarchy.h"
+#include "jobsystem.h"
+
+//Reorders a array, the element at order[i] is moved to i
+template<typename T>
+void Permute(std::vector<T>& values, const std::vector<unsigned>& order) {
+	std::vector<T> sorted(values.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		sorted[i] = values[order[i]];
+	}
+	values.swap(sorted);
+}
+
+TransformHierarchy* TransformHierarchy::_instance; // Declare static member
+
+TransformHierarchy::TransformHierarchy() {
+	this->unsorted = false;
+}
+
+TransformHierarchy* TransformHierarchy::GetInstance() {
+	if (!_instance) {
+		_instance = new TransformHierarchy();
+	}
+
+	return _instance;
+}
+
+void TransformHierarchy::MarkDirty(unsigned index) {
+	//The flag is tested under the lock as well, two jobs marking the same transform would otherwise both add it
+	std::lock_guard<std::mutex> lock(dirtyMutex);
+	if (dirty[index]) return; // Already in the dirty list
+
+	dirty[index] = 1;
+	dirtyHandles.push_back(handles[index]);
+}
+
+void TransformHierarchy::Sort() {
+	size_t count = handles.size();
+
+	//Transforms with a destroyed parent become roots
+	for (size_t i = 0; i < count; i++) {
+		if (parentHandles[i] != TRANSFORM_NONE && indices[parentHandles[i]] == TRANSFORM_NONE) {
+			parentHandles[i] = TRANSFORM_NONE;
+			MarkDirty((unsigned)i);
+		}
+	}
+
+	//Destroyed handles are only reused now, before this a child could still reference them as parent
+	freeHandles.insert(freeHandles.end(), pendingFreeHandles.begin(), pendingFreeHandles.end());
+	pendingFreeHandles.clear();
+
+	//Group the children of every transform, by their current index
+	std::vector<unsigned> childOffsets(count + 1, 0);
+	std::vector<unsigned> children(count);
+	std::vector<unsigned> roots;
+	for (size_t i = 0; i < count; i++) {
+		if (parentHandles[i] == TRANSFORM_NONE) roots.push_back((unsigned)i);
+		else childOffsets[indices[parentHandles[i]] + 1]++;
+	}
+	for (size_t i = 0; i < count; i++) {
+		childOffsets[i + 1] += childOffsets[i];
+	}
+	std::vector<unsigned> childFill(childOffsets.begin(), childOffsets.end() - 1);
+	for (size_t i = 0; i < count; i++) {
+		if (parentHandles[i] != TRANSFORM_NONE) children[childFill[indices[parentHandles[i]]]++] = (unsigned)i;
+	}
+
+	//Depth first order, every subtree ends up as a contiguous range
+	std::vector<unsigned> order;
+	std::vector<unsigned> stack(roots.rbegin(), roots.rend());
+	order.reserve(count);
+	while (!stack.empty()) {
+		unsigned index = stack.back();
+		stack.pop_back();
+		order.push_back(index);
+
+		for (unsigned c = childOffsets[index + 1]; c > childOffsets[index]; c--) {
+			stack.push_back(children[c - 1]);
+		}
+	}
+
+	Permute(handles, order);
+	Permute(parentHandles, order);
+	Permute(localPositions, order);
+	Permute(localRotations, order);
+	Permute(localScales, order);
+	Permute(globalRotations, order);
+	Permute(globalScales, order);
+	Permute(localMatrices, order);
+	Permute(worldMatrices, order);
+	Permute(dirty, order);
+
+	for (size_t i = 0; i < count; i++) {
+		indices[handles[i]] = (unsigned)i;
+	}
+
+	parents.resize(count);
+	subtreeSizes.assign(count, 1);
+	for (size_t i = 0; i < count; i++) {
+		parents[i] = parentHandles[i] == TRANSFORM_NONE ? TRANSFORM_NONE : indices[parentHandles[i]];
+	}
+
+	//Children are stored after their parent, so walking backwards adds every finished subtree to its parent
+	for (size_t i = count; i > 0; i--) {
+		if (parents[i - 1] != TRANSFORM_NONE) subtreeSizes[parents[i - 1]] += subtreeSizes[i - 1];
+	}
+
+	unsorted = false;
+}
+
+void TransformHierarchy::UpdateRange(unsigned first, unsigned last) {
+	for (unsigned i = first; i < last; i++) {
+		if (dirty[i]) {
+			localMatrices[i] = BuildMatrix(localPositions[i], localRotations[i], localScales[i]);
+			dirty[i] = 0;
+		}
+
+		unsigned parent = parents[i];
+		if (parent == TRANSFORM_NONE) {
+			worldMatrices[i] = localMatrices[i];
+			globalRotations[i] = localRotations[i];
+			globalScales[i] = localScales[i];
+		}
+		else {
+			worldMatrices[i] = worldMatrices[parent] * localMatrices[i];
+			globalRotations[i] = globalRotations[parent] + localRotations[i];
+			globalScales[i] = globalScales[parent] * localScales[i];
+		}
+	}
+}
+
+unsigned TransformHierarchy::Create() {
+	TransformHierarchy* instance = GetInstance();
+
+	unsigned handle;
+	if (!instance->freeHandles.empty()) {
+		handle = instance->freeHandles.back();
+		instance->freeHandles.pop_back();
+	}
+	else {
+		handle = (unsigned)instance->indices.size();
+		instance->indices.push_back(TRANSFORM_NONE);
+		instance->userData.push_back(nullptr);
+	}
+	instance->userData[handle] = nullptr;
+
+	//New transforms are roots, a root at the end of the arrays does not break the depth first order
+	unsigned index = (unsigned)instance->handles.size();
+	instance->indices[handle] = index;
+	instance->handles.push_back(handle);
+	instance->parentHandles.push_back(TRANSFORM_NONE);
+	instance->parents.push_back(TRANSFORM_NONE);
+	instance->subtreeSizes.push_back(1);
+	instance->localPositions.push_back(glm::vec3(0.0f));
+	instance->localRotations.push_back(glm::vec3(0.0f));
+	instance->localScales.push_back(glm::vec3(1.0f));
+	instance->globalRotations.push_back(glm::vec3(0.0f));
+	instance->globalScales.push_back(glm::vec3(1.0f));
+	instance->localMatrices.push_back(glm::mat4(1.0f));
+	instance->worldMatrices.push_back(glm::mat4(1.0f));
+	instance->dirty.push_back(0);
+	return handle;
+}
+
+void TransformHierarchy::Destroy(unsigned handle) {
+	TransformHierarchy* instance = GetInstance();
+	unsigned index = instance->indices[handle];
+	unsigned last = (unsigned)instance->handles.size() - 1;
+
+	//Move the last transform into the gap, the order is restored by the next sort
+	if (index != last) {
+		instance->handles[index] = instance->handles[last];
+		instance->parentHandles[index] = instance->parentHandles[last];
+		instance->localPositions[index] = instance->localPositions[last];
+		instance->localRotations[index] = instance->localRotations[last];
+		instance->localScales[index] = instance->localScales[last];
+		instance->globalRotations[index] = instance->globalRotations[last];
+		instance->globalScales[index] = instance->globalScales[last];
+		instance->localMatrices[index] = instance->localMatrices[last];
+		instance->worldMatrices[index] = instance->worldMatrices[last];
+		instance->dirty[index] = instance->dirty[last];
+		instance->indices[instance->handles[index]] = index;
+	}
+
+	instance->handles.pop_back();
+	instance->parentHandles.pop_back();
+	instance->parents.pop_back();
+	instance->subtreeSizes.pop_back();
+	instance->localPositions.pop_back();
+	instance->localRotations.pop_back();
+	instance->localScales.pop_back();
+	instance->globalRotations.pop_back();
+	instance->globalScales.pop_back();
+	instance->localMatrices.pop_back();
+	instance->worldMatrices.pop_back();
+	instance->dirty.pop_back();
+
+	instance->indices[handle] = TRANSFORM_NONE;
+	instance->userData[handle] = nullptr;
+	instance->pendingFreeHandles.push_back(handle);
+	instance->changedRanges.clear(); // Indices have moved
+	instance->unsorted = true;
+}
+
+void TransformHierarchy::SetParent(unsigned handle, unsigned parent) {
+	TransformHierarchy* instance = GetInstance();
+
+	//A transform can not become a child of its own subtree
+	for (unsigned p = parent; p != TRANSFORM_NONE; p = instance->parentHandles[instance->indices[p]]) {
+		if (p == handle) return;
+	}
+
+	unsigned index = instance->indices[handle];
+	if (instance->parentHandles[index] == parent) return;
+
+	instance->parentHandles[index] = parent;
+	instance->unsorted = true;
+	instance->MarkDirty(index);
+}
+
+void TransformHierarchy::SetLocalPosition(unsigned handle, const glm::vec3& position) {
+	TransformHierarchy* instance = GetInstance();
+	unsigned index = instance->indices[handle];
+	instance->localPositions[index] = position;
+	instance->MarkDirty(index);
+}
+
+void TransformHierarchy::SetLocalRotation(unsigned handle, const glm::vec3& rotation) {
+	TransformHierarchy* instance = GetInstance();
+	unsigned index = instance->indices[handle];
+	instance->localRotations[index] = rotation;
+	instance->MarkDirty(index);
+}
+
+void TransformHierarchy::SetLocalScale(unsigned handle, const glm::vec3& scale) {
+	TransformHierarchy* instance = GetInstance();
+	unsigned index = instance->indices[handle];
+	instance->localScales[index] = scale;
+	instance->MarkDirty(index);
+}
+
+void TransformHierarchy::SetWorldPosition(unsigned handle, const glm::vec3& position) {
+	TransformHierarchy* instance = GetInstance();
+	unsigned index = instance->indices[handle];
+	unsigned parent = instance->parentHandles[index];
+
+	if (parent == TRANSFORM_NONE) {
+		instance->localPositions[index] = position;
+	}
+	else {
+		instance->localPositions[index] = glm::vec3(glm::inverse(instance->worldMatrices[instance->indices[parent]]) * glm::vec4(position, 1.0f));
+	}
+
+	//Set the world position now as well, so it can be read back before the next update
+	instance->worldMatrices[index][3] = glm::vec4(position, 1.0f);
+	instance->MarkDirty(index);
+}
+
+const glm::vec3& TransformHierarchy::GetLocalPosition(unsigned handle) {
+	TransformHierarchy* instance = GetInstance();
+	return instance->localPositions[instance->indices[handle]];
+}
+
+const glm::vec3& TransformHierarchy::GetLocalRotation(unsigned handle) {
+	TransformHierarchy* instance = GetInstance();
+	return instance->localRotations[instance->indices[handle]];
+}
+
+const glm::vec3& TransformHierarchy::GetLocalScale(unsigned handle) {
+	TransformHierarchy* instance = GetInstance();
+	return instance->localScales[instance->indices[handle]];
+}
+
+glm::vec3 TransformHierarchy::GetWorldPosition(unsigned handle) {
+	TransformHierarchy* instance = GetInstance();
+	return glm::vec3(instance->worldMatrices[instance->indices[handle]][3]);
+}
+
+const glm::vec3& TransformHierarchy::GetGlobalRotation(unsigned handle) {
+	TransformHierarchy* instance = GetInstance();
+	return instance->globalRotations[instance->indices[handle]];
+}
+
+const glm::vec3& TransformHierarchy::GetGlobalScale(unsigned handle) {
+	TransformHierarchy* instance = GetInstance();
+	return instance->globalScales[instance->indices[handle]];
+}
+
+const glm::mat4& TransformHierarchy::GetWorldMatrix(unsigned handle) {
+	TransformHierarchy* instance = GetInstance();
+	return instance->worldMatrices[instance->indices[handle]];
+}
+
+void TransformHierarchy::Update() {
+	TransformHierarchy* instance = GetInstance();
+	if (instance->unsorted) instance->Sort();
+	instance->changedRanges.clear();
+
+	std::vector<unsigned> dirtyIndices;
+	{
+		std::lock_guard<std::mutex> lock(instance->dirtyMutex);
+		if (instance->dirtyHandles.empty()) return; // Nothing has changed, static transforms cost nothing
+
+		dirtyIndices.reserve(instance->dirtyHandles.size());
+		for (size_t i = 0; i < instance->dirtyHandles.size(); i++) {
+			unsigned index = instance->indices[instance->dirtyHandles[i]];
+			if (index != TRANSFORM_NONE) dirtyIndices.push_back(index);
+		}
+		instance->dirtyHandles.clear();
+	}
+
+	//Dirty transforms inside the subtree of another dirty transform are updated along with it
+	std::sort(dirtyIndices.begin(), dirtyIndices.end());
+	std::vector<std::pair<unsigned, unsigned>> ranges;
+	size_t total = 0;
+	unsigned end = 0;
+	for (size_t i = 0; i < dirtyIndices.size(); i++) {
+		if (dirtyIndices[i] < end) continue;
+
+		end = dirtyIndices[i] + instance->subtreeSizes[dirtyIndices[i]];
+		ranges.push_back(std::make_pair(dirtyIndices[i], end));
+		total += end - dirtyIndices[i];
+	}
+	instance->changedRanges = ranges;
+
+	if (total < TRANSFORM_PARALLEL_MIN) {
+		for (size_t i = 0; i < ranges.size(); i++) {
+			instance->UpdateRange(ranges[i].first, ranges[i].second);
+		}
+		return;
+	}
+
+	//Split large subtrees, the root is updated here and its child subtrees become independent ranges
+	std::vector<std::pair<unsigned, unsigned>> independent;
+	while (!ranges.empty()) {
+		std::pair<unsigned, unsigned> range = ranges.back();
+		ranges.pop_back();
+
+		if (range.second - range.first <= TRANSFORM_SPLIT_SIZE) {
+			independent.push_back(range);
+			continue;
+		}
+
+		instance->UpdateRange(range.first, range.first + 1);
+		for (unsigned child = range.first + 1; child < range.second; child += instance->subtreeSizes[child]) {
+			ranges.push_back(std::make_pair(child, child + instance->subtreeSizes[child]));
+		}
+	}
+
+	//Batch small ranges together, so a batch holds about TRANSFORM_SPLIT_SIZE transforms
+	size_t batchSize = std::max((size_t)1, independent.size() * TRANSFORM_SPLIT_SIZE / total);
+	JobSystem::ParallelFor(independent.size(), batchSize, [instance, &independent](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++) {
+			instance->UpdateRange(independent[i].first, independent[i].second);
+		}
+	});
+}
+
+void TransformHierarchy::SetUserData(unsigned handle, void* data) {
+	GetInstance()->userData[handle] = data;
+}
+
+void TransformHierarchy::GetChangedUserData(std::vector<void*>& data) {
+	TransformHierarchy* instance = GetInstance();
+	for (size_t r = 0; r < instance->changedRanges.size(); r++) {
+		for (unsigned i = instance->changedRanges[r].first; i < instance->changedRanges[r].second; i++) {
+			void* owner = instance->userData[instance->handles[i]];
+			if (owner) data.push_back(owner);
+		}
+	}
+}
+
+size_t TransformHierarchy::GetCount() {
+	return GetInstance()->handles.size();
+}
+
+glm::mat4 TransformHierarchy::BuildMatrix(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale) {
+	//Same as translate * rotate x * rotate y * rotate z * scale, written out to avoid the matrix multiplications
+	float sx = sin(glm::radians(rotation.x)), cx = cos(glm::radians(rotation.x));
+	float sy = sin(glm::radians(rotation.y)), cy = cos(glm::radians(rotation.y));
+	float sz = sin(glm::radians(rotation.z)), cz = cos(glm::radians(rotation.z));
+
+	glm::mat4 transform;
+	transform[0] = glm::vec4(cy * cz, cx * sz + sx * sy * cz, sx * sz - cx * sy * cz, 0) * scale.x;
+	transform[1] = glm::vec4(-cy * sz, cx * cz - sx * sy * sz, sx * cz + cx * sy * sz, 0) * scale.y;
+	transform[2] = glm::vec4(sy, -sx * cy, cx * cy, 0) * scale.z;
+	transform[3] = glm::vec4(position, 1);
+	return transform;
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+/**
+*	Filename: transformhierarchy.h
+*
+*	Description: Header file for TransformHierarchy class, stores the transforms of all entities in contiguous arrays
+*				 and only recalculates the world matrices of subtrees that have changed
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef TRANSFORMHIERARCHY_H
+#define TRANSFORMHIERARCHY_H
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <utility>
+#include <glm/glm.hpp>
+
+#define TRANSFORM_NONE 0xFFFFFFFF // Handle or index of no transform, used as parent of root transforms
+#define TRANSFORM_PARALLEL_MIN 4096 // Minimum amount of dirty transforms before the update is spread over the job system
+#define TRANSFORM_SPLIT_SIZE 2048 // Dirty subtrees larger than this are split into their child subtrees when updating in parallel
+
+/**
+* Transforms are addressed by a handle that never changes, the arrays are indexed by a index that changes when the arrays are sorted.
+* The arrays are sorted depth first, so parents are stored before their children and every subtree is a contiguous range.
+*/
+class TransformHierarchy {
+private:
+	static TransformHierarchy* _instance; /// @brief Static transform hierarchy singleton instance
+
+	std::vector<unsigned> indices; /// @brief Index into the arrays of every handle, TRANSFORM_NONE for free handles
+	std::vector<unsigned> freeHandles; /// @brief Handles that can be reused
+	std::vector<unsigned> pendingFreeHandles; /// @brief Destroyed handles, they can be reused after the next sort
+	std::vector<void*> userData; /// @brief Object owning the transform of every handle, not sorted
+
+	//Arrays, all indexed by index
+	std::vector<unsigned> handles; /// @brief Handle of the transform
+	std::vector<unsigned> parentHandles; /// @brief Handle of the parent, TRANSFORM_NONE for roots
+	std::vector<unsigned> parents; /// @brief Index of the parent, valid after sorting
+	std::vector<unsigned> subtreeSizes; /// @brief Amount of transforms in the subtree including the transform itself, valid after sorting
+	std::vector<glm::vec3> localPositions; /// @brief Position relative to the parent
+	std::vector<glm::vec3> localRotations; /// @brief Euler rotation in degrees relative to the parent
+	std::vector<glm::vec3> localScales; /// @brief Scale relative to the parent
+	std::vector<glm::vec3> globalRotations; /// @brief Sum of the euler rotations of the transform and its parents
+	std::vector<glm::vec3> globalScales; /// @brief Product of the scales of the transform and its parents
+	std::vector<glm::mat4> localMatrices; /// @brief Cached local matrix
+	std::vector<glm::mat4> worldMatrices; /// @brief Cached world matrix
+	std::vector<uint8_t> dirty; /// @brief 1 if the local values have changed since the last update
+
+	std::vector<unsigned> dirtyHandles; /// @brief Handles of the transforms marked dirty since the last update
+	std::mutex dirtyMutex; /// @brief Guards dirty and dirtyHandles while marking, transforms can be changed from jobs
+	bool unsorted; /// @brief True if transforms were added, removed or reparented since the last sort
+	std::vector<std::pair<unsigned, unsigned>> changedRanges; /// @brief Index ranges recalculated by the last update
+
+	/**
+	* Constructor
+	*/
+	TransformHierarchy();
+
+	/**
+	* Returns the instance, if none is existant it will create a new instance
+	*/
+	static TransformHierarchy* GetInstance();
+
+	/**
+	* Marks the transform at index dirty, safe to call from jobs but not while Update runs
+	*/
+	void MarkDirty(unsigned index);
+
+	/**
+	* Sorts the arrays depth first and calculates the parent indices and subtree sizes
+	*/
+	void Sort();
+
+	/**
+	* Recalculates the world matrices of the transforms in [first, last), the parent of first must be up to date
+	*/
+	void UpdateRange(unsigned first, unsigned last);
+public:
+	/**
+	* Creates a new root transform with identity values, returns its handle
+	*/
+	static unsigned Create();
+
+	/**
+	* Frees the handle, the children of the transform become roots
+	*/
+	static void Destroy(unsigned handle);
+
+	/**
+	* Sets the parent of the transform, parent can be TRANSFORM_NONE. The local values are kept
+	*/
+	static void SetParent(unsigned handle, unsigned parent);
+
+	/**
+	* Sets the local position
+	*/
+	static void SetLocalPosition(unsigned handle, const glm::vec3& position);
+
+	/**
+	* Sets the local euler rotation in degrees
+	*/
+	static void SetLocalRotation(unsigned handle, const glm::vec3& rotation);
+
+	/**
+	* Sets the local scale
+	*/
+	static void SetLocalScale(unsigned handle, const glm::vec3& scale);
+
+	/**
+	* Sets the local position so the world position becomes position, the world position is changed right away
+	*/
+	static void SetWorldPosition(unsigned handle, const glm::vec3& position);
+
+	/**
+	* Returns the local position
+	*/
+	static const glm::vec3& GetLocalPosition(unsigned handle);
+
+	/**
+	* Returns the local euler rotation in degrees
+	*/
+	static const glm::vec3& GetLocalRotation(unsigned handle);
+
+	/**
+	* Returns the local scale
+	*/
+	static const glm::vec3& GetLocalScale(unsigned handle);
+
+	/**
+	* Returns the world position, as of the last update
+	*/
+	static glm::vec3 GetWorldPosition(unsigned handle);
+
+	/**
+	* Returns the sum of the euler rotations of the transform and its parents, as of the last update
+	*/
+	static const glm::vec3& GetGlobalRotation(unsigned handle);
+
+	/**
+	* Returns the product of the scales of the transform and its parents, as of the last update
+	*/
+	static const glm::vec3& GetGlobalScale(unsigned handle);
+
+	/**
+	* Returns the cached world matrix, as of the last update
+	*/
+	static const glm::mat4& GetWorldMatrix(unsigned handle);
+
+	/**
+	* Recalculates the world matrices of all dirty transforms and their children. Does nothing if no transform has changed
+	*/
+	static void Update();
+
+	/**
+	* Sets the object owning the transform, returned by GetChangedUserData
+	*/
+	static void SetUserData(unsigned handle, void* data);
+
+	/**
+	* Adds the user data of every transform recalculated by the last update, transforms without user data are skipped
+	*/
+	static void GetChangedUserData(std::vector<void*>& data);
+
+	/**
+	* Returns the amount of transforms
+	*/
+	static size_t GetCount();
+
+	/**
+	* Builds a matrix, translate * rotate x * rotate y * rotate z * scale. Rotation is in degrees
+	*/
+	static glm::mat4 BuildMatrix(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+};
+
+#endif // !TRANSFORMHIERARCHY_H
\ No newline at end of file
@@ -11,6 +11,8 @@ Text::Text() {
 	this->color = Point4f(1, 1, 1, 1);
 	this->textScale = 1;
 	this->text = "";
+	this->revision = 0;
+	SetRenderEnabled(true);
 }
 
 void Text::Render(Renderer* renderer, Camera* camera) {
@@ -34,9 +36,16 @@ float Text::GetTextScale() {
 }
 
 void Text::SetText(std::string text) {
+	if (this->text == text) return; // Nothing changed, keep the current mesh
+
 	this->text = text;
+	this->revision++;
 }
 
-std::string& Text::GetText() {
+const std::string& Text::GetText() {
 	return this->text;
+}
+
+unsigned Text::GetRevision() {
+	return this->revision;
 }
\ No newline at end of file
@@ -19,6 +19,7 @@ private:
 	Point4f color; /**< The color of the text */
 	float textScale; /**< The scale of the text*/
 	std::string text; /**< The contents of the text */
+	unsigned revision; /**< Incremented every time the contents change, the renderer only rebuilds the text mesh when it differs */
 
 protected:
 	/*
@@ -68,10 +69,16 @@ public:
 	void SetText(std::string text);
 
 	/**
-	* Returns the text
+	* Returns the text, use SetText to change it
 	* @return std::string
 	*/
-	std::string& GetText();
+	const std::string& GetText();
+
+	/**
+	* Returns the revision of the contents
+	* @return unsigned
+	*/
+	unsigned GetRevision();
 };
 
 #endif // !TEXT_H
@@ -14,6 +14,8 @@ UIElement::UIElement() {
 	this->image = nullptr;
 	this->mouseInBounds = false;
 	this->mouseInBoundsLastFrame = false;
+	SetUpdateEnabled(true); // Checks the mouse every frame
+	SetRenderEnabled(true);
 }
 
 void UIElement::Update() {
@@ -43,16 +45,7 @@ void UIElement::Update() {
 }
 
 void UIElement::Render(Renderer* renderer, Camera* camera) {
-	renderer->RegisterUIElement(this);
-
-	for (size_t i = 0; i < GetChildren().size(); i++) {
-		//Cast to our type to allow for render call
-		UIElement* element = dynamic_cast<UIElement*>(GetChild(i));
-
-		if (element != NULL) {
-			element->Render(renderer, camera);
-		}
-	}
+	renderer->RegisterUIElement(this); // Child elements are in the render list of the scene themselves
 }
 
 void UIElement::SetImage(Texture* image) {
@@ -144,7 +137,7 @@ void UIInputField::Update() {
 	if (this->image == nullptr) return;
 
 	if (this->text != nullptr) {
-		this->text->position = Vec3(this->GetPositionGlobal().x, this->GetPositionGlobal().y + this->GetImage()->textureData->height);
+		this->text->SetPosition(Vec3(this->GetPositionGlobal().x, this->GetPositionGlobal().y + this->GetImage()->textureData->height));
 	}
 
 	if (!Core::CursorEnabled()) return;
@@ -173,21 +166,22 @@ void UIInputField::Update() {
 		if (Input::GetLastKey() == KEYCODE_EMPTY_KEY) return;
 
 		//We translate the key press to character
+		std::string value = text->GetText();
 		if (Input::GetLastKey() != KEYCODE_BACKSPACE) {
 
 			//Check for key combo's
 			if (Input::GetKey(KEYCODE_RIGHT_SHIFT) || Input::GetKey(KEYCODE_LEFT_SHIFT)) {
 				if (Input::GetKeyDown(KEYCODE_9)) {
-					text->GetText().push_back('(');
+					value.push_back('(');
 				}
 				else if (Input::GetKeyDown(KEYCODE_0)) {
-					text->GetText().push_back(')');
+					value.push_back(')');
 				}
 				else if (Input::GetKeyDown(KEYCODE_APOSTROPHE)) {
-					text->GetText().push_back('"');
+					value.push_back('"');
 				}
 				else if (Input::GetKeyDown(KEYCODE_EQUAL)) {
-					text->GetText().push_back('+');
+					value.push_back('+');
 				}
 				else {
 					bool falseKeyFound = false;
@@ -199,7 +193,7 @@ void UIInputField::Update() {
 					}
 
 					if (!falseKeyFound) {
-						text->GetText().push_back((char)Input::GetLastKey());
+						value.push_back((char)Input::GetLastKey());
 					}
 				}
 			}
@@ -213,15 +207,16 @@ void UIInputField::Update() {
 				}
 
 				if (!falseKeyFound) {
-					text->GetText().push_back(tolower((char)Input::GetLastKey()));
+					value.push_back(tolower((char)Input::GetLastKey()));
 				}
 			}
 		}
 		else {
-			if (text->GetText().length() > 0) {
-				text->GetText().erase(text->GetText().begin() + text->GetText().length() - 1);
+			if (value.length() > 0) {
+				value.erase(value.begin() + value.length() - 1);
 			}
 		}
+		text->SetText(value);
 		lastTypeTime = Core::GetTimeElapsed();
 		
 	}
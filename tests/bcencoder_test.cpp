@@ -0,0 +1,133 @@
+/**
+*	Filename: bcencoder_test.cpp
+*
+*	Description: Encodes a test image to BC1, BC3 and BC7, decodes it again and checks the error stays within bounds
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "../aquarite/graphics/bcencoder.h"
+#include "../aquarite/jobsystem.h"
+
+#define TEST_IMAGE_WIDTH 257 // Not a multiple of 4, so the edge blocks are partial
+#define TEST_IMAGE_HEIGHT 131
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { std::cout << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed" << std::endl; failures++; }
+
+/**
+* Returns the peak signal to noise ratio in dB over the channels first to last of two RGBA images, 99 if they are equal
+*/
+static double GetPSNR(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int first, int last) {
+	double error = 0.0;
+	size_t count = 0;
+	for (size_t i = 0; i < a.size(); i += 4) {
+		for (int c = first; c <= last; c++) {
+			double difference = (double)a[i + c] - b[i + c];
+			error += difference * difference;
+			count++;
+		}
+	}
+	if (error == 0.0) return 99.0;
+	return 10.0 * std::log10(255.0 * 255.0 / (error / count));
+}
+
+/**
+* Returns the largest difference of a channel between a solid block and its decoded pixels
+*/
+static int GetSolidError(const unsigned char* color, const unsigned char* rgba, int channels) {
+	int largest = 0;
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		for (int c = 0; c < channels; c++) largest = std::max(largest, std::abs((int)rgba[i * 4 + c] - color[c]));
+	}
+	return largest;
+}
+
+int main() {
+	JobSystem::Initialize();
+
+	//Smooth color gradients with a little noise, and alpha as a hard edged checkerboard on the left and a gradient on the right
+	std::vector<unsigned char> image(TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * 4);
+	std::mt19937 random(1);
+	for (int y = 0; y < TEST_IMAGE_HEIGHT; y++) {
+		for (int x = 0; x < TEST_IMAGE_WIDTH; x++) {
+			unsigned char* pixel = &image[(y * TEST_IMAGE_WIDTH + x) * 4];
+			int color[3] = { (int)(128 + 100 * std::sin(x * 0.05)), x * 255 / TEST_IMAGE_WIDTH, y * 255 / TEST_IMAGE_HEIGHT };
+			for (int c = 0; c < 3; c++) pixel[c] = (unsigned char)std::min(255, std::max(0, color[c] + (int)(random() % 9) - 4));
+			pixel[3] = x < TEST_IMAGE_WIDTH / 2 ? (((x / 16 + y / 16) & 1) ? 255 : 0) : (unsigned char)(y * 255 / TEST_IMAGE_HEIGHT);
+		}
+	}
+
+	CHECK(BCEncoder::GetEncodedSize(BC1Format, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT) == 65 * 33 * 8);
+	CHECK(BCEncoder::GetEncodedSize(BC3Format, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT) == 65 * 33 * 16);
+	CHECK(BCEncoder::GetEncodedSize(BC7Format, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT) == 65 * 33 * 16);
+
+	//Bounds are a little below what the encoders reach, BC1 has no alpha and BC7 is the most precise
+	BCFormat formats[] = { BC1Format, BC3Format, BC7Format };
+	double minColorPSNR[] = { 37.0, 37.0, 40.0 };
+	double minAlphaPSNR[] = { 0.0, 40.0, 42.0 };
+	int maxHardEdgeError[] = { 0, 0, 1 }; // The BC7 p-bit is shared with the color channels
+	for (int f = 0; f < 3; f++) {
+		std::vector<unsigned char> blocks(BCEncoder::GetEncodedSize(formats[f], TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT));
+		std::vector<unsigned char> decoded(image.size());
+		BCEncoder::Encode(formats[f], image.data(), TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, 4, blocks.data());
+		CHECK(BCEncoder::Decode(formats[f], blocks.data(), TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, decoded.data()));
+
+		double colorPSNR = GetPSNR(image, decoded, 0, 2);
+		double alphaPSNR = GetPSNR(image, decoded, 3, 3);
+		std::cout << "Format " << f << ": color " << colorPSNR << " dB, alpha " << alphaPSNR << " dB" << std::endl;
+		CHECK(colorPSNR >= minColorPSNR[f]);
+		if (formats[f] != BC1Format) CHECK(alphaPSNR >= minAlphaPSNR[f]);
+
+		//Fully transparent and fully opaque pixels of the checkerboard stay exact up to the alpha precision
+		int hardEdgeError = 0;
+		for (int y = 0; y < TEST_IMAGE_HEIGHT && formats[f] != BC1Format; y++) {
+			for (int x = 0; x < TEST_IMAGE_WIDTH / 2 / 16 * 16; x++) {
+				size_t alpha = (y * TEST_IMAGE_WIDTH + x) * 4 + 3;
+				hardEdgeError = std::max(hardEdgeError, std::abs((int)decoded[alpha] - image[alpha]));
+			}
+		}
+		CHECK(hardEdgeError <= maxHardEdgeError[f]);
+	}
+
+	//A solid block is within the precision of the endpoints, 5:6:5 for BC1 and BC3 and 7 bits for BC7
+	unsigned char color[4] = { 10, 200, 77, 128 };
+	unsigned char solid[BC_BLOCK_PIXELS * 4];
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) std::copy(color, color + 4, solid + i * 4);
+
+	unsigned char block[16], decoded[BC_BLOCK_PIXELS * 4];
+	BCEncoder::EncodeBC1(solid, block);
+	BCEncoder::DecodeBC1(block, decoded);
+	CHECK(GetSolidError(color, decoded, 3) <= 4);
+
+	BCEncoder::EncodeBC3(solid, block);
+	BCEncoder::DecodeBC3(block, decoded);
+	CHECK(GetSolidError(color, decoded, 3) <= 4);
+	CHECK(GetSolidError(color, decoded, 4) <= 4);
+
+	BCEncoder::EncodeBC7(solid, block);
+	CHECK(BCEncoder::DecodeBC7(block, decoded));
+	CHECK(GetSolidError(color, decoded, 4) <= 1);
+
+	//Only mode 6 is written, a block in another mode is reported
+	unsigned char modeZero[16] = { 0x01 };
+	CHECK(!BCEncoder::DecodeBC7(modeZero, decoded));
+
+	JobSystem::Destroy();
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
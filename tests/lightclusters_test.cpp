@@ -0,0 +1,106 @@
+/**
+*	Filename: lightclusters_test.cpp
+*
+*	Description: Bins known lights with every supported kernel and checks the ranges and the light lists of the clusters
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../aquarite/graphics/lightclusters.h"
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { std::cout << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed" << std::endl; failures++; }
+
+/**
+* Returns true if the light touches the cluster according to the expected range
+*/
+static bool Touches(const ClusterRange& range, int x, int y, int z) {
+	return x >= range.minX && x <= range.maxX && y >= range.minY && y <= range.maxY && z >= range.minZ && z <= range.maxZ;
+}
+
+int main() {
+	//Camera at the origin looking down -z. With a 90 degree fov and 16:9 the x tiles are 2/9 apart in slope and the y tiles
+	//2/9 as well. With near 1 and far 1000 a depth d lies in slice floor(24 * ln(d) / ln(1000)), depth 20 is in slice 10
+	glm::mat4 view(1.0f);
+	glm::mat4 projection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 1.0f, 1000.0f);
+
+	//6 lights, so the vector kernel does 4 and the scalar remainder 2
+	std::vector<glm::vec4> lights;
+	lights.push_back(glm::vec4(-20.0f, 0.0f, -20.0f, 0.1f)); // Inside a single cluster
+	lights.push_back(glm::vec4(0.0f, 0.0f, -20.0f, 3.0f)); // On the center boundary, spans 2 x 3 x 2 clusters
+	lights.push_back(glm::vec4(0.0f, 0.0f, 5.0f, 1.0f)); // Behind the camera
+	lights.push_back(glm::vec4(0.0f, 0.0f, -20.0f, 0.0f)); // No radius
+	lights.push_back(glm::vec4(0.5f, 0.0f, -20.0f, 0.1f)); // Shares a cluster with light 1
+	lights.push_back(glm::vec4(0.0f, 0.0f, -2000.0f, 1.0f)); // Beyond the far plane
+
+	ClusterRange none = { 1, 0, 1, 0, 1, 0 };
+	ClusterRange expected[] = {
+		{ 3, 3, 4, 4, 10, 10 },
+		{ 7, 8, 3, 5, 9, 10 },
+		none,
+		none,
+		{ 8, 8, 4, 4, 10, 10 },
+		none
+	};
+
+	for (int k = 0; k < ClusterKernelCount; k++) {
+		ClusterKernel kernel = (ClusterKernel)k;
+		if (!LightClusters::SetKernel(kernel)) continue;
+		std::cout << "Kernel " << LightClusters::GetKernelName(kernel) << std::endl;
+
+		LightClusters clusters;
+		clusters.Build(view, projection, 1.0f, 1000.0f, lights.data(), lights.size());
+
+		for (size_t l = 0; l < lights.size(); l++) {
+			const ClusterRange& range = clusters.GetRange(l);
+			if (expected[l].minZ > expected[l].maxZ) {
+				CHECK(range.minZ > range.maxZ);
+				continue;
+			}
+
+			CHECK(range.minX == expected[l].minX && range.maxX == expected[l].maxX);
+			CHECK(range.minY == expected[l].minY && range.maxY == expected[l].maxY);
+			CHECK(range.minZ == expected[l].minZ && range.maxZ == expected[l].maxZ);
+		}
+
+		//Every cluster lists exactly the lights that touch it, in light order
+		const std::vector<glm::uvec2>& grid = clusters.GetGrid();
+		const std::vector<unsigned>& indices = clusters.GetIndices();
+		size_t total = 0;
+		for (int z = 0; z < CLUSTER_GRID_Z; z++) {
+			for (int y = 0; y < CLUSTER_GRID_Y; y++) {
+				for (int x = 0; x < CLUSTER_GRID_X; x++) {
+					std::vector<unsigned> list;
+					for (size_t l = 0; l < lights.size(); l++) {
+						if (Touches(expected[l], x, y, z)) list.push_back((unsigned)l);
+					}
+
+					glm::uvec2 cluster = grid[LightClusters::GetClusterIndex(x, y, z)];
+					CHECK(cluster.y == list.size());
+					for (size_t i = 0; i < list.size() && i < cluster.y; i++) {
+						CHECK(indices[cluster.x + i] == list[i]);
+					}
+					total += list.size();
+				}
+			}
+		}
+		CHECK(indices.size() == total);
+
+		//The cluster shared by light 1 and 4
+		glm::uvec2 shared = grid[LightClusters::GetClusterIndex(8, 4, 10)];
+		CHECK(shared.y == 2 && indices[shared.x] == 1 && indices[shared.x + 1] == 4);
+	}
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,97 @@
+/**
+*	Filename: lz4block_test.cpp
+*
+*	Description: Round trips buffers through LZ4 blocks and checks that corrupt blocks are rejected without overrunning
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cstring>
+#include "../aquarite/lz4block.h"
+
+#define CORRUPTION_ROUNDS 200 // Random bit flips tried on every compressed block
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { std::cout << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed" << std::endl; failures++; }
+
+/**
+* Decompresses a hand made block, returns true if it is accepted and decompresses to expected
+*/
+static bool DecompressBlock(const std::vector<unsigned char>& block, const char* expected, size_t size) {
+	std::vector<unsigned char> output(size + 1, 0);
+	if (!LZ4Block::Decompress(block.data(), block.size(), output.data(), size)) return false;
+	return memcmp(output.data(), expected, size) == 0 && output[size] == 0;
+}
+
+int main() {
+	std::mt19937 random(1);
+
+	//Sizes around the literal and match limits of the format, and past the 64K match window
+	std::vector<std::vector<unsigned char>> inputs;
+	size_t sizes[] = { 0, 1, 5, 12, 13, 20, 100, 1000, 70000, 300000 };
+	for (size_t size : sizes) {
+		std::vector<unsigned char> text(size);
+		for (size_t i = 0; i < size; i++) text[i] = random() % 4 == 0 ? (unsigned char)random() : 'a' + random() % 3;
+		inputs.push_back(text);
+		inputs.push_back(std::vector<unsigned char>(size, 0));
+
+		std::vector<unsigned char> noise(size);
+		for (size_t i = 0; i < size; i++) noise[i] = (unsigned char)random();
+		inputs.push_back(noise);
+	}
+
+	for (size_t n = 0; n < inputs.size(); n++) {
+		const std::vector<unsigned char>& input = inputs[n];
+		std::vector<unsigned char> compressed(LZ4Block::GetMaxCompressedSize(input.size()));
+		size_t compressedSize = LZ4Block::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+		CHECK(compressedSize > 0);
+		CHECK(compressedSize <= LZ4Block::GetMaxCompressedSize(input.size()));
+		compressed.resize(compressedSize);
+
+		//Round trip, and the exact size is required
+		std::vector<unsigned char> output(input.size() + 1);
+		CHECK(LZ4Block::Decompress(compressed.data(), compressed.size(), output.data(), input.size()));
+		CHECK(input.empty() || memcmp(output.data(), input.data(), input.size()) == 0);
+		CHECK(!LZ4Block::Decompress(compressed.data(), compressed.size(), output.data(), input.size() + 1));
+		if (input.size() > 0) {
+			CHECK(!LZ4Block::Decompress(compressed.data(), compressed.size(), output.data(), input.size() - 1));
+			CHECK(!LZ4Block::Decompress(compressed.data(), compressed.size() - 1, output.data(), input.size()));
+		}
+
+		//Flipped bits may decompress to wrong data, but never write outside the output. The sanitizers catch overruns
+		for (int round = 0; round < CORRUPTION_ROUNDS && compressedSize > 0; round++) {
+			std::vector<unsigned char> corrupt = compressed;
+			corrupt[random() % corrupt.size()] ^= 1 << (random() % 8);
+			std::vector<unsigned char> exact(input.size());
+			LZ4Block::Decompress(corrupt.data(), corrupt.size(), exact.data(), exact.size());
+		}
+	}
+
+	//Capacity below the worst case is refused instead of overrunning
+	std::vector<unsigned char> noise(1000);
+	for (size_t i = 0; i < noise.size(); i++) noise[i] = (unsigned char)random();
+	std::vector<unsigned char> small(noise.size() / 2);
+	CHECK(LZ4Block::Compress(noise.data(), noise.size(), small.data(), small.size()) == 0);
+
+	//Hand made blocks: 3 literals "abc", a match of offset 3 and length 6, then the literals "xxxxx"
+	CHECK(DecompressBlock({ 0x32, 'a', 'b', 'c', 3, 0, 0x50, 'x', 'x', 'x', 'x', 'x' }, "abcabcabcxxxxx", 14));
+	CHECK(!DecompressBlock({ 0x32, 'a', 'b', 'c', 0, 0, 0x50, 'x', 'x', 'x', 'x', 'x' }, "abcabcabcxxxxx", 14)); // Offset 0
+	CHECK(!DecompressBlock({ 0x32, 'a', 'b', 'c', 4, 0, 0x50, 'x', 'x', 'x', 'x', 'x' }, "abcabcabcxxxxx", 14)); // Offset before the output
+	CHECK(!DecompressBlock({ 0x3F, 'a', 'b', 'c', 3, 0, 200, 0x50, 'x', 'x', 'x', 'x', 'x' }, "abcabcabcxxxxx", 14)); // Match past the output
+	CHECK(!DecompressBlock({ 0x92, 'a', 'b', 'c' }, "abc", 3)); // Literals past the input
+	CHECK(!DecompressBlock({ 0xF0, 255 }, "", 0)); // Literal length past the input
+	CHECK(!DecompressBlock({ 0x32, 'a', 'b', 'c', 3 }, "abc", 3)); // Truncated offset
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,110 @@
+/**
+*	Filename: meshoptimizer_test.cpp
+*
+*	Description: Indexes a triangle soup grid and checks the deduplication and the vertex cache optimisation
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <random>
+#include "../aquarite/graphics/meshoptimizer.h"
+
+#define GRID_SIZE 32 // Quads along each side of the test grid
+#define GRID_STRIDE 8 // Floats per vertex, position normal and uv like a mesh
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { std::cout << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed" << std::endl; failures++; }
+
+/**
+* Pushes the vertex of the grid at x, y to the soup
+*/
+static void PushVertex(std::vector<float>& soup, int x, int y) {
+	float vertex[GRID_STRIDE] = { (float)x, 0.0f, (float)y, 0.0f, 1.0f, 0.0f, (float)x / GRID_SIZE, (float)y / GRID_SIZE };
+	soup.insert(soup.end(), vertex, vertex + GRID_STRIDE);
+}
+
+/**
+* Returns the triangles as sorted position triples, so two index buffers can be compared independent of their order and vertex layout
+*/
+static std::vector<std::array<float, 9>> GetTriangles(const std::vector<float>& vertices, const std::vector<unsigned>& indices) {
+	std::vector<std::array<float, 9>> triangles;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		std::array<float, 9> triangle;
+		for (int corner = 0; corner < 3; corner++) {
+			for (int component = 0; component < 3; component++) {
+				triangle[corner * 3 + component] = vertices[indices[i + corner] * GRID_STRIDE + component];
+			}
+		}
+		triangles.push_back(triangle);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+int main() {
+	//A flat grid as a triangle soup, every inner vertex is repeated by the 6 triangles that share it
+	std::vector<float> soup;
+	for (int y = 0; y < GRID_SIZE; y++) {
+		for (int x = 0; x < GRID_SIZE; x++) {
+			PushVertex(soup, x, y); PushVertex(soup, x, y + 1); PushVertex(soup, x + 1, y);
+			PushVertex(soup, x + 1, y); PushVertex(soup, x, y + 1); PushVertex(soup, x + 1, y + 1);
+		}
+	}
+
+	std::vector<float> vertices;
+	std::vector<unsigned> indices;
+	MeshOptimizer::GenerateIndexBuffer(soup, GRID_STRIDE, vertices, indices);
+	size_t vertexCount = vertices.size() / GRID_STRIDE;
+
+	//Deduplication keeps every triangle and leaves one vertex per grid point
+	CHECK(vertexCount == (GRID_SIZE + 1) * (GRID_SIZE + 1));
+	CHECK(indices.size() == GRID_SIZE * GRID_SIZE * 6);
+	std::vector<unsigned> soupIndices(soup.size() / GRID_STRIDE);
+	for (size_t i = 0; i < soupIndices.size(); i++) soupIndices[i] = (unsigned)i;
+	std::vector<std::array<float, 9>> expected = GetTriangles(soup, soupIndices);
+	CHECK(GetTriangles(vertices, indices) == expected);
+
+	//Shuffled triangles miss the cache on nearly every vertex, the optimised order has to do much better
+	std::vector<std::array<unsigned, 3>> shuffled(indices.size() / 3);
+	for (size_t i = 0; i < shuffled.size(); i++) shuffled[i] = { indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2] };
+	std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+	for (size_t i = 0; i < shuffled.size(); i++) std::copy(shuffled[i].begin(), shuffled[i].end(), indices.begin() + i * 3);
+
+	float shuffledACMR = MeshOptimizer::CalculateACMR(indices, vertexCount);
+	MeshOptimizer::OptimizeVertexCache(indices, vertexCount);
+	float optimizedACMR = MeshOptimizer::CalculateACMR(indices, vertexCount);
+	std::cout << "ACMR shuffled " << shuffledACMR << ", optimized " << optimizedACMR << std::endl;
+	CHECK(shuffledACMR > 2.0f);
+	CHECK(optimizedACMR < 0.8f);
+	CHECK(GetTriangles(vertices, indices) == expected);
+
+	//The overdraw and fetch passes reorder, but keep the triangles and the cache efficiency
+	MeshOptimizer::OptimizeOverdraw(indices, vertices, GRID_STRIDE);
+	MeshOptimizer::OptimizeVertexFetch(vertices, GRID_STRIDE, indices);
+	CHECK(vertices.size() == vertexCount * GRID_STRIDE);
+	CHECK(GetTriangles(vertices, indices) == expected);
+	CHECK(MeshOptimizer::CalculateACMR(indices, vertexCount) < 0.8f);
+
+	//Fetch order means every vertex is first used after all vertices before it
+	unsigned next = 0;
+	bool ordered = true;
+	for (size_t i = 0; i < indices.size(); i++) {
+		if (indices[i] > next) ordered = false;
+		if (indices[i] == next) next++;
+	}
+	CHECK(ordered);
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
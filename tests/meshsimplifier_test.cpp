@@ -0,0 +1,138 @@
+/**
+*	Filename: meshsimplifier_test.cpp
+*
+*	Description: Simplifies grids to lod targets and checks the triangle counts, the error bound and that borders stay in place
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include "../aquarite/graphics/meshsimplifier.h"
+
+#define GRID_SIZE 32 // Quads along each side of the test grids
+#define GRID_STRIDE 8 // Floats per vertex, position normal and uv like a mesh
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { std::cout << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed" << std::endl; failures++; }
+
+/**
+* Builds a indexed grid in the xz plane, bump scales a height field that is flat at the border
+*/
+static void BuildGrid(float bump, std::vector<float>& vertices, std::vector<unsigned>& indices) {
+	for (int y = 0; y <= GRID_SIZE; y++) {
+		for (int x = 0; x <= GRID_SIZE; x++) {
+			float height = bump * std::sin(glm::pi<float>() * x / GRID_SIZE) * std::sin(glm::pi<float>() * y / GRID_SIZE);
+			float vertex[GRID_STRIDE] = { (float)x, height, (float)y, 0.0f, 1.0f, 0.0f, (float)x / GRID_SIZE, (float)y / GRID_SIZE };
+			vertices.insert(vertices.end(), vertex, vertex + GRID_STRIDE);
+		}
+	}
+
+	for (unsigned y = 0; y < GRID_SIZE; y++) {
+		for (unsigned x = 0; x < GRID_SIZE; x++) {
+			unsigned corner = y * (GRID_SIZE + 1) + x;
+			unsigned quad[6] = { corner, corner + GRID_SIZE + 1, corner + 1, corner + 1, corner + GRID_SIZE + 1, corner + GRID_SIZE + 2 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+/**
+* Returns the position of a vertex
+*/
+static glm::vec3 GetPosition(const std::vector<float>& vertices, unsigned index) {
+	return glm::vec3(vertices[index * GRID_STRIDE], vertices[index * GRID_STRIDE + 1], vertices[index * GRID_STRIDE + 2]);
+}
+
+/**
+* Returns true if every vertex on the border of the grid is still used by the simplified indices
+*/
+static bool KeepsBorder(const std::vector<unsigned>& indices) {
+	std::vector<bool> used((GRID_SIZE + 1) * (GRID_SIZE + 1), false);
+	for (size_t i = 0; i < indices.size(); i++) used[indices[i]] = true;
+
+	for (int i = 0; i <= GRID_SIZE; i++) {
+		if (!used[i] || !used[GRID_SIZE * (GRID_SIZE + 1) + i]) return false; // Bottom and top row
+		if (!used[i * (GRID_SIZE + 1)] || !used[i * (GRID_SIZE + 1) + GRID_SIZE]) return false; // Left and right column
+	}
+	return true;
+}
+
+/**
+* Returns the area of the triangles projected on the xz plane, and counts the triangles facing down
+*/
+static float GetProjectedArea(const std::vector<float>& vertices, const std::vector<unsigned>& indices, int& flipped) {
+	float area = 0.0f;
+	flipped = 0;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		glm::vec3 normal = glm::cross(GetPosition(vertices, indices[i + 1]) - GetPosition(vertices, indices[i]), GetPosition(vertices, indices[i + 2]) - GetPosition(vertices, indices[i]));
+		if (normal.y <= 0.0f) flipped++;
+		area += std::abs(normal.y) * 0.5f;
+	}
+	return area;
+}
+
+int main() {
+	int flipped;
+
+	//A flat grid collapses without error, down to the target, and its outline and area stay the same
+	std::vector<float> flatVertices;
+	std::vector<unsigned> flatIndices;
+	BuildGrid(0.0f, flatVertices, flatIndices);
+
+	std::vector<unsigned> simplified;
+	size_t target = flatIndices.size() / 4 / 3 * 3;
+	float error = MeshSimplifier::Simplify(flatVertices, GRID_STRIDE, flatIndices, target, 0.001f, simplified);
+	CHECK(!simplified.empty());
+	CHECK(simplified.size() <= target);
+	CHECK(simplified.size() % 3 == 0);
+	CHECK(error <= 0.001f);
+	CHECK(KeepsBorder(simplified));
+	CHECK(std::abs(GetProjectedArea(flatVertices, simplified, flipped) - GRID_SIZE * GRID_SIZE) < 0.01f);
+	CHECK(flipped == 0);
+
+	//A curved grid is only simplified as far as the error bound allows
+	std::vector<float> vertices;
+	std::vector<unsigned> indices;
+	BuildGrid(4.0f, vertices, indices);
+
+	float tightError = MeshSimplifier::Simplify(vertices, GRID_STRIDE, indices, 0, 0.01f, simplified);
+	CHECK(tightError <= 0.01f);
+	CHECK(simplified.size() > 0 && simplified.size() < indices.size());
+	CHECK(KeepsBorder(simplified));
+	size_t tightCount = simplified.size();
+
+	float looseError = MeshSimplifier::Simplify(vertices, GRID_STRIDE, indices, 0, 1.0f, simplified);
+	CHECK(looseError <= 1.0f);
+	CHECK(simplified.size() < tightCount);
+	CHECK(KeepsBorder(simplified));
+
+	//Every level of a lod chain halves the triangles of the previous level, keeps the border and flips nothing
+	std::vector<std::vector<unsigned>> lods;
+	size_t levels = MeshSimplifier::GenerateLodChain(vertices, GRID_STRIDE, indices, 4, lods);
+	std::cout << "Lod chain of " << levels << " levels:";
+	for (size_t level = 0; level < levels; level++) std::cout << " " << lods[level].size() / 3;
+	std::cout << " triangles" << std::endl;
+	CHECK(levels >= 2);
+	CHECK(lods.size() == levels);
+	for (size_t level = 0; level < levels; level++) {
+		const std::vector<unsigned>& previous = level == 0 ? indices : lods[level - 1];
+		CHECK(lods[level].size() <= (size_t)(previous.size() / 3 * LOD_REDUCTION) * 3);
+		CHECK(KeepsBorder(lods[level]));
+		GetProjectedArea(vertices, lods[level], flipped);
+		CHECK(flipped == 0);
+	}
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,51 @@
+/**
+*	Filename: occlusionbuffer_test.cpp
+*
+*	Description: Rasterizes a occluder quad without a OpenGL context and checks which boxes it hides
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../aquarite/graphics/occlusionbuffer.h"
+#include "../aquarite/jobsystem.h"
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { std::cout << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed" << std::endl; failures++; }
+
+int main() {
+	JobSystem::Initialize();
+
+	//Camera at the origin looking down -z, a 10 by 10 quad 10 units in front of it
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	std::vector<glm::vec3> positions = { glm::vec3(-5, -5, 0), glm::vec3(5, -5, 0), glm::vec3(5, 5, 0), glm::vec3(-5, 5, 0) };
+	std::vector<unsigned> indices = { 0, 1, 2, 0, 2, 3 };
+
+	OcclusionBuffer buffer;
+	buffer.Begin(projection * view);
+	buffer.AddOccluder(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -10.0f)), positions, indices);
+	buffer.Rasterize();
+
+	CHECK(buffer.GetTriangleCount() == 2);
+	CHECK(buffer.GetDepth(buffer.GetWidth() / 2, buffer.GetHeight() / 2) < 1.0f); // The quad covers the centre
+	CHECK(buffer.GetDepth(0, 0) == 1.0f); // But not the corner
+
+	CHECK(!buffer.IsVisible(glm::vec3(-1, -1, -20), glm::vec3(1, 1, -19))); // Behind the quad
+	CHECK(buffer.IsVisible(glm::vec3(20, -1, -20), glm::vec3(22, 1, -19))); // Beside it
+	CHECK(buffer.IsVisible(glm::vec3(-1, -1, -8), glm::vec3(1, 1, -7))); // In front of it
+
+	JobSystem::Destroy();
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
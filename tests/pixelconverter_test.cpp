@@ -0,0 +1,100 @@
+/**
+*	Filename: pixelconverter_test.cpp
+*
+*	Description: Converts pixels with every supported kernel and checks the vector kernels match the scalar kernel
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <vector>
+#include <random>
+#include "../aquarite/graphics/pixelconverter.h"
+
+#define TEST_MAX_PIXELS 200 // Pixel counts up to this are tested, covering several registers and every remainder
+#define TEST_GUARD_BYTES 16 // Bytes after the pixels that no kernel may touch
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { std::cout << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed" << std::endl; failures++; }
+
+/**
+* The conversions under test
+*/
+enum PixelOperation {
+	SwapOperation,
+	FillOperation,
+	TintOperation,
+	OperationCount
+};
+
+/**
+* Runs a conversion with a kernel
+*/
+static void Convert(PixelOperation operation, PixelKernel kernel, unsigned char* pixels, size_t count, unsigned bytesPerPixel, const unsigned char* color) {
+	if (operation == SwapOperation) PixelConverter::SwapRedBlue(kernel, pixels, count, bytesPerPixel);
+	if (operation == FillOperation) PixelConverter::Fill(kernel, pixels, count, bytesPerPixel, color);
+	if (operation == TintOperation) PixelConverter::Tint(kernel, pixels, count, bytesPerPixel, color);
+}
+
+int main() {
+	std::mt19937 random(3);
+	const unsigned char color[4] = { 1, 2, 3, 4 };
+	CHECK(PixelConverter::IsSupported(ScalarPixelKernel));
+
+	//The scalar results are checked by hand on a single pixel first
+	unsigned char pixel[4] = { 10, 20, 30, 40 };
+	PixelConverter::SwapRedBlue(ScalarPixelKernel, pixel, 1, 4);
+	CHECK(pixel[0] == 30 && pixel[1] == 20 && pixel[2] == 10 && pixel[3] == 40);
+	unsigned char black[4] = { 0, 0, 0, 40 };
+	PixelConverter::Tint(ScalarPixelKernel, black, 1, 4, color);
+	CHECK(black[0] == 0 && black[1] == 0 && black[2] == 0 && black[3] == 40);
+	PixelConverter::Tint(ScalarPixelKernel, pixel, 1, 3, color);
+	CHECK(pixel[0] == 1 && pixel[1] == 2 && pixel[2] == 3 && pixel[3] == 40);
+
+	int tested = 0;
+	for (int k = ScalarPixelKernel + 1; k < PixelKernelCount; k++) {
+		PixelKernel kernel = (PixelKernel)k;
+		if (!PixelConverter::IsSupported(kernel)) {
+			std::cout << PixelConverter::GetKernelName(kernel) << " is not supported, skipped" << std::endl;
+			continue;
+		}
+		tested++;
+
+		for (unsigned bytesPerPixel = 3; bytesPerPixel <= 4; bytesPerPixel++) {
+			for (size_t count = 0; count <= TEST_MAX_PIXELS; count++) {
+				//Random pixels, with every third pixel black so tinting has something to skip. Shifted by one byte so the
+				//pixels do not start on a register boundary
+				std::vector<unsigned char> source(1 + count * bytesPerPixel + TEST_GUARD_BYTES);
+				for (size_t i = 0; i < source.size(); i++) source[i] = random() % 3 == 0 ? 0 : (unsigned char)random();
+				for (size_t i = 0; i < count; i += 3) std::fill(source.begin() + 1 + i * bytesPerPixel, source.begin() + 1 + i * bytesPerPixel + 3, 0);
+
+				for (int operation = 0; operation < OperationCount; operation++) {
+					std::vector<unsigned char> expected = source, result = source;
+					Convert((PixelOperation)operation, ScalarPixelKernel, expected.data() + 1, count, bytesPerPixel, color);
+					Convert((PixelOperation)operation, kernel, result.data() + 1, count, bytesPerPixel, color);
+					if (result != expected) {
+						std::cout << PixelConverter::GetKernelName(kernel) << " differs from the scalar kernel for operation " << operation << ", " << count << " pixels of " << bytesPerPixel << " bytes" << std::endl;
+						failures++;
+					}
+				}
+			}
+		}
+	}
+
+	//The kernel chosen at startup is supported, and only supported kernels can be chosen
+	CHECK(PixelConverter::IsSupported(PixelConverter::GetKernel()));
+	for (int k = 0; k < PixelKernelCount; k++) {
+		CHECK(PixelConverter::SetKernel((PixelKernel)k) == PixelConverter::IsSupported((PixelKernel)k));
+	}
+	std::cout << tested << " vector kernels compared with the scalar kernel" << std::endl;
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
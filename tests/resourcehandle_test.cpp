@@ -0,0 +1,103 @@
+/**
+*	Filename: resourcehandle_test.cpp
+*
+*	Description: Adds, replaces and removes resources in a ResourceTable and checks that stale handles no longer resolve
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../aquarite/resourcehandle.h"
+
+#define TEST_RESOURCE_COUNT 1000 // Enough resources to grow the table several times
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { std::cout << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed" << std::endl; failures++; }
+
+/**
+* A resource, the table only stores pointers
+*/
+struct TestResource {
+	int value;
+};
+
+int main() {
+	//The compile time hash matches the runtime hash and the FNV-1a reference values
+	static_assert(RESOURCE_ID("") == 2166136261u, "Hash of the empty name is the offset basis");
+	static_assert(RESOURCE_ID("a") == 0xE40C292Cu, "FNV-1a reference value");
+	CHECK(HashResourceName(std::string("_aquariteDefaultShader")) == RESOURCE_ID("_aquariteDefaultShader"));
+
+	ResourceTable<TestResource> table;
+	TestResource first = { 1 }, second = { 2 }, replacement = { 3 };
+	CHECK(!table.Find("first").IsValid());
+	CHECK(table.Get(ResourceHandle<TestResource>()) == nullptr);
+
+	//Add, and keep resolving while the table grows
+	ResourceHandle<TestResource> firstHandle = table.Add("first", &first);
+	ResourceHandle<TestResource> secondHandle = table.Add("second", &second);
+	CHECK(firstHandle.IsValid() && secondHandle.IsValid());
+	CHECK(firstHandle.index != secondHandle.index);
+
+	std::vector<TestResource> resources(TEST_RESOURCE_COUNT);
+	for (int i = 0; i < TEST_RESOURCE_COUNT; i++) {
+		resources[i].value = i;
+		table.Add("resource" + std::to_string(i), &resources[i]);
+	}
+	CHECK(table.GetSlotCount() == TEST_RESOURCE_COUNT + 2);
+	CHECK(table.Get(firstHandle) == &first);
+	CHECK(table.Get(secondHandle) == &second);
+	CHECK(table.Get(RESOURCE_ID("second")) == &second);
+
+	bool allFound = true;
+	for (int i = 0; i < TEST_RESOURCE_COUNT; i++) {
+		if (table.Get(table.Find("resource" + std::to_string(i))) != &resources[i]) allFound = false;
+	}
+	CHECK(allFound);
+	CHECK(table.GetName(&resources[500]) == "resource500");
+
+	//Replacing under the same name keeps the handle valid, and the old resource loses its name
+	ResourceHandle<TestResource> replacedHandle = table.Add("first", &replacement);
+	CHECK(replacedHandle.index == firstHandle.index && replacedHandle.generation == firstHandle.generation);
+	CHECK(table.Get(firstHandle) == &replacement);
+	CHECK(table.GetName(&replacement) == "first");
+	CHECK(table.GetName(&first) == "");
+
+	//Removing makes every handle to the slot stale, also after a new resource is added under the name
+	CHECK(table.Remove(firstHandle) == &replacement);
+	CHECK(table.Get(firstHandle) == nullptr);
+	CHECK(table.Remove(firstHandle) == nullptr);
+	CHECK(!table.Find("first").IsValid());
+	CHECK(table.GetName(&replacement) == "");
+
+	ResourceHandle<TestResource> readdedHandle = table.Add("first", &first);
+	CHECK(readdedHandle.index == firstHandle.index);
+	CHECK(readdedHandle.generation != firstHandle.generation);
+	CHECK(table.Get(firstHandle) == nullptr);
+	CHECK(table.Get(readdedHandle) == &first);
+	CHECK(table.GetSlotCount() == TEST_RESOURCE_COUNT + 2);
+
+	//A handle from a integer is as stale as the handle it was packed from, and out of range slots do not resolve
+	CHECK(table.Get(ResourceHandle<TestResource>::FromInteger(readdedHandle.ToInteger())) == &first);
+	CHECK(table.Get(ResourceHandle<TestResource>::FromInteger(firstHandle.ToInteger())) == nullptr);
+	CHECK(table.Get(ResourceHandle<TestResource>(TEST_RESOURCE_COUNT + 2, 1)) == nullptr);
+
+	//Two names with the same hash can not share a slot, the second one is refused instead of replacing the first
+	CHECK(HashResourceName(std::string("costarring")) == HashResourceName(std::string("liquid")));
+	ResourceHandle<TestResource> collidingHandle = table.Add("costarring", &second);
+	CHECK(collidingHandle.IsValid());
+	CHECK(!table.Add("liquid", &first).IsValid());
+	CHECK(!table.Find("liquid").IsValid());
+	CHECK(table.Get(collidingHandle) == &second);
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,115 @@
+/**
+*	Filename: tgadecoder_test.cpp
+*
+*	Description: Decodes raw and run length encoded Targa pixels in every row order and checks corrupt data is rejected
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "../aquarite/graphics/tgadecoder.h"
+
+#define TEST_IMAGE_WIDTH 7 // Odd, so mirroring has a middle pixel
+#define TEST_IMAGE_HEIGHT 5
+
+static int failures = 0;
+
+#define CHECK(condition) if (!(condition)) { std::cout << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed" << std::endl; failures++; }
+
+/**
+* Returns the pixel of the image at x, y, counted from the bottom left as OpenGL expects. Rows repeat in runs so they compress
+*/
+static std::vector<unsigned char> GetPixel(uint32_t x, uint32_t y, unsigned bytesPerPixel) {
+	std::vector<unsigned char> pixel = { (unsigned char)(x < 3 ? 0 : x), (unsigned char)(y * 10), 200, 255 };
+	pixel.resize(bytesPerPixel);
+	return pixel;
+}
+
+/**
+* Returns the pixels in the order the descriptor stores them
+*/
+static std::vector<unsigned char> StorePixels(unsigned bytesPerPixel, unsigned char descriptor) {
+	std::vector<unsigned char> pixels;
+	for (uint32_t row = 0; row < TEST_IMAGE_HEIGHT; row++) {
+		uint32_t y = (descriptor & TGA_TOP_TO_BOTTOM) ? TEST_IMAGE_HEIGHT - 1 - row : row;
+		for (uint32_t column = 0; column < TEST_IMAGE_WIDTH; column++) {
+			uint32_t x = (descriptor & TGA_RIGHT_TO_LEFT) ? TEST_IMAGE_WIDTH - 1 - column : column;
+			std::vector<unsigned char> pixel = GetPixel(x, y, bytesPerPixel);
+			pixels.insert(pixels.end(), pixel.begin(), pixel.end());
+		}
+	}
+	return pixels;
+}
+
+/**
+* Run length encodes pixels, runs of equal pixels become repeat packets and the rest raw packets. Packets cross rows like most writers do
+*/
+static std::vector<unsigned char> EncodeRLE(const std::vector<unsigned char>& pixels, unsigned bytesPerPixel) {
+	std::vector<unsigned char> encoded;
+	size_t count = pixels.size() / bytesPerPixel;
+	size_t i = 0;
+	while (i < count) {
+		size_t run = 1;
+		while (i + run < count && run < 128 && std::equal(&pixels[i * bytesPerPixel], &pixels[(i + 1) * bytesPerPixel], &pixels[(i + run) * bytesPerPixel])) run++;
+
+		if (run > 1) {
+			encoded.push_back((unsigned char)(0x80 | (run - 1)));
+			encoded.insert(encoded.end(), &pixels[i * bytesPerPixel], &pixels[(i + 1) * bytesPerPixel]);
+		}
+		else {
+			encoded.push_back(0);
+			encoded.insert(encoded.end(), &pixels[i * bytesPerPixel], &pixels[(i + 1) * bytesPerPixel]);
+		}
+		i += run;
+	}
+	return encoded;
+}
+
+int main() {
+	unsigned char descriptors[] = { 0, TGA_TOP_TO_BOTTOM, TGA_RIGHT_TO_LEFT, TGA_TOP_TO_BOTTOM | TGA_RIGHT_TO_LEFT };
+	for (unsigned bytesPerPixel = 3; bytesPerPixel <= 4; bytesPerPixel++) {
+		std::vector<unsigned char> expected = StorePixels(bytesPerPixel, 0);
+		for (unsigned char descriptor : descriptors) {
+			std::vector<unsigned char> stored = StorePixels(bytesPerPixel, descriptor);
+			std::vector<unsigned char> encoded = EncodeRLE(stored, bytesPerPixel);
+			CHECK(encoded.size() < stored.size());
+
+			//Raw and run length encoded pixels in every row order end up bottom to top, left to right
+			std::vector<unsigned char> raw(expected.size()), rle(expected.size());
+			CHECK(TGADecoder::DecodePixels(stored.data(), stored.size(), TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, bytesPerPixel, TGA_TYPE_RGB, descriptor, raw.data()));
+			CHECK(raw == expected);
+			CHECK(TGADecoder::DecodePixels(encoded.data(), encoded.size(), TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, bytesPerPixel, TGA_TYPE_RLE_RGB, descriptor, rle.data()));
+			CHECK(rle == expected);
+
+			//Data that ends early is rejected, the pixels are never read or written out of bounds
+			CHECK(!TGADecoder::DecodePixels(stored.data(), stored.size() - 1, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, bytesPerPixel, TGA_TYPE_RGB, descriptor, raw.data()));
+			for (size_t size = 0; size < encoded.size(); size++) {
+				CHECK(!TGADecoder::DecodePixels(encoded.data(), size, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, bytesPerPixel, TGA_TYPE_RLE_RGB, descriptor, rle.data()));
+			}
+		}
+	}
+
+	//A run past the last pixel is cut off instead of overrunning the image
+	std::vector<unsigned char> run = { 0xFF, 1, 2, 3 };
+	std::vector<unsigned char> pixels(TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * 3 + 3, 9);
+	CHECK(TGADecoder::DecodePixels(run.data(), run.size(), TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, 3, TGA_TYPE_RLE_RGB, 0, pixels.data()));
+	CHECK(pixels[0] == 1 && pixels[1] == 2 && pixels[2] == 3);
+	CHECK(pixels[pixels.size() - 6] == 1 && pixels[pixels.size() - 4] == 3);
+	CHECK(pixels[pixels.size() - 3] == 9 && pixels[pixels.size() - 1] == 9);
+
+	//Color mapped and grayscale images are not supported
+	std::vector<unsigned char> stored = StorePixels(3, 0);
+	CHECK(!TGADecoder::DecodePixels(stored.data(), stored.size(), TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, 3, 1, 0, pixels.data()));
+	CHECK(!TGADecoder::DecodePixels(stored.data(), stored.size(), TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, 3, 3, 0, pixels.data()));
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,342 @@
+/**
+*	Filename: cooker.cpp
+*
+*	Description: Source file for Cooker class.
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include "cooker.h"
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <typeinfo>
+#include "../../aquarite/assetarchive.h"
+#include "../../aquarite/jobsystem.h"
+#include "../../aquarite/texture.h"
+#include "../../aquarite/mesh.h"
+#include "../../aquarite/debug.h"
+
+/**
+* Returns true if path ends with extension
+*/
+static bool HasExtension(const std::string& path, const std::string& extension) {
+	return path.size() > extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+/**
+* Returns path with its extension replaced
+*/
+static std::string ReplaceExtension(std::string path, const std::string& extension) {
+	size_t dot = path.find_last_of('.');
+	if (dot != std::string::npos) path.erase(dot);
+	return path + extension;
+}
+
+/**
+* Returns the cooked extension of a source file, and how it is cooked
+*/
+static std::string GetCookedPath(const std::string& path, CookType& type) {
+	if (HasExtension(path, ".meta")) { type = CookMeta; return path; }
+	if (HasExtension(path, ".obj")) { type = CookMesh; return ReplaceExtension(path, ".amesh"); }
+	if (HasExtension(path, ".tga")) { type = CookTexture; return ReplaceExtension(path, ".atex"); }
+	if (HasExtension(path, ".amat") || HasExtension(path, ".amod") || HasExtension(path, ".ascene")) { type = CookText; return path; }
+	type = CookCopy;
+	return path;
+}
+
+/**
+* Returns the lines of a text file without carriage returns, empty lines and // comments
+*/
+static std::vector<std::string> ReadLines(const std::string& path) {
+	std::vector<std::string> lines;
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty() || line.compare(0, 2, "//") == 0) continue;
+		lines.push_back(line);
+	}
+	return lines;
+}
+
+/**
+* Writes lines to a text file, returns false if the file can not be written
+*/
+static bool WriteLines(const std::string& path, const std::vector<std::string>& lines) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) return false;
+	for (size_t i = 0; i < lines.size(); i++) {
+		file << lines[i] << '\n';
+	}
+	return file.good();
+}
+
+Cooker::Cooker(std::string root, std::string cacheDirectory) {
+	if (!root.empty() && root.back() != '/' && root.back() != '\\') root.push_back('/');
+	if (!cacheDirectory.empty() && cacheDirectory.back() != '/' && cacheDirectory.back() != '\\') cacheDirectory.push_back('/');
+	this->root = AssetArchive::NormalizePath(root);
+	this->cacheDirectory = AssetArchive::NormalizePath(cacheDirectory);
+	this->archiveHash = 0;
+	this->textureCompression = AutoCompressTexture;
+	this->mipFilter = KaiserMipFilter;
+	this->textureOptionsChanged = true;
+}
+
+void Cooker::SetTextureOptions(TextureCompression compression, MipFilter filter) {
+	this->textureCompression = compression;
+	this->mipFilter = filter;
+}
+
+void Cooker::AddAsset(std::string input, std::string output, CookType type) {
+	for (size_t i = 0; i < assets.size(); i++) {
+		if (assets[i].input == input) return;
+	}
+
+	CookAsset asset = {};
+	asset.input = input;
+	asset.output = output;
+	asset.type = type;
+	assets.push_back(asset);
+}
+
+bool Cooker::Add(std::string path) {
+	path = AssetArchive::NormalizePath(path, root);
+
+	CookType type;
+	std::string output = GetCookedPath(path, type);
+	if (type != CookMeta) {
+		AddAsset(path, output, type);
+		return true;
+	}
+
+	//A meta file lists its files relative to its offset, with one section per resource type
+	std::ifstream file(root + path);
+	if (!file.is_open()) {
+		Debug::Log("Cannot open meta file " + root + path, typeid(Cooker).name());
+		return false;
+	}
+	file.close();
+	AddAsset(path, output, type);
+
+	std::vector<std::string> lines = ReadLines(root + path);
+	std::string offset;
+	std::string section;
+	for (size_t i = 0; i < lines.size(); i++) {
+		if (lines[i].at(0) == '#') {
+			section = lines[i];
+			continue;
+		}
+
+		size_t separator = lines[i].find('=');
+		if (separator == std::string::npos) continue;
+		std::string key = lines[i].substr(0, separator);
+		std::string value = lines[i].substr(separator + 1);
+
+		if (section == "#META") {
+			if (key == "offset") offset = value;
+		}
+		else if (section == "#TEXTURES" || section == "#MESHES" || section == "#MATERIALS" || section == "#MODELS") {
+			std::string asset = AssetArchive::NormalizePath(offset + value);
+			CookType assetType;
+			std::string assetOutput = GetCookedPath(asset, assetType);
+			AddAsset(asset, assetOutput, assetType);
+		}
+	}
+	return true;
+}
+
+void Cooker::CookFile(CookAsset& asset) {
+	std::string input = root + asset.input;
+	std::string output = cacheDirectory + asset.output;
+	std::error_code error;
+
+	CookState state;
+	state.size = (uint64_t)std::filesystem::file_size(input, error);
+	if (error) {
+		Debug::Log("Cannot open " + input, typeid(Cooker).name());
+		asset.failed = true;
+		return;
+	}
+	state.time = (int64_t)std::filesystem::last_write_time(input, error).time_since_epoch().count();
+
+	std::map<std::string, CookState>::const_iterator cached = cache.find(asset.input);
+	bool outputExists = std::filesystem::exists(output, error);
+
+	//Unchanged size and write time, the contents are not even read
+	bool optionsChanged = asset.type == CookTexture && textureOptionsChanged;
+	if (outputExists && !optionsChanged && cached != cache.end() && cached->second.size == state.size && cached->second.time == state.time) {
+		asset.state = cached->second;
+		return;
+	}
+
+	std::ifstream file(input, std::ios::binary);
+	std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+
+	//The cooker version and type are part of the hash, so a new cooker cooks everything again
+	bool texture = asset.type == CookTexture;
+	uint64_t header[4] = { COOKER_VERSION, (uint64_t)asset.type, texture ? (uint64_t)textureCompression : 0, texture ? (uint64_t)mipFilter : 0 };
+	state.hash = Hash((const unsigned char*)header, sizeof(header));
+	state.hash = Hash(data.data(), data.size(), state.hash);
+	asset.state = state;
+
+	//Touched but not changed
+	if (outputExists && cached != cache.end() && cached->second.hash == state.hash) return;
+
+	bool cooked = false;
+	switch (asset.type) {
+	case CookMesh:
+		cooked = Mesh::ConvertObj(input, output);
+		break;
+	case CookTexture:
+		cooked = Texture::ConvertTGA(input, output, textureCompression, mipFilter); // Encodes on the job system as well
+		break;
+	case CookText:
+		cooked = WriteLines(output, ReadLines(input));
+		break;
+	case CookMeta: {
+		//The cooked meta lists the cooked files
+		std::vector<std::string> lines = ReadLines(input);
+		bool resources = false;
+		for (size_t i = 0; i < lines.size(); i++) {
+			if (lines[i].at(0) == '#') {
+				resources = lines[i] != "#META";
+				continue;
+			}
+
+			size_t separator = lines[i].find('=');
+			if (!resources || separator == std::string::npos) continue;
+
+			CookType type;
+			lines[i] = lines[i].substr(0, separator + 1) + GetCookedPath(lines[i].substr(separator + 1), type);
+		}
+		cooked = WriteLines(output, lines);
+		break;
+	}
+	case CookCopy:
+		cooked = std::filesystem::copy_file(input, output, std::filesystem::copy_options::overwrite_existing, error);
+		break;
+	}
+
+	if (!cooked) {
+		Debug::Log("Failed to cook " + input, typeid(Cooker).name());
+		asset.failed = true;
+		return;
+	}
+	asset.rebuilt = true;
+}
+
+void Cooker::ReadCache() {
+	cache.clear();
+	archiveHash = 0;
+	textureOptionsChanged = true;
+
+	std::ifstream file(cacheDirectory + COOK_CACHE_FILE);
+	std::string line;
+	if (!std::getline(file, line) || line != "cook " + std::to_string(COOKER_VERSION)) return; // Missing or written by another version
+
+	if (std::getline(file, line)) {
+		std::istringstream textures(line);
+		std::string tag;
+		int compression = -1, filter = -1;
+		textures >> tag >> compression >> filter;
+		textureOptionsChanged = compression != (int)textureCompression || filter != (int)mipFilter;
+	}
+
+	if (std::getline(file, line)) {
+		std::istringstream archive(line);
+		std::string tag;
+		archive >> tag >> archiveHash;
+	}
+
+	//hash size time path, the path is last as it may contain spaces
+	while (std::getline(file, line)) {
+		std::istringstream entry(line);
+		CookState state;
+		std::string path;
+		if (!(entry >> state.hash >> state.size >> state.time)) continue;
+		entry.get();
+		std::getline(entry, path);
+		cache[path] = state;
+	}
+}
+
+void Cooker::WriteCache() {
+	std::ofstream file(cacheDirectory + COOK_CACHE_FILE, std::ios::binary);
+	file << "cook " << COOKER_VERSION << '\n';
+	file << "textures " << (int)textureCompression << ' ' << (int)mipFilter << '\n';
+	file << "archive " << archiveHash << '\n';
+	for (size_t i = 0; i < assets.size(); i++) {
+		if (assets[i].failed) continue;
+		const CookState& state = assets[i].state;
+		file << state.hash << ' ' << state.size << ' ' << state.time << ' ' << assets[i].input << '\n';
+	}
+}
+
+bool Cooker::Cook(std::string archivePath, bool compress) {
+	ReadCache();
+
+	//Directories are made up front, the jobs only write files
+	std::error_code error;
+	std::filesystem::create_directories(cacheDirectory, error);
+	for (size_t i = 0; i < assets.size(); i++) {
+		assets[i].rebuilt = false;
+		assets[i].failed = false;
+		std::filesystem::path directory = std::filesystem::path(cacheDirectory + assets[i].output).parent_path();
+		if (!directory.empty()) std::filesystem::create_directories(directory, error);
+	}
+
+	JobSystem::ParallelFor(assets.size(), 1, [this](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++) {
+			CookFile(assets[i]);
+		}
+	});
+
+	bool failed = false;
+	std::vector<std::string> outputs;
+	uint64_t hash = Hash(nullptr, 0);
+	for (size_t i = 0; i < assets.size(); i++) {
+		if (assets[i].failed) {
+			failed = true;
+			continue;
+		}
+		outputs.push_back(assets[i].output);
+		hash = Hash((const unsigned char*)&assets[i].state.hash, sizeof(uint64_t), hash);
+		hash = Hash((const unsigned char*)assets[i].output.data(), assets[i].output.size(), hash);
+	}
+	if (compress) hash = Hash((const unsigned char*)"lz4", 3, hash);
+
+	//The archive is only written again if any of its files or the compression changed
+	if (hash != archiveHash || !std::filesystem::exists(archivePath, error)) {
+		if (!AssetArchive::Write(archivePath, cacheDirectory, outputs, compress)) {
+			Debug::Log("Cannot write archive " + archivePath, typeid(Cooker).name());
+			failed = true;
+			hash = 0;
+		}
+		archiveHash = hash;
+	}
+
+	WriteCache();
+	return !failed;
+}
+
+size_t Cooker::GetAssetCount() {
+	return assets.size();
+}
+
+size_t Cooker::GetRebuiltCount() {
+	size_t count = 0;
+	for (size_t i = 0; i < assets.size(); i++) {
+		if (assets[i].rebuilt) count++;
+	}
+	return count;
+}
+
+uint64_t Cooker::Hash(const unsigned char* data, size_t size, uint64_t hash) {
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ data[i]) * 1099511628211ull;
+	}
+	return hash;
+}
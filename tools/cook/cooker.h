@@ -0,0 +1,127 @@
+/**
+*	Filename: cooker.h
+*
+*	Description: Header file for Cooker class, converts the assets of meta files to their cooked form and packs them into a archive
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#ifndef COOKER_H
+#define COOKER_H
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include "../../aquarite/texture.h"
+
+#define COOKER_VERSION 3 // Bump when a cooked format or the way assets are cooked changes, every asset is cooked again
+#define COOK_CACHE_FILE "cook.cache" // Name of the cache in the cache directory
+
+/**
+* How a asset is cooked
+*/
+enum CookType {
+	CookMeta, // Rewritten to list the cooked files
+	CookMesh, // .obj to .amesh
+	CookTexture, // .tga to .atex with mips, block compressed
+	CookText, // .amat, .amod and .ascene, stripped of comments and empty lines
+	CookCopy // Already cooked, copied as is
+};
+
+/**
+* The state of a source file when it was last cooked
+*/
+struct CookState {
+	uint64_t hash; /// @brief Hash of the contents, the cooker version, the cook type and for textures the texture options
+	uint64_t size; /// @brief Size in bytes
+	int64_t time; /// @brief Last write time
+};
+
+/**
+* A single source file and the cooked file made from it
+*/
+struct CookAsset {
+	std::string input; /// @brief Source path, relative to the root
+	std::string output; /// @brief Cooked path, relative to the cache directory and the archive root
+	CookType type; /// @brief How it is cooked
+	CookState state; /// @brief State of the source when cooked
+	bool rebuilt; /// @brief True if cooked in this run
+	bool failed; /// @brief True if cooking failed
+};
+
+/**
+* Source files are hashed and only cooked when their contents changed since the cached cook, or the cooked file is missing.
+* The size and write time are checked first, so a run without changes does not read the sources at all.
+* Cooking runs on the job system, one asset per job.
+*/
+class Cooker {
+private:
+	std::string root; /// @brief Directory the sources are relative to
+	std::string cacheDirectory; /// @brief Directory the cooked files are written to
+	std::vector<CookAsset> assets; /// @brief All assets to cook, without duplicates
+	std::map<std::string, CookState> cache; /// @brief State of every source at its last cook, by source path
+	uint64_t archiveHash; /// @brief Hash of the contents of the last written archive
+	TextureCompression textureCompression; /// @brief Block compression of the cooked textures
+	MipFilter mipFilter; /// @brief Filter of the mip chains of the cooked textures
+	bool textureOptionsChanged; /// @brief True if the cached textures were cooked with other texture options
+
+	/**
+	* Adds a asset unless it is already added
+	*/
+	void AddAsset(std::string input, std::string output, CookType type);
+
+	/**
+	* Brings the cooked file of a asset up to date
+	*/
+	void CookFile(CookAsset& asset);
+
+	/**
+	* Reads the cache, a missing cache means everything is cooked
+	*/
+	void ReadCache();
+
+	/**
+	* Writes the cache
+	*/
+	void WriteCache();
+public:
+	/**
+	* Constructor
+	*/
+	Cooker(std::string root, std::string cacheDirectory);
+
+	/**
+	* Adds a source file relative to the root, a .meta file adds itself and every file it lists.
+	* Returns false if a meta file can not be read
+	*/
+	bool Add(std::string path);
+
+	/**
+	* Sets how textures are cooked, textures cooked with other options are cooked again
+	*/
+	void SetTextureOptions(TextureCompression compression, MipFilter filter);
+
+	/**
+	* Cooks all added assets that changed and writes the archive if any of them did.
+	* Returns false if a asset failed to cook or the archive can not be written
+	*/
+	bool Cook(std::string archivePath, bool compress);
+
+	/**
+	* Returns the amount of assets
+	*/
+	size_t GetAssetCount();
+
+	/**
+	* Returns the amount of assets cooked in the last run
+	*/
+	size_t GetRebuiltCount();
+
+	/**
+	* Returns the 64 bit FNV-1a hash of data, continuing from hash
+	*/
+	static uint64_t Hash(const unsigned char* data, size_t size, uint64_t hash = 14695981039346656037ull);
+};
+
+#endif // !COOKER_H
@@ -0,0 +1,62 @@
+/**
+*	Filename: main.cpp
+*
+*	Description: Entry point of aquarite_cook, cooks the assets of meta files into a archive
+*
+*	Version: 17/10/2026
+*
+*	 2019, Jens Heukers
+*/
+#include <iostream>
+#include <string>
+#include <chrono>
+#include "cooker.h"
+#include "../../aquarite/jobsystem.h"
+
+int main(int argc, char* argv[]) {
+	std::string root;
+	std::string archive;
+	std::string cacheDirectory;
+	bool compress = false;
+	TextureCompression compression = AutoCompressTexture;
+	MipFilter filter = KaiserMipFilter;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		if (argument == "-lz4") compress = true;
+		else if (argument == "-cache" && i + 1 < argc) cacheDirectory = argv[++i];
+		else if (argument == "-tex" && i + 1 < argc) {
+			std::string value = argv[++i];
+			if (value == "none") compression = UncompressedTexture;
+			else if (value == "bc7") compression = BC7Texture;
+			else compression = AutoCompressTexture;
+		}
+		else if (argument == "-mip" && i + 1 < argc) filter = std::string(argv[++i]) == "box" ? BoxMipFilter : KaiserMipFilter;
+		else if (root.empty()) root = argument;
+		else if (archive.empty()) archive = argument;
+		else files.push_back(argument);
+	}
+
+	if (root.empty() || archive.empty() || files.empty()) {
+		std::cout << "Usage: aquarite_cook <root> <out.apak> [-lz4] [-cache directory] [-tex auto|bc7|none] [-mip kaiser|box] <file.meta|file.ascene> ..." << std::endl;
+		return 1;
+	}
+	if (cacheDirectory.empty()) cacheDirectory = archive + ".cache";
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	JobSystem::Initialize();
+
+	Cooker cooker(root, cacheDirectory);
+	cooker.SetTextureOptions(compression, filter);
+	bool success = true;
+	for (size_t i = 0; i < files.size(); i++) {
+		if (!cooker.Add(files[i])) success = false;
+	}
+	if (!cooker.Cook(archive, compress)) success = false;
+
+	JobSystem::Destroy();
+	float time = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << "Cooked " << cooker.GetRebuiltCount() << " of " << cooker.GetAssetCount() << " assets in " << time << " ms" << std::endl;
+	return success ? 0 : 1;
+}